@@ -0,0 +1,165 @@
+/// \file benchmark_small_gemm.c
+/// \brief Benchmark of the specialized small-k matrix-matrix multiplication kernels, compared to the generic BLAS 'gemm' routines.
+
+#include <math.h>
+#include <stdio.h>
+#include <assert.h>
+#include <time.h>
+#include <cblas.h>
+#include "small_gemm.h"
+#include "dense_tensor.h"
+#include "aligned_memory.h"
+#include "rng.h"
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Matrix-matrix multiplication by the generic BLAS routines, corresponding to the previous code path.
+///
+static void blas_gemm(const enum numeric_type dtype, const CBLAS_TRANSPOSE transa, const CBLAS_TRANSPOSE transb, const long m, const long n, const long k,
+	const void* alpha, const void* a, const long lda, const void* b, const long ldb, const void* beta, void* c, const long ldc)
+{
+	switch (dtype)
+	{
+		case CT_SINGLE_REAL:
+		{
+			cblas_sgemm(CblasRowMajor, transa, transb, m, n, k, *((float*)alpha), a, lda, b, ldb, *((float*)beta), c, ldc);
+			break;
+		}
+		case CT_DOUBLE_REAL:
+		{
+			cblas_dgemm(CblasRowMajor, transa, transb, m, n, k, *((double*)alpha), a, lda, b, ldb, *((double*)beta), c, ldc);
+			break;
+		}
+		case CT_SINGLE_COMPLEX:
+		{
+			cblas_cgemm(CblasRowMajor, transa, transb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+			break;
+		}
+		case CT_DOUBLE_COMPLEX:
+		{
+			cblas_zgemm(CblasRowMajor, transa, transb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+			break;
+		}
+		default:
+		{
+			// unknown data type
+			assert(false);
+		}
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Current wall clock time in seconds.
+///
+static double wall_time()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+
+int main()
+{
+	struct rng_state rng_state;
+	seed_rng_state(42, &rng_state);
+
+	// test cases, modeled after contractions over a physical axis (d = 2 or d = 4) in DMRG,
+	// with virtual bond dimensions ranging from tiny (individual blocks of a block-sparse tensor) to moderate
+	const int num_cases = 8;
+	const long m_list[8] = {   16,   64,  256, 1024,   16,   64,  256, 1024 };
+	const long n_list[8] = {   16,   64,  256,   64,   16,   64,  256,   64 };
+	const long k_list[8] = {    2,    2,    2,    2,    4,    4,    4,    4 };
+	const CBLAS_TRANSPOSE transa_list[2] = { CblasNoTrans, CblasTrans };
+	const CBLAS_TRANSPOSE transb_list[2] = { CblasNoTrans, CblasTrans };
+	const char* dtype_names[4] = { "float", "double", "scomplex", "dcomplex" };
+
+	// minimum number of floating-point operations per measurement, to obtain measurable timings for small matrices
+	const double min_flops = 1e8;
+	// number of repetitions per measurement
+	const int num_reps = 5;
+
+	printf("%-10s %-18s %-6s %14s %14s %10s\n", "dtype", "m x n x k", "trans", "BLAS GFlop/s", "small GFlop/s", "speedup");
+
+	for (int dt = 0; dt < 4; dt++)
+	{
+		const enum numeric_type dtype = (enum numeric_type)dt;
+		const double tol = (dtype == CT_SINGLE_REAL || dtype == CT_SINGLE_COMPLEX ? 1e-5 : 1e-13);
+
+		for (int j = 0; j < num_cases; j++)
+		{
+			const long m = m_list[j];
+			const long n = n_list[j];
+			const long k = k_list[j];
+			assert(small_k_gemm_applicable(k));
+
+			for (int ta = 0; ta < 2; ta++)
+			{
+				for (int tb = 0; tb < 2; tb++)
+				{
+					const CBLAS_TRANSPOSE transa = transa_list[ta];
+					const CBLAS_TRANSPOSE transb = transb_list[tb];
+
+					struct dense_tensor a, b, c_blas, c_small;
+					const long dim_a[2] = { transa == CblasNoTrans ? m : k, transa == CblasNoTrans ? k : m };
+					const long dim_b[2] = { transb == CblasNoTrans ? k : n, transb == CblasNoTrans ? n : k };
+					const long dim_c[2] = { m, n };
+					allocate_dense_tensor(dtype, 2, dim_a, &a);
+					allocate_dense_tensor(dtype, 2, dim_b, &b);
+					allocate_dense_tensor(dtype, 2, dim_c, &c_blas);
+					allocate_dense_tensor(dtype, 2, dim_c, &c_small);
+					dense_tensor_fill_random_normal(numeric_one(dtype), numeric_zero(dtype), &rng_state, &a);
+					dense_tensor_fill_random_normal(numeric_one(dtype), numeric_zero(dtype), &rng_state, &b);
+
+					// floating-point operations per multiplication (complex multiply-add counted as 8 operations)
+					const double flops = ((dtype == CT_SINGLE_COMPLEX || dtype == CT_DOUBLE_COMPLEX) ? 8. : 2.) * m * n * k;
+					const long num_calls = (long)ceil(min_flops / flops);
+
+					double t_blas  = 1e10;
+					double t_small = 1e10;
+					for (int r = 0; r < num_reps; r++)
+					{
+						double start = wall_time();
+						for (long i = 0; i < num_calls; i++) {
+							blas_gemm(dtype, transa, transb, m, n, k, numeric_one(dtype), a.data, dim_a[1], b.data, dim_b[1], numeric_one(dtype), c_blas.data, n);
+						}
+						t_blas = fmin(t_blas, wall_time() - start);
+					}
+					for (int r = 0; r < num_reps; r++)
+					{
+						double start = wall_time();
+						for (long i = 0; i < num_calls; i++) {
+							small_k_gemm(dtype, transa, transb, m, n, k, numeric_one(dtype), a.data, dim_a[1], b.data, dim_b[1], numeric_one(dtype), c_small.data, n);
+						}
+						t_small = fmin(t_small, wall_time() - start);
+					}
+
+					// compare a single multiplication
+					blas_gemm(dtype, transa, transb, m, n, k, numeric_one(dtype), a.data, dim_a[1], b.data, dim_b[1], numeric_zero(dtype), c_blas.data, n);
+					small_k_gemm(dtype, transa, transb, m, n, k, numeric_one(dtype), a.data, dim_a[1], b.data, dim_b[1], numeric_zero(dtype), c_small.data, n);
+					if (!dense_tensor_allclose(&c_small, &c_blas, tol)) {
+						fprintf(stderr, "specialized small-k kernel does not agree with BLAS reference\n");
+						return -1;
+					}
+
+					char shape_str[64];
+					char trans_str[8];
+					sprintf(shape_str, "%li x %li x %li", m, n, k);
+					sprintf(trans_str, "%c%c", transa == CblasNoTrans ? 'N' : 'T', transb == CblasNoTrans ? 'N' : 'T');
+					printf("%-10s %-18s %-6s %14.2f %14.2f %10.2f\n", dtype_names[dt], shape_str, trans_str,
+						1e-9 * num_calls * flops / t_blas, 1e-9 * num_calls * flops / t_small, t_blas / t_small);
+
+					delete_dense_tensor(&c_small);
+					delete_dense_tensor(&c_blas);
+					delete_dense_tensor(&b);
+					delete_dense_tensor(&a);
+				}
+			}
+		}
+	}
+
+	return 0;
+}
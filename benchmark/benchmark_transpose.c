@@ -0,0 +1,216 @@
+/// \file benchmark_transpose.c
+/// \brief Benchmark of the generalized dense tensor transposition, compared to a reference implementation with strided stores.
+
+#include <math.h>
+#include <stdio.h>
+#include <assert.h>
+#include <time.h>
+#include "dense_tensor.h"
+#include "aligned_memory.h"
+#include "rng.h"
+#include "util.h"
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Reference implementation of a generalized transposition, corresponding to the previous (untiled) kernel:
+/// the last axis of 't' is copied by an innermost loop with contiguous loads and strided stores,
+/// and trailing axes which are not permuted are copied as contiguous chunks.
+///
+static void transpose_dense_tensor_reference(const int* restrict perm, const struct dense_tensor* restrict t, struct dense_tensor* restrict r)
+{
+	const size_t dtype_size = sizeof_numeric_type(t->dtype);
+
+	// trailing axes which are not permuted
+	int ax_tail = t->ndim;
+	while (ax_tail > 0 && perm[ax_tail - 1] == ax_tail - 1) {
+		ax_tail--;
+	}
+	const int ndim = (ax_tail < t->ndim ? ax_tail + 1 : ax_tail);
+	const long chunk = integer_product(t->dim + ndim, t->ndim - ndim);
+
+	// strides of the axes of 't' within 'r', in units of 'chunk'
+	long* stride_r = ct_malloc(ndim * sizeof(long));
+	long s = 1;
+	for (int i = ndim - 1; i >= 0; i--) {
+		stride_r[perm[i]] = s;
+		s *= r->dim[i];
+	}
+
+	long* index = ct_calloc(ndim, sizeof(long));
+	const long n = t->dim[ndim - 1];
+	const long sr = stride_r[ndim - 1];
+	const long nouter = integer_product(t->dim, ndim - 1);
+	long offset_r = 0;
+	for (long o = 0; o < nouter; o++)
+	{
+		const int8_t* pt = (const int8_t*)t->data + o * n * chunk * dtype_size;
+		int8_t*       pr =       (int8_t*)r->data + offset_r * chunk * dtype_size;
+		if (chunk > 1)
+		{
+			for (long i = 0; i < n; i++) {
+				memcpy(pr + i * sr * chunk * dtype_size, pt + i * chunk * dtype_size, chunk * dtype_size);
+			}
+		}
+		else
+		{
+			switch (t->dtype)
+			{
+				case CT_SINGLE_REAL:
+				{
+					for (long i = 0; i < n; i++) {
+						((float*)pr)[i*sr] = ((const float*)pt)[i];
+					}
+					break;
+				}
+				case CT_DOUBLE_REAL:
+				{
+					for (long i = 0; i < n; i++) {
+						((double*)pr)[i*sr] = ((const double*)pt)[i];
+					}
+					break;
+				}
+				case CT_SINGLE_COMPLEX:
+				{
+					for (long i = 0; i < n; i++) {
+						((scomplex*)pr)[i*sr] = ((const scomplex*)pt)[i];
+					}
+					break;
+				}
+				case CT_DOUBLE_COMPLEX:
+				{
+					for (long i = 0; i < n; i++) {
+						((dcomplex*)pr)[i*sr] = ((const dcomplex*)pt)[i];
+					}
+					break;
+				}
+				default:
+				{
+					// unknown data type
+					assert(false);
+				}
+			}
+		}
+
+		// advance outer tensor index and offset in 'r'
+		for (int i = ndim - 2; i >= 0; i--)
+		{
+			index[i]++;
+			offset_r += stride_r[i];
+			if (index[i] < t->dim[i]) {
+				break;
+			}
+			offset_r -= index[i] * stride_r[i];
+			index[i] = 0;
+		}
+	}
+
+	ct_free(index);
+	ct_free(stride_r);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Current wall clock time in seconds.
+///
+static double wall_time()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+
+int main()
+{
+	struct rng_state rng_state;
+	seed_rng_state(42, &rng_state);
+
+	// test cases, modeled after the transpositions in the local Hamiltonian application of DMRG
+	const int num_cases = 5;
+	const int ndim_list[5] = { 2, 3, 3, 4, 4 };
+	const long dim_list[5][4] = {
+		{ 2048, 2048 },
+		{  256,  32, 256 },
+		{  128, 256,  64 },
+		{   64,   8,   8,  512 },
+		{   96,  12,  96,   12 },
+	};
+	const int perm_list[5][4] = {
+		{ 1, 0 },
+		{ 2, 1, 0 },
+		{ 0, 2, 1 },
+		{ 3, 1, 2, 0 },
+		{ 2, 1, 0, 3 },
+	};
+	const char* dtype_names[4] = { "float", "double", "scomplex", "dcomplex" };
+
+	// number of repetitions per measurement
+	const int num_reps = 5;
+
+	printf("%-10s %-24s %-12s %14s %14s %10s\n", "dtype", "dimensions", "permutation", "reference GB/s", "tiled GB/s", "speedup");
+
+	for (int k = 0; k < 4; k++)
+	{
+		const enum numeric_type dtype = (enum numeric_type)k;
+
+		for (int j = 0; j < num_cases; j++)
+		{
+			const int ndim = ndim_list[j];
+			const long* dim = dim_list[j];
+			const int* perm = perm_list[j];
+
+			struct dense_tensor t;
+			allocate_dense_tensor(dtype, ndim, dim, &t);
+			dense_tensor_fill_random_normal(numeric_one(dtype), numeric_zero(dtype), &rng_state, &t);
+
+			struct dense_tensor r_ref;
+			transpose_dense_tensor(perm, &t, &r_ref);
+			struct dense_tensor r;
+			allocate_dense_tensor(dtype, ndim, r_ref.dim, &r);
+
+			// bytes read and written per transposition
+			const double nbytes = 2. * dense_tensor_num_elements(&t) * sizeof_numeric_type(dtype);
+
+			double t_ref = 1e10;
+			double t_tiled = 1e10;
+			for (int n = 0; n < num_reps; n++)
+			{
+				double start = wall_time();
+				transpose_dense_tensor_reference(perm, &t, &r);
+				t_ref = fmin(t_ref, wall_time() - start);
+			}
+			if (!dense_tensor_allclose(&r, &r_ref, 0.)) {
+				fprintf(stderr, "reference transposition does not agree with 'transpose_dense_tensor'\n");
+				return -1;
+			}
+			for (int n = 0; n < num_reps; n++)
+			{
+				double start = wall_time();
+				transpose_dense_tensor_fill(perm, &t, &r);
+				t_tiled = fmin(t_tiled, wall_time() - start);
+			}
+			if (!dense_tensor_allclose(&r, &r_ref, 0.)) {
+				fprintf(stderr, "'transpose_dense_tensor_fill' does not agree with 'transpose_dense_tensor'\n");
+				return -1;
+			}
+
+			char dim_str[64];
+			char perm_str[64];
+			int ld = 0;
+			int lp = 0;
+			for (int i = 0; i < ndim; i++) {
+				ld += sprintf(dim_str + ld, (i == 0 ? "%li" : " x %li"), dim[i]);
+				lp += sprintf(perm_str + lp, (i == 0 ? "%i" : ",%i"), perm[i]);
+			}
+			printf("%-10s %-24s %-12s %14.2f %14.2f %10.2f\n", dtype_names[k], dim_str, perm_str, 1e-9 * nbytes / t_ref, 1e-9 * nbytes / t_tiled, t_ref / t_tiled);
+
+			delete_dense_tensor(&r);
+			delete_dense_tensor(&r_ref);
+			delete_dense_tensor(&t);
+		}
+	}
+
+	return 0;
+}
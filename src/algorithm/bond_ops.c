@@ -201,40 +201,40 @@ void retained_bond_indices(const double* sigma, const long n, const double tol,
 
 //________________________________________________________________________________________________________________________
 ///
-/// \brief Split a block-sparse matrix by singular value decomposition,
+/// \brief Split a block-sparse matrix by singular value decomposition into the isometries 'u' and 'vh' and the retained singular values 's',
 /// and truncate small singular values based on tolerance and maximum bond dimension.
 ///
-int split_block_sparse_matrix_svd(const struct block_sparse_tensor* restrict a,
-	const double tol, const long max_vdim, const bool renormalize, const enum singular_value_distr svd_distr,
-	struct block_sparse_tensor* restrict a0, struct block_sparse_tensor* restrict a1, struct trunc_info* info)
+int split_block_sparse_matrix_svd_isometries(const struct block_sparse_tensor* restrict a,
+	const double tol, const long max_vdim, const bool renormalize,
+	struct block_sparse_tensor* restrict u, struct dense_tensor* restrict s, struct block_sparse_tensor* restrict vh, struct trunc_info* info)
 {
 	assert(a->ndim == 2);
 
-	struct block_sparse_tensor u, vh;
-	struct dense_tensor s;
-	int ret = block_sparse_tensor_svd(a, &u, &s, &vh);
+	struct block_sparse_tensor u_full, vh_full;
+	struct dense_tensor s_full;
+	int ret = block_sparse_tensor_svd(a, &u_full, &s_full, &vh_full);
 	if (ret < 0) {
 		return ret;
 	}
 
 	// determine retained bond indices
 	struct index_list retained;
-	if (s.dtype == CT_DOUBLE_REAL)
+	if (s_full.dtype == CT_DOUBLE_REAL)
 	{
-		retained_bond_indices(s.data, s.dim[0], tol, max_vdim, &retained, info);
+		retained_bond_indices(s_full.data, s_full.dim[0], tol, max_vdim, &retained, info);
 	}
 	else
 	{
-		assert(s.dtype == CT_SINGLE_REAL);
+		assert(s_full.dtype == CT_SINGLE_REAL);
 
 		// temporarily convert singular values to double format
-		const float* sdata = s.data;
-		double* sigma = ct_malloc(s.dim[0] * sizeof(double));
-		for (long i = 0; i < s.dim[0]; i++) {
+		const float* sdata = s_full.data;
+		double* sigma = ct_malloc(s_full.dim[0] * sizeof(double));
+		for (long i = 0; i < s_full.dim[0]; i++) {
 			sigma[i] = (double)sdata[i];
 		}
 
-		retained_bond_indices(sigma, s.dim[0], tol, max_vdim, &retained, info);
+		retained_bond_indices(sigma, s_full.dim[0], tol, max_vdim, &retained, info);
 
 		ct_free(sigma);
 	}
@@ -243,88 +243,88 @@ int split_block_sparse_matrix_svd(const struct block_sparse_tensor* restrict a,
 	{
 		// use dummy virtual bond dimension 1
 		const long ind[1] = { 0 };
-		block_sparse_tensor_slice(&u, 1, ind, 1, a0);
-		delete_block_sparse_tensor(&u);
+		block_sparse_tensor_slice(&u_full, 1, ind, 1, u);
+		delete_block_sparse_tensor(&u_full);
 		// note: 'vh' is not an isometry in the special case of incompatible quantum numbers in 'a'
-		block_sparse_tensor_slice(&vh, 0, ind, 1, a1);
-		delete_block_sparse_tensor(&vh);
+		block_sparse_tensor_slice(&vh_full, 0, ind, 1, vh);
+		delete_block_sparse_tensor(&vh_full);
 
 		// dummy singular value vector with a single entry 0
-		struct dense_tensor s_zero;
 		const long sdim[1] = { 1 };
-		allocate_dense_tensor(s.dtype, 1, sdim, &s_zero);
-		delete_dense_tensor(&s);
-
-		if (svd_distr == SVD_DISTR_LEFT)
-		{
-			struct block_sparse_tensor tmp;
-			block_sparse_tensor_multiply_pointwise_vector(a0, &s_zero, TENSOR_AXIS_RANGE_TRAILING, &tmp);
-			delete_block_sparse_tensor(a0);
-			move_block_sparse_tensor_data(&tmp, a0);
-		}
-		else
-		{
-			struct block_sparse_tensor tmp;
-			block_sparse_tensor_multiply_pointwise_vector(a1, &s_zero, TENSOR_AXIS_RANGE_LEADING, &tmp);
-			delete_block_sparse_tensor(a1);
-			move_block_sparse_tensor_data(&tmp, a1);
-		}
-
-		delete_dense_tensor(&s_zero);
+		allocate_dense_tensor(s_full.dtype, 1, sdim, s);
+		delete_dense_tensor(&s_full);
 
 		return 0;
 	}
 
 	// select retained singular values and corresponding matrix slices
 
-	block_sparse_tensor_slice(&u, 1, retained.ind, retained.num, a0);
-	delete_block_sparse_tensor(&u);
+	block_sparse_tensor_slice(&u_full, 1, retained.ind, retained.num, u);
+	delete_block_sparse_tensor(&u_full);
 
-	block_sparse_tensor_slice(&vh, 0, retained.ind, retained.num, a1);
-	delete_block_sparse_tensor(&vh);
+	block_sparse_tensor_slice(&vh_full, 0, retained.ind, retained.num, vh);
+	delete_block_sparse_tensor(&vh_full);
 
-	struct dense_tensor s_ret;
-	dense_tensor_slice(&s, 0, retained.ind, retained.num, &s_ret);
+	dense_tensor_slice(&s_full, 0, retained.ind, retained.num, s);
 	if (renormalize)
 	{
 		// norm of all singular values
-		const double norm_sigma_all = dense_tensor_norm2(&s);
+		const double norm_sigma_all = dense_tensor_norm2(&s_full);
 
 		// rescale retained singular values
 		assert(info->norm_sigma > 0);
 		const double scale = norm_sigma_all / info->norm_sigma;
-		if (s_ret.dtype == CT_SINGLE_REAL)
+		if (s->dtype == CT_SINGLE_REAL)
 		{
 			const float scalef = (float)scale;
-			scale_dense_tensor(&scalef, &s_ret);
+			scale_dense_tensor(&scalef, s);
 		}
 		else
 		{
-			assert(s_ret.dtype == CT_DOUBLE_REAL);
-			scale_dense_tensor(&scale, &s_ret);
+			assert(s->dtype == CT_DOUBLE_REAL);
+			scale_dense_tensor(&scale, s);
 		}
 	}
-	delete_dense_tensor(&s);
+	delete_dense_tensor(&s_full);
 
 	delete_index_list(&retained);
 
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Split a block-sparse matrix by singular value decomposition,
+/// and truncate small singular values based on tolerance and maximum bond dimension.
+///
+int split_block_sparse_matrix_svd(const struct block_sparse_tensor* restrict a,
+	const double tol, const long max_vdim, const bool renormalize, const enum singular_value_distr svd_distr,
+	struct block_sparse_tensor* restrict a0, struct block_sparse_tensor* restrict a1, struct trunc_info* info)
+{
+	struct dense_tensor s;
+	int ret = split_block_sparse_matrix_svd_isometries(a, tol, max_vdim, renormalize, a0, &s, a1, info);
+	if (ret < 0) {
+		return ret;
+	}
+
 	// multiply retained singular values with left or right isometry
 	if (svd_distr == SVD_DISTR_LEFT)
 	{
 		struct block_sparse_tensor tmp;
-		block_sparse_tensor_multiply_pointwise_vector(a0, &s_ret, TENSOR_AXIS_RANGE_TRAILING, &tmp);
+		block_sparse_tensor_multiply_pointwise_vector(a0, &s, TENSOR_AXIS_RANGE_TRAILING, &tmp);
 		delete_block_sparse_tensor(a0);
 		move_block_sparse_tensor_data(&tmp, a0);
 	}
 	else
 	{
 		struct block_sparse_tensor tmp;
-		block_sparse_tensor_multiply_pointwise_vector(a1, &s_ret, TENSOR_AXIS_RANGE_LEADING, &tmp);
+		block_sparse_tensor_multiply_pointwise_vector(a1, &s, TENSOR_AXIS_RANGE_LEADING, &tmp);
 		delete_block_sparse_tensor(a1);
 		move_block_sparse_tensor_data(&tmp, a1);
 	}
 
-	delete_dense_tensor(&s_ret);
+	delete_dense_tensor(&s);
 
 	return 0;
 }
@@ -50,6 +50,10 @@ enum singular_value_distr
 };
 
 
+int split_block_sparse_matrix_svd_isometries(const struct block_sparse_tensor* restrict a,
+	const double tol, const long max_vdim, const bool renormalize,
+	struct block_sparse_tensor* restrict u, struct dense_tensor* restrict s, struct block_sparse_tensor* restrict vh, struct trunc_info* info);
+
 int split_block_sparse_matrix_svd(const struct block_sparse_tensor* restrict a,
 	const double tol, const long max_vdim, const bool renormalize, const enum singular_value_distr svd_distr,
 	struct block_sparse_tensor* restrict a0, struct block_sparse_tensor* restrict a1, struct trunc_info* info);
@@ -4,6 +4,7 @@
 #include <memory.h>
 #include <assert.h>
 #include "chain_ops.h"
+#include "aligned_memory.h"
 
 
 //________________________________________________________________________________________________________________________
@@ -35,7 +36,7 @@ void create_dummy_operator_block_right(const struct block_sparse_tensor* restric
 	};
 	struct block_sparse_tensor s;
 	allocate_block_sparse_tensor(dtype, 6, dim, axis_dir, qnums, &s);
-	assert(s.blocks[0] != NULL);
+	assert(s.nblocks == 1);
 	memcpy(s.blocks[0]->data, numeric_one(dtype), sizeof_numeric_type(dtype));
 	struct block_sparse_tensor t;
 	flatten_block_sparse_tensor_axes(&s, 4, TENSOR_AXIS_IN, &t);
@@ -74,7 +75,7 @@ void create_dummy_operator_block_left(const struct block_sparse_tensor* restrict
 	};
 	struct block_sparse_tensor s;
 	allocate_block_sparse_tensor(dtype, 6, dim, axis_dir, qnums, &s);
-	assert(s.blocks[0] != NULL);
+	assert(s.nblocks == 1);
 	memcpy(s.blocks[0]->data, numeric_one(dtype), sizeof_numeric_type(dtype));
 	struct block_sparse_tensor t;
 	flatten_block_sparse_tensor_axes(&s, 0, TENSOR_AXIS_OUT, &t);
@@ -119,37 +120,35 @@ void contraction_operator_step_right(const struct block_sparse_tensor* restrict
 	struct block_sparse_tensor s;
 	block_sparse_tensor_dot(a, TENSOR_AXIS_RANGE_TRAILING, r, TENSOR_AXIS_RANGE_LEADING, 1, &s);
 
-	// multiply with 'w' tensor
-	// re-order first three dimensions
-	const int perm0[5] = { 1, 2, 0, 3, 4 };
+	// multiply with 'w' tensor, contracting the axes [w2, w3] with [a1, r1] in place: [w0, w1, a0, r2, r3]
+	const int axes_w[2] = { 2, 3 };
+	const int axes_s[2] = { 1, 2 };
 	struct block_sparse_tensor t;
-	transpose_block_sparse_tensor(perm0, &s, &t);
-	delete_block_sparse_tensor(&s);
-	block_sparse_tensor_dot(w, TENSOR_AXIS_RANGE_TRAILING, &t, TENSOR_AXIS_RANGE_LEADING, 2, &s);
-	delete_block_sparse_tensor(&t);
-	// undo re-ordering
-	const int perm1[5] = { 2, 0, 1, 3, 4 };
-	transpose_block_sparse_tensor(perm1, &s, &t);
+	block_sparse_tensor_contract(w, axes_w, &s, axes_s, 2, &t);
 	delete_block_sparse_tensor(&s);
 
-	// TODO: fuse transpositions
-
-	// multiply with conjugated 'b' tensor
-	struct block_sparse_tensor bc;
-	copy_block_sparse_tensor(b, &bc);  // TODO: fuse conjugation with dot product
-	conjugate_block_sparse_tensor(&bc);
-	block_sparse_tensor_reverse_axis_directions(&bc);
-	// temporarily make trailing dimension in 't' the leading dimension
-	const int perm2[5] = { 4, 0, 1, 2, 3 };
-	transpose_block_sparse_tensor(perm2, &t, &s);
+	// multiply with conjugated 'b' tensor (conjugation is performed within the matrix-matrix multiplications)
+	// lazily re-order dimensions: [a0, w0, r3, w1, r2]
+	const int perm0[5] = { 2, 0, 4, 1, 3 };
+	struct block_sparse_tensor_lazy_view tv;
+	create_block_sparse_tensor_lazy_view(&t, &tv);
+	block_sparse_tensor_lazy_view_transpose(perm0, &tv);
+	struct block_sparse_tensor_lazy_view bv;
+	create_block_sparse_tensor_lazy_view(b, &bv);
+	block_sparse_tensor_lazy_view_conjugate(&bv);
+	const int axes_tv[2] = { 3, 4 };
+	const int axes_bv[2] = { 1, 2 };
+	struct block_sparse_tensor_lazy_view sv;
+	block_sparse_tensor_lazy_view_contract(&tv, axes_tv, &bv, axes_bv, 2, &s, &sv);
+	delete_block_sparse_tensor_lazy_view(&bv);
+	delete_block_sparse_tensor_lazy_view(&tv);
 	delete_block_sparse_tensor(&t);
-	block_sparse_tensor_dot(&s, TENSOR_AXIS_RANGE_TRAILING, &bc, TENSOR_AXIS_RANGE_TRAILING, 2, &t);
+	// swap trailing dimensions; composed with the pending permutation, such that the entries are re-ordered only once
+	const int perm1[4] = { 0, 1, 3, 2 };
+	block_sparse_tensor_lazy_view_transpose(perm1, &sv);
+	block_sparse_tensor_lazy_view_materialize(&sv, r_next);
+	delete_block_sparse_tensor_lazy_view(&sv);
 	delete_block_sparse_tensor(&s);
-	delete_block_sparse_tensor(&bc);
-	// restore original trailing dimension
-	const int perm3[4] = { 1, 2, 3, 0 };
-	transpose_block_sparse_tensor(perm3, &t, r_next);
-	delete_block_sparse_tensor(&t);
 }
 
 
@@ -184,41 +183,26 @@ void contraction_operator_step_left(const struct block_sparse_tensor* restrict a
 	assert(w->ndim == 4);
 	assert(l->ndim == 4);
 
-	// multiply with conjugated 'b' tensor
-	struct block_sparse_tensor bc;
-	copy_block_sparse_tensor(b, &bc);  // TODO: fuse conjugation with dot product
-	conjugate_block_sparse_tensor(&bc);
-	block_sparse_tensor_reverse_axis_directions(&bc);
+	// multiply with conjugated 'b' tensor (conjugation is performed within the matrix-matrix multiplications)
 	struct block_sparse_tensor s;
-	block_sparse_tensor_dot(l, TENSOR_AXIS_RANGE_TRAILING, &bc, TENSOR_AXIS_RANGE_LEADING, 1, &s);
-	delete_block_sparse_tensor(&bc);
+	block_sparse_tensor_dot_conj(b, TENSOR_AXIS_RANGE_LEADING, true, l, TENSOR_AXIS_RANGE_TRAILING, false, 1, &s);
 
-	// multiply with 'w' tensor
-	// re-order last three dimensions
-	const int perm0[5] = { 0, 1, 4, 2, 3 };
+	// multiply with 'w' tensor, contracting the axes [l2, b1] with [w0, w1] in place: [b2, l0, l1, w2, w3]
+	const int axes_s0[2] = { 4, 0 };
+	const int axes_w[2]  = { 0, 1 };
 	struct block_sparse_tensor t;
-	transpose_block_sparse_tensor(perm0, &s, &t);
+	block_sparse_tensor_contract(&s, axes_s0, w, axes_w, 2, &t);
 	delete_block_sparse_tensor(&s);
-	block_sparse_tensor_dot(&t, TENSOR_AXIS_RANGE_TRAILING, w, TENSOR_AXIS_RANGE_LEADING, 2, &s);
-	delete_block_sparse_tensor(&t);
-	// undo re-ordering
-	const int perm1[5] = { 0, 1, 3, 4, 2 };
-	transpose_block_sparse_tensor(perm1, &s, &t);
-	delete_block_sparse_tensor(&s);
-
-	// TODO: fuse transpositions
 
-	// multiply with 'a' tensor
-	// temporarily make leading dimension in 't' the trailing dimension
-	const int perm2[5] = { 1, 2, 3, 4, 0 };
-	transpose_block_sparse_tensor(perm2, &t, &s);
+	// multiply with 'a' tensor, contracting the axes [l1, w2] with [a0, a1] in place: [b2, l0, w3, a2]
+	const int axes_t[2] = { 2, 3 };
+	const int axes_a[2] = { 0, 1 };
+	block_sparse_tensor_contract(&t, axes_t, a, axes_a, 2, &s);
 	delete_block_sparse_tensor(&t);
-	block_sparse_tensor_dot(a, TENSOR_AXIS_RANGE_LEADING, &s, TENSOR_AXIS_RANGE_LEADING, 2, &t);
+	// re-order dimensions: [l0, a2, w3, b2]
+	const int perm[4] = { 1, 3, 2, 0 };
+	transpose_block_sparse_tensor(perm, &s, l_next);
 	delete_block_sparse_tensor(&s);
-	// restore original leading dimension
-	const int perm3[4] = { 3, 0, 1, 2 };
-	transpose_block_sparse_tensor(perm3, &t, l_next);
-	delete_block_sparse_tensor(&t);
 }
 
 
@@ -288,7 +272,7 @@ void mpo_inner_product(const struct mps* chi, const struct mpo* op, const struct
 	// 'r' should now be a 1 x 1 tensor
 	assert(r.ndim == 2);
 	assert(r.dim_logical[0] == 1 && r.dim_logical[1] == 1);
-	assert(r.blocks[0] != NULL);
+	assert(r.nblocks == 1);
 	memcpy(ret, r.blocks[0]->data, sizeof_numeric_type(dtype));
 	delete_block_sparse_tensor(&r);
 }
@@ -334,26 +318,17 @@ void apply_local_hamiltonian(const struct block_sparse_tensor* restrict a, const
 	struct block_sparse_tensor s;
 	block_sparse_tensor_dot(a, TENSOR_AXIS_RANGE_TRAILING, r, TENSOR_AXIS_RANGE_LEADING, 1, &s);
 
-	// multiply with 'w' tensor
-	// re-order first three dimensions
-	const int perm0[5] = { 1, 2, 0, 3, 4 };
+	// multiply with 'w' tensor, contracting the axes [w2, w3] with [a1, r1] in place: [w0, w1, a0, r2, r3]
+	const int axes_w[2] = { 2, 3 };
+	const int axes_s[2] = { 1, 2 };
 	struct block_sparse_tensor t;
-	transpose_block_sparse_tensor(perm0, &s, &t);
-	delete_block_sparse_tensor(&s);
-	block_sparse_tensor_dot(w, TENSOR_AXIS_RANGE_TRAILING, &t, TENSOR_AXIS_RANGE_LEADING, 2, &s);
-	delete_block_sparse_tensor(&t);
-	// undo re-ordering
-	const int perm1[5] = { 2, 0, 1, 3, 4 };
-	transpose_block_sparse_tensor(perm1, &s, &t);
+	block_sparse_tensor_contract(w, axes_w, &s, axes_s, 2, &t);
 	delete_block_sparse_tensor(&s);
 
-	// multiply with 'l' tensor
-	// re-order last three dimensions
-	const int perm2[4] = { 0, 3, 1, 2 };
-	struct block_sparse_tensor k;
-	transpose_block_sparse_tensor(perm2, l, &k);
-	block_sparse_tensor_dot(&k, TENSOR_AXIS_RANGE_TRAILING, &t, TENSOR_AXIS_RANGE_LEADING, 2, &s);
-	delete_block_sparse_tensor(&k);
+	// multiply with 'l' tensor, contracting the axes [l1, l2] with [a0, w0] in place: [l0, l3, w1, r2, r3]
+	const int axes_l[2] = { 1, 2 };
+	const int axes_t[2] = { 2, 0 };
+	block_sparse_tensor_contract(l, axes_l, &t, axes_t, 2, &s);
 	delete_block_sparse_tensor(&t);
 
 	// trace out outer virtual bonds (assumed to be low-dimensional)
@@ -362,6 +337,264 @@ void apply_local_hamiltonian(const struct block_sparse_tensor* restrict a, const
 }
 
 
+//________________________________________________________________________________________________________________________
+///
+/// \brief Create the contraction plans and workspace for repeatedly applying a local Hamiltonian operator (see 'apply_local_hamiltonian')
+/// to MPS tensors with the same block sparsity structure as 'a'.
+///
+/// The entries of 'a' are not accessed, and 'w', 'l' and 'r' must be provided again when executing the plan.
+/// All intermediate tensors are allocated here, such that executing the plan does not allocate any memory.
+/// The contractions operate on the original axis orderings via strided matrix-matrix multiplications, without transposed copies.
+///
+void create_apply_local_hamiltonian_plan(const struct block_sparse_tensor* restrict a, const struct block_sparse_tensor* restrict w,
+	const struct block_sparse_tensor* restrict l, const struct block_sparse_tensor* restrict r, struct apply_local_hamiltonian_plan* restrict plan)
+{
+	assert(a->ndim == 3);
+	assert(w->ndim == 4);
+	assert(l->ndim == 4);
+	assert(r->ndim == 4);
+
+	// trace the block sparsity structure of the intermediate tensors and allocate them
+
+	// contract 'a' with 'r'; output axes: left virtual bond of 'a', physical axis of 'a', virtual bonds of 'r'
+	create_block_sparse_tensor_dot_plan(a, TENSOR_AXIS_RANGE_TRAILING, r, TENSOR_AXIS_RANGE_LEADING, 1, &plan->plan_ar);
+	allocate_block_sparse_tensor_dot_output(&plan->plan_ar, &plan->s_ar);
+
+	// contract the input physical and right virtual bond of 'w' with the corresponding axes of 's_ar', without re-ordering
+	const int axes_w[2]  = { 2, 3 };
+	const int axes_ar[2] = { 1, 2 };
+	create_block_sparse_tensor_contract_plan(w, axes_w, &plan->s_ar, axes_ar, 2, &plan->plan_wt);
+	allocate_block_sparse_tensor_dot_output(&plan->plan_wt, &plan->s_wt);
+
+	// contract the inner virtual bonds of 'l' with the corresponding (non-consecutive) axes of 's_wt', without re-ordering
+	const int axes_l[2]  = { 1, 2 };
+	const int axes_wt[2] = { 2, 0 };
+	create_block_sparse_tensor_contract_plan(l, axes_l, &plan->s_wt, axes_wt, 2, &plan->plan_lt);
+	allocate_block_sparse_tensor_dot_output(&plan->plan_lt, &plan->s_lt);
+
+	// input and output tensors referring to external flat vectors
+	allocate_block_sparse_tensor_view(a, &plan->a_view);
+	struct block_sparse_tensor b;
+	block_sparse_tensor_cyclic_partial_trace(&plan->s_lt, 1, &b);
+	// output must have the same block structure as the input
+	assert(b.nblocks == a->nblocks);
+	for (long k = 0; k < b.nblocks; k++) {
+		assert(b.grid_offsets[k] == a->grid_offsets[k]);
+	}
+	allocate_block_sparse_tensor_view(&b, &plan->b_view);
+	delete_block_sparse_tensor(&b);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Delete the contraction plans and workspace for applying a local Hamiltonian operator (free memory).
+///
+void delete_apply_local_hamiltonian_plan(struct apply_local_hamiltonian_plan* plan)
+{
+	delete_block_sparse_tensor_view(&plan->b_view);
+	delete_block_sparse_tensor_view(&plan->a_view);
+	delete_block_sparse_tensor(&plan->s_lt);
+	delete_block_sparse_tensor(&plan->s_wt);
+	delete_block_sparse_tensor(&plan->s_ar);
+	delete_block_sparse_tensor_dot_plan(&plan->plan_lt);
+	delete_block_sparse_tensor_dot_plan(&plan->plan_wt);
+	delete_block_sparse_tensor_dot_plan(&plan->plan_ar);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Apply a local Hamiltonian operator using the precomputed plan and workspace, storing the result in the already allocated tensor 'b'.
+///
+static void apply_local_hamiltonian_execute_fill(struct apply_local_hamiltonian_plan* restrict plan, const struct block_sparse_tensor* restrict a, const struct block_sparse_tensor* restrict w,
+	const struct block_sparse_tensor* restrict l, const struct block_sparse_tensor* restrict r, struct block_sparse_tensor* restrict b)
+{
+	const void* one  = numeric_one(a->dtype);
+	const void* zero = numeric_zero(a->dtype);
+
+	// multiply with 'a' tensor
+	block_sparse_tensor_dot_execute(&plan->plan_ar, one, a, r, zero, &plan->s_ar);
+
+	// multiply with 'w' tensor
+	block_sparse_tensor_dot_execute(&plan->plan_wt, one, w, &plan->s_ar, zero, &plan->s_wt);
+
+	// multiply with 'l' tensor
+	block_sparse_tensor_dot_execute(&plan->plan_lt, one, l, &plan->s_wt, zero, &plan->s_lt);
+
+	// trace out outer virtual bonds (assumed to be low-dimensional)
+	block_sparse_tensor_cyclic_partial_trace_fill(&plan->s_lt, 1, b);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Apply a local Hamiltonian operator using precomputed contraction plans; equivalent to 'apply_local_hamiltonian'.
+///
+/// Tensors 'a', 'w', 'l' and 'r' must have the same block sparsity structure as the tensors used for creating the plan.
+/// Memory will be allocated for 'b'.
+///
+void apply_local_hamiltonian_execute(struct apply_local_hamiltonian_plan* restrict plan, const struct block_sparse_tensor* restrict a, const struct block_sparse_tensor* restrict w,
+	const struct block_sparse_tensor* restrict l, const struct block_sparse_tensor* restrict r, struct block_sparse_tensor* restrict b)
+{
+	allocate_block_sparse_tensor_like(&plan->b_view, b);
+	apply_local_hamiltonian_execute_fill(plan, a, w, l, r, b);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Apply a local Hamiltonian operator to the MPS tensor entries 'v', and store the result in 'ret'.
+///
+/// Both 'v' and 'ret' use the flat layout of 'block_sparse_tensor_serialize_entries' for the block sparsity structure of the plan.
+/// The function operates on the preallocated workspace of the plan and does not allocate any memory.
+///
+void apply_local_hamiltonian_execute_entries(struct apply_local_hamiltonian_plan* restrict plan, const struct block_sparse_tensor* restrict w,
+	const struct block_sparse_tensor* restrict l, const struct block_sparse_tensor* restrict r, const void* restrict v, void* restrict ret)
+{
+	// input entries are only read
+	block_sparse_tensor_view_entries(&plan->a_view, (void*)v);
+	block_sparse_tensor_view_entries(&plan->b_view, ret);
+
+	apply_local_hamiltonian_execute_fill(plan, &plan->a_view, w, l, r, &plan->b_view);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Extract the "diagonal" entries of a dense tensor with respect to the axes 'i_ax' and 'j_ax' (i.e., both indices are equal),
+/// with axis 'j_ax' removed in the output tensor 'r'.
+///
+/// Memory will be allocated for 'r'.
+///
+static void dense_tensor_diagonal_axes(const struct dense_tensor* restrict t, const int i_ax, const int j_ax, struct dense_tensor* restrict r)
+{
+	assert(0 <= i_ax && i_ax < j_ax && j_ax < t->ndim);
+	assert(t->dim[i_ax] == t->dim[j_ax]);
+
+	long* rdim = ct_malloc((t->ndim - 1) * sizeof(long));
+	for (int i = 0; i < t->ndim - 1; i++) {
+		rdim[i] = t->dim[i < j_ax ? i : i + 1];
+	}
+	allocate_dense_tensor(t->dtype, t->ndim - 1, rdim, r);
+	ct_free(rdim);
+
+	const size_t dtype_size = sizeof_numeric_type(t->dtype);
+
+	long* index_r = ct_calloc(r->ndim, sizeof(long));
+	long* index_t = ct_malloc(t->ndim * sizeof(long));
+	const long nelem = dense_tensor_num_elements(r);
+	for (long k = 0; k < nelem; k++, next_tensor_index(r->ndim, r->dim, index_r))
+	{
+		for (int i = 0; i < t->ndim; i++) {
+			index_t[i] = (i < j_ax ? index_r[i] : (i == j_ax ? index_r[i_ax] : index_r[i - 1]));
+		}
+		// casting to int8_t* to ensure that pointer arithmetic is performed in terms of bytes
+		memcpy((int8_t*)r->data + k * dtype_size, (int8_t*)t->data + tensor_index_to_offset(t->ndim, t->dim, index_t) * dtype_size, dtype_size);
+	}
+	ct_free(index_t);
+	ct_free(index_r);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Compute the diagonal entries of a local Hamiltonian operator (see 'apply_local_hamiltonian'),
+/// stored as block-sparse tensor 'd' with the same structure as the MPS tensor 'a'.
+///
+/// The diagonal entries can serve as preconditioner for iterative eigensolvers.
+/// Only the block sparsity structure of 'a' is accessed. Memory will be allocated for 'd'.
+///
+void compute_local_hamiltonian_diagonal(const struct block_sparse_tensor* restrict a, const struct block_sparse_tensor* restrict w,
+	const struct block_sparse_tensor* restrict l, const struct block_sparse_tensor* restrict r, struct block_sparse_tensor* restrict d)
+{
+	assert(a->ndim == 3);
+	assert(w->ndim == 4);
+	assert(l->ndim == 4);
+	assert(r->ndim == 4);
+
+	// d[α, σ, β] = sum_{o, μ, ν} l[o, α, μ, α] w[μ, σ, σ, ν] r[β, ν, β, o],
+	// evaluated as sum_{o, ν} (sum_μ l[o, α, μ, α] w[μ, σ, σ, ν]) r[β, ν, β, o]
+
+	allocate_block_sparse_tensor_like(a, d);
+
+	const void* one = numeric_one(a->dtype);
+
+	long index_block_d[3];
+	long index_block_l[4];
+	long index_block_w[4];
+	long index_block_r[4];
+	for (long k = 0; k < d->nblocks; k++)
+	{
+		block_sparse_tensor_block_index(d, k, index_block_d);
+		struct dense_tensor* bd = d->blocks[k];
+
+		for (long io = 0; io < l->dim_blocks[0]; io++)
+		{
+			for (long in = 0; in < w->dim_blocks[3]; in++)
+			{
+				index_block_r[0] = index_block_d[2];
+				index_block_r[1] = in;
+				index_block_r[2] = index_block_d[2];
+				index_block_r[3] = io;
+				const struct dense_tensor* br = block_sparse_tensor_find_block(r, index_block_r);
+				if (br == NULL) {
+					continue;
+				}
+
+				// contract diagonals of 'l' and 'w' blocks along the left MPO virtual bond
+				struct dense_tensor lw;
+				const long dim_lw[4] = { br->dim[3], bd->dim[0], bd->dim[1], br->dim[1] };
+				allocate_dense_tensor(a->dtype, 4, dim_lw, &lw);
+				bool found = false;
+				for (long im = 0; im < l->dim_blocks[2]; im++)
+				{
+					index_block_l[0] = io;
+					index_block_l[1] = index_block_d[0];
+					index_block_l[2] = im;
+					index_block_l[3] = index_block_d[0];
+					const struct dense_tensor* bl = block_sparse_tensor_find_block(l, index_block_l);
+					index_block_w[0] = im;
+					index_block_w[1] = index_block_d[1];
+					index_block_w[2] = index_block_d[1];
+					index_block_w[3] = in;
+					const struct dense_tensor* bw = block_sparse_tensor_find_block(w, index_block_w);
+					if (bl == NULL || bw == NULL) {
+						continue;
+					}
+
+					struct dense_tensor ld, wd;
+					dense_tensor_diagonal_axes(bl, 1, 3, &ld);
+					dense_tensor_diagonal_axes(bw, 1, 2, &wd);
+					// 'lw' has been initialized to zero
+					dense_tensor_dot_update(one, &ld, TENSOR_AXIS_RANGE_TRAILING, &wd, TENSOR_AXIS_RANGE_LEADING, 1, one, &lw);
+					delete_dense_tensor(&wd);
+					delete_dense_tensor(&ld);
+					found = true;
+				}
+				if (!found) {
+					delete_dense_tensor(&lw);
+					continue;
+				}
+
+				// contract with diagonal of 'r' block along outer and right MPO virtual bonds
+				struct dense_tensor rd, rd_perm, lw_perm;
+				dense_tensor_diagonal_axes(br, 0, 2, &rd);
+				const int perm_r[3] = { 1, 2, 0 };
+				transpose_dense_tensor(perm_r, &rd, &rd_perm);
+				const int perm_lw[4] = { 1, 2, 3, 0 };
+				transpose_dense_tensor(perm_lw, &lw, &lw_perm);
+				dense_tensor_dot_update(one, &lw_perm, TENSOR_AXIS_RANGE_TRAILING, &rd_perm, TENSOR_AXIS_RANGE_LEADING, 2, one, bd);
+				delete_dense_tensor(&lw_perm);
+				delete_dense_tensor(&rd_perm);
+				delete_dense_tensor(&rd);
+				delete_dense_tensor(&lw);
+			}
+		}
+	}
+}
+
+
 //________________________________________________________________________________________________________________________
 ///
 /// \brief Evaluate the network environment of a local Hamiltonian operator.
@@ -400,36 +633,160 @@ void compute_local_hamiltonian_environment(const struct block_sparse_tensor* res
 	struct block_sparse_tensor s;
 	block_sparse_tensor_dot(a, TENSOR_AXIS_RANGE_TRAILING, r, TENSOR_AXIS_RANGE_LEADING, 1, &s);
 
-	// multiply with conjugated 'b' tensor
-	struct block_sparse_tensor bc;
-	copy_block_sparse_tensor(b, &bc);  // TODO: fuse conjugation with dot product
-	conjugate_block_sparse_tensor(&bc);
-	block_sparse_tensor_reverse_axis_directions(&bc);
-	// re-order last two dimensions
-	const int perm0[5] = { 0, 1, 2, 4, 3 };
+	// multiply with conjugated 'b' tensor, contracting the axes [r2] with [b2]: [a0, a1, r1, r3, b0, b1]
+	struct block_sparse_tensor_lazy_view sv;
+	create_block_sparse_tensor_lazy_view(&s, &sv);
+	struct block_sparse_tensor_lazy_view bv;
+	create_block_sparse_tensor_lazy_view(b, &bv);
+	block_sparse_tensor_lazy_view_conjugate(&bv);
+	const int axes_sv[1] = { 3 };
+	const int axes_bv[1] = { 2 };
 	struct block_sparse_tensor t;
-	transpose_block_sparse_tensor(perm0, &s, &t);
+	struct block_sparse_tensor_lazy_view tv;
+	block_sparse_tensor_lazy_view_contract(&sv, axes_sv, &bv, axes_bv, 1, &t, &tv);
+	delete_block_sparse_tensor_lazy_view(&bv);
+	delete_block_sparse_tensor_lazy_view(&sv);
 	delete_block_sparse_tensor(&s);
-	block_sparse_tensor_dot(&bc, TENSOR_AXIS_RANGE_TRAILING, &t, TENSOR_AXIS_RANGE_TRAILING, 1, &s);
+
+	// multiply with 'l' tensor, contracting the axes [l1, l3] with [a0, b0]
+	// lazily re-order dimensions of 't' (to make MPS virtual bond dimensions the leading dimensions)
+	const int perm[6] = { 0, 4, 5, 1, 2, 3 };
+	block_sparse_tensor_lazy_view_transpose(perm, &tv);
+	struct block_sparse_tensor_lazy_view lv;
+	create_block_sparse_tensor_lazy_view(l, &lv);
+	const int axes_lv[2] = { 1, 3 };
+	const int axes_tv[2] = { 0, 1 };
+	struct block_sparse_tensor_lazy_view uv;
+	block_sparse_tensor_lazy_view_contract(&lv, axes_lv, &tv, axes_tv, 2, &s, &uv);
+	delete_block_sparse_tensor_lazy_view(&lv);
+	delete_block_sparse_tensor_lazy_view(&tv);
 	delete_block_sparse_tensor(&t);
-	delete_block_sparse_tensor(&bc);
+	// re-order the (small) output tensor: [l0, l2, b1, a1, r1, r3]
+	block_sparse_tensor_lazy_view_materialize(&uv, &t);
+	delete_block_sparse_tensor_lazy_view(&uv);
+	delete_block_sparse_tensor(&s);
 
-	// multiply with 'l' tensor
-	// re-order second and third dimension of 'l'
-	const int perm1[4] = { 0, 2, 1, 3 };
-	struct block_sparse_tensor k;
-	transpose_block_sparse_tensor(perm1, l, &k);
-	// re-order leading three dimensions of 's' (to make MPS virtual bond dimensions the leading dimensions)
-	const int perm2[6] = { 2, 0, 1, 3, 4, 5 };
-	transpose_block_sparse_tensor(perm2, &s, &t);
+	// trace out outer virtual bonds (assumed to be low-dimensional)
+	block_sparse_tensor_cyclic_partial_trace(&t, 1, dw);
+	delete_block_sparse_tensor(&t);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Compute the subspace expansion term for a left-to-right sweep (single-site DMRG with subspace expansion),
+/// consisting of the local Hamiltonian applied to 'a' without the right operator block.
+///
+/// To-be contracted tensor network:
+///
+///       _______
+///      /       \
+///      |   ...3|->-   0
+///      |   :   |
+///      |   :   |            1
+///      |   :   |            ^
+///      |   :   |          __|__
+///      |   :   |         /  1  \
+///   -<-|0  l  2|-<-   -<-|0 w 3|-<-  (2)
+///      |       |         \__2__/
+///      |       |            |
+///      |       |            ^
+///      |       |          __|__
+///      |       |         /  1  \
+///      |      1|-<-   -<-|0 a 2|-<-  (2)
+///      \_______/         \_____/
+///
+/// The right virtual bonds of 'w' and 'a' and the outer virtual bond of 'l' are combined into the right virtual bond of the output tensor,
+/// such that the output tensor has the same left virtual bond and physical axis as 'a'.
+///
+void compute_subspace_expansion_left(const struct block_sparse_tensor* restrict a, const struct block_sparse_tensor* restrict w,
+	const struct block_sparse_tensor* restrict l, struct block_sparse_tensor* restrict p)
+{
+	assert(a->ndim == 3);
+	assert(w->ndim == 4);
+	assert(l->ndim == 4);
+
+	// multiply 'w' with 'a' tensor, contracting the axes [w2] with [a1]: [w0, w1, w3, a0, a2]
+	const int axes_w[1] = { 2 };
+	const int axes_a[1] = { 1 };
+	struct block_sparse_tensor s;
+	block_sparse_tensor_contract(w, axes_w, a, axes_a, 1, &s);
+
+	// multiply with 'l' tensor, contracting the axes [l1, l2] with [a0, w0]: [l0, l3, w1, w3, a2]
+	const int axes_l[2] = { 1, 2 };
+	const int axes_s[2] = { 3, 0 };
+	struct block_sparse_tensor t;
+	block_sparse_tensor_contract(l, axes_l, &s, axes_s, 2, &t);
 	delete_block_sparse_tensor(&s);
-	block_sparse_tensor_dot(&k, TENSOR_AXIS_RANGE_TRAILING, &t, TENSOR_AXIS_RANGE_LEADING, 2, &s);
-	delete_block_sparse_tensor(&k);
+
+	// re-order dimensions: [l3, w1, w3, a2, l0]
+	const int perm[5] = { 1, 2, 3, 4, 0 };
+	transpose_block_sparse_tensor(perm, &t, &s);
 	delete_block_sparse_tensor(&t);
 
-	// trace out outer virtual bonds (assumed to be low-dimensional)
-	block_sparse_tensor_cyclic_partial_trace(&s, 1, dw);
+	// combine the trailing axes into the new right virtual bond
+	flatten_block_sparse_tensor_axes(&s, 3, TENSOR_AXIS_IN, &t);
 	delete_block_sparse_tensor(&s);
+	flatten_block_sparse_tensor_axes(&t, 2, TENSOR_AXIS_IN, p);
+	delete_block_sparse_tensor(&t);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Compute the subspace expansion term for a right-to-left sweep (single-site DMRG with subspace expansion),
+/// consisting of the local Hamiltonian applied to 'a' without the left operator block.
+///
+/// To-be contracted tensor network:
+///
+///                                         _______
+///                                        /       \
+///                   2                 ->-|2...   |
+///                                        |   :   |
+///                   1                    |   :   |
+///                   ^                    |   :   |
+///                 __|__                  |   :   |
+///                /  1  \                 |   :   |
+///         (0)  -<-|0 w 3|-<-          -<-|1  r  3|-<-
+///                \__2__/                 |       |
+///                   |                    |       |
+///                   ^                    |       |
+///                 __|__                  |       |
+///                /  1  \                 |       |
+///         (0)  -<-|0 a 2|-<-          -<-|0      |
+///                \_____/                 \_______/
+///
+/// The left virtual bonds of 'w' and 'a' and the outer virtual bond of 'r' are combined into the left virtual bond of the output tensor,
+/// such that the output tensor has the same physical axis and right virtual bond as 'a'.
+///
+void compute_subspace_expansion_right(const struct block_sparse_tensor* restrict a, const struct block_sparse_tensor* restrict w,
+	const struct block_sparse_tensor* restrict r, struct block_sparse_tensor* restrict p)
+{
+	assert(a->ndim == 3);
+	assert(w->ndim == 4);
+	assert(r->ndim == 4);
+
+	// multiply with 'a' tensor
+	struct block_sparse_tensor s;
+	block_sparse_tensor_dot(a, TENSOR_AXIS_RANGE_TRAILING, r, TENSOR_AXIS_RANGE_LEADING, 1, &s);
+
+	// multiply with 'w' tensor, contracting the axes [w2, w3] with [a1, r1] in place: [w0, w1, a0, r2, r3]
+	const int axes_w[2] = { 2, 3 };
+	const int axes_s[2] = { 1, 2 };
+	struct block_sparse_tensor t;
+	block_sparse_tensor_contract(w, axes_w, &s, axes_s, 2, &t);
+	delete_block_sparse_tensor(&s);
+
+	// re-order dimensions: [r3, w0, a0, w1, r2]
+	const int perm[5] = { 4, 0, 2, 1, 3 };
+	transpose_block_sparse_tensor(perm, &t, &s);
+	delete_block_sparse_tensor(&t);
+
+	// combine the leading axes into the new left virtual bond
+	flatten_block_sparse_tensor_axes(&s, 0, TENSOR_AXIS_OUT, &t);
+	delete_block_sparse_tensor(&s);
+	flatten_block_sparse_tensor_axes(&t, 0, TENSOR_AXIS_OUT, p);
+	delete_block_sparse_tensor(&t);
 }
 
 
@@ -449,28 +806,37 @@ void apply_mpo(const struct mpo* op, const struct mps* psi, struct mps* op_psi)
 
 	for (int i = 0; i < psi->nsites; i++)
 	{
-		// move physical input axis of op->a[i] to the end
+		// lazily move physical input axis of op->a[i] to the end
 		const int perm_op[4] = { 0, 1, 3, 2 };
-		struct block_sparse_tensor r;
-		transpose_block_sparse_tensor(perm_op, &op->a[i], &r);
+		struct block_sparse_tensor_lazy_view rv;
+		create_block_sparse_tensor_lazy_view(&op->a[i], &rv);
+		block_sparse_tensor_lazy_view_transpose(perm_op, &rv);
 
-		// move physical axis of psi->a[i] to the beginning
+		// lazily move physical axis of psi->a[i] to the beginning
 		const int perm_psi[3] = { 1, 0, 2 };
-		struct block_sparse_tensor s;
-		transpose_block_sparse_tensor(perm_psi, &psi->a[i], &s);
+		struct block_sparse_tensor_lazy_view sv;
+		create_block_sparse_tensor_lazy_view(&psi->a[i], &sv);
+		block_sparse_tensor_lazy_view_transpose(perm_psi, &sv);
 
 		// contract local tensors
+		const int axes_rv[1] = { 3 };
+		const int axes_sv[1] = { 0 };
 		struct block_sparse_tensor t;
-		block_sparse_tensor_dot(&r, TENSOR_AXIS_RANGE_TRAILING, &s, TENSOR_AXIS_RANGE_LEADING, 1, &t);
-		delete_block_sparse_tensor(&r);
-		delete_block_sparse_tensor(&s);
+		struct block_sparse_tensor_lazy_view tv;
+		block_sparse_tensor_lazy_view_contract(&rv, axes_rv, &sv, axes_sv, 1, &t, &tv);
+		delete_block_sparse_tensor_lazy_view(&rv);
+		delete_block_sparse_tensor_lazy_view(&sv);
 
-		// reorder axes
+		// reorder axes (only this permutation touches the tensor entries)
 		const int perm_ax[5] = { 0, 3, 1, 2, 4 };
-		transpose_block_sparse_tensor(perm_ax, &t, &r);
+		block_sparse_tensor_lazy_view_transpose(perm_ax, &tv);
+		struct block_sparse_tensor r;
+		block_sparse_tensor_lazy_view_materialize(&tv, &r);
+		delete_block_sparse_tensor_lazy_view(&tv);
 		delete_block_sparse_tensor(&t);
 
 		// flatten left and right virtual bonds
+		struct block_sparse_tensor s;
 		flatten_block_sparse_tensor_axes(&r, 0, TENSOR_AXIS_OUT, &s);
 		delete_block_sparse_tensor(&r);
 		flatten_block_sparse_tensor_axes(&s, 2, TENSOR_AXIS_IN, &op_psi->a[i]);
@@ -31,9 +31,47 @@ void mpo_inner_product(const struct mps* chi, const struct mpo* op, const struct
 void apply_local_hamiltonian(const struct block_sparse_tensor* restrict a, const struct block_sparse_tensor* restrict w,
 	const struct block_sparse_tensor* restrict l, const struct block_sparse_tensor* restrict r, struct block_sparse_tensor* restrict b);
 
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Precomputed contraction plans and preallocated intermediate tensors (workspace) for repeatedly applying a local Hamiltonian operator
+/// to MPS tensors sharing the same block sparsity structure, e.g., during a Lanczos iteration.
+///
+struct apply_local_hamiltonian_plan
+{
+	struct block_sparse_tensor_dot_plan plan_ar;         //!< contraction plan of 'a' with 'r'
+	struct block_sparse_tensor_dot_plan plan_wt;         //!< contraction plan of 'w' with intermediate tensor
+	struct block_sparse_tensor_dot_plan plan_lt;         //!< contraction plan of 'l' with intermediate tensor
+	struct block_sparse_tensor s_ar;                     //!< intermediate tensor: 'a' contracted with 'r'
+	struct block_sparse_tensor s_wt;                     //!< intermediate tensor: 'w' contracted with 's_ar'
+	struct block_sparse_tensor s_lt;                     //!< intermediate tensor: 'l' contracted with 's_wt'
+	struct block_sparse_tensor a_view;                   //!< input MPS tensor whose blocks refer to the entries of an external flat vector
+	struct block_sparse_tensor b_view;                   //!< output MPS tensor whose blocks refer to the entries of an external flat vector
+};
+
+void create_apply_local_hamiltonian_plan(const struct block_sparse_tensor* restrict a, const struct block_sparse_tensor* restrict w,
+	const struct block_sparse_tensor* restrict l, const struct block_sparse_tensor* restrict r, struct apply_local_hamiltonian_plan* restrict plan);
+
+void delete_apply_local_hamiltonian_plan(struct apply_local_hamiltonian_plan* plan);
+
+void apply_local_hamiltonian_execute(struct apply_local_hamiltonian_plan* restrict plan, const struct block_sparse_tensor* restrict a, const struct block_sparse_tensor* restrict w,
+	const struct block_sparse_tensor* restrict l, const struct block_sparse_tensor* restrict r, struct block_sparse_tensor* restrict b);
+
+void apply_local_hamiltonian_execute_entries(struct apply_local_hamiltonian_plan* restrict plan, const struct block_sparse_tensor* restrict w,
+	const struct block_sparse_tensor* restrict l, const struct block_sparse_tensor* restrict r, const void* restrict v, void* restrict ret);
+
+void compute_local_hamiltonian_diagonal(const struct block_sparse_tensor* restrict a, const struct block_sparse_tensor* restrict w,
+	const struct block_sparse_tensor* restrict l, const struct block_sparse_tensor* restrict r, struct block_sparse_tensor* restrict d);
+
 void compute_local_hamiltonian_environment(const struct block_sparse_tensor* restrict a, const struct block_sparse_tensor* restrict b,
 	const struct block_sparse_tensor* restrict l, const struct block_sparse_tensor* restrict r, struct block_sparse_tensor* restrict dw);
 
+void compute_subspace_expansion_left(const struct block_sparse_tensor* restrict a, const struct block_sparse_tensor* restrict w,
+	const struct block_sparse_tensor* restrict l, struct block_sparse_tensor* restrict p);
+
+void compute_subspace_expansion_right(const struct block_sparse_tensor* restrict a, const struct block_sparse_tensor* restrict w,
+	const struct block_sparse_tensor* restrict r, struct block_sparse_tensor* restrict p);
+
 //________________________________________________________________________________________________________________________
 //
 
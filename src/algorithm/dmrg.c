@@ -1,10 +1,14 @@
 /// \file dmrg.c
 /// \brief DMRG algorithm.
 
+#include <math.h>
+#include <limits.h>
 #include "dmrg.h"
 #include "chain_ops.h"
+#include "environment_cache.h"
 #include "krylov.h"
 #include "aligned_memory.h"
+#include "util.h"
 
 
 //________________________________________________________________________________________________________________________
@@ -13,10 +17,11 @@
 ///
 struct local_hamiltonian_data
 {
-	const struct block_sparse_tensor* w;  //!< local Hamiltonian operator
-	const struct block_sparse_tensor* l;  //!< left tensor network block
-	const struct block_sparse_tensor* r;  //!< right tensor network block
-	struct block_sparse_tensor* a;        //!< local input MPS tensor (entries will be filled dynamically)
+	const struct block_sparse_tensor* w;              //!< local Hamiltonian operator
+	const struct block_sparse_tensor* l;              //!< left tensor network block
+	const struct block_sparse_tensor* r;              //!< right tensor network block
+	struct apply_local_hamiltonian_plan* plan;        //!< precomputed contraction plans and workspace
+	long num_matvec;                                  //!< number of local Hamiltonian applications
 };
 
 
@@ -24,23 +29,31 @@ struct local_hamiltonian_data
 ///
 /// \brief Wrapper function for applying a site-local Hamiltonian operator, required for Lanczos iteration.
 ///
-static void apply_local_hamiltonian_wrapper_d(const long n, const void* restrict data, const double* restrict v, double* restrict ret)
+static void apply_local_hamiltonian_wrapper_s(const long n, const void* restrict data, const float* restrict v, float* restrict ret)
 {
 	struct local_hamiltonian_data* hdata = (struct local_hamiltonian_data*)data;
 
-	// interpret input vector as MPS tensor entries
-	assert(hdata->a->dtype == CT_DOUBLE_REAL);
-	assert(n == block_sparse_tensor_num_elements_blocks(hdata->a));
-	block_sparse_tensor_deserialize_entries(hdata->a, v);
+	// interpret input and output vectors as MPS tensor entries, without copying or allocating memory
+	assert(hdata->plan->a_view.dtype == CT_SINGLE_REAL);
+	assert(n == block_sparse_tensor_num_elements_blocks(&hdata->plan->a_view));
+	apply_local_hamiltonian_execute_entries(hdata->plan, hdata->w, hdata->l, hdata->r, v, ret);
+	hdata->num_matvec++;
+}
 
-	struct block_sparse_tensor ha;
-	apply_local_hamiltonian(hdata->a, hdata->w, hdata->l, hdata->r, &ha);
 
-	assert(ha.dtype == CT_DOUBLE_REAL);
-	assert(n == block_sparse_tensor_num_elements_blocks(&ha));
-	block_sparse_tensor_serialize_entries(&ha, ret);
+//________________________________________________________________________________________________________________________
+///
+/// \brief Wrapper function for applying a site-local Hamiltonian operator, required for Lanczos iteration.
+///
+static void apply_local_hamiltonian_wrapper_d(const long n, const void* restrict data, const double* restrict v, double* restrict ret)
+{
+	struct local_hamiltonian_data* hdata = (struct local_hamiltonian_data*)data;
 
-	delete_block_sparse_tensor(&ha);
+	// interpret input and output vectors as MPS tensor entries, without copying or allocating memory
+	assert(hdata->plan->a_view.dtype == CT_DOUBLE_REAL);
+	assert(n == block_sparse_tensor_num_elements_blocks(&hdata->plan->a_view));
+	apply_local_hamiltonian_execute_entries(hdata->plan, hdata->w, hdata->l, hdata->r, v, ret);
+	hdata->num_matvec++;
 }
 
 
@@ -48,75 +61,157 @@ static void apply_local_hamiltonian_wrapper_d(const long n, const void* restrict
 ///
 /// \brief Wrapper function for applying a site-local Hamiltonian operator, required for Lanczos iteration.
 ///
-static void apply_local_hamiltonian_wrapper_z(const long n, const void* restrict data, const dcomplex* restrict v, dcomplex* restrict ret)
+static void apply_local_hamiltonian_wrapper_c(const long n, const void* restrict data, const scomplex* restrict v, scomplex* restrict ret)
 {
 	struct local_hamiltonian_data* hdata = (struct local_hamiltonian_data*)data;
 
-	// interpret input vector as MPS tensor entries
-	assert(hdata->a->dtype == CT_DOUBLE_COMPLEX);
-	assert(n == block_sparse_tensor_num_elements_blocks(hdata->a));
-	block_sparse_tensor_deserialize_entries(hdata->a, v);
+	// interpret input and output vectors as MPS tensor entries, without copying or allocating memory
+	assert(hdata->plan->a_view.dtype == CT_SINGLE_COMPLEX);
+	assert(n == block_sparse_tensor_num_elements_blocks(&hdata->plan->a_view));
+	apply_local_hamiltonian_execute_entries(hdata->plan, hdata->w, hdata->l, hdata->r, v, ret);
+	hdata->num_matvec++;
+}
 
-	struct block_sparse_tensor ha;
-	apply_local_hamiltonian(hdata->a, hdata->w, hdata->l, hdata->r, &ha);
 
-	assert(ha.dtype == CT_DOUBLE_COMPLEX);
-	assert(n == block_sparse_tensor_num_elements_blocks(&ha));
-	block_sparse_tensor_serialize_entries(&ha, ret);
+//________________________________________________________________________________________________________________________
+///
+/// \brief Wrapper function for applying a site-local Hamiltonian operator, required for Lanczos iteration.
+///
+static void apply_local_hamiltonian_wrapper_z(const long n, const void* restrict data, const dcomplex* restrict v, dcomplex* restrict ret)
+{
+	struct local_hamiltonian_data* hdata = (struct local_hamiltonian_data*)data;
 
-	delete_block_sparse_tensor(&ha);
+	// interpret input and output vectors as MPS tensor entries, without copying or allocating memory
+	assert(hdata->plan->a_view.dtype == CT_DOUBLE_COMPLEX);
+	assert(n == block_sparse_tensor_num_elements_blocks(&hdata->plan->a_view));
+	apply_local_hamiltonian_execute_entries(hdata->plan, hdata->w, hdata->l, hdata->r, v, ret);
+	hdata->num_matvec++;
 }
 
 
 //________________________________________________________________________________________________________________________
 ///
-/// \brief Minimize site-local energy by a Lanczos iteration; memory will be allocated for result 'a_opt'.
+/// \brief Minimize site-local energy by the eigensolver selected in 'opts'; memory will be allocated for result 'a_opt'.
+///
+/// 'tol' is the residual norm tolerance of the Davidson or restarted Lanczos method.
+/// The number of local Hamiltonian applications is added to 'num_matvec'.
 ///
 static int minimize_local_energy(const struct block_sparse_tensor* restrict w, const struct block_sparse_tensor* restrict l, const struct block_sparse_tensor* restrict r,
-	const struct block_sparse_tensor* restrict a_start, const int maxiter, double* restrict en_min, struct block_sparse_tensor* restrict a_opt)
+	const struct block_sparse_tensor* restrict a_start, const struct dmrg_options* restrict opts, const double tol, double* restrict en_min, struct block_sparse_tensor* restrict a_opt, long* restrict num_matvec)
 {
 	assert(w->dtype == l->dtype);
 	assert(w->dtype == r->dtype);
 	assert(w->dtype == a_start->dtype);
 
 	const int n = block_sparse_tensor_num_elements_blocks(a_start);
-	void* vstart = ct_malloc(n * sizeof_numeric_type(a_start->dtype));
-	block_sparse_tensor_serialize_entries(a_start, vstart);
 
-	// using 'a_opt' as temporary tensor for iterations
+	// the eigensolver writes the optimized entries directly into the contiguous storage of the output tensor
 	allocate_block_sparse_tensor_like(a_start, a_opt);
+	block_sparse_tensor_make_contiguous(a_opt);
+	void* u_opt = a_opt->data;
+
+	// starting vector; the entries of a tensor with contiguous storage are used directly
+	void* vstart_buffer = NULL;
+	if (a_start->data == NULL) {
+		vstart_buffer = ct_malloc(n * sizeof_numeric_type(a_start->dtype));
+		block_sparse_tensor_serialize_entries(a_start, vstart_buffer);
+	}
+	const void* vstart = (a_start->data != NULL ? a_start->data : vstart_buffer);
 
-	struct local_hamiltonian_data hdata = { .w = w, .l = l, .r = r, .a = a_opt };
+	// precompute contraction plans and allocate workspace, which are re-used by all iterations
+	struct apply_local_hamiltonian_plan plan;
+	create_apply_local_hamiltonian_plan(a_start, w, l, r, &plan);
 
-	void* u_opt = ct_malloc(n * sizeof_numeric_type(a_start->dtype));
+	struct local_hamiltonian_data hdata = { .w = w, .l = l, .r = r, .plan = &plan, .num_matvec = 0 };
 
+	// diagonal of the local Hamiltonian as preconditioner for the Davidson method
+	double* diag = NULL;
+	if (opts->eigensolver == DMRG_EIGENSOLVER_DAVIDSON && numeric_real_type(a_start->dtype) == CT_DOUBLE_REAL)
+	{
+		diag = ct_malloc(n * sizeof(double));
+		// the intermediate tensors of the diagonal are short-lived and served by a scoped arena region
+		const struct ct_memory_marker marker = ct_memory_mark();
+		struct block_sparse_tensor d;
+		compute_local_hamiltonian_diagonal(a_start, w, l, r, &d);
+		void* d_entries = ct_malloc(n * sizeof_numeric_type(d.dtype));
+		block_sparse_tensor_serialize_entries(&d, d_entries);
+		delete_block_sparse_tensor(&d);
+		for (long i = 0; i < n; i++) {
+			// diagonal entries of a self-adjoint operator are real
+			diag[i] = (a_start->dtype == CT_DOUBLE_COMPLEX ? creal(((dcomplex*)d_entries)[i]) : ((double*)d_entries)[i]);
+		}
+		ct_free(d_entries);
+		ct_memory_release(&marker);
+	}
+	// maximum number of stored basis vectors of the Davidson or restarted Lanczos method
+	const int maxvec = (opts->max_vectors > 0 ? opts->max_vectors : 32);
+
+	int status = 0;
 	switch (a_start->dtype)
 	{
 		case CT_SINGLE_REAL:
 		{
-			// not implemented yet
-			assert(false);
+			// single precision: always use Lanczos iteration
+			float en_min_single;
+			int ret = eigensystem_krylov_symmetric_single(n, apply_local_hamiltonian_wrapper_s, &hdata, vstart, opts->maxiter, 1, &en_min_single, u_opt);
+			if (ret < 0) {
+				status = ret;
+				break;
+			}
+			(*en_min) = en_min_single;
 			break;
 		}
 		case CT_DOUBLE_REAL:
 		{
-			int ret = eigensystem_krylov_symmetric(n, apply_local_hamiltonian_wrapper_d, &hdata, vstart, maxiter, 1, en_min, u_opt);
+			int ret;
+			if (opts->eigensolver == DMRG_EIGENSOLVER_DAVIDSON) {
+				int num_matvec_davidson;
+				ret = eigensystem_davidson_symmetric(n, apply_local_hamiltonian_wrapper_d, &hdata, diag, vstart, opts->maxiter, maxvec, tol, en_min, u_opt, &num_matvec_davidson);
+				assert(num_matvec_davidson == hdata.num_matvec);
+			}
+			else if (opts->eigensolver == DMRG_EIGENSOLVER_LANCZOS_RESTARTED) {
+				int num_matvec_lanczos;
+				ret = eigensystem_krylov_restarted_symmetric(n, apply_local_hamiltonian_wrapper_d, &hdata, vstart, opts->maxiter, maxvec, 1, tol, en_min, u_opt, &num_matvec_lanczos);
+				assert(num_matvec_lanczos == hdata.num_matvec);
+			}
+			else {
+				ret = eigensystem_krylov_symmetric(n, apply_local_hamiltonian_wrapper_d, &hdata, vstart, opts->maxiter, 1, en_min, u_opt);
+			}
 			if (ret < 0) {
-				return ret;
+				status = ret;
 			}
 			break;
 		}
 		case CT_SINGLE_COMPLEX:
 		{
-			// not implemented yet
-			assert(false);
+			// single precision: always use Lanczos iteration
+			float en_min_single;
+			int ret = eigensystem_krylov_hermitian_single(n, apply_local_hamiltonian_wrapper_c, &hdata, vstart, opts->maxiter, 1, &en_min_single, u_opt);
+			if (ret < 0) {
+				status = ret;
+				break;
+			}
+			(*en_min) = en_min_single;
 			break;
 		}
 		case CT_DOUBLE_COMPLEX:
 		{
-			int ret = eigensystem_krylov_hermitian(n, apply_local_hamiltonian_wrapper_z, &hdata, vstart, maxiter, 1, en_min, u_opt);
+			int ret;
+			if (opts->eigensolver == DMRG_EIGENSOLVER_DAVIDSON) {
+				int num_matvec_davidson;
+				ret = eigensystem_davidson_hermitian(n, apply_local_hamiltonian_wrapper_z, &hdata, diag, vstart, opts->maxiter, maxvec, tol, en_min, u_opt, &num_matvec_davidson);
+				assert(num_matvec_davidson == hdata.num_matvec);
+			}
+			else if (opts->eigensolver == DMRG_EIGENSOLVER_LANCZOS_RESTARTED) {
+				int num_matvec_lanczos;
+				ret = eigensystem_krylov_restarted_hermitian(n, apply_local_hamiltonian_wrapper_z, &hdata, vstart, opts->maxiter, maxvec, 1, tol, en_min, u_opt, &num_matvec_lanczos);
+				assert(num_matvec_lanczos == hdata.num_matvec);
+			}
+			else {
+				ret = eigensystem_krylov_hermitian(n, apply_local_hamiltonian_wrapper_z, &hdata, vstart, opts->maxiter, 1, en_min, u_opt);
+			}
 			if (ret < 0) {
-				return ret;
+				status = ret;
 			}
 			break;
 		}
@@ -127,10 +222,276 @@ static int minimize_local_energy(const struct block_sparse_tensor* restrict w, c
 		}
 	}
 
-	block_sparse_tensor_deserialize_entries(a_opt, u_opt);
+	delete_apply_local_hamiltonian_plan(&plan);
 
-	ct_free(u_opt);
-	ct_free(vstart);
+	(*num_matvec) += hdata.num_matvec;
+
+	if (diag != NULL) {
+		ct_free(diag);
+	}
+	if (vstart_buffer != NULL) {
+		ct_free(vstart_buffer);
+	}
+
+	return status;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Residual norm tolerance of the local eigensolver, adapted to the truncation weight 'trunc_error' if enabled in 'opts'.
+///
+/// Solving the local eigenvalue problem more accurately than the subsequent truncation is not useful. The error of the state
+/// due to the truncation is the square root of the truncation weight, which is compared to the residual norm.
+///
+static inline double dmrg_adaptive_eigensolver_tol(const struct dmrg_options* opts, const double trunc_error)
+{
+	if (opts->tol_eigensolver_trunc_ratio <= 0) {
+		return opts->tol_eigensolver;
+	}
+	return fmax(opts->tol_eigensolver, opts->tol_eigensolver_trunc_ratio * sqrt(trunc_error));
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Scale a block-sparse tensor by the real factor 'alpha', converted to the precision of the tensor.
+///
+static void dmrg_rscale_tensor(const double alpha, struct block_sparse_tensor* t)
+{
+	if (numeric_real_type(t->dtype) == CT_SINGLE_REAL) {
+		const float alpha_s = (float)alpha;
+		rscale_block_sparse_tensor(&alpha_s, t);
+	}
+	else {
+		rscale_block_sparse_tensor(&alpha, t);
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Enlarge the right virtual bond of the optimized tensor 'a' by the subspace expansion term (with mixing factor 'alpha')
+/// and pad 'a_next' by zeros correspondingly, then left-orthonormalize 'a' by a SVD with truncation and update 'a_next'.
+///
+/// The represented state is unchanged up to the truncation.
+///
+static int dmrg_subspace_expansion_left(const struct block_sparse_tensor* restrict w, const struct block_sparse_tensor* restrict l,
+	const double alpha, const double tol, const long max_vdim, struct block_sparse_tensor* restrict a, struct block_sparse_tensor* restrict a_next, struct trunc_info* info)
+{
+	// expansion term, with the same left virtual bond and physical axis as 'a'
+	struct block_sparse_tensor p;
+	compute_subspace_expansion_left(a, w, l, &p);
+	dmrg_rscale_tensor(alpha, &p);
+
+	// zero padding of 'a_next' along the expanded bond
+	struct block_sparse_tensor z;
+	{
+		const long dim[3] = { p.dim_logical[2], a_next->dim_logical[1], a_next->dim_logical[2] };
+		const qnumber* qnums[3] = { p.qnums_logical[2], a_next->qnums_logical[1], a_next->qnums_logical[2] };
+		allocate_block_sparse_tensor(a_next->dtype, 3, dim, a_next->axis_dir, qnums, &z);
+	}
+
+	struct block_sparse_tensor a_exp, a_next_exp;
+	{
+		const struct block_sparse_tensor tlist[2] = { *a, p };
+		block_sparse_tensor_concatenate(tlist, 2, 2, &a_exp);
+	}
+	{
+		const struct block_sparse_tensor tlist[2] = { *a_next, z };
+		block_sparse_tensor_concatenate(tlist, 2, 0, &a_next_exp);
+	}
+	delete_block_sparse_tensor(&z);
+	delete_block_sparse_tensor(&p);
+	delete_block_sparse_tensor(a_next);
+	delete_block_sparse_tensor(a);
+	move_block_sparse_tensor_data(&a_exp, a);
+	move_block_sparse_tensor_data(&a_next_exp, a_next);
+
+	return mps_local_orthonormalize_left_svd(tol, max_vdim, false, a, a_next, info);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Enlarge the left virtual bond of the optimized tensor 'a' by the subspace expansion term (with mixing factor 'alpha')
+/// and pad 'a_prev' by zeros correspondingly, then right-orthonormalize 'a' by a SVD with truncation and update 'a_prev'.
+///
+/// The represented state is unchanged up to the truncation.
+///
+static int dmrg_subspace_expansion_right(const struct block_sparse_tensor* restrict w, const struct block_sparse_tensor* restrict r,
+	const double alpha, const double tol, const long max_vdim, struct block_sparse_tensor* restrict a, struct block_sparse_tensor* restrict a_prev, struct trunc_info* info)
+{
+	// expansion term, with the same physical axis and right virtual bond as 'a'
+	struct block_sparse_tensor p;
+	compute_subspace_expansion_right(a, w, r, &p);
+	dmrg_rscale_tensor(alpha, &p);
+
+	// zero padding of 'a_prev' along the expanded bond
+	struct block_sparse_tensor z;
+	{
+		const long dim[3] = { a_prev->dim_logical[0], a_prev->dim_logical[1], p.dim_logical[0] };
+		const qnumber* qnums[3] = { a_prev->qnums_logical[0], a_prev->qnums_logical[1], p.qnums_logical[0] };
+		allocate_block_sparse_tensor(a_prev->dtype, 3, dim, a_prev->axis_dir, qnums, &z);
+	}
+
+	struct block_sparse_tensor a_exp, a_prev_exp;
+	{
+		const struct block_sparse_tensor tlist[2] = { *a, p };
+		block_sparse_tensor_concatenate(tlist, 2, 0, &a_exp);
+	}
+	{
+		const struct block_sparse_tensor tlist[2] = { *a_prev, z };
+		block_sparse_tensor_concatenate(tlist, 2, 2, &a_prev_exp);
+	}
+	delete_block_sparse_tensor(&z);
+	delete_block_sparse_tensor(&p);
+	delete_block_sparse_tensor(a_prev);
+	delete_block_sparse_tensor(a);
+	move_block_sparse_tensor_data(&a_exp, a);
+	move_block_sparse_tensor_data(&a_prev_exp, a_prev);
+
+	return mps_local_orthonormalize_right_svd(tol, max_vdim, false, a, a_prev, info);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Compute the energy variance `<psi | H^2 | psi> - <psi | H | psi>^2` of a normalized state.
+///
+static double dmrg_energy_variance(const struct mpo* hamiltonian, const struct mps* psi)
+{
+	struct mps h_psi;
+	apply_mpo(hamiltonian, psi, &h_psi);
+
+	// expectation value <psi | H | psi>, which is real for a self-adjoint Hamiltonian
+	double en;
+	switch (psi->a[0].dtype)
+	{
+		case CT_SINGLE_REAL:
+		{
+			float vdot;
+			mps_vdot(psi, &h_psi, &vdot);
+			en = vdot;
+			break;
+		}
+		case CT_DOUBLE_REAL:
+		{
+			mps_vdot(psi, &h_psi, &en);
+			break;
+		}
+		case CT_SINGLE_COMPLEX:
+		{
+			scomplex vdot;
+			mps_vdot(psi, &h_psi, &vdot);
+			en = crealf(vdot);
+			break;
+		}
+		case CT_DOUBLE_COMPLEX:
+		{
+			dcomplex vdot;
+			mps_vdot(psi, &h_psi, &vdot);
+			en = creal(vdot);
+			break;
+		}
+		default:
+		{
+			// unknown data type
+			assert(false);
+			en = 0;
+		}
+	}
+
+	// <psi | H^2 | psi> = || H psi ||^2
+	const double nrm = mps_norm(&h_psi);
+	delete_mps(&h_psi);
+
+	return nrm*nrm - en*en;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Collect the diagnostics after a sweep; 'en_prev' is the energy after the previous sweep (or infinite for the first sweep).
+///
+static void dmrg_sweep_diagnostics(const struct mpo* hamiltonian, const struct mps* psi, const struct dmrg_options* opts,
+	const double en, const double en_prev, const double trunc_error, const long num_matvec, struct dmrg_sweep_info* info)
+{
+	info->energy        = en;
+	info->energy_change = fabs(en - en_prev);
+	info->trunc_error   = trunc_error;
+	info->variance      = (opts->tol_variance > 0 ? dmrg_energy_variance(hamiltonian, psi) : -1);
+	info->max_vdim      = 0;
+	for (int i = 0; i < psi->nsites + 1; i++) {
+		info->max_vdim = lmax(info->max_vdim, mps_bond_dim(psi, i));
+	}
+	info->num_matvec    = num_matvec;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Whether the convergence criteria specified in 'opts' are met after a sweep.
+/// Without any specified tolerance, the sweeps never terminate early.
+///
+static bool dmrg_sweep_converged(const struct dmrg_options* opts, const struct dmrg_sweep_info* info)
+{
+	if (opts->tol_energy <= 0 && opts->tol_trunc <= 0 && opts->tol_variance <= 0) {
+		return false;
+	}
+	if (opts->tol_energy > 0 && !(info->energy_change <= opts->tol_energy)) {
+		return false;
+	}
+	if (opts->tol_trunc > 0 && info->trunc_error > opts->tol_trunc) {
+		return false;
+	}
+	if (opts->tol_variance > 0 && info->variance > opts->tol_variance) {
+		return false;
+	}
+	return true;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Create the environment cache of the left and right operator blocks, stored at slot indices 'i' and 'nsites + i', respectively,
+/// and compute the right operator blocks for the right-normalized 'psi'.
+///
+/// Only the leftmost (dummy) left operator block is initialized; the remaining ones are computed during the first left-to-right sweep.
+///
+static int dmrg_create_operator_blocks(const struct mpo* hamiltonian, const struct mps* psi, const struct dmrg_options* opts, struct environment_cache* cache)
+{
+	const int nsites = hamiltonian->nsites;
+
+	create_environment_cache(2 * nsites, opts->env_ram_budget > 0 ? (size_t)opts->env_ram_budget : 0, opts->env_scratch_dir, cache);
+	struct block_sparse_tensor* lblocks = cache->blocks;
+	struct block_sparse_tensor* rblocks = cache->blocks + nsites;
+
+	create_dummy_operator_block_left(&psi->a[0], &psi->a[0], &hamiltonian->a[0], &lblocks[0]);
+	int ret = environment_cache_store(cache, 0);
+	if (ret < 0) {
+		return ret;
+	}
+
+	// same as 'compute_right_operator_blocks', but respecting the memory budget
+	create_dummy_operator_block_right(&psi->a[nsites - 1], &psi->a[nsites - 1], &hamiltonian->a[nsites - 1], &rblocks[nsites - 1]);
+	ret = environment_cache_store(cache, 2 * nsites - 1);
+	if (ret < 0) {
+		return ret;
+	}
+	for (int i = nsites - 1; i > 0; i--)
+	{
+		ret = environment_cache_acquire(cache, nsites + i);
+		if (ret < 0) {
+			return ret;
+		}
+		contraction_operator_step_right(&psi->a[i], &psi->a[i], &hamiltonian->a[i], &rblocks[i], &rblocks[i - 1]);
+		environment_cache_release(cache, nsites + i);
+		ret = environment_cache_store(cache, nsites + i - 1);
+		if (ret < 0) {
+			return ret;
+		}
+	}
 
 	return 0;
 }
@@ -139,17 +500,101 @@ static int minimize_local_energy(const struct block_sparse_tensor* restrict w, c
 //________________________________________________________________________________________________________________________
 ///
 /// \brief Run the single-site DMRG algorithm: Approximate the ground state as MPS via left and right sweeps and local single-site optimizations.
-/// The input 'psi' is used as starting state and is updated in-place during the optimization. Its virtual bond dimensions cannot increase.
+/// The input 'psi' is used as starting state and is updated in-place during the optimization. Its virtual bond dimensions cannot increase
+/// (see 'dmrg_singlesite_options' for the subspace expansion).
+///
+/// The local optimizations use a Lanczos iteration with 'maxiter_lanczos' iterations.
 ///
 int dmrg_singlesite(const struct mpo* hamiltonian, const int num_sweeps, const int maxiter_lanczos, struct mps* psi, double* en_sweeps)
+{
+	const struct dmrg_options opts = { .eigensolver = DMRG_EIGENSOLVER_LANCZOS, .maxiter = maxiter_lanczos };
+	return dmrg_singlesite_options(hamiltonian, num_sweeps, &opts, psi, en_sweeps, NULL, NULL);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Run the single-site DMRG algorithm with the local eigensolver specified by 'opts'.
+///
+/// If 'opts->expansion_alpha > 0', the virtual bonds are enriched after each local optimization by the subspace expansion
+/// (DMRG3S, see C. Hubig et al., Phys. Rev. B 91, 155115 (2015)) and subsequently truncated according to 'opts->tol_expansion'
+/// and the maximum virtual bond dimension 'opts->max_vdim_expansion' (or the schedule 'opts->max_vdim_sweeps'), such that
+/// the virtual bond dimensions can increase, as for two-site DMRG, while the local problems remain single-site.
+/// The expansion perturbs the state once the bond dimensions are saturated; the mixing factor should thus be decreased
+/// in later sweeps via 'opts->expansion_decay'.
+///
+/// At most 'num_sweeps' sweeps are performed; the sweeps terminate early once the convergence criteria specified by the
+/// tolerances in 'opts' are met. Only the leading entries of 'en_sweeps' and 'sweep_info' (if not NULL) corresponding
+/// to the performed sweeps are set. If 'stats' is not NULL, the number of local Hamiltonian applications, local optimizations
+/// and performed sweeps are stored in it.
+///
+/// For single precision Hamiltonians and states, the local optimizations use a Lanczos iteration with 'opts->maxiter' iterations.
+/// In mixed-precision mode ('opts->num_sweeps_single > 0' for double precision input), the Hamiltonian and state are converted
+/// to single precision for the initial sweeps, and the state is converted back to double precision for the remaining sweeps.
+///
+int dmrg_singlesite_options(const struct mpo* hamiltonian, const int num_sweeps, const struct dmrg_options* opts, struct mps* psi,
+	double* en_sweeps, struct dmrg_sweep_info* sweep_info, struct dmrg_statistics* stats)
 {
 	// number of lattice sites
 	const int nsites = hamiltonian->nsites;
 	assert(nsites == psi->nsites);
 	assert(nsites >= 1);
 
-	// currently only double precision supported
-	assert(numeric_real_type(hamiltonian->a[0].dtype) == CT_DOUBLE_REAL);
+	assert(hamiltonian->a[0].dtype == psi->a[0].dtype);
+
+	// mixed-precision mode: perform initial sweeps in single precision, and the remaining sweeps in double precision
+	if (opts->num_sweeps_single > 0 && numeric_real_type(hamiltonian->a[0].dtype) == CT_DOUBLE_REAL)
+	{
+		const enum numeric_type dtype = hamiltonian->a[0].dtype;
+		const enum numeric_type dtype_single = (dtype == CT_DOUBLE_REAL ? CT_SINGLE_REAL : CT_SINGLE_COMPLEX);
+		const int num_sweeps_single = imin(opts->num_sweeps_single, num_sweeps);
+
+		struct dmrg_options opts_single = (*opts);
+		opts_single.num_sweeps_single = 0;
+
+		struct mpo hamiltonian_single;
+		struct mps psi_single;
+		convert_mpo(dtype_single, hamiltonian, &hamiltonian_single);
+		convert_mps(dtype_single, psi, &psi_single);
+		struct dmrg_statistics stats_single;
+		int ret = dmrg_singlesite_options(&hamiltonian_single, num_sweeps_single, &opts_single, &psi_single, en_sweeps, sweep_info, &stats_single);
+		delete_mpo(&hamiltonian_single);
+		if (ret < 0) {
+			delete_mps(&psi_single);
+			return ret;
+		}
+		delete_mps(psi);
+		convert_mps(dtype, &psi_single, psi);
+		delete_mps(&psi_single);
+
+		// remaining sweeps in double precision, continuing after the sweeps actually performed in single precision
+		const int n_single = stats_single.num_sweeps;
+		struct dmrg_statistics stats_double = { .converged = stats_single.converged };
+		if (num_sweeps > n_single)
+		{
+			struct dmrg_options opts_double = opts_single;
+			if (opts->max_vdim_sweeps != NULL) {
+				opts_double.max_vdim_sweeps = opts->max_vdim_sweeps + n_single;
+			}
+			if (opts->expansion_decay > 0) {
+				opts_double.expansion_alpha = opts->expansion_alpha * pow(opts->expansion_decay, n_single);
+			}
+			ret = dmrg_singlesite_options(hamiltonian, num_sweeps - n_single, &opts_double, psi, en_sweeps + n_single,
+				sweep_info != NULL ? sweep_info + n_single : NULL, &stats_double);
+			if (ret < 0) {
+				return ret;
+			}
+		}
+
+		if (stats != NULL) {
+			stats->num_matvec    = stats_single.num_matvec    + stats_double.num_matvec;
+			stats->num_local_opt = stats_single.num_local_opt + stats_double.num_local_opt;
+			stats->num_sweeps    = n_single + stats_double.num_sweeps;
+			stats->converged     = stats_double.converged;
+		}
+
+		return 0;
+	}
 
 	// right-normalize input matrix product state
 	double nrm = mps_orthonormalize_qr(psi, MPS_ORTHONORMAL_RIGHT);
@@ -157,25 +602,52 @@ int dmrg_singlesite(const struct mpo* hamiltonian, const int num_sweeps, const i
 		printf("Warning: in 'dmrg_singlesite': initial MPS has norm zero (possibly due to mismatching quantum numbers)\n");
 	}
 
-	// left and right operator blocks
-	struct block_sparse_tensor* lblocks = ct_malloc(nsites * sizeof(struct block_sparse_tensor));
-	struct block_sparse_tensor* rblocks = ct_malloc(nsites * sizeof(struct block_sparse_tensor));
-	compute_right_operator_blocks(psi, psi, hamiltonian, rblocks);
-	create_dummy_operator_block_left(&psi->a[0], &psi->a[0], &hamiltonian->a[0], &lblocks[0]);
-	for (int i = 1; i < nsites; i++) {
-		copy_block_sparse_tensor(&lblocks[0], &lblocks[i]);
+	// left and right operator blocks, managed by the environment cache within the memory budget
+	struct environment_cache env_cache;
+	int ret = dmrg_create_operator_blocks(hamiltonian, psi, opts, &env_cache);
+	if (ret < 0) {
+		return ret;
 	}
+	struct block_sparse_tensor* lblocks = env_cache.blocks;
+	struct block_sparse_tensor* rblocks = env_cache.blocks + nsites;
+
+	long num_matvec = 0;
+	long num_local_opt = 0;
+	int num_sweeps_performed = 0;
+	bool converged = false;
+
+	const bool expansion = (opts->expansion_alpha > 0);
+	// mixing factor of the subspace expansion, decreased after each sweep
+	double expansion_alpha = opts->expansion_alpha;
 
-	// TODO: number of sweeps should be determined by tolerance and some convergence measure
+	// sweeps terminate early once the convergence criteria are met
 	for (int n = 0; n < num_sweeps; n++)
 	{
 		double en;
+		const long num_matvec_start = num_matvec;
+		double trunc_error = 0;
+
+		// maximum virtual bond dimension of the current sweep for the subspace expansion, and whether the final bond dimension of the schedule has been reached
+		const long max_vdim_sweep = (opts->max_vdim_sweeps != NULL ? opts->max_vdim_sweeps[n] : (opts->max_vdim_expansion > 0 ? opts->max_vdim_expansion : LONG_MAX));
+		const bool schedule_complete = (!expansion || opts->max_vdim_sweeps == NULL || max_vdim_sweep >= opts->max_vdim_sweeps[num_sweeps - 1]);
 
 		// sweep from left to right
 		for (int i = 0; i < nsites - 1; i++)
 		{
+			// load the operator blocks of the current site, and prefetch the right block of the next site during the local optimization
+			ret = environment_cache_acquire(&env_cache, i);
+			if (ret < 0) {
+				return ret;
+			}
+			ret = environment_cache_acquire(&env_cache, nsites + i);
+			if (ret < 0) {
+				return ret;
+			}
+			environment_cache_prefetch(&env_cache, nsites + i + 1);
+
 			struct block_sparse_tensor a_opt;
-			int ret = minimize_local_energy(&hamiltonian->a[i], &lblocks[i], &rblocks[i], &psi->a[i], maxiter_lanczos, &en, &a_opt);
+			ret = minimize_local_energy(&hamiltonian->a[i], &lblocks[i], &rblocks[i], &psi->a[i], opts, opts->tol_eigensolver, &en, &a_opt, &num_matvec);
+			num_local_opt++;
 			if (ret < 0) {
 				return ret;
 			}
@@ -183,19 +655,51 @@ int dmrg_singlesite(const struct mpo* hamiltonian, const int num_sweeps, const i
 			delete_block_sparse_tensor(&psi->a[i]);
 			move_block_sparse_tensor_data(&a_opt, &psi->a[i]);
 
-			// left-orthonormalize current psi->a[i]
-			mps_local_orthonormalize_qr(&psi->a[i], &psi->a[i + 1]);
+			if (expansion)
+			{
+				// enrich the right virtual bond, and left-orthonormalize current psi->a[i] with truncation
+				struct trunc_info info;
+				ret = dmrg_subspace_expansion_left(&hamiltonian->a[i], &lblocks[i], expansion_alpha, opts->tol_expansion, max_vdim_sweep, &psi->a[i], &psi->a[i + 1], &info);
+				if (ret < 0) {
+					return ret;
+				}
+				trunc_error = fmax(trunc_error, info.tol_eff);
+			}
+			else
+			{
+				// left-orthonormalize current psi->a[i]
+				mps_local_orthonormalize_qr(&psi->a[i], &psi->a[i + 1]);
+			}
 
 			// update the left blocks
-			delete_block_sparse_tensor(&lblocks[i + 1]);
+			environment_cache_discard(&env_cache, i + 1);
 			contraction_operator_step_left(&psi->a[i], &psi->a[i], &hamiltonian->a[i], &lblocks[i], &lblocks[i + 1]);
+			environment_cache_release(&env_cache, i);
+			// the right block of the current site is recomputed in the subsequent right-to-left sweep before it is accessed again
+			environment_cache_discard(&env_cache, nsites + i);
+			ret = environment_cache_store(&env_cache, i + 1);
+			if (ret < 0) {
+				return ret;
+			}
 		}
 
 		// sweep from right to left
 		for (int i = nsites - 1; i > 0; i--)
 		{
+			// load the operator blocks of the current site, and prefetch the left block of the next site during the local optimization
+			ret = environment_cache_acquire(&env_cache, i);
+			if (ret < 0) {
+				return ret;
+			}
+			ret = environment_cache_acquire(&env_cache, nsites + i);
+			if (ret < 0) {
+				return ret;
+			}
+			environment_cache_prefetch(&env_cache, i - 1);
+
 			struct block_sparse_tensor a_opt;
-			int ret = minimize_local_energy(&hamiltonian->a[i], &lblocks[i], &rblocks[i], &psi->a[i], maxiter_lanczos, &en, &a_opt);
+			ret = minimize_local_energy(&hamiltonian->a[i], &lblocks[i], &rblocks[i], &psi->a[i], opts, opts->tol_eigensolver, &en, &a_opt, &num_matvec);
+			num_local_opt++;
 			if (ret < 0) {
 				return ret;
 			}
@@ -203,12 +707,32 @@ int dmrg_singlesite(const struct mpo* hamiltonian, const int num_sweeps, const i
 			delete_block_sparse_tensor(&psi->a[i]);
 			move_block_sparse_tensor_data(&a_opt, &psi->a[i]);
 
-			// right-orthonormalize current psi->a[i]
-			mps_local_orthonormalize_rq(&psi->a[i], &psi->a[i - 1]);
+			if (expansion)
+			{
+				// enrich the left virtual bond, and right-orthonormalize current psi->a[i] with truncation
+				struct trunc_info info;
+				ret = dmrg_subspace_expansion_right(&hamiltonian->a[i], &rblocks[i], expansion_alpha, opts->tol_expansion, max_vdim_sweep, &psi->a[i], &psi->a[i - 1], &info);
+				if (ret < 0) {
+					return ret;
+				}
+				trunc_error = fmax(trunc_error, info.tol_eff);
+			}
+			else
+			{
+				// right-orthonormalize current psi->a[i]
+				mps_local_orthonormalize_rq(&psi->a[i], &psi->a[i - 1]);
+			}
 
 			// update the right blocks
-			delete_block_sparse_tensor(&rblocks[i - 1]);
+			environment_cache_discard(&env_cache, nsites + i - 1);
 			contraction_operator_step_right(&psi->a[i], &psi->a[i], &hamiltonian->a[i], &rblocks[i], &rblocks[i - 1]);
+			environment_cache_release(&env_cache, nsites + i);
+			// the left block of the current site is recomputed in the subsequent left-to-right sweep before it is accessed again
+			environment_cache_discard(&env_cache, i);
+			ret = environment_cache_store(&env_cache, nsites + i - 1);
+			if (ret < 0) {
+				return ret;
+			}
 		}
 
 		// right-normalize leftmost tensor to ensure that 'psi' is normalized
@@ -226,18 +750,32 @@ int dmrg_singlesite(const struct mpo* hamiltonian, const int num_sweeps, const i
 			delete_block_sparse_tensor(&t);
 		}
 
-		// record energy after each sweep
+		// record energy and diagnostics after each sweep
 		en_sweeps[n] = en;
+		struct dmrg_sweep_info info;
+		dmrg_sweep_diagnostics(hamiltonian, psi, opts, en, n > 0 ? en_sweeps[n - 1] : INFINITY, trunc_error, num_matvec - num_matvec_start, &info);
+		if (opts->expansion_decay > 0) {
+			expansion_alpha *= opts->expansion_decay;
+		}
+		if (sweep_info != NULL) {
+			sweep_info[n] = info;
+		}
+		num_sweeps_performed = n + 1;
+		if (schedule_complete && dmrg_sweep_converged(opts, &info)) {
+			converged = true;
+			break;
+		}
 	}
 
-	// clean up
-	for (int i = 0; i < nsites; i++)
-	{
-		delete_block_sparse_tensor(&rblocks[i]);
-		delete_block_sparse_tensor(&lblocks[i]);
+	if (stats != NULL) {
+		stats->num_matvec    = num_matvec;
+		stats->num_local_opt = num_local_opt;
+		stats->num_sweeps    = num_sweeps_performed;
+		stats->converged     = converged;
 	}
-	ct_free(rblocks);
-	ct_free(lblocks);
+
+	// clean up
+	delete_environment_cache(&env_cache);
 
 	return 0;
 }
@@ -248,16 +786,90 @@ int dmrg_singlesite(const struct mpo* hamiltonian, const int num_sweeps, const i
 /// \brief Run the two-site DMRG algorithm: Approximate the ground state as MPS via left and right sweeps and local two-site optimizations.
 /// The input 'psi' is used as starting state and is updated in-place during the optimization.
 ///
+/// The local optimizations use a Lanczos iteration with 'maxiter_lanczos' iterations.
+///
 int dmrg_twosite(const struct mpo* hamiltonian, const int num_sweeps, const int maxiter_lanczos, const double tol_split, const long max_vdim,
 	struct mps* psi, double* restrict en_sweeps, double* restrict entropy)
+{
+	const struct dmrg_options opts = { .eigensolver = DMRG_EIGENSOLVER_LANCZOS, .maxiter = maxiter_lanczos };
+	return dmrg_twosite_options(hamiltonian, num_sweeps, &opts, tol_split, max_vdim, psi, en_sweeps, entropy, NULL, NULL);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Run the two-site DMRG algorithm with the local eigensolver specified by 'opts'.
+///
+/// At most 'num_sweeps' sweeps are performed; the sweeps terminate early once the convergence criteria specified by the
+/// tolerances in 'opts' are met, but not before the final bond dimension of the schedule 'opts->max_vdim_sweeps' (if provided,
+/// replacing 'max_vdim') has been reached. Only the leading entries of 'en_sweeps' and 'sweep_info' (if not NULL) corresponding
+/// to the performed sweeps are set. If 'stats' is not NULL, the number of local Hamiltonian applications, local optimizations
+/// and performed sweeps are stored in it.
+///
+/// For single precision Hamiltonians and states, the local optimizations use a Lanczos iteration with 'opts->maxiter' iterations.
+/// In mixed-precision mode ('opts->num_sweeps_single > 0' for double precision input), the Hamiltonian and state are converted
+/// to single precision for the initial sweeps, and the state is converted back to double precision for the remaining sweeps.
+///
+int dmrg_twosite_options(const struct mpo* hamiltonian, const int num_sweeps, const struct dmrg_options* opts, const double tol_split, const long max_vdim,
+	struct mps* psi, double* restrict en_sweeps, double* restrict entropy, struct dmrg_sweep_info* sweep_info, struct dmrg_statistics* stats)
 {
 	// number of lattice sites
 	const int nsites = hamiltonian->nsites;
 	assert(nsites == psi->nsites);
 	assert(nsites >= 2);
 
-	// currently only double precision supported
-	assert(numeric_real_type(hamiltonian->a[0].dtype) == CT_DOUBLE_REAL);
+	assert(hamiltonian->a[0].dtype == psi->a[0].dtype);
+
+	// mixed-precision mode: perform initial sweeps in single precision, and the remaining sweeps in double precision
+	if (opts->num_sweeps_single > 0 && numeric_real_type(hamiltonian->a[0].dtype) == CT_DOUBLE_REAL)
+	{
+		const enum numeric_type dtype = hamiltonian->a[0].dtype;
+		const enum numeric_type dtype_single = (dtype == CT_DOUBLE_REAL ? CT_SINGLE_REAL : CT_SINGLE_COMPLEX);
+		const int num_sweeps_single = imin(opts->num_sweeps_single, num_sweeps);
+
+		struct dmrg_options opts_single = (*opts);
+		opts_single.num_sweeps_single = 0;
+
+		struct mpo hamiltonian_single;
+		struct mps psi_single;
+		convert_mpo(dtype_single, hamiltonian, &hamiltonian_single);
+		convert_mps(dtype_single, psi, &psi_single);
+		struct dmrg_statistics stats_single;
+		int ret = dmrg_twosite_options(&hamiltonian_single, num_sweeps_single, &opts_single, tol_split, max_vdim, &psi_single, en_sweeps, entropy, sweep_info, &stats_single);
+		delete_mpo(&hamiltonian_single);
+		if (ret < 0) {
+			delete_mps(&psi_single);
+			return ret;
+		}
+		delete_mps(psi);
+		convert_mps(dtype, &psi_single, psi);
+		delete_mps(&psi_single);
+
+		// remaining sweeps in double precision, continuing after the sweeps actually performed in single precision
+		const int n_single = stats_single.num_sweeps;
+		struct dmrg_statistics stats_double = { .converged = stats_single.converged };
+		if (num_sweeps > n_single)
+		{
+			struct dmrg_options opts_double = opts_single;
+			if (opts->max_vdim_sweeps != NULL) {
+				opts_double.max_vdim_sweeps = opts->max_vdim_sweeps + n_single;
+			}
+			ret = dmrg_twosite_options(hamiltonian, num_sweeps - n_single, &opts_double, tol_split, max_vdim, psi, en_sweeps + n_single, entropy,
+				sweep_info != NULL ? sweep_info + n_single : NULL, &stats_double);
+			if (ret < 0) {
+				return ret;
+			}
+		}
+
+		if (stats != NULL) {
+			stats->num_matvec    = stats_single.num_matvec    + stats_double.num_matvec;
+			stats->num_local_opt = stats_single.num_local_opt + stats_double.num_local_opt;
+			stats->num_sweeps    = n_single + stats_double.num_sweeps;
+			stats->converged     = stats_double.converged;
+		}
+
+		return 0;
+	}
 
 	// right-normalize input matrix product state
 	double nrm = mps_orthonormalize_qr(psi, MPS_ORTHONORMAL_RIGHT);
@@ -265,14 +877,14 @@ int dmrg_twosite(const struct mpo* hamiltonian, const int num_sweeps, const int
 		printf("Warning: in 'dmrg_twosite': initial MPS has norm zero (possibly due to mismatching quantum numbers)\n");
 	}
 
-	// left and right operator blocks
-	struct block_sparse_tensor* lblocks = ct_malloc(nsites * sizeof(struct block_sparse_tensor));
-	struct block_sparse_tensor* rblocks = ct_malloc(nsites * sizeof(struct block_sparse_tensor));
-	compute_right_operator_blocks(psi, psi, hamiltonian, rblocks);
-	create_dummy_operator_block_left(&psi->a[0], &psi->a[0], &hamiltonian->a[0], &lblocks[0]);
-	for (int i = 1; i < nsites; i++) {
-		copy_block_sparse_tensor(&lblocks[0], &lblocks[i]);
+	// left and right operator blocks, managed by the environment cache within the memory budget
+	struct environment_cache env_cache;
+	int ret = dmrg_create_operator_blocks(hamiltonian, psi, opts, &env_cache);
+	if (ret < 0) {
+		return ret;
 	}
+	struct block_sparse_tensor* lblocks = env_cache.blocks;
+	struct block_sparse_tensor* rblocks = env_cache.blocks + nsites;
 
 	// precompute merged neighboring Hamiltonian MPO tensors
 	struct block_sparse_tensor* h2 = ct_malloc((nsites - 1) * sizeof(struct block_sparse_tensor));
@@ -280,15 +892,40 @@ int dmrg_twosite(const struct mpo* hamiltonian, const int num_sweeps, const int
 		mpo_merge_tensor_pair(&hamiltonian->a[i], &hamiltonian->a[i + 1], &h2[i]);
 	}
 
-	// TODO: number of sweeps should be determined by tolerance and some convergence measure
+	long num_matvec = 0;
+	long num_local_opt = 0;
+	int num_sweeps_performed = 0;
+	bool converged = false;
+	// truncation error of the previous sweep, for the adaptive eigensolver tolerance
+	double trunc_error_prev = 0;
+
+	// sweeps terminate early once the convergence criteria are met
 	for (int n = 0; n < num_sweeps; n++)
 	{
 		double en;
+		const long num_matvec_start = num_matvec;
+		double trunc_error = 0;
+
+		// maximum virtual bond dimension of the current sweep, and whether the final bond dimension of the schedule has been reached
+		const long max_vdim_sweep = (opts->max_vdim_sweeps != NULL ? opts->max_vdim_sweeps[n] : max_vdim);
+		const bool schedule_complete = (opts->max_vdim_sweeps == NULL || max_vdim_sweep >= opts->max_vdim_sweeps[num_sweeps - 1]);
 
 		// sweep from left to right
 		for (int i = 0; i < nsites - 2; i++)
 		{
-			// merge neighboring MPS tensors
+			// load the operator blocks of the current site pair, and prefetch the right block of the next pair during the local optimization
+			ret = environment_cache_acquire(&env_cache, i);
+			if (ret < 0) {
+				return ret;
+			}
+			ret = environment_cache_acquire(&env_cache, nsites + i + 1);
+			if (ret < 0) {
+				return ret;
+			}
+			environment_cache_prefetch(&env_cache, nsites + i + 2);
+
+			// merge neighboring MPS tensors; since the singular values of the preceding splitting have been absorbed into 'psi->a[i]',
+			// the merged tensor is the transformed optimized state of the previous step (wavefunction prediction)
 			struct block_sparse_tensor a_cur;
 			mps_merge_tensor_pair(&psi->a[i], &psi->a[i + 1], &a_cur);
 			delete_block_sparse_tensor(&psi->a[i]);
@@ -296,7 +933,8 @@ int dmrg_twosite(const struct mpo* hamiltonian, const int num_sweeps, const int
 
 			// minimize local two-site energy using merged tensor as starting point
 			struct block_sparse_tensor a_opt;
-			int ret = minimize_local_energy(&h2[i], &lblocks[i], &rblocks[i + 1], &a_cur, maxiter_lanczos, &en, &a_opt);
+			ret = minimize_local_energy(&h2[i], &lblocks[i], &rblocks[i + 1], &a_cur, opts, dmrg_adaptive_eigensolver_tol(opts, fmax(trunc_error_prev, trunc_error)), &en, &a_opt, &num_matvec);
+			num_local_opt++;
 			delete_block_sparse_tensor(&a_cur);
 			if (ret < 0) {
 				return ret;
@@ -306,21 +944,43 @@ int dmrg_twosite(const struct mpo* hamiltonian, const int num_sweeps, const int
 			const long d_pair[2] = { psi->d, psi->d };
 			const qnumber* qsite_pair[2] = { psi->qsite, psi->qsite };
 			struct trunc_info info;
-			ret = mps_split_tensor_svd(&a_opt, d_pair, qsite_pair, tol_split, max_vdim, false, SVD_DISTR_RIGHT, &psi->a[i], &psi->a[i + 1], &info);
+			ret = mps_split_tensor_svd(&a_opt, d_pair, qsite_pair, tol_split, max_vdim_sweep, false, SVD_DISTR_RIGHT, &psi->a[i], &psi->a[i + 1], &info);
 			if (ret < 0) {
 				return ret;
 			}
 			delete_block_sparse_tensor(&a_opt);
+			trunc_error = fmax(trunc_error, info.tol_eff);
 
 			// update the left blocks
-			delete_block_sparse_tensor(&lblocks[i + 1]);
+			environment_cache_discard(&env_cache, i + 1);
 			contraction_operator_step_left(&psi->a[i], &psi->a[i], &hamiltonian->a[i], &lblocks[i], &lblocks[i + 1]);
+			environment_cache_release(&env_cache, i);
+			// the right block of the current site pair is recomputed in the subsequent right-to-left sweep before it is accessed again
+			environment_cache_discard(&env_cache, nsites + i + 1);
+			ret = environment_cache_store(&env_cache, i + 1);
+			if (ret < 0) {
+				return ret;
+			}
 		}
 
 		// sweep from right to left
 		for (int i = nsites - 2; i >= 0; i--)
 		{
-			// merge neighboring MPS tensors
+			// load the operator blocks of the current site pair, and prefetch the left block of the next pair during the local optimization
+			ret = environment_cache_acquire(&env_cache, i);
+			if (ret < 0) {
+				return ret;
+			}
+			ret = environment_cache_acquire(&env_cache, nsites + i + 1);
+			if (ret < 0) {
+				return ret;
+			}
+			if (i > 0) {
+				environment_cache_prefetch(&env_cache, i - 1);
+			}
+
+			// merge neighboring MPS tensors; since the singular values of the preceding splitting have been absorbed into 'psi->a[i + 1]',
+			// the merged tensor is the transformed optimized state of the previous step (wavefunction prediction)
 			struct block_sparse_tensor a_cur;
 			mps_merge_tensor_pair(&psi->a[i], &psi->a[i + 1], &a_cur);
 			delete_block_sparse_tensor(&psi->a[i]);
@@ -328,7 +988,8 @@ int dmrg_twosite(const struct mpo* hamiltonian, const int num_sweeps, const int
 
 			// minimize local two-site energy using merged tensor as starting point
 			struct block_sparse_tensor a_opt;
-			int ret = minimize_local_energy(&h2[i], &lblocks[i], &rblocks[i + 1], &a_cur, maxiter_lanczos, &en, &a_opt);
+			ret = minimize_local_energy(&h2[i], &lblocks[i], &rblocks[i + 1], &a_cur, opts, dmrg_adaptive_eigensolver_tol(opts, fmax(trunc_error_prev, trunc_error)), &en, &a_opt, &num_matvec);
+			num_local_opt++;
 			delete_block_sparse_tensor(&a_cur);
 			if (ret < 0) {
 				return ret;
@@ -338,17 +999,31 @@ int dmrg_twosite(const struct mpo* hamiltonian, const int num_sweeps, const int
 			const long d_pair[2] = { psi->d, psi->d };
 			const qnumber* qsite_pair[2] = { psi->qsite, psi->qsite };
 			struct trunc_info info;
-			ret = mps_split_tensor_svd(&a_opt, d_pair, qsite_pair, tol_split, max_vdim, false, SVD_DISTR_LEFT, &psi->a[i], &psi->a[i + 1], &info);
+			ret = mps_split_tensor_svd(&a_opt, d_pair, qsite_pair, tol_split, max_vdim_sweep, false, SVD_DISTR_LEFT, &psi->a[i], &psi->a[i + 1], &info);
 			if (ret < 0) {
 				return ret;
 			}
 			delete_block_sparse_tensor(&a_opt);
+			trunc_error = fmax(trunc_error, info.tol_eff);
 			// record entropy
 			entropy[i] = info.entropy;
 
 			// update the right blocks
-			delete_block_sparse_tensor(&rblocks[i]);
+			environment_cache_discard(&env_cache, nsites + i);
 			contraction_operator_step_right(&psi->a[i + 1], &psi->a[i + 1], &hamiltonian->a[i + 1], &rblocks[i + 1], &rblocks[i]);
+			environment_cache_release(&env_cache, nsites + i + 1);
+			// the left block of the current site pair is recomputed in the subsequent left-to-right sweep before it is accessed again
+			// (except for the leftmost dummy block)
+			if (i > 0) {
+				environment_cache_discard(&env_cache, i);
+			}
+			else {
+				environment_cache_release(&env_cache, i);
+			}
+			ret = environment_cache_store(&env_cache, nsites + i);
+			if (ret < 0) {
+				return ret;
+			}
 		}
 
 		// right-normalize leftmost tensor to ensure that 'psi' is normalized
@@ -366,11 +1041,403 @@ int dmrg_twosite(const struct mpo* hamiltonian, const int num_sweeps, const int
 			delete_block_sparse_tensor(&t);
 		}
 
+		// record energy and diagnostics after each sweep
+		en_sweeps[n] = en;
+		struct dmrg_sweep_info info;
+		dmrg_sweep_diagnostics(hamiltonian, psi, opts, en, n > 0 ? en_sweeps[n - 1] : INFINITY, trunc_error, num_matvec - num_matvec_start, &info);
+		trunc_error_prev = trunc_error;
+		if (sweep_info != NULL) {
+			sweep_info[n] = info;
+		}
+		num_sweeps_performed = n + 1;
+		if (schedule_complete && dmrg_sweep_converged(opts, &info)) {
+			converged = true;
+			break;
+		}
+	}
+
+	if (stats != NULL) {
+		stats->num_matvec    = num_matvec;
+		stats->num_local_opt = num_local_opt;
+		stats->num_sweeps    = num_sweeps_performed;
+		stats->converged     = converged;
+	}
+
+	// clean up
+	for (int i = 0; i < nsites - 1; i++)
+	{
+		delete_block_sparse_tensor(&h2[i]);
+	}
+	ct_free(h2);
+	delete_environment_cache(&env_cache);
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Inverse of the retained singular values of a virtual bond, setting the inverse of (numerically) vanishing singular values to zero.
+///
+static void dmrg_inverse_singular_values(const struct dense_tensor* restrict s, struct dense_tensor* restrict s_inv)
+{
+	assert(s->ndim == 1);
+	allocate_dense_tensor(s->dtype, 1, s->dim, s_inv);
+
+	switch (s->dtype)
+	{
+		case CT_SINGLE_REAL:
+		{
+			const float* sdata = s->data;
+			float* s_inv_data = s_inv->data;
+			float smax = 0;
+			for (long k = 0; k < s->dim[0]; k++) {
+				smax = fmaxf(smax, sdata[k]);
+			}
+			for (long k = 0; k < s->dim[0]; k++) {
+				s_inv_data[k] = (sdata[k] > 1e-5f * smax ? 1 / sdata[k] : 0);
+			}
+			break;
+		}
+		case CT_DOUBLE_REAL:
+		{
+			const double* sdata = s->data;
+			double* s_inv_data = s_inv->data;
+			double smax = 0;
+			for (long k = 0; k < s->dim[0]; k++) {
+				smax = fmax(smax, sdata[k]);
+			}
+			for (long k = 0; k < s->dim[0]; k++) {
+				s_inv_data[k] = (sdata[k] > 1e-10 * smax ? 1 / sdata[k] : 0);
+			}
+			break;
+		}
+		default:
+		{
+			// singular values must be real-valued
+			assert(false);
+		}
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Split the two-site tensor 'theta' at the boundary between the sites 'j' and 'j + 1' of neighboring segments,
+/// absorb the retained singular values into both tensors and store their inverse in 's_inv' (parallel DMRG).
+///
+/// The left operator block at site 'j + 1' and the right operator block at site 'j' are computed from the left and right isometries of the splitting,
+/// respectively, and serve as environments of the neighboring segments.
+///
+static int dmrg_parallel_split_boundary(const struct mpo* hamiltonian, const struct block_sparse_tensor* restrict theta, const int j,
+	const double tol_split, const long max_vdim, struct mps* psi, struct block_sparse_tensor* restrict lblocks, struct block_sparse_tensor* restrict rblocks,
+	struct dense_tensor* restrict s_inv)
+{
+	const long d_pair[2] = { psi->d, psi->d };
+	const qnumber* qsite_pair[2] = { psi->qsite, psi->qsite };
+	struct block_sparse_tensor u, vh;
+	struct dense_tensor s;
+	struct trunc_info info;
+	int ret = mps_split_tensor_svd_isometries(theta, d_pair, qsite_pair, tol_split, max_vdim, false, &u, &s, &vh, &info);
+	if (ret < 0) {
+		return ret;
+	}
+
+	// environments of the neighboring segments
+	delete_block_sparse_tensor(&lblocks[j + 1]);
+	contraction_operator_step_left(&u, &u, &hamiltonian->a[j], &lblocks[j], &lblocks[j + 1]);
+	delete_block_sparse_tensor(&rblocks[j]);
+	contraction_operator_step_right(&vh, &vh, &hamiltonian->a[j + 1], &rblocks[j + 1], &rblocks[j]);
+
+	// the boundary tensor of either segment contains the singular values,
+	// such that the segments are connected by their inverse
+	delete_block_sparse_tensor(&psi->a[j]);
+	block_sparse_tensor_multiply_pointwise_vector(&u, &s, TENSOR_AXIS_RANGE_TRAILING, &psi->a[j]);
+	delete_block_sparse_tensor(&psi->a[j + 1]);
+	block_sparse_tensor_multiply_pointwise_vector(&vh, &s, TENSOR_AXIS_RANGE_LEADING, &psi->a[j + 1]);
+	dmrg_inverse_singular_values(&s, s_inv);
+
+	delete_dense_tensor(&s);
+	delete_block_sparse_tensor(&vh);
+	delete_block_sparse_tensor(&u);
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Two-site DMRG half-sweep within the segment of sites 'istart <= i < iend' (parallel DMRG),
+/// using the left operator block at 'istart' and the right operator block at 'iend - 1' as fixed environments.
+///
+static int dmrg_parallel_segment_sweep(const struct mpo* hamiltonian, const struct block_sparse_tensor* h2, const struct dmrg_options* opts,
+	const double tol_split, const long max_vdim, const int istart, const int iend, const bool to_right,
+	struct mps* psi, struct block_sparse_tensor* restrict lblocks, struct block_sparse_tensor* restrict rblocks,
+	double* en, long* num_matvec, long* num_local_opt)
+{
+	const long d_pair[2] = { psi->d, psi->d };
+	const qnumber* qsite_pair[2] = { psi->qsite, psi->qsite };
+
+	for (int k = 0; k < iend - istart - 1; k++)
+	{
+		const int i = (to_right ? istart + k : iend - 2 - k);
+
+		struct block_sparse_tensor a_cur;
+		mps_merge_tensor_pair(&psi->a[i], &psi->a[i + 1], &a_cur);
+		delete_block_sparse_tensor(&psi->a[i]);
+		delete_block_sparse_tensor(&psi->a[i + 1]);
+
+		struct block_sparse_tensor a_opt;
+		int ret = minimize_local_energy(&h2[i], &lblocks[i], &rblocks[i + 1], &a_cur, opts, opts->tol_eigensolver, en, &a_opt, num_matvec);
+		(*num_local_opt)++;
+		delete_block_sparse_tensor(&a_cur);
+		if (ret < 0) {
+			return ret;
+		}
+
+		struct trunc_info info;
+		ret = mps_split_tensor_svd(&a_opt, d_pair, qsite_pair, tol_split, max_vdim, false, to_right ? SVD_DISTR_RIGHT : SVD_DISTR_LEFT, &psi->a[i], &psi->a[i + 1], &info);
+		delete_block_sparse_tensor(&a_opt);
+		if (ret < 0) {
+			return ret;
+		}
+
+		if (to_right)
+		{
+			delete_block_sparse_tensor(&lblocks[i + 1]);
+			contraction_operator_step_left(&psi->a[i], &psi->a[i], &hamiltonian->a[i], &lblocks[i], &lblocks[i + 1]);
+		}
+		else
+		{
+			delete_block_sparse_tensor(&rblocks[i]);
+			contraction_operator_step_right(&psi->a[i + 1], &psi->a[i + 1], &hamiltonian->a[i + 1], &rblocks[i + 1], &rblocks[i]);
+		}
+	}
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Optimize the two-site tensor at the boundary between the sites 'j' and 'j + 1' of neighboring segments (parallel DMRG).
+///
+/// The starting tensor is formed by connecting the boundary tensors of the segments via the inverse singular values 's_inv'
+/// of the previous splitting, which are updated in-place.
+///
+static int dmrg_parallel_stitch_boundary(const struct mpo* hamiltonian, const struct block_sparse_tensor* h2, const struct dmrg_options* opts,
+	const double tol_split, const long max_vdim, const int j, struct mps* psi, struct block_sparse_tensor* restrict lblocks, struct block_sparse_tensor* restrict rblocks,
+	struct dense_tensor* restrict s_inv, double* en, long* num_matvec, long* num_local_opt)
+{
+	struct block_sparse_tensor a_scaled;
+	block_sparse_tensor_multiply_pointwise_vector(&psi->a[j], s_inv, TENSOR_AXIS_RANGE_TRAILING, &a_scaled);
+	struct block_sparse_tensor a_cur;
+	mps_merge_tensor_pair(&a_scaled, &psi->a[j + 1], &a_cur);
+	delete_block_sparse_tensor(&a_scaled);
+
+	struct block_sparse_tensor a_opt;
+	int ret = minimize_local_energy(&h2[j], &lblocks[j], &rblocks[j + 1], &a_cur, opts, opts->tol_eigensolver, en, &a_opt, num_matvec);
+	(*num_local_opt)++;
+	delete_block_sparse_tensor(&a_cur);
+	if (ret < 0) {
+		return ret;
+	}
+
+	delete_dense_tensor(s_inv);
+	ret = dmrg_parallel_split_boundary(hamiltonian, &a_opt, j, tol_split, max_vdim, psi, lblocks, rblocks, s_inv);
+	delete_block_sparse_tensor(&a_opt);
+
+	return ret;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Run the real-space parallel two-site DMRG algorithm (Stoudenmire and White): the chain is divided into 'num_segments' segments
+/// of at least two sites each, which are optimized concurrently by separate threads using their own environment blocks.
+/// The input 'psi' is used as starting state and is updated in-place during the optimization.
+///
+/// Neighboring segments are connected by the inverse singular values of the virtual bond between them.
+/// Each sweep consists of two stages; in every stage, each segment performs a half-sweep towards one of its ends,
+/// alternating such that every other segment boundary is shared by two segments sweeping towards it.
+/// The two-site tensors at these boundaries are subsequently optimized (again concurrently) and split by SVD,
+/// which updates the environments of both segments. Threads are provided by OpenMP; without OpenMP, the segments are processed sequentially.
+///
+/// The recorded energy of a sweep is the lowest energy of the local optimizations in its last stage.
+/// Only the eigensolver settings and 'tol_energy' of the options are used. Finally, the segments are merged and 'psi' is right-normalized.
+///
+int dmrg_twosite_parallel(const struct mpo* hamiltonian, const int num_sweeps, const int num_segments, const struct dmrg_options* opts,
+	const double tol_split, const long max_vdim, struct mps* psi, double* en_sweeps, struct dmrg_statistics* stats)
+{
+	// number of lattice sites
+	const int nsites = hamiltonian->nsites;
+	assert(nsites == psi->nsites);
+	assert(num_segments >= 1);
+	// each segment must contain at least two sites
+	assert(nsites >= 2 * num_segments);
+
+	assert(hamiltonian->a[0].dtype == psi->a[0].dtype);
+
+	// first site of each segment, and 'nsites' as final entry
+	int* seg_start = ct_malloc((num_segments + 1) * sizeof(int));
+	for (int p = 0; p <= num_segments; p++) {
+		seg_start[p] = (int)(((long)p * nsites) / num_segments);
+	}
+
+	// right-normalize input matrix product state
+	double nrm = mps_orthonormalize_qr(psi, MPS_ORTHONORMAL_RIGHT);
+	if (nrm == 0) {
+		printf("Warning: in 'dmrg_twosite_parallel': initial MPS has norm zero (possibly due to mismatching quantum numbers)\n");
+	}
+
+	// left and right operator blocks
+	struct block_sparse_tensor* lblocks = ct_malloc(nsites * sizeof(struct block_sparse_tensor));
+	struct block_sparse_tensor* rblocks = ct_malloc(nsites * sizeof(struct block_sparse_tensor));
+	compute_right_operator_blocks(psi, psi, hamiltonian, rblocks);
+	create_dummy_operator_block_left(&psi->a[0], &psi->a[0], &hamiltonian->a[0], &lblocks[0]);
+	for (int i = 1; i < nsites; i++) {
+		copy_block_sparse_tensor(&lblocks[0], &lblocks[i]);
+	}
+
+	// precompute merged neighboring Hamiltonian MPO tensors
+	struct block_sparse_tensor* h2 = ct_malloc((nsites - 1) * sizeof(struct block_sparse_tensor));
+	for (int i = 0; i < nsites - 1; i++) {
+		mpo_merge_tensor_pair(&hamiltonian->a[i], &hamiltonian->a[i + 1], &h2[i]);
+	}
+
+	// inverse singular values of the virtual bond following each segment (except for the last one)
+	struct dense_tensor* s_inv = ct_malloc(num_segments * sizeof(struct dense_tensor));
+
+	// left-orthonormalize each segment and split the virtual bonds between segments,
+	// such that each segment is left-orthonormal with respect to its left environment, with the center at its last site
+	for (int p = 0; p < num_segments; p++)
+	{
+		for (int i = seg_start[p]; i < seg_start[p + 1] - 1; i++)
+		{
+			mps_local_orthonormalize_qr(&psi->a[i], &psi->a[i + 1]);
+			delete_block_sparse_tensor(&lblocks[i + 1]);
+			contraction_operator_step_left(&psi->a[i], &psi->a[i], &hamiltonian->a[i], &lblocks[i], &lblocks[i + 1]);
+		}
+		if (p < num_segments - 1)
+		{
+			const int j = seg_start[p + 1] - 1;
+			struct block_sparse_tensor theta;
+			mps_merge_tensor_pair(&psi->a[j], &psi->a[j + 1], &theta);
+			int ret = dmrg_parallel_split_boundary(hamiltonian, &theta, j, tol_split, max_vdim, psi, lblocks, rblocks, &s_inv[p]);
+			delete_block_sparse_tensor(&theta);
+			if (ret < 0) {
+				return ret;
+			}
+		}
+	}
+
+	// per-segment (and per-boundary) results of the concurrent optimizations
+	bool* center_right = ct_malloc(num_segments * sizeof(bool));
+	double* en_local   = ct_malloc(2 * num_segments * sizeof(double));
+	long* num_matvec_local    = ct_calloc(num_segments, sizeof(long));
+	long* num_local_opt_local = ct_calloc(num_segments, sizeof(long));
+	int* ret_local = ct_malloc(num_segments * sizeof(int));
+	for (int p = 0; p < num_segments; p++) {
+		center_right[p] = true;
+	}
+
+	int num_sweeps_performed = 0;
+	bool converged = false;
+
+	for (int n = 0; n < num_sweeps; n++)
+	{
+		double en = INFINITY;
+
+		for (int stage = 0; stage < 2; stage++)
+		{
+			for (int p = 0; p < 2 * num_segments; p++) {
+				en_local[p] = INFINITY;
+			}
+
+			// concurrent half-sweeps of all segments, towards the right end for even 'p + stage' and otherwise towards the left end
+			#pragma omp parallel for schedule(dynamic, 1)
+			for (int p = 0; p < num_segments; p++)
+			{
+				const bool target_right = ((p + stage) % 2 == 0);
+				ret_local[p] = 0;
+				if (center_right[p] == target_right) {
+					// first sweep away from the target end
+					ret_local[p] = dmrg_parallel_segment_sweep(hamiltonian, h2, opts, tol_split, max_vdim, seg_start[p], seg_start[p + 1], !target_right,
+						psi, lblocks, rblocks, &en_local[p], &num_matvec_local[p], &num_local_opt_local[p]);
+				}
+				if (ret_local[p] == 0) {
+					ret_local[p] = dmrg_parallel_segment_sweep(hamiltonian, h2, opts, tol_split, max_vdim, seg_start[p], seg_start[p + 1], target_right,
+						psi, lblocks, rblocks, &en_local[p], &num_matvec_local[p], &num_local_opt_local[p]);
+				}
+				center_right[p] = target_right;
+			}
+			for (int p = 0; p < num_segments; p++) {
+				if (ret_local[p] < 0) {
+					return ret_local[p];
+				}
+			}
+
+			// concurrent optimization of the boundaries between segments sweeping towards each other
+			#pragma omp parallel for schedule(dynamic, 1)
+			for (int p = stage; p < num_segments - 1; p += 2)
+			{
+				ret_local[p] = dmrg_parallel_stitch_boundary(hamiltonian, h2, opts, tol_split, max_vdim, seg_start[p + 1] - 1, psi, lblocks, rblocks,
+					&s_inv[p], &en_local[num_segments + p], &num_matvec_local[p], &num_local_opt_local[p]);
+			}
+			for (int p = stage; p < num_segments - 1; p += 2) {
+				if (ret_local[p] < 0) {
+					return ret_local[p];
+				}
+			}
+
+			en = INFINITY;
+			for (int p = 0; p < 2 * num_segments; p++) {
+				en = fmin(en, en_local[p]);
+			}
+		}
+
 		// record energy after each sweep
 		en_sweeps[n] = en;
+		num_sweeps_performed = n + 1;
+		if (n > 0 && opts->tol_energy > 0 && fabs(en - en_sweeps[n - 1]) <= opts->tol_energy) {
+			converged = true;
+			break;
+		}
+	}
+
+	// merge the segments by absorbing the inverse singular values of the virtual bonds between them
+	for (int p = 0; p < num_segments - 1; p++)
+	{
+		const int j = seg_start[p + 1];
+		struct block_sparse_tensor a_scaled;
+		block_sparse_tensor_multiply_pointwise_vector(&psi->a[j], &s_inv[p], TENSOR_AXIS_RANGE_LEADING, &a_scaled);
+		delete_block_sparse_tensor(&psi->a[j]);
+		move_block_sparse_tensor_data(&a_scaled, &psi->a[j]);
+	}
+	mps_orthonormalize_qr(psi, MPS_ORTHONORMAL_RIGHT);
+
+	if (stats != NULL)
+	{
+		stats->num_matvec    = 0;
+		stats->num_local_opt = 0;
+		for (int p = 0; p < num_segments; p++) {
+			stats->num_matvec    += num_matvec_local[p];
+			stats->num_local_opt += num_local_opt_local[p];
+		}
+		stats->num_sweeps = num_sweeps_performed;
+		stats->converged  = converged;
 	}
 
 	// clean up
+	ct_free(ret_local);
+	ct_free(num_local_opt_local);
+	ct_free(num_matvec_local);
+	ct_free(en_local);
+	ct_free(center_right);
+	for (int p = 0; p < num_segments - 1; p++) {
+		delete_dense_tensor(&s_inv[p]);
+	}
+	ct_free(s_inv);
 	for (int i = 0; i < nsites - 1; i++)
 	{
 		delete_block_sparse_tensor(&h2[i]);
@@ -383,6 +1450,7 @@ int dmrg_twosite(const struct mpo* hamiltonian, const int num_sweeps, const int
 	}
 	ct_free(rblocks);
 	ct_free(lblocks);
+	ct_free(seg_start);
 
 	return 0;
 }
@@ -7,7 +7,84 @@
 #include "mpo.h"
 
 
+//________________________________________________________________________________________________________________________
+///
+/// \brief Iterative eigensolver for the local optimization steps.
+///
+enum dmrg_eigensolver
+{
+	DMRG_EIGENSOLVER_LANCZOS           = 0,  //!< Lanczos iteration with a fixed number of iterations, storing the full Krylov basis
+	DMRG_EIGENSOLVER_DAVIDSON          = 1,  //!< Davidson method with diagonal preconditioner and residual norm convergence criterion
+	DMRG_EIGENSOLVER_LANCZOS_RESTARTED = 2,  //!< thick-restart Lanczos iteration with bounded number of stored Krylov vectors and residual norm convergence criterion
+};
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief DMRG options.
+///
+struct dmrg_options
+{
+	enum dmrg_eigensolver eigensolver;  //!< local eigensolver
+	int maxiter;                        //!< maximum number of local Hamiltonian applications per local optimization (number of Lanczos iterations)
+	int max_vectors;                    //!< maximum number of stored basis vectors of the Davidson or restarted Lanczos method (memory cap); a non-positive value selects a default
+	double tol_eigensolver;             //!< residual norm tolerance of the Davidson or restarted Lanczos method
+	double tol_eigensolver_trunc_ratio; //!< two-site DMRG: ratio of the adaptive residual norm tolerance of the Davidson or restarted Lanczos method and the square root of the truncation weight (disabled if non-positive)
+	int num_sweeps_single;              //!< mixed-precision mode: number of initial sweeps performed in single precision for a double precision Hamiltonian and state
+	double tol_energy;                  //!< convergence tolerance of the absolute energy change between consecutive sweeps (disabled if non-positive)
+	double tol_trunc;                   //!< convergence tolerance of the maximum truncation weight within a sweep (disabled if non-positive; two-site DMRG or subspace expansion only)
+	double tol_variance;                //!< convergence tolerance of the energy variance after a sweep (disabled if non-positive; requires applying the Hamiltonian to the state)
+	const long* max_vdim_sweeps;        //!< optional bond dimension schedule: maximum virtual bond dimension for each sweep (array of length 'num_sweeps'), or NULL (two-site DMRG or subspace expansion only)
+	double expansion_alpha;             //!< single-site DMRG: mixing factor of the subspace expansion (DMRG3S) for increasing the virtual bond dimensions (disabled if non-positive)
+	double expansion_decay;             //!< single-site DMRG with subspace expansion: factor by which the mixing factor is multiplied after each sweep (no decay if non-positive)
+	double tol_expansion;               //!< single-site DMRG with subspace expansion: tolerance for truncating the expanded virtual bonds
+	long max_vdim_expansion;            //!< single-site DMRG with subspace expansion: maximum virtual bond dimension (unlimited if non-positive, replaced by 'max_vdim_sweeps' if provided)
+	long env_ram_budget;                //!< memory budget in bytes for the entries of the left and right operator blocks (environment); least recently used blocks exceeding the budget are spilled to a scratch file (unlimited if non-positive)
+	const char* env_scratch_dir;        //!< directory of the scratch file for spilled operator blocks, or NULL to use the directory given by the 'TMPDIR' environment variable or "/tmp"
+};
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief DMRG diagnostics of a single sweep.
+///
+struct dmrg_sweep_info
+{
+	double energy;         //!< energy after the sweep
+	double energy_change;  //!< absolute energy change compared to the previous sweep (infinite for the first sweep)
+	double trunc_error;    //!< maximum effective truncation tolerance (bound on the discarded weight) of the bond splittings within the sweep (zero for single-site DMRG without subspace expansion)
+	double variance;       //!< energy variance after the sweep, only computed if a variance tolerance is specified (otherwise negative)
+	long max_vdim;         //!< maximum virtual bond dimension of the state after the sweep
+	long num_matvec;       //!< number of local Hamiltonian applications during the sweep
+};
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief DMRG run statistics.
+///
+struct dmrg_statistics
+{
+	long num_matvec;     //!< total number of local Hamiltonian applications
+	long num_local_opt;  //!< number of local optimizations
+	int num_sweeps;      //!< number of performed sweeps, which is smaller than the requested number after convergence
+	bool converged;      //!< whether the convergence criteria specified by the tolerances have been met
+};
+
+
+//________________________________________________________________________________________________________________________
+//
+
 int dmrg_singlesite(const struct mpo* hamiltonian, const int num_sweeps, const int maxiter_lanczos, struct mps* psi, double* en_sweeps);
 
 int dmrg_twosite(const struct mpo* hamiltonian, const int num_sweeps, const int maxiter_lanczos, const double tol_split, const long max_vdim,
 	struct mps* psi, double* restrict en_sweeps, double* restrict entropy);
+
+int dmrg_singlesite_options(const struct mpo* hamiltonian, const int num_sweeps, const struct dmrg_options* opts, struct mps* psi,
+	double* en_sweeps, struct dmrg_sweep_info* sweep_info, struct dmrg_statistics* stats);
+
+int dmrg_twosite_options(const struct mpo* hamiltonian, const int num_sweeps, const struct dmrg_options* opts, const double tol_split, const long max_vdim,
+	struct mps* psi, double* restrict en_sweeps, double* restrict entropy, struct dmrg_sweep_info* sweep_info, struct dmrg_statistics* stats);
+
+int dmrg_twosite_parallel(const struct mpo* hamiltonian, const int num_sweeps, const int num_segments, const struct dmrg_options* opts,
+	const double tol_split, const long max_vdim, struct mps* psi, double* en_sweeps, struct dmrg_statistics* stats);
@@ -0,0 +1,459 @@
+/// \file environment_cache.c
+/// \brief Storage of tensor network environment blocks with a memory budget, spilling blocks to a scratch file on disk.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <assert.h>
+#include "environment_cache.h"
+#include "aligned_memory.h"
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Create an environment cache with 'num_blocks' (initially empty) slots.
+///
+/// A 'ram_budget' of zero disables spilling to disk. If 'scratch_dir' is NULL, the scratch file is created in the directory
+/// given by the 'TMPDIR' environment variable, or in "/tmp". The scratch file is only created once a block is spilled.
+///
+void create_environment_cache(const int num_blocks, const size_t ram_budget, const char* scratch_dir, struct environment_cache* cache)
+{
+	assert(num_blocks >= 0);
+
+	cache->blocks = ct_calloc(num_blocks, sizeof(struct block_sparse_tensor));
+	cache->slots  = ct_calloc(num_blocks, sizeof(struct environment_cache_slot));
+	for (int i = 0; i < num_blocks; i++) {
+		cache->slots[i].offset = -1;
+	}
+	memset(&cache->stats, 0, sizeof(struct environment_cache_stats));
+
+	if (scratch_dir == NULL)
+	{
+		scratch_dir = getenv("TMPDIR");
+		if (scratch_dir == NULL || scratch_dir[0] == '\0') {
+			scratch_dir = "/tmp";
+		}
+	}
+	cache->scratch_dir = ct_malloc(strlen(scratch_dir) + 1);
+	strcpy(cache->scratch_dir, scratch_dir);
+
+	cache->ram_budget     = ram_budget;
+	cache->ram_usage      = 0;
+	cache->file_size      = 0;
+	cache->access_counter = 0;
+	memset(&cache->prefetch_request, 0, sizeof(struct aiocb));
+	cache->prefetch_buffer = NULL;
+	cache->prefetch_index  = -1;
+	cache->fd              = -1;
+	cache->num_blocks      = num_blocks;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Wait for the pending prefetch to complete, and let the corresponding block refer to the read entries.
+///
+/// If the asynchronous read has failed, the block remains non-resident.
+///
+static void environment_cache_complete_prefetch(struct environment_cache* cache)
+{
+	assert(cache->prefetch_index >= 0);
+	struct environment_cache_slot* slot = &cache->slots[cache->prefetch_index];
+
+	const struct aiocb* request_list[1] = { &cache->prefetch_request };
+	int err;
+	while ((err = aio_error(&cache->prefetch_request)) == EINPROGRESS) {
+		aio_suspend(request_list, 1, NULL);
+	}
+	const ssize_t nread = aio_return(&cache->prefetch_request);
+
+	if (err == 0 && nread == (ssize_t)slot->size)
+	{
+		block_sparse_tensor_attach_entries(&cache->blocks[cache->prefetch_index], cache->prefetch_buffer);
+		slot->resident = true;
+		cache->stats.num_prefetches++;
+	}
+	else
+	{
+		ct_free(cache->prefetch_buffer);
+		cache->ram_usage -= slot->size;
+	}
+
+	cache->prefetch_buffer = NULL;
+	cache->prefetch_index  = -1;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Delete an environment cache (free memory and close the scratch file, which is thereby removed).
+///
+void delete_environment_cache(struct environment_cache* cache)
+{
+	if (cache->prefetch_index >= 0) {
+		environment_cache_complete_prefetch(cache);
+	}
+
+	for (int i = 0; i < cache->num_blocks; i++)
+	{
+		if (cache->slots[i].valid) {
+			delete_block_sparse_tensor(&cache->blocks[i]);
+		}
+	}
+	ct_free(cache->slots);
+	cache->slots = NULL;
+	ct_free(cache->blocks);
+	cache->blocks = NULL;
+	ct_free(cache->scratch_dir);
+	cache->scratch_dir = NULL;
+
+	if (cache->fd >= 0) {
+		close(cache->fd);
+		cache->fd = -1;
+	}
+	cache->num_blocks = 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Account for 'size' additional bytes of memory used by resident block entries.
+///
+static inline void environment_cache_add_usage(struct environment_cache* cache, const size_t size)
+{
+	cache->ram_usage += size;
+	if (cache->ram_usage > cache->stats.peak_ram_usage) {
+		cache->stats.peak_ram_usage = cache->ram_usage;
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Create the scratch file in the scratch directory.
+///
+static int environment_cache_create_scratch_file(struct environment_cache* cache)
+{
+	const char* name = "chemtensor_env_XXXXXX";
+	char* path = ct_malloc(strlen(cache->scratch_dir) + strlen(name) + 2);
+	sprintf(path, "%s/%s", cache->scratch_dir, name);
+
+	cache->fd = mkstemp(path);
+	if (cache->fd < 0) {
+		fprintf(stderr, "creating scratch file '%s' failed: %s\n", path, strerror(errno));
+		ct_free(path);
+		return -1;
+	}
+	// remove the directory entry right away, such that the file is deleted once it is closed (also in case of abnormal termination)
+	unlink(path);
+	ct_free(path);
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Write 'size' bytes to the scratch file at 'offset', resuming after partial writes.
+///
+static int environment_cache_write(const int fd, const void* data, size_t size, off_t offset)
+{
+	const char* p = data;
+	while (size > 0)
+	{
+		const ssize_t n = pwrite(fd, p, size, offset);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -1;
+		}
+		p      += n;
+		size   -= n;
+		offset += n;
+	}
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Read 'size' bytes from the scratch file at 'offset', resuming after partial reads.
+///
+static int environment_cache_read(const int fd, void* data, size_t size, off_t offset)
+{
+	char* p = data;
+	while (size > 0)
+	{
+		const ssize_t n = pread(fd, p, size, offset);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -1;
+		}
+		if (n == 0) {
+			// unexpected end of file
+			errno = EIO;
+			return -1;
+		}
+		p      += n;
+		size   -= n;
+		offset += n;
+	}
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Evict a resident block from memory, writing its entries to the scratch file unless an up-to-date copy exists there.
+///
+static int environment_cache_evict(struct environment_cache* cache, const int i)
+{
+	struct environment_cache_slot* slot = &cache->slots[i];
+	struct block_sparse_tensor* t = &cache->blocks[i];
+	assert(slot->valid && slot->resident && !slot->pinned);
+
+	if (!slot->on_disk)
+	{
+		if (cache->fd < 0)
+		{
+			int ret = environment_cache_create_scratch_file(cache);
+			if (ret < 0) {
+				return ret;
+			}
+		}
+
+		// re-use the region previously reserved for the slot if it is large enough, otherwise append to the file
+		if (slot->offset < 0 || slot->capacity < slot->size)
+		{
+			slot->offset   = cache->file_size;
+			slot->capacity = slot->size;
+			cache->file_size += slot->size;
+		}
+
+		// write entries in the layout of 'block_sparse_tensor_serialize_entries'
+		int ret = 0;
+		if (t->data != NULL)
+		{
+			ret = environment_cache_write(cache->fd, t->data, slot->size, slot->offset);
+		}
+		else
+		{
+			const size_t dtype_size = sizeof_numeric_type(t->dtype);
+			off_t offset = slot->offset;
+			for (long k = 0; k < t->nblocks && ret == 0; k++)
+			{
+				const size_t nbytes = dense_tensor_num_elements(t->blocks[k]) * dtype_size;
+				ret = environment_cache_write(cache->fd, t->blocks[k]->data, nbytes, offset);
+				offset += nbytes;
+			}
+		}
+		if (ret < 0) {
+			fprintf(stderr, "writing to scratch file in '%s' failed: %s\n", cache->scratch_dir, strerror(errno));
+			return ret;
+		}
+
+		slot->on_disk = true;
+		cache->stats.num_writes++;
+	}
+
+	block_sparse_tensor_release_entries(t);
+	slot->resident = false;
+	cache->ram_usage -= slot->size;
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Evict least recently used blocks until 'size' additional bytes fit into the memory budget.
+///
+/// Blocks in use are never evicted, such that the budget can be exceeded temporarily.
+///
+static int environment_cache_make_room(struct environment_cache* cache, const size_t size)
+{
+	if (cache->ram_budget == 0) {
+		// unlimited
+		return 0;
+	}
+
+	while (cache->ram_usage + size > cache->ram_budget)
+	{
+		int i_lru = -1;
+		for (int i = 0; i < cache->num_blocks; i++)
+		{
+			const struct environment_cache_slot* slot = &cache->slots[i];
+			if (slot->valid && slot->resident && !slot->pinned && slot->size > 0 &&
+				(i_lru < 0 || slot->last_access < cache->slots[i_lru].last_access)) {
+				i_lru = i;
+			}
+		}
+		if (i_lru < 0) {
+			// all resident blocks are in use
+			break;
+		}
+
+		int ret = environment_cache_evict(cache, i_lru);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Take over the (newly computed) tensor in 'cache->blocks[i]', evicting other blocks if the memory budget is exceeded.
+///
+/// The slot must be empty, i.e., not hold a block or have been discarded before.
+///
+int environment_cache_store(struct environment_cache* cache, const int i)
+{
+	assert(0 <= i && i < cache->num_blocks);
+	struct environment_cache_slot* slot = &cache->slots[i];
+	assert(!slot->valid);
+
+	const struct block_sparse_tensor* t = &cache->blocks[i];
+	slot->size        = block_sparse_tensor_num_elements_blocks(t) * sizeof_numeric_type(t->dtype);
+	slot->last_access = cache->access_counter++;
+	slot->valid       = true;
+	slot->resident    = true;
+	slot->on_disk     = false;
+	slot->pinned      = false;
+	environment_cache_add_usage(cache, slot->size);
+
+	return environment_cache_make_room(cache, 0);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Ensure that the entries of block 'i' are in memory, and protect the block from eviction until it is released.
+///
+int environment_cache_acquire(struct environment_cache* cache, const int i)
+{
+	assert(0 <= i && i < cache->num_blocks);
+	struct environment_cache_slot* slot = &cache->slots[i];
+	assert(slot->valid);
+
+	if (cache->prefetch_index == i) {
+		environment_cache_complete_prefetch(cache);
+	}
+
+	if (!slot->resident)
+	{
+		// synchronous read, also as fallback after a failed prefetch
+		assert(slot->on_disk);
+		int ret = environment_cache_make_room(cache, slot->size);
+		if (ret < 0) {
+			return ret;
+		}
+		void* entries = ct_malloc(slot->size);
+		ret = environment_cache_read(cache->fd, entries, slot->size, slot->offset);
+		if (ret < 0) {
+			fprintf(stderr, "reading from scratch file in '%s' failed: %s\n", cache->scratch_dir, strerror(errno));
+			ct_free(entries);
+			return ret;
+		}
+		block_sparse_tensor_attach_entries(&cache->blocks[i], entries);
+		slot->resident = true;
+		environment_cache_add_usage(cache, slot->size);
+		cache->stats.num_reads++;
+	}
+
+	slot->pinned      = true;
+	slot->last_access = cache->access_counter++;
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Release block 'i' after use, such that it can be evicted again.
+///
+void environment_cache_release(struct environment_cache* cache, const int i)
+{
+	assert(0 <= i && i < cache->num_blocks);
+	assert(cache->slots[i].valid);
+	cache->slots[i].pinned = false;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Start reading the entries of block 'i' from the scratch file asynchronously, such that a subsequent
+/// 'environment_cache_acquire' overlaps the disk access with the computation in between.
+///
+/// This is only a hint: nothing happens if the block is resident or another prefetch is pending,
+/// and if the asynchronous read cannot be issued, the block is read synchronously when acquired.
+/// Note that glibc implements POSIX asynchronous I/O by helper threads, which only access the destination buffer.
+///
+void environment_cache_prefetch(struct environment_cache* cache, const int i)
+{
+	assert(0 <= i && i < cache->num_blocks);
+	const struct environment_cache_slot* slot = &cache->slots[i];
+
+	if (!slot->valid || slot->resident || cache->prefetch_index >= 0) {
+		return;
+	}
+	assert(slot->on_disk);
+
+	if (environment_cache_make_room(cache, slot->size) < 0) {
+		// error will be reported by 'environment_cache_acquire'
+		return;
+	}
+
+	void* buffer = ct_malloc(slot->size);
+	memset(&cache->prefetch_request, 0, sizeof(struct aiocb));
+	cache->prefetch_request.aio_fildes = cache->fd;
+	cache->prefetch_request.aio_offset = slot->offset;
+	cache->prefetch_request.aio_buf    = buffer;
+	cache->prefetch_request.aio_nbytes = slot->size;
+	cache->prefetch_request.aio_sigevent.sigev_notify = SIGEV_NONE;
+	if (aio_read(&cache->prefetch_request) < 0) {
+		ct_free(buffer);
+		return;
+	}
+
+	cache->prefetch_buffer = buffer;
+	cache->prefetch_index  = i;
+	environment_cache_add_usage(cache, slot->size);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Delete block 'i' (which is not needed anymore or will be recomputed), without writing it to the scratch file.
+///
+/// The region of the scratch file reserved for the slot is re-used by a subsequently stored block. Nothing happens if the slot is empty.
+///
+void environment_cache_discard(struct environment_cache* cache, const int i)
+{
+	assert(0 <= i && i < cache->num_blocks);
+	struct environment_cache_slot* slot = &cache->slots[i];
+
+	if (cache->prefetch_index == i) {
+		environment_cache_complete_prefetch(cache);
+	}
+
+	if (!slot->valid) {
+		return;
+	}
+
+	if (slot->resident) {
+		cache->ram_usage -= slot->size;
+	}
+	delete_block_sparse_tensor(&cache->blocks[i]);
+	slot->valid    = false;
+	slot->resident = false;
+	slot->on_disk  = false;
+	slot->pinned   = false;
+}
@@ -0,0 +1,80 @@
+/// \file environment_cache.h
+/// \brief Storage of tensor network environment blocks with a memory budget, spilling blocks to a scratch file on disk.
+
+#pragma once
+
+#include <stdbool.h>
+#include <sys/types.h>
+#include <aio.h>
+#include "block_sparse_tensor.h"
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Storage state of an environment block.
+///
+struct environment_cache_slot
+{
+	off_t offset;      //!< offset of the region reserved for the block in the scratch file, or -1 if not reserved yet
+	size_t capacity;   //!< size of the region reserved for the block in the scratch file, in bytes
+	size_t size;       //!< size of the block entries in bytes
+	long last_access;  //!< logical time of the last access, for evicting the least recently used block
+	bool valid;        //!< whether the slot holds a block
+	bool resident;     //!< whether the block entries are in memory
+	bool on_disk;      //!< whether the scratch file holds an up-to-date copy of the block entries
+	bool pinned;       //!< whether the block is in use and must not be evicted
+};
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Environment cache statistics.
+///
+struct environment_cache_stats
+{
+	long num_writes;        //!< number of blocks written to the scratch file
+	long num_reads;         //!< number of blocks read synchronously from the scratch file
+	long num_prefetches;    //!< number of blocks read asynchronously from the scratch file and used afterwards
+	size_t peak_ram_usage;  //!< peak memory usage of the block entries, in bytes
+};
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Environment cache: a fixed number of block-sparse tensor slots, of which only the most recently used ones
+/// are kept in memory within a memory budget, while the entries of the others are stored in a scratch file.
+///
+/// The structure (quantum numbers and block dimensions) of each block always stays in memory.
+/// A block has to be acquired before accessing its entries, and released afterwards.
+///
+struct environment_cache
+{
+	struct block_sparse_tensor* blocks;    //!< environment blocks, array of length 'num_blocks'; the dense blocks of non-resident tensors refer to NULL
+	struct environment_cache_slot* slots;  //!< storage state of each block, array of length 'num_blocks'
+	struct environment_cache_stats stats;  //!< statistics
+	char* scratch_dir;                     //!< directory of the scratch file
+	size_t ram_budget;                     //!< memory budget for the entries of resident blocks in bytes (unlimited if zero)
+	size_t ram_usage;                      //!< memory usage of the entries of resident blocks, including a pending prefetch, in bytes
+	off_t file_size;                       //!< size of the scratch file in bytes
+	long access_counter;                   //!< logical time, incremented on each block access
+	struct aiocb prefetch_request;         //!< asynchronous read request of the pending prefetch
+	void* prefetch_buffer;                 //!< destination buffer of the pending prefetch
+	int prefetch_index;                    //!< slot index of the pending prefetch, or -1 if there is none
+	int fd;                                //!< file descriptor of the (already unlinked) scratch file, or -1 if not created yet
+	int num_blocks;                        //!< number of slots
+};
+
+
+void create_environment_cache(const int num_blocks, const size_t ram_budget, const char* scratch_dir, struct environment_cache* cache);
+
+void delete_environment_cache(struct environment_cache* cache);
+
+int environment_cache_store(struct environment_cache* cache, const int i);
+
+int environment_cache_acquire(struct environment_cache* cache, const int i);
+
+void environment_cache_release(struct environment_cache* cache, const int i);
+
+void environment_cache_prefetch(struct environment_cache* cache, const int i);
+
+void environment_cache_discard(struct environment_cache* cache, const int i);
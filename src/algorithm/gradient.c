@@ -57,7 +57,7 @@ void operator_average_coefficient_gradient(const struct mpo_assembly* assembly,
 		assert(r.dim_logical[0] == 1 && r.dim_logical[1] == 1);
 
 		// 'r' is logically zero in case quantum numbers do not match
-		if (r.blocks[0] == NULL)
+		if (r.nblocks == 0)
 		{
 			memset(avr, 0, sizeof_numeric_type(assembly->dtype));
 
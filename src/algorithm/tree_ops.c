@@ -333,21 +333,21 @@ void ttno_inner_product(const struct ttns* chi, const struct ttno* op, const str
 
 		ct_free(axis_desc_op_psi);
 
-		struct block_sparse_tensor chi_a_conj;
-		copy_block_sparse_tensor(&chi->a[i_site], &chi_a_conj);
-		conjugate_block_sparse_tensor(&chi_a_conj);
-		block_sparse_tensor_reverse_axis_directions(&chi_a_conj);
+		// local tensor of 'chi', complex conjugated within the contraction below;
+		// a (transposed or reshaped) copy is only created if required
+		const struct block_sparse_tensor* chi_a = &chi->a[i_site];
+		struct block_sparse_tensor chi_a_copy;
 
 		if (l > 0)  // not root node
 		{
 			assert(i_parent != -1);
 
-			// move parent bond axis in 'chi_a_conj' to the front
+			// move parent bond axis in 'chi_a' to the front
 
 			struct ttns_tensor_axis_desc* axis_desc_chi = ct_malloc(chi->a[i_site].ndim * sizeof(struct ttns_tensor_axis_desc));
 			ttns_tensor_get_axis_desc(chi, i_site, axis_desc_chi);
 
-			int* perm = ct_malloc(chi_a_conj.ndim * sizeof(int));
+			int* perm = ct_malloc(chi_a->ndim * sizeof(int));
 			int c = 0;
 			for (int i = 0; i < chi->a[i_site].ndim; i++) {
 				if (axis_desc_chi[i].type == TTNS_TENSOR_AXIS_VIRTUAL && axis_desc_chi[i].index == i_parent) {
@@ -359,14 +359,12 @@ void ttno_inner_product(const struct ttns* chi, const struct ttno* op, const str
 					perm[c++] = i;
 				}
 			}
-			assert(c == chi_a_conj.ndim);
+			assert(c == chi_a->ndim);
 
-			if (!is_identity_permutation(perm, chi_a_conj.ndim))
+			if (!is_identity_permutation(perm, chi_a->ndim))
 			{
-				struct block_sparse_tensor tmp;
-				transpose_block_sparse_tensor(perm, &chi_a_conj, &tmp);
-				delete_block_sparse_tensor(&chi_a_conj);
-				move_block_sparse_tensor_data(&tmp, &chi_a_conj);
+				transpose_block_sparse_tensor(perm, chi_a, &chi_a_copy);
+				chi_a = &chi_a_copy;
 			}
 
 			ct_free(perm);
@@ -374,7 +372,7 @@ void ttno_inner_product(const struct ttns* chi, const struct ttno* op, const str
 		}
 
 		struct block_sparse_tensor r;
-		const int ndim_mult_chi = chi_a_conj.ndim - (i_parent == -1 ? 0 : 1);
+		const int ndim_mult_chi = chi_a->ndim - (i_parent == -1 ? 0 : 1);
 		if (ndim_mult_chi == 0)
 		{
 			// special case: single virtual bond axis to parent node and no physical or auxiliary axis
@@ -393,25 +391,31 @@ void ttno_inner_product(const struct ttns* chi, const struct ttno* op, const str
 			}
 
 			{
-				assert(chi_a_conj.ndim == 1);
+				// dummy axis is reversed by the conjugation in the contraction
+				assert(chi_a->ndim == 1);
 				const qnumber q_zero[1] = { 0 };
-				const long new_dim_logical[2]                    = { chi_a_conj.dim_logical[0],   1              };
-				const enum tensor_axis_direction new_axis_dir[2] = { chi_a_conj.axis_dir[0],      TENSOR_AXIS_IN };
-				const qnumber* new_qnums_logical[2]              = { chi_a_conj.qnums_logical[0], q_zero         };
+				const long new_dim_logical[2]                    = { chi_a->dim_logical[0],   1               };
+				const enum tensor_axis_direction new_axis_dir[2] = { chi_a->axis_dir[0],      TENSOR_AXIS_OUT };
+				const qnumber* new_qnums_logical[2]              = { chi_a->qnums_logical[0], q_zero          };
 				struct block_sparse_tensor tmp;
-				split_block_sparse_tensor_axis(&chi_a_conj, 0, new_dim_logical, new_axis_dir, new_qnums_logical, &tmp);
-				delete_block_sparse_tensor(&chi_a_conj);
-				move_block_sparse_tensor_data(&tmp, &chi_a_conj);
+				split_block_sparse_tensor_axis(chi_a, 0, new_dim_logical, new_axis_dir, new_qnums_logical, &tmp);
+				if (chi_a == &chi_a_copy) {
+					delete_block_sparse_tensor(&chi_a_copy);
+				}
+				move_block_sparse_tensor_data(&tmp, &chi_a_copy);
+				chi_a = &chi_a_copy;
 			}
 		}
-		block_sparse_tensor_dot(&op_psi_a_bonds, TENSOR_AXIS_RANGE_TRAILING, &chi_a_conj, TENSOR_AXIS_RANGE_TRAILING, imax(ndim_mult_chi, 1), &r);
+		block_sparse_tensor_dot_conj(&op_psi_a_bonds, TENSOR_AXIS_RANGE_TRAILING, false, chi_a, TENSOR_AXIS_RANGE_TRAILING, true, imax(ndim_mult_chi, 1), &r);
 		delete_block_sparse_tensor(&op_psi_a_bonds);
-		delete_block_sparse_tensor(&chi_a_conj);
+		if (chi_a == &chi_a_copy) {
+			delete_block_sparse_tensor(&chi_a_copy);
+		}
 
 		if (l == 0)  // root node
 		{
 			assert(r.ndim == 0);
-			assert(r.blocks[0] != NULL);
+			assert(r.nblocks == 1);
 
 			// copy scalar entry
 			memcpy(ret, r.blocks[0]->data, sizeof_numeric_type(r.dtype));
@@ -0,0 +1,645 @@
+/// \file aligned_memory.c
+/// \brief Aligned memory allocation.
+
+#include <stdint.h>
+#include <assert.h>
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#endif
+#include "aligned_memory.h"
+
+
+#if defined(_MSC_VER)
+#define CT_THREAD_LOCAL __declspec(thread)
+#else
+#define CT_THREAD_LOCAL _Thread_local
+#endif
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Round 'size' up to the next multiple of 'CT_MEM_DATA_ALIGN', which must be a power of 2.
+///
+static inline size_t align_size(const size_t size)
+{
+	return (size + CT_MEM_DATA_ALIGN - 1) & (-CT_MEM_DATA_ALIGN);
+}
+
+
+/// \brief Alignment of the memory blocks provided by allocators. Memory blocks returned by 'ct_malloc' with a preceding header
+/// are offset by an odd multiple of 'CT_MEM_DATA_ALIGN', such that 'ct_free' can recognize them by their address.
+#define MEMORY_TAG_ALIGN (2 * CT_MEM_DATA_ALIGN)
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Header stored directly in front of memory blocks returned by 'ct_malloc' which are not provided by the system allocator.
+///
+struct memory_header
+{
+	size_t size;                           //!< requested size in bytes
+	const struct ct_allocator* allocator;  //!< allocator which provided the memory block, or NULL for an arena allocation
+	struct arena* arena;                   //!< arena of the allocating thread for an arena allocation, or NULL otherwise
+};
+
+/// \brief Size reserved for the memory header, an odd multiple of 'CT_MEM_DATA_ALIGN'.
+#define MEMORY_HEADER_SIZE ((((sizeof(struct memory_header) + CT_MEM_DATA_ALIGN - 1) / CT_MEM_DATA_ALIGN) | 1) * CT_MEM_DATA_ALIGN)
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Whether the memory block 'memblock' returned by 'ct_malloc' is preceded by a memory header.
+///
+static inline bool has_memory_header(const void* memblock)
+{
+	return ((uintptr_t)memblock & CT_MEM_DATA_ALIGN) != 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Access the memory header of the memory block 'memblock' returned by 'ct_malloc'.
+///
+static inline struct memory_header* get_memory_header(void* memblock)
+{
+	return (struct memory_header*)((char*)memblock - sizeof(struct memory_header));
+}
+
+
+/// \brief Size of a transparent huge page on Linux.
+#define HUGE_PAGE_SIZE ((size_t)1 << 21)
+
+/// \brief Minimum size of memory blocks backed by transparent huge pages, or 0 if disabled.
+static size_t huge_page_threshold = CT_MEM_HUGE_PAGE_THRESHOLD;
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Set the minimum size in bytes of memory blocks for which transparent huge pages are requested
+/// (only effective on Linux); a threshold of 0 disables the advice.
+///
+void ct_set_huge_page_threshold(size_t threshold)
+{
+	huge_page_threshold = threshold;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Allocate a memory block aligned to 'MEMORY_TAG_ALIGN' from the C runtime.
+///
+static void* system_allocate(size_t size, void* context)
+{
+	(void)context;
+	#ifdef _WIN32
+	return _aligned_malloc(size, MEMORY_TAG_ALIGN);
+	#else
+	#if defined(__linux__) && defined(MADV_HUGEPAGE)
+	if (huge_page_threshold > 0 && size >= huge_page_threshold)
+	{
+		// align to and round up to huge pages, such that the advice covers the whole block
+		const size_t size_huge = (size + HUGE_PAGE_SIZE - 1) & (-HUGE_PAGE_SIZE);
+		void* p = aligned_alloc(HUGE_PAGE_SIZE, size_huge);
+		if (p != NULL) {
+			// only an advice, hence failure is not an error
+			madvise(p, size_huge, MADV_HUGEPAGE);
+		}
+		return p;
+	}
+	#endif
+	// unlike 'aligned_alloc', 'posix_memalign' does not require the size to be a multiple of the alignment
+	void* p;
+	if (posix_memalign(&p, MEMORY_TAG_ALIGN, align_size(size)) != 0) {
+		return NULL;
+	}
+	return p;
+	#endif
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Deallocate a memory block obtained from 'system_allocate'.
+///
+static void system_deallocate(void* memblock, size_t size, void* context)
+{
+	(void)size;
+	(void)context;
+	#ifdef _WIN32
+	_aligned_free(memblock);
+	#else
+	free(memblock);
+	#endif
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Usable size of a memory block obtained from 'system_allocate', or zero if the C runtime does not provide it.
+///
+static size_t system_block_size(void* memblock)
+{
+	#if defined(_WIN32)
+	return _aligned_msize(memblock, MEMORY_TAG_ALIGN, 0);
+	#elif defined(__linux__)
+	return malloc_usable_size(memblock);
+	#elif defined(__APPLE__)
+	return malloc_size(memblock);
+	#else
+	(void)memblock;
+	return 0;
+	#endif
+}
+
+
+const struct ct_allocator ct_system_allocator = { .allocate = system_allocate, .deallocate = system_deallocate, .context = NULL };
+
+
+//________________________________________________________________________________________________________________________
+//
+
+// size-class memory pool
+
+/// \brief Binary logarithm of the smallest pool size class in bytes.
+#define POOL_MIN_CLASS_LOG 6
+
+/// \brief Number of pool size classes; larger blocks bypass the pool.
+#define POOL_NUM_CLASSES 12
+
+/// \brief Maximum number of bytes cached in the free list of a size class; further freed blocks are returned to the system.
+#define POOL_MAX_CACHED_BYTES ((size_t)1 << 20)
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Freed memory block in a pool free list.
+///
+struct pool_block
+{
+	struct pool_block* next;  //!< next free block of the same size class
+};
+
+
+/// \brief Thread-local free lists of the pool, one per size class.
+static CT_THREAD_LOCAL struct pool_block* pool_free_lists[POOL_NUM_CLASSES];
+
+/// \brief Number of blocks in the thread-local free lists of the pool.
+static CT_THREAD_LOCAL long pool_num_cached[POOL_NUM_CLASSES];
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Size class of a memory block of 'size' bytes, or -1 if it is too large for the pool.
+///
+static inline int pool_size_class(const size_t size)
+{
+	int c = 0;
+	while (((size_t)1 << (POOL_MIN_CLASS_LOG + c)) < size) {
+		c++;
+		if (c == POOL_NUM_CLASSES) {
+			return -1;
+		}
+	}
+	return c;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Allocate a memory block from the thread-local pool.
+///
+static void* pool_allocate(size_t size, void* context)
+{
+	const int c = pool_size_class(size);
+	if (c < 0) {
+		return system_allocate(size, context);
+	}
+	struct pool_block* block = pool_free_lists[c];
+	if (block != NULL) {
+		pool_free_lists[c] = block->next;
+		pool_num_cached[c]--;
+		return block;
+	}
+	return system_allocate((size_t)1 << (POOL_MIN_CLASS_LOG + c), context);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Return a memory block to the free list of the calling thread.
+///
+/// Blocks are interchangeable between threads, such that a block allocated by a different thread can be cached as well.
+/// The size of each free list is bounded, since a thread could otherwise accumulate the blocks freed on behalf of other threads.
+///
+static void pool_deallocate(void* memblock, size_t size, void* context)
+{
+	const int c = pool_size_class(size);
+	if (c < 0 || (size_t)pool_num_cached[c] >= (POOL_MAX_CACHED_BYTES >> (POOL_MIN_CLASS_LOG + c))) {
+		system_deallocate(memblock, size, context);
+		return;
+	}
+	struct pool_block* block = memblock;
+	block->next = pool_free_lists[c];
+	pool_free_lists[c] = block;
+	pool_num_cached[c]++;
+}
+
+
+const struct ct_allocator ct_pool_allocator = { .allocate = pool_allocate, .deallocate = pool_deallocate, .context = NULL };
+
+
+/// \brief Allocator used outside of arena regions.
+static const struct ct_allocator* current_allocator = &ct_system_allocator;
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Set the allocator used by 'ct_malloc' outside of arena regions.
+///
+/// Memory blocks remember their allocator, such that blocks allocated before the switch
+/// are correctly returned to their original allocator, which must stay valid until then.
+///
+void ct_set_allocator(const struct ct_allocator* allocator)
+{
+	assert(allocator != NULL);
+	current_allocator = allocator;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Get the allocator used by 'ct_malloc' outside of arena regions.
+///
+const struct ct_allocator* ct_get_allocator(void)
+{
+	return current_allocator;
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+// arena regions
+
+/// \brief Default capacity of an arena chunk in bytes; a single chunk of this capacity is retained after the outermost region has been released.
+#define ARENA_CHUNK_CAPACITY ((size_t)1 << 20)
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Chunk of arena memory, followed by its data.
+///
+struct arena_chunk
+{
+	struct arena_chunk* next;  //!< next chunk, re-used after the current chunk is exhausted
+	size_t capacity;           //!< capacity of the data in bytes
+	size_t used;               //!< number of used bytes
+};
+
+/// \brief Size of the arena chunk header, padded such that the chunk data is aligned to 'MEMORY_TAG_ALIGN'.
+#define ARENA_CHUNK_HEADER_SIZE ((sizeof(struct arena_chunk) + MEMORY_TAG_ALIGN - 1) & (-MEMORY_TAG_ALIGN))
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Thread-local bump allocator for scoped regions.
+///
+struct arena
+{
+	struct arena_chunk* first;    //!< first chunk in the list
+	struct arena_chunk* current;  //!< chunk currently used for allocations, or NULL if none has been used yet
+	size_t footprint;             //!< memory held by all chunks in bytes
+	long num_live;                //!< number of arena allocations which have not been freed yet
+	int depth;                    //!< nesting depth of the active regions
+};
+
+static CT_THREAD_LOCAL struct arena thread_arena;
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Number of arena bytes occupied by an allocation of 'size' bytes, including the memory header.
+///
+static inline size_t arena_allocation_size(const size_t size)
+{
+	return (MEMORY_HEADER_SIZE + size + MEMORY_TAG_ALIGN - 1) & (-MEMORY_TAG_ALIGN);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Return an arena chunk to the system.
+///
+static void arena_delete_chunk(struct arena* arena, struct arena_chunk* chunk)
+{
+	arena->footprint -= ARENA_CHUNK_HEADER_SIZE + chunk->capacity;
+	system_deallocate(chunk, ARENA_CHUNK_HEADER_SIZE + chunk->capacity, NULL);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Allocate 'total' bytes (a multiple of 'MEMORY_TAG_ALIGN') from the thread-local arena.
+///
+static void* arena_allocate(const size_t total)
+{
+	struct arena* arena = &thread_arena;
+	struct arena_chunk* chunk = arena->current;
+	if (chunk == NULL || chunk->capacity - chunk->used < total)
+	{
+		// chunks following the current one are unused; replace those which are too small,
+		// such that they do not accumulate when the requested sizes grow
+		struct arena_chunk* next = (chunk != NULL ? chunk->next : arena->first);
+		while (next != NULL && next->capacity < total)
+		{
+			struct arena_chunk* following = next->next;
+			arena_delete_chunk(arena, next);
+			next = following;
+		}
+		if (next == NULL)
+		{
+			const size_t capacity = (total > ARENA_CHUNK_CAPACITY ? total : ARENA_CHUNK_CAPACITY);
+			next = system_allocate(ARENA_CHUNK_HEADER_SIZE + capacity, NULL);
+			if (next == NULL) {
+				return NULL;
+			}
+			next->capacity = capacity;
+			next->next = NULL;
+			arena->footprint += ARENA_CHUNK_HEADER_SIZE + capacity;
+		}
+		if (chunk != NULL) {
+			chunk->next = next;
+		}
+		else {
+			arena->first = next;
+		}
+		next->used = 0;
+		arena->current = next;
+		chunk = next;
+	}
+	void* p = (char*)chunk + ARENA_CHUNK_HEADER_SIZE + chunk->used;
+	chunk->used += total;
+	return p;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Reclaim the arena allocation 'p' of 'total' bytes if it is the most recent one in the current chunk,
+/// such that temporaries freed in reverse order of their allocation do not accumulate within a region.
+///
+static void arena_deallocate(void* p, const size_t total)
+{
+	struct arena_chunk* chunk = thread_arena.current;
+	if (chunk == NULL) {
+		return;
+	}
+	char* data = (char*)chunk + ARENA_CHUNK_HEADER_SIZE;
+	if ((char*)p >= data && (char*)p + total == data + chunk->used) {
+		chunk->used -= total;
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Return the arena chunks of the calling thread to the system, optionally retaining a first chunk of default capacity.
+///
+static void arena_trim(const bool retain_default_chunk)
+{
+	struct arena* arena = &thread_arena;
+	assert(arena->depth == 0);
+	assert(arena->num_live == 0);
+	struct arena_chunk* chunk = arena->first;
+	if (retain_default_chunk && chunk != NULL && chunk->capacity == ARENA_CHUNK_CAPACITY) {
+		chunk = chunk->next;
+		arena->first->next = NULL;
+	}
+	else {
+		arena->first = NULL;
+	}
+	while (chunk != NULL)
+	{
+		struct arena_chunk* next = chunk->next;
+		arena_delete_chunk(arena, chunk);
+		chunk = next;
+	}
+	arena->current = NULL;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Begin a scoped region: until the matching 'ct_memory_release', 'ct_malloc' calls of the current thread
+/// are served by a bump allocator, and the corresponding 'ct_free' calls only reclaim the most recent allocation.
+///
+/// All memory blocks allocated within the region must be freed by the same thread before the region is released.
+/// Regions can be nested. Regions are meant for short-lived temporaries; long-lived or large workspace
+/// (like the basis of an eigensolver) should be allocated outside of regions.
+///
+struct ct_memory_marker ct_memory_mark(void)
+{
+	struct arena* arena = &thread_arena;
+	struct ct_memory_marker marker = {
+		.chunk    = arena->current,
+		.used     = (arena->current != NULL ? arena->current->used : 0),
+		.num_live = arena->num_live,
+		.depth    = arena->depth,
+	};
+	arena->depth++;
+	return marker;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief End a scoped region, making the arena memory used within the region available again.
+///
+/// Releasing the outermost region returns all arena chunks except for one of default capacity to the system.
+///
+void ct_memory_release(const struct ct_memory_marker* marker)
+{
+	struct arena* arena = &thread_arena;
+	assert(arena->depth == marker->depth + 1);
+	// all memory blocks allocated within the region must have been freed
+	assert(arena->num_live == marker->num_live);
+	arena->current = marker->chunk;
+	if (arena->current != NULL) {
+		arena->current->used = marker->used;
+	}
+	arena->depth--;
+	if (arena->depth == 0) {
+		arena_trim(true);
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Return the cached pool blocks and (outside of regions) the arena chunks of the calling thread to the system.
+///
+void ct_memory_trim(void)
+{
+	for (int c = 0; c < POOL_NUM_CLASSES; c++)
+	{
+		while (pool_free_lists[c] != NULL)
+		{
+			struct pool_block* block = pool_free_lists[c];
+			pool_free_lists[c] = block->next;
+			system_deallocate(block, (size_t)1 << (POOL_MIN_CLASS_LOG + c), NULL);
+		}
+		pool_num_cached[c] = 0;
+	}
+
+	if (thread_arena.depth == 0) {
+		arena_trim(false);
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+//
+
+// statistics
+
+static CT_THREAD_LOCAL struct ct_memory_stats thread_stats;
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Get the memory allocation statistics of the calling thread.
+///
+/// Memory blocks are accounted for in the thread which allocates or frees them, respectively,
+/// such that 'current_bytes' of a thread can become negative when it frees blocks allocated by other threads.
+///
+void ct_get_memory_stats(struct ct_memory_stats* stats)
+{
+	(*stats) = thread_stats;
+	stats->arena_bytes = thread_arena.footprint;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Reset the allocation counters and the peak memory usage of the calling thread.
+///
+void ct_reset_memory_stats(void)
+{
+	thread_stats.num_allocations       = 0;
+	thread_stats.num_deallocations     = 0;
+	thread_stats.num_arena_allocations = 0;
+	thread_stats.peak_bytes = thread_stats.current_bytes;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Record an allocation of 'size' bytes in the statistics of the calling thread.
+///
+static inline void record_allocation(const size_t size)
+{
+	thread_stats.num_allocations++;
+	thread_stats.current_bytes += (int64_t)size;
+	if (thread_stats.peak_bytes < thread_stats.current_bytes) {
+		thread_stats.peak_bytes = thread_stats.current_bytes;
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Allocate 'size' bytes of uninitialized storage, and return a pointer to the allocated memory block.
+///
+/// The memory block is aligned to 'CT_MEM_DATA_ALIGN'. Within a region opened by 'ct_memory_mark',
+/// the storage is taken from the thread-local arena, and otherwise from the allocator set by 'ct_set_allocator'.
+/// Only arena allocations and memory blocks provided by allocators other than the system allocator are preceded by a header.
+///
+void* ct_malloc(size_t size)
+{
+	void* memblock;
+	if (thread_arena.depth > 0)
+	{
+		const size_t total = arena_allocation_size(size);
+		char* p = arena_allocate(total);
+		if (p == NULL) {
+			return NULL;
+		}
+		memblock = p + MEMORY_HEADER_SIZE;
+		struct memory_header* header = get_memory_header(memblock);
+		header->size      = size;
+		header->allocator = NULL;
+		header->arena     = &thread_arena;
+		thread_arena.num_live++;
+		thread_stats.num_arena_allocations++;
+		record_allocation(size);
+	}
+	else if (current_allocator == &ct_system_allocator)
+	{
+		memblock = system_allocate(size, NULL);
+		if (memblock == NULL) {
+			return NULL;
+		}
+		assert(!has_memory_header(memblock));
+		record_allocation(system_block_size(memblock));
+	}
+	else
+	{
+		const struct ct_allocator* allocator = current_allocator;
+		char* p = allocator->allocate(MEMORY_HEADER_SIZE + align_size(size), allocator->context);
+		if (p == NULL) {
+			return NULL;
+		}
+		// allocators must provide memory blocks aligned to 'MEMORY_TAG_ALIGN'
+		assert(((uintptr_t)p & (MEMORY_TAG_ALIGN - 1)) == 0);
+		memblock = p + MEMORY_HEADER_SIZE;
+		struct memory_header* header = get_memory_header(memblock);
+		header->size      = size;
+		header->allocator = allocator;
+		header->arena     = NULL;
+		record_allocation(size);
+	}
+
+	return memblock;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Deallocate a previously allocated memory block.
+///
+/// Memory blocks allocated within an arena region must be freed by the allocating thread.
+///
+void ct_free(void* memblock)
+{
+	if (memblock == NULL) {
+		return;
+	}
+
+	thread_stats.num_deallocations++;
+
+	if (!has_memory_header(memblock))
+	{
+		thread_stats.current_bytes -= (int64_t)system_block_size(memblock);
+		system_deallocate(memblock, 0, NULL);
+		return;
+	}
+
+	struct memory_header* header = get_memory_header(memblock);
+	thread_stats.current_bytes -= (int64_t)header->size;
+
+	if (header->allocator == NULL)
+	{
+		// cross-thread frees of arena memory are not supported
+		assert(header->arena == &thread_arena);
+		thread_arena.num_live--;
+		// remaining arena memory is reclaimed by 'ct_memory_release'
+		arena_deallocate((char*)memblock - MEMORY_HEADER_SIZE, arena_allocation_size(header->size));
+		return;
+	}
+
+	const struct ct_allocator* allocator = header->allocator;
+	allocator->deallocate((char*)memblock - MEMORY_HEADER_SIZE, MEMORY_HEADER_SIZE + align_size(header->size), allocator->context);
+}
@@ -4,40 +4,119 @@
 #pragma once
 
 #include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
 #include <memory.h>
 
 
-/// \brief Memory alignment used in dynamic memory allocation, must be a power of 2.
-#define CT_MEM_DATA_ALIGN 16
+#ifndef CT_MEM_DATA_ALIGN
+/// \brief Memory alignment used in dynamic memory allocation, must be a power of 2 and at least 16;
+/// the default corresponds to a cache line and the width of AVX-512 registers.
+#define CT_MEM_DATA_ALIGN 64
+#endif
+
+_Static_assert(CT_MEM_DATA_ALIGN >= 16 && (CT_MEM_DATA_ALIGN & (CT_MEM_DATA_ALIGN - 1)) == 0, "CT_MEM_DATA_ALIGN must be a power of 2 and at least 16");
+
+
+#ifndef CT_MEM_HUGE_PAGE_THRESHOLD
+/// \brief Default minimum size in bytes of memory blocks for which transparent huge pages are requested, or 0 to disable.
+#define CT_MEM_HUGE_PAGE_THRESHOLD 0
+#endif
 
 
 //________________________________________________________________________________________________________________________
 ///
-/// \brief Allocate 'size' bytes of uninitialized storage, and return a pointer to the allocated memory block.
+/// \brief Whether the memory address 'p' is aligned to 'CT_MEM_DATA_ALIGN'.
 ///
-static inline void* ct_malloc(size_t size)
+static inline bool ct_is_aligned(const void* p)
 {
-	#ifdef _WIN32
-	return _aligned_malloc(size, CT_MEM_DATA_ALIGN);
-	#else
-	// round 'size' up to the next multiple of 'CT_MEM_DATA_ALIGN', which must be a power of 2
-	return aligned_alloc(CT_MEM_DATA_ALIGN, (size + CT_MEM_DATA_ALIGN - 1) & (-CT_MEM_DATA_ALIGN));
-	#endif
+	return ((uintptr_t)p & (CT_MEM_DATA_ALIGN - 1)) == 0;
 }
 
 
+/// \brief Inform the compiler that pointer 'p' is aligned to 'CT_MEM_DATA_ALIGN'.
+/// Not all dense tensors own their data (e.g., blocks in contiguous storage), hence 'ct_is_aligned' must be checked before.
+#if defined(__GNUC__) || defined(__clang__)
+#define ct_assume_aligned(p) __builtin_assume_aligned((p), CT_MEM_DATA_ALIGN)
+#else
+#define ct_assume_aligned(p) (p)
+#endif
+
+
 //________________________________________________________________________________________________________________________
 ///
-/// \brief Deallocate a previously allocated memory block.
+/// \brief Pluggable memory allocator used by 'ct_malloc' and 'ct_free' outside of arena regions.
 ///
-static inline void ct_free(void* memblock)
+/// 'allocate' must return a memory block of 'size' bytes aligned to twice 'CT_MEM_DATA_ALIGN' (or NULL),
+/// and 'deallocate' receives the same 'size' which has been passed to 'allocate'.
+/// Memory blocks provided by custom allocators are preceded by a header of 'CT_MEM_DATA_ALIGN' bytes (or an odd multiple of it).
+///
+struct ct_allocator
 {
-	#ifdef _WIN32
-	_aligned_free(memblock);
-	#else
-	free(memblock);
-	#endif
-}
+	void* (*allocate)(size_t size, void* context);                    //!< allocate a memory block of 'size' bytes
+	void  (*deallocate)(void* memblock, size_t size, void* context);  //!< deallocate a memory block of 'size' bytes
+	void* context;                                                     //!< user-provided context passed to 'allocate' and 'deallocate'
+};
+
+/// \brief Default allocator forwarding to the aligned allocation functions of the C runtime.
+extern const struct ct_allocator ct_system_allocator;
+
+/// \brief Allocator keeping freed small memory blocks in thread-local size-class free lists for re-use.
+extern const struct ct_allocator ct_pool_allocator;
+
+void ct_set_allocator(const struct ct_allocator* allocator);
+
+const struct ct_allocator* ct_get_allocator(void);
+
+void ct_set_huge_page_threshold(size_t threshold);
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Marker of a scoped arena region, returned by 'ct_memory_mark'.
+///
+struct ct_memory_marker
+{
+	void* chunk;    //!< current arena chunk at the time of the mark
+	size_t used;    //!< number of used bytes of the current chunk at the time of the mark
+	long num_live;  //!< number of live arena allocations at the time of the mark
+	int depth;      //!< region nesting depth at the time of the mark
+};
+
+struct ct_memory_marker ct_memory_mark(void);
+
+void ct_memory_release(const struct ct_memory_marker* marker);
+
+void ct_memory_trim(void);
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Memory allocation statistics of the calling thread.
+///
+struct ct_memory_stats
+{
+	long num_allocations;        //!< number of calls of 'ct_malloc' (including those from 'ct_calloc')
+	long num_deallocations;      //!< number of calls of 'ct_free' with a non-NULL argument
+	long num_arena_allocations;  //!< number of allocations served by an arena region
+	int64_t current_bytes;       //!< number of allocated minus freed bytes (as requested by the caller, or the usable size for the system allocator)
+	int64_t peak_bytes;          //!< maximum of 'current_bytes' since the last reset
+	size_t arena_bytes;          //!< memory held by the arena chunks in bytes
+};
+
+void ct_get_memory_stats(struct ct_memory_stats* stats);
+
+void ct_reset_memory_stats(void);
+
+
+//________________________________________________________________________________________________________________________
+//
+
+// allocation and deallocation
+
+void* ct_malloc(size_t size);
+
+void ct_free(void* memblock);
 
 
 //________________________________________________________________________________________________________________________
@@ -197,6 +197,26 @@ void delete_mpo(struct mpo* mpo)
 }
 
 
+//________________________________________________________________________________________________________________________
+///
+/// \brief Copy a matrix product operator and convert its tensor entries to numeric type 'dtype', allocating memory for the copy.
+///
+void convert_mpo(const enum numeric_type dtype, const struct mpo* restrict src, struct mpo* restrict dst)
+{
+	dst->nsites = src->nsites;
+	dst->d = src->d;
+
+	dst->qsite = ct_malloc(src->d * sizeof(qnumber));
+	memcpy(dst->qsite, src->qsite, src->d * sizeof(qnumber));
+
+	dst->a = ct_calloc(src->nsites, sizeof(struct block_sparse_tensor));
+	for (int i = 0; i < src->nsites; i++)
+	{
+		convert_block_sparse_tensor(dtype, &src->a[i], &dst->a[i]);
+	}
+}
+
+
 //________________________________________________________________________________________________________________________
 ///
 /// \brief Internal consistency check of the MPO data structure.
@@ -51,6 +51,8 @@ void mpo_from_assembly(const struct mpo_assembly* assembly, struct mpo* mpo);
 
 void delete_mpo(struct mpo* mpo);
 
+void convert_mpo(const enum numeric_type dtype, const struct mpo* restrict src, struct mpo* restrict dst);
+
 bool mpo_is_consistent(const struct mpo* mpo);
 
 
@@ -65,6 +65,36 @@ void delete_mps(struct mps* mps)
 }
 
 
+//________________________________________________________________________________________________________________________
+///
+/// \brief Copy a matrix product state, allocating memory for the copy.
+///
+void copy_mps(const struct mps* restrict src, struct mps* restrict dst)
+{
+	allocate_empty_mps(src->nsites, src->d, src->qsite, dst);
+
+	for (int i = 0; i < src->nsites; i++)
+	{
+		copy_block_sparse_tensor(&src->a[i], &dst->a[i]);
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Copy a matrix product state and convert its tensor entries to numeric type 'dtype', allocating memory for the copy.
+///
+void convert_mps(const enum numeric_type dtype, const struct mps* restrict src, struct mps* restrict dst)
+{
+	allocate_empty_mps(src->nsites, src->d, src->qsite, dst);
+
+	for (int i = 0; i < src->nsites; i++)
+	{
+		convert_block_sparse_tensor(dtype, &src->a[i], &dst->a[i]);
+	}
+}
+
+
 //________________________________________________________________________________________________________________________
 ///
 /// \brief Construct a matrix product state with random normal tensor entries, given an overall quantum number sector and maximum virtual bond dimension.
@@ -235,23 +265,26 @@ static void mps_contraction_step_right(const struct block_sparse_tensor* restric
 	struct block_sparse_tensor s;
 	block_sparse_tensor_dot(a, TENSOR_AXIS_RANGE_TRAILING, r, TENSOR_AXIS_RANGE_LEADING, 1, &s);
 
-	// multiply with conjugated 'b' tensor
-	struct block_sparse_tensor bc;
-	copy_block_sparse_tensor(b, &bc);  // TODO: fuse conjugation with dot product
-	conjugate_block_sparse_tensor(&bc);
-	block_sparse_tensor_reverse_axis_directions(&bc);
-	// temporarily make trailing dimension in 's' the leading dimension
-	const int perm0[4] = { 3, 0, 1, 2 };
+	// multiply with conjugated 'b' tensor, contracting the axes [a1, r1] with [b1, b2]: [a0, r2, b0]
+	struct block_sparse_tensor_lazy_view sv;
+	create_block_sparse_tensor_lazy_view(&s, &sv);
+	struct block_sparse_tensor_lazy_view bv;
+	create_block_sparse_tensor_lazy_view(b, &bv);
+	block_sparse_tensor_lazy_view_conjugate(&bv);
+	const int axes_sv[2] = { 1, 2 };
+	const int axes_bv[2] = { 1, 2 };
 	struct block_sparse_tensor t;
-	transpose_block_sparse_tensor(perm0, &s, &t);
+	struct block_sparse_tensor_lazy_view tv;
+	block_sparse_tensor_lazy_view_contract(&sv, axes_sv, &bv, axes_bv, 2, &t, &tv);
+	delete_block_sparse_tensor_lazy_view(&bv);
+	delete_block_sparse_tensor_lazy_view(&sv);
 	delete_block_sparse_tensor(&s);
-	block_sparse_tensor_dot(&t, TENSOR_AXIS_RANGE_TRAILING, &bc, TENSOR_AXIS_RANGE_TRAILING, 2, &s);
+	// re-order dimensions: [a0, b0, r2]
+	const int perm[3] = { 0, 2, 1 };
+	block_sparse_tensor_lazy_view_transpose(perm, &tv);
+	block_sparse_tensor_lazy_view_materialize(&tv, r_next);
+	delete_block_sparse_tensor_lazy_view(&tv);
 	delete_block_sparse_tensor(&t);
-	delete_block_sparse_tensor(&bc);
-	// restore original trailing dimension
-	const int perm1[3] = { 1, 2, 0 };
-	transpose_block_sparse_tensor(perm1, &s, r_next);
-	delete_block_sparse_tensor(&s);
 }
 
 
@@ -283,7 +316,7 @@ void mps_vdot(const struct mps* chi, const struct mps* psi, void* ret)
 			chi->a[chi->nsites - 1].qnums_logical[2], };
 		struct block_sparse_tensor t;
 		allocate_block_sparse_tensor(dtype, 4, dim, axis_dir, qnums, &t);
-		assert(t.blocks[0] != NULL);
+		assert(t.nblocks == 1);
 		memcpy(t.blocks[0]->data, numeric_one(dtype), sizeof_numeric_type(dtype));
 		flatten_block_sparse_tensor_axes(&t, 2, TENSOR_AXIS_IN, &r);
 		delete_block_sparse_tensor(&t);
@@ -308,7 +341,7 @@ void mps_vdot(const struct mps* chi, const struct mps* psi, void* ret)
 	// 'r' should now be a 1 x 1 tensor
 	assert(r.ndim == 2);
 	assert(r.dim_logical[0] == 1 && r.dim_logical[1] == 1);
-	assert(r.blocks[0] != NULL);
+	assert(r.nblocks == 1);
 	memcpy(ret, r.blocks[0]->data, sizeof_numeric_type(dtype));
 	delete_block_sparse_tensor(&r);
 }
@@ -408,15 +441,13 @@ void mps_add(const struct mps* chi, const struct mps* psi, struct mps* ret)
 		copy_block_sparse_tensor(&chi->a[0], &ret->a[0]);
 
 		// add individual dense tensors
-		const long nblocks = integer_product(ret->a[0].dim_blocks, ret->a[0].ndim);
-		for (long k = 0; k < nblocks; k++)
+		assert(psi->a[0].nblocks == ret->a[0].nblocks);
+		for (long k = 0; k < ret->a[0].nblocks; k++)
 		{
 			struct dense_tensor* a = psi->a[0].blocks[k];
 			struct dense_tensor* b = ret->a[0].blocks[k];
-			if (a != NULL) {
-				assert(b != NULL);
-				dense_tensor_scalar_multiply_add(numeric_one(a->dtype), a, b);
-			}
+			assert(a != NULL && b != NULL);
+			dense_tensor_scalar_multiply_add(numeric_one(a->dtype), a, b);
 		}
 	}
 	else  // nsites > 1
@@ -578,7 +609,7 @@ double mps_orthonormalize_qr(struct mps* mps, const enum mps_orthonormalization_
 		allocate_block_sparse_tensor(mps->a[i].dtype, 3, dim_tail, axis_dir_tail, qnums_tail, &a_tail);
 		assert(a_tail.dim_blocks[0] == 1 && a_tail.dim_blocks[1] == 1 && a_tail.dim_blocks[2] == 1);
 		// set single entry to 1
-		assert(a_tail.blocks[0] != NULL);
+		assert(a_tail.nblocks == 1);
 		memcpy(a_tail.blocks[0]->data, numeric_one(a_tail.blocks[0]->dtype), sizeof_numeric_type(a_tail.blocks[0]->dtype));
 
 		// orthonormalize last MPS tensor
@@ -587,7 +618,7 @@ double mps_orthonormalize_qr(struct mps* mps, const enum mps_orthonormalization_
 		// retrieve normalization factor (real-valued since diagonal of 'r' matrix is real)
 		double norm = 0;
 		// 'a_tail' can be logically zero in case quantum numbers do not match
-		if (a_tail.blocks[0] != NULL)
+		if (a_tail.nblocks > 0)
 		{
 			switch (a_tail.blocks[0]->dtype)
 			{
@@ -651,7 +682,7 @@ double mps_orthonormalize_qr(struct mps* mps, const enum mps_orthonormalization_
 		allocate_block_sparse_tensor(mps->a[0].dtype, 3, dim_head, axis_dir_head, qnums_head, &a_head);
 		assert(a_head.dim_blocks[0] == 1 && a_head.dim_blocks[1] == 1 && a_head.dim_blocks[2] == 1);
 		// set single entry to 1
-		assert(a_head.blocks[0] != NULL);
+		assert(a_head.nblocks == 1);
 		memcpy(a_head.blocks[0]->data, numeric_one(a_head.blocks[0]->dtype), sizeof_numeric_type(a_head.blocks[0]->dtype));
 
 		// orthonormalize first MPS tensor
@@ -660,7 +691,7 @@ double mps_orthonormalize_qr(struct mps* mps, const enum mps_orthonormalization_
 		// retrieve normalization factor (real-valued since diagonal of 'r' matrix is real)
 		double norm = 0;
 		// 'a_head' can be logically zero in case quantum numbers do not match
-		if (a_head.blocks[0] != NULL)
+		if (a_head.nblocks > 0)
 		{
 			switch (a_head.blocks[0]->dtype)
 			{
@@ -843,7 +874,7 @@ int mps_compress(const double tol, const long max_vdim, const enum mps_orthonorm
 		allocate_block_sparse_tensor(mps->a[i].dtype, 3, dim_tail, axis_dir_tail, qnums_tail, &a_tail);
 		assert(a_tail.dim_blocks[0] == 1 && a_tail.dim_blocks[1] == 1 && a_tail.dim_blocks[2] == 1);
 		// set single entry to 1
-		assert(a_tail.blocks[0] != NULL);
+		assert(a_tail.nblocks == 1);
 		memcpy(a_tail.blocks[0]->data, numeric_one(a_tail.blocks[0]->dtype), sizeof_numeric_type(a_tail.blocks[0]->dtype));
 
 		// orthonormalize last MPS tensor
@@ -854,7 +885,7 @@ int mps_compress(const double tol, const long max_vdim, const enum mps_orthonorm
 		assert(a_tail.dtype == mps->a[i].dtype);
 		assert(a_tail.dim_logical[0] == 1 && a_tail.dim_logical[1] == 1 && a_tail.dim_logical[2] == 1);
 		// quantum numbers for 'a_tail' should match due to preceeding QR orthonormalization
-		assert(a_tail.blocks[0] != NULL);
+		assert(a_tail.nblocks == 1);
 		switch (a_tail.blocks[0]->dtype)
 		{
 			case CT_SINGLE_REAL:
@@ -937,7 +968,7 @@ int mps_compress(const double tol, const long max_vdim, const enum mps_orthonorm
 		allocate_block_sparse_tensor(mps->a[0].dtype, 3, dim_head, axis_dir_head, qnums_head, &a_head);
 		assert(a_head.dim_blocks[0] == 1 && a_head.dim_blocks[1] == 1 && a_head.dim_blocks[2] == 1);
 		// set single entry to 1
-		assert(a_head.blocks[0] != NULL);
+		assert(a_head.nblocks == 1);
 		memcpy(a_head.blocks[0]->data, numeric_one(a_head.blocks[0]->dtype), sizeof_numeric_type(a_head.blocks[0]->dtype));
 
 		// orthonormalize first MPS tensor
@@ -948,7 +979,7 @@ int mps_compress(const double tol, const long max_vdim, const enum mps_orthonorm
 		assert(a_head.dtype == mps->a[0].dtype);
 		assert(a_head.dim_logical[0] == 1 && a_head.dim_logical[1] == 1 && a_head.dim_logical[2] == 1);
 		// quantum numbers for 'a_head' should match due to preceeding QR orthonormalization
-		assert(a_head.blocks[0] != NULL);
+		assert(a_head.nblocks == 1);
 		switch (a_head.blocks[0]->dtype)
 		{
 			case CT_SINGLE_REAL:
@@ -1011,12 +1042,12 @@ int mps_compress(const double tol, const long max_vdim, const enum mps_orthonorm
 
 //________________________________________________________________________________________________________________________
 ///
-/// \brief Split a MPS tensor with dimension `D0 x d0*d1 x D2` into two MPS tensors
-/// with dimensions `D0 x d0 x D1` and `D1 x d1 x D2`, respectively, using SVD.
+/// \brief Split a MPS tensor with dimension `D0 x d0*d1 x D2` into the left isometry 'u' with dimension `D0 x d0 x D1`,
+/// the retained singular values 's' and the right isometry 'vh' with dimension `D1 x d1 x D2`, using SVD.
 ///
-int mps_split_tensor_svd(const struct block_sparse_tensor* restrict a, const long d[2], const qnumber* new_qsite[2],
-	const double tol, const long max_vdim, const bool renormalize, const enum singular_value_distr svd_distr,
-	struct block_sparse_tensor* restrict a0, struct block_sparse_tensor* restrict a1, struct trunc_info* info)
+int mps_split_tensor_svd_isometries(const struct block_sparse_tensor* restrict a, const long d[2], const qnumber* new_qsite[2],
+	const double tol, const long max_vdim, const bool renormalize,
+	struct block_sparse_tensor* restrict u, struct dense_tensor* restrict s, struct block_sparse_tensor* restrict vh, struct trunc_info* info)
 {
 	assert(a->ndim == 3);
 	// physical dimension of MPS tensor must be equal to product of new dimensions
@@ -1037,7 +1068,7 @@ int mps_split_tensor_svd(const struct block_sparse_tensor* restrict a, const lon
 
 	// split by truncated SVD
 	struct block_sparse_tensor m0, m1;
-	int ret = split_block_sparse_matrix_svd(&a_mat, tol, max_vdim, renormalize, svd_distr, &m0, &m1, info);
+	int ret = split_block_sparse_matrix_svd_isometries(&a_mat, tol, max_vdim, renormalize, &m0, s, &m1, info);
 	delete_block_sparse_tensor(&a_mat);
 	if (ret < 0) {
 		return ret;
@@ -1045,8 +1076,8 @@ int mps_split_tensor_svd(const struct block_sparse_tensor* restrict a, const lon
 
 	// restore original virtual bonds and physical axes
 	assert(a_twosite.ndim == 4);
-	split_block_sparse_tensor_axis(&m0, 0, a_twosite.dim_logical,     a_twosite.axis_dir,     (const qnumber**) a_twosite.qnums_logical,      a0);
-	split_block_sparse_tensor_axis(&m1, 1, a_twosite.dim_logical + 2, a_twosite.axis_dir + 2, (const qnumber**)(a_twosite.qnums_logical + 2), a1);
+	split_block_sparse_tensor_axis(&m0, 0, a_twosite.dim_logical,     a_twosite.axis_dir,     (const qnumber**) a_twosite.qnums_logical,      u);
+	split_block_sparse_tensor_axis(&m1, 1, a_twosite.dim_logical + 2, a_twosite.axis_dir + 2, (const qnumber**)(a_twosite.qnums_logical + 2), vh);
 
 	delete_block_sparse_tensor(&m1);
 	delete_block_sparse_tensor(&m0);
@@ -1057,6 +1088,43 @@ int mps_split_tensor_svd(const struct block_sparse_tensor* restrict a, const lon
 }
 
 
+//________________________________________________________________________________________________________________________
+///
+/// \brief Split a MPS tensor with dimension `D0 x d0*d1 x D2` into two MPS tensors
+/// with dimensions `D0 x d0 x D1` and `D1 x d1 x D2`, respectively, using SVD.
+///
+int mps_split_tensor_svd(const struct block_sparse_tensor* restrict a, const long d[2], const qnumber* new_qsite[2],
+	const double tol, const long max_vdim, const bool renormalize, const enum singular_value_distr svd_distr,
+	struct block_sparse_tensor* restrict a0, struct block_sparse_tensor* restrict a1, struct trunc_info* info)
+{
+	struct dense_tensor s;
+	int ret = mps_split_tensor_svd_isometries(a, d, new_qsite, tol, max_vdim, renormalize, a0, &s, a1, info);
+	if (ret < 0) {
+		return ret;
+	}
+
+	// multiply retained singular values with left or right isometry
+	if (svd_distr == SVD_DISTR_LEFT)
+	{
+		struct block_sparse_tensor tmp;
+		block_sparse_tensor_multiply_pointwise_vector(a0, &s, TENSOR_AXIS_RANGE_TRAILING, &tmp);
+		delete_block_sparse_tensor(a0);
+		move_block_sparse_tensor_data(&tmp, a0);
+	}
+	else
+	{
+		struct block_sparse_tensor tmp;
+		block_sparse_tensor_multiply_pointwise_vector(a1, &s, TENSOR_AXIS_RANGE_LEADING, &tmp);
+		delete_block_sparse_tensor(a1);
+		move_block_sparse_tensor_data(&tmp, a1);
+	}
+
+	delete_dense_tensor(&s);
+
+	return 0;
+}
+
+
 //________________________________________________________________________________________________________________________
 ///
 /// \brief Merge two neighboring MPS tensors.
@@ -31,6 +31,10 @@ void allocate_mps(const enum numeric_type dtype, const int nsites, const long d,
 
 void delete_mps(struct mps* mps);
 
+void copy_mps(const struct mps* restrict src, struct mps* restrict dst);
+
+void convert_mps(const enum numeric_type dtype, const struct mps* restrict src, struct mps* restrict dst);
+
 void construct_random_mps(const enum numeric_type dtype, const int nsites, const long d, const qnumber* qsite, const qnumber qnum_sector, const long max_vdim, struct rng_state* rng_state, struct mps* mps);
 
 bool mps_is_consistent(const struct mps* mps);
@@ -98,6 +102,10 @@ int mps_compress(const double tol, const long max_vdim, const enum mps_orthonorm
 
 // splitting and merging
 
+int mps_split_tensor_svd_isometries(const struct block_sparse_tensor* restrict a, const long d[2], const qnumber* new_qsite[2],
+	const double tol, const long max_vdim, const bool renormalize,
+	struct block_sparse_tensor* restrict u, struct dense_tensor* restrict s, struct block_sparse_tensor* restrict vh, struct trunc_info* info);
+
 int mps_split_tensor_svd(const struct block_sparse_tensor* restrict a, const long d[2], const qnumber* new_qsite[2],
 	const double tol, const long max_vdim, const bool renormalize, const enum singular_value_distr svd_distr,
 	struct block_sparse_tensor* restrict a0, struct block_sparse_tensor* restrict a1, struct trunc_info* info);
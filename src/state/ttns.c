@@ -466,18 +466,18 @@ void ttns_vdot(const struct ttns* chi, const struct ttns* psi, void* ret)
 			move_block_sparse_tensor_data(&tmp, &psi_a_bonds);
 		}
 
-		struct block_sparse_tensor chi_a_conj;
-		copy_block_sparse_tensor(&chi->a[i_site], &chi_a_conj);
-		conjugate_block_sparse_tensor(&chi_a_conj);
-		block_sparse_tensor_reverse_axis_directions(&chi_a_conj);
+		// local tensor of 'chi', complex conjugated within the contraction below;
+		// a (transposed or reshaped) copy is only created if required
+		const struct block_sparse_tensor* chi_a = &chi->a[i_site];
+		struct block_sparse_tensor chi_a_copy;
 
 		if (l == 0)  // root node
 		{
 			// contract all axes
 			struct block_sparse_tensor r;
-			block_sparse_tensor_dot(&chi_a_conj, TENSOR_AXIS_RANGE_LEADING, &psi_a_bonds, TENSOR_AXIS_RANGE_LEADING, psi_a_bonds.ndim, &r);
+			block_sparse_tensor_dot_conj(chi_a, TENSOR_AXIS_RANGE_LEADING, true, &psi_a_bonds, TENSOR_AXIS_RANGE_LEADING, false, psi_a_bonds.ndim, &r);
 			assert(r.ndim == 0);
-			assert(r.blocks[0] != NULL);
+			assert(r.nblocks == 1);
 
 			// copy scalar entry
 			memcpy(ret, r.blocks[0]->data, sizeof_numeric_type(r.dtype));
@@ -498,7 +498,7 @@ void ttns_vdot(const struct ttns* chi, const struct ttns* psi, void* ret)
 			}
 			assert(i_ax_p != -1);
 
-			assert(psi_a_bonds.ndim == chi_a_conj.ndim);
+			assert(psi_a_bonds.ndim == chi_a->ndim);
 			assert(psi_a_bonds.ndim == psi->topology.num_neighbors[i_site] + offset_phys_aux);
 
 			if (i_ax_p != 0)
@@ -517,9 +517,8 @@ void ttns_vdot(const struct ttns* chi, const struct ttns* psi, void* ret)
 				delete_block_sparse_tensor(&psi_a_bonds);
 				move_block_sparse_tensor_data(&tmp, &psi_a_bonds);
 
-				transpose_block_sparse_tensor(perm, &chi_a_conj, &tmp);
-				delete_block_sparse_tensor(&chi_a_conj);
-				move_block_sparse_tensor_data(&tmp, &chi_a_conj);
+				transpose_block_sparse_tensor(perm, chi_a, &chi_a_copy);
+				chi_a = &chi_a_copy;
 
 				ct_free(perm);
 			}
@@ -541,14 +540,18 @@ void ttns_vdot(const struct ttns* chi, const struct ttns* psi, void* ret)
 				}
 
 				{
+					// dummy axis is reversed by the conjugation in the contraction
 					const qnumber q_zero[1] = { 0 };
-					const long new_dim_logical[2]                    = { chi_a_conj.dim_logical[0],   1              };
-					const enum tensor_axis_direction new_axis_dir[2] = { chi_a_conj.axis_dir[0],      TENSOR_AXIS_IN };
-					const qnumber* new_qnums_logical[2]              = { chi_a_conj.qnums_logical[0], q_zero         };
+					const long new_dim_logical[2]                    = { chi_a->dim_logical[0],   1               };
+					const enum tensor_axis_direction new_axis_dir[2] = { chi_a->axis_dir[0],      TENSOR_AXIS_OUT };
+					const qnumber* new_qnums_logical[2]              = { chi_a->qnums_logical[0], q_zero          };
 					struct block_sparse_tensor tmp;
-					split_block_sparse_tensor_axis(&chi_a_conj, 0, new_dim_logical, new_axis_dir, new_qnums_logical, &tmp);
-					delete_block_sparse_tensor(&chi_a_conj);
-					move_block_sparse_tensor_data(&tmp, &chi_a_conj);
+					split_block_sparse_tensor_axis(chi_a, 0, new_dim_logical, new_axis_dir, new_qnums_logical, &tmp);
+					if (chi_a == &chi_a_copy) {
+						delete_block_sparse_tensor(&chi_a_copy);
+					}
+					move_block_sparse_tensor_data(&tmp, &chi_a_copy);
+					chi_a = &chi_a_copy;
 				}
 			}
 			assert(psi_a_bonds.ndim > 1);
@@ -558,10 +561,12 @@ void ttns_vdot(const struct ttns* chi, const struct ttns* psi, void* ret)
 
 			// contract all other axes
 			r_bonds[ib] = ct_malloc(sizeof(struct block_sparse_tensor));
-			block_sparse_tensor_dot(&psi_a_bonds, TENSOR_AXIS_RANGE_TRAILING, &chi_a_conj, TENSOR_AXIS_RANGE_TRAILING, psi_a_bonds.ndim - 1, r_bonds[ib]);
+			block_sparse_tensor_dot_conj(&psi_a_bonds, TENSOR_AXIS_RANGE_TRAILING, false, chi_a, TENSOR_AXIS_RANGE_TRAILING, true, psi_a_bonds.ndim - 1, r_bonds[ib]);
 		}
 
-		delete_block_sparse_tensor(&chi_a_conj);
+		if (chi_a == &chi_a_copy) {
+			delete_block_sparse_tensor(&chi_a_copy);
+		}
 		delete_block_sparse_tensor(&psi_a_bonds);
 	}
 
@@ -5,32 +5,381 @@
 #include <math.h>
 #include <inttypes.h>
 #include <cblas.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include "block_sparse_tensor.h"
+#include "small_gemm.h"
 #include "aligned_memory.h"
 
 
 //________________________________________________________________________________________________________________________
 ///
-/// \brief Temporary data structure for enumerating quantum numbers and their multiplicities.
+/// \brief Comparison function for sorting quantum numbers.
 ///
-struct qnumber_count
+static int compare_qnumbers(const void* a, const void* b)
 {
-	qnumber qnum;
-	int count;
+	const qnumber x = *((const qnumber*)a);
+	const qnumber y = *((const qnumber*)b);
+	return (x > y) - (x < y);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Find quantum number 'qnum' in the list 'qnums' of 'n' distinct quantum numbers sorted in ascending order.
+///
+/// Returns the index of 'qnum' in the list, or -1 if it is not contained.
+///
+static inline long find_qnumber_sorted(const qnumber* qnums, const long n, const qnumber qnum)
+{
+	long lo = 0;
+	long hi = n;
+	while (lo < hi)
+	{
+		const long mid = lo + (hi - lo) / 2;
+		if (qnums[mid] < qnum) {
+			lo = mid + 1;
+		}
+		else {
+			hi = mid;
+		}
+	}
+	if (lo < n && qnums[lo] == qnum) {
+		return lo;
+	}
+	return -1;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Determine the distinct quantum numbers in 'qnums' (sorted in ascending order) and their multiplicities, by sorting a copy of 'qnums'.
+///
+/// 'qnums_unique' and 'counts' must provide space for 'n' entries. Returns the number of distinct quantum numbers.
+///
+static long count_sorted_qnumbers(const qnumber* qnums, const long n, qnumber* restrict qnums_unique, long* restrict counts)
+{
+	qnumber* qnums_sorted = ct_malloc(n * sizeof(qnumber));
+	memcpy(qnums_sorted, qnums, n * sizeof(qnumber));
+	qsort(qnums_sorted, n, sizeof(qnumber), compare_qnumbers);
+
+	long nqc = 0;
+	for (long j = 0; j < n; j++)
+	{
+		if (nqc > 0 && qnums_unique[nqc - 1] == qnums_sorted[j]) {
+			counts[nqc - 1]++;
+		}
+		else {
+			qnums_unique[nqc] = qnums_sorted[j];
+			counts[nqc] = 1;
+			nqc++;
+		}
+	}
+
+	ct_free(qnums_sorted);
+
+	return nqc;
+}
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Current parallelization strategy for block-sparse tensor operations.
+///
+static enum block_sparse_parallel_mode block_sparse_parallel_mode = BLOCK_SPARSE_PARALLEL_BLAS;
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Set the parallelization strategy for block-sparse tensor operations.
+///
+/// When choosing 'BLOCK_SPARSE_PARALLEL_BLOCKS', the BLAS library should run single-threaded to avoid oversubscription.
+/// For OpenBLAS (detected at build time), this is ensured automatically while the blocks are processed in parallel.
+/// Other BLAS libraries have to be configured by the user (e.g., by setting the environment variable MKL_NUM_THREADS=1).
+/// The number of threads for processing blocks is controlled by OpenMP (e.g., via OMP_NUM_THREADS).
+/// Without OpenMP support, blocks are always processed sequentially.
+///
+void set_block_sparse_parallel_mode(const enum block_sparse_parallel_mode mode)
+{
+	block_sparse_parallel_mode = mode;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Get the current parallelization strategy for block-sparse tensor operations.
+///
+enum block_sparse_parallel_mode get_block_sparse_parallel_mode()
+{
+	return block_sparse_parallel_mode;
+}
+
+
+#ifdef CHEMTENSOR_OPENBLAS_NUM_THREADS
+// declared here since the included 'cblas.h' is not necessarily the one shipped with OpenBLAS
+void openblas_set_num_threads(int num_threads);
+int openblas_get_num_threads(void);
+#endif
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Switch the BLAS library to a single thread before processing blocks in parallel.
+///
+/// Returns the previous number of BLAS threads, to be passed to 'block_parallel_blas_threads_restore',
+/// or zero if the number of threads has not been changed. The setting is global, so it is only modified
+/// outside of an enclosing parallel region.
+///
+static int block_parallel_blas_threads_single()
+{
+	#if defined(CHEMTENSOR_OPENBLAS_NUM_THREADS) && defined(_OPENMP)
+	if (!omp_in_parallel())
+	{
+		const int nthreads = openblas_get_num_threads();
+		if (nthreads > 1)
+		{
+			openblas_set_num_threads(1);
+			return nthreads;
+		}
+	}
+	#endif
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Restore the number of BLAS threads after processing blocks in parallel.
+///
+static void block_parallel_blas_threads_restore(const int nthreads)
+{
+	#ifdef CHEMTENSOR_OPENBLAS_NUM_THREADS
+	if (nthreads > 0) {
+		openblas_set_num_threads(nthreads);
+	}
+	#else
+	(void)nthreads;
+	#endif
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Current threshold for batching small dense block multiplications in block-sparse contraction plans.
+///
+static long block_sparse_gemm_batch_threshold = 512;
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Set the threshold (in terms of multiply-add operations 'm * n * k') up to which dense block multiplications
+/// are grouped by shape and executed by an internal small-matrix kernel instead of individual BLAS calls.
+///
+/// A threshold of 0 disables batching. The threshold is applied when creating a contraction plan.
+///
+void set_block_sparse_gemm_batch_threshold(const long threshold)
+{
+	assert(threshold >= 0);
+	block_sparse_gemm_batch_threshold = threshold;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Get the current threshold for batching small dense block multiplications.
+///
+long get_block_sparse_gemm_batch_threshold()
+{
+	return block_sparse_gemm_batch_threshold;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Temporary data structure for ordering blocks by computational cost.
+///
+struct block_cost
+{
+	long cost;   //!< computational cost (number of multiply-add operations)
+	long index;  //!< block index
+};
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Comparison function for sorting by decreasing cost.
+///
+static int compare_block_cost(const void* a, const void* b)
+{
+	const struct block_cost* x = (const struct block_cost*)a;
+	const struct block_cost* y = (const struct block_cost*)b;
+
+	if (x->cost > y->cost) {
+		return -1;
+	}
+	if (x->cost < y->cost) {
+		return 1;
+	}
+	// ensure deterministic ordering
+	if (x->index < y->index) {
+		return -1;
+	}
+	if (x->index > y->index) {
+		return 1;
+	}
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Temporary data structure for enumerating the blocks with conserved quantum numbers.
+///
+struct conserved_blocks_enumerator
+{
+	const long* dim_blocks;                       //!< block dimensions
+	const enum tensor_axis_direction* axis_dir;   //!< tensor axis directions
+	const qnumber** qnums_blocks;                 //!< block quantum numbers along each axis, sorted in ascending order
+	qnumber* qsum_min;                            //!< minimum of the signed quantum number sum over the trailing axes, starting from each axis
+	qnumber* qsum_max;                            //!< maximum of the signed quantum number sum over the trailing axes, starting from each axis
+	long* grid_offsets;                           //!< output grid offsets (can be NULL)
+	long nblocks;                                 //!< number of blocks found so far
+	int ndim;                                     //!< number of dimensions (degree)
 };
 
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Recursively enumerate the conserved blocks, given the signed quantum number sum 'qsum' and
+/// the grid offset 'offset' of the leading axes before axis 'i'.
+///
+/// Subtrees for which the remaining axes cannot compensate 'qsum' are skipped,
+/// and the quantum number of the last axis is solved for directly instead of probed.
+///
+static void enumerate_conserved_blocks_axis(struct conserved_blocks_enumerator* e, const int i, const qnumber qsum, const long offset)
+{
+	if (qsum + e->qsum_min[i] > 0 || qsum + e->qsum_max[i] < 0) {
+		return;
+	}
+
+	if (i == e->ndim - 1)
+	{
+		// axis directions are +1 or -1
+		const long j = find_qnumber_sorted(e->qnums_blocks[i], e->dim_blocks[i], -e->axis_dir[i] * qsum);
+		if (j >= 0)
+		{
+			if (e->grid_offsets != NULL) {
+				e->grid_offsets[e->nblocks] = offset * e->dim_blocks[i] + j;
+			}
+			e->nblocks++;
+		}
+		return;
+	}
+
+	for (long j = 0; j < e->dim_blocks[i]; j++)
+	{
+		enumerate_conserved_blocks_axis(e, i + 1, qsum + e->axis_dir[i] * e->qnums_blocks[i][j], offset * e->dim_blocks[i] + j);
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Enumerate the virtual grid offsets of all blocks with conserved quantum numbers (summing to zero), in ascending order.
+///
+/// The block quantum numbers along each axis must be distinct and sorted in ascending order.
+/// The cost scales with the number of conserved blocks instead of the size of the block grid.
+/// Returns the number of such blocks. The offsets are only stored if 'grid_offsets' is not NULL.
+///
+static long enumerate_conserved_blocks(const int ndim, const long* restrict dim_blocks, const enum tensor_axis_direction* axis_dir, const qnumber** restrict qnums_blocks, long* restrict grid_offsets)
+{
+	if (ndim == 0)
+	{
+		// single block of a scalar tensor
+		if (grid_offsets != NULL) {
+			grid_offsets[0] = 0;
+		}
+		return 1;
+	}
+
+	struct conserved_blocks_enumerator e = {
+		.dim_blocks   = dim_blocks,
+		.axis_dir     = axis_dir,
+		.qnums_blocks = qnums_blocks,
+		.qsum_min     = ct_malloc(ndim * sizeof(qnumber)),
+		.qsum_max     = ct_malloc(ndim * sizeof(qnumber)),
+		.grid_offsets = grid_offsets,
+		.nblocks      = 0,
+		.ndim         = ndim,
+	};
+
+	// range of the signed quantum number sum of the trailing axes
+	qnumber qmin = 0;
+	qnumber qmax = 0;
+	for (int i = ndim - 1; i >= 0; i--)
+	{
+		assert(dim_blocks[i] > 0);
+		const qnumber q0 = axis_dir[i] * qnums_blocks[i][0];
+		const qnumber q1 = axis_dir[i] * qnums_blocks[i][dim_blocks[i] - 1];
+		qmin += (q0 < q1 ? q0 : q1);
+		qmax += (q0 < q1 ? q1 : q0);
+		e.qsum_min[i] = qmin;
+		e.qsum_max[i] = qmax;
+	}
+
+	enumerate_conserved_blocks_axis(&e, 0, 0, 0);
+
+	ct_free(e.qsum_max);
+	ct_free(e.qsum_min);
+
+	return e.nblocks;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Initialize the data type and dimensions of a dense tensor block, without allocating memory for its entries.
+///
+static void allocate_dense_tensor_header(const enum numeric_type dtype, const int ndim, const long* restrict dim, struct dense_tensor* restrict t)
+{
+	t->dtype = dtype;
+	t->ndim  = ndim;
+	if (ndim > 0)
+	{
+		t->dim = ct_malloc(ndim * sizeof(long));
+		memcpy(t->dim, dim, ndim * sizeof(long));
+	}
+	else
+	{
+		t->dim = NULL;
+	}
+	t->data = NULL;
+}
+
+
 //________________________________________________________________________________________________________________________
 ///
-/// \brief Comparison function for sorting.
+/// \brief Let the dense blocks of 't' refer to consecutive segments of 'entries' (in block order), and store 'entries' as contiguous storage of 't'.
 ///
-static int compare_qnumber_count(const void* a, const void* b)
+/// The tensor takes ownership of 'entries', which must have been allocated by 'ct_malloc'.
+///
+void block_sparse_tensor_attach_entries(struct block_sparse_tensor* t, void* entries)
 {
-	const struct qnumber_count* x = (const struct qnumber_count*)a;
-	const struct qnumber_count* y = (const struct qnumber_count*)b;
-	// assuming that quantum numbers are distinct
-	return x->qnum - y->qnum;
+	const size_t dtype_size = sizeof_numeric_type(t->dtype);
+
+	// casting to int8_t* to ensure that pointer arithmetic is performed in terms of bytes
+	int8_t* pentries = (int8_t*)entries;
+
+	t->data = entries;
+	long offset = 0;
+	for (long k = 0; k < t->nblocks; k++)
+	{
+		assert(t->blocks[k]->dtype == t->dtype);
+		t->blocks[k]->data = pentries + offset * dtype_size;
+		offset += dense_tensor_num_elements(t->blocks[k]);
+	}
 }
 
+
 //________________________________________________________________________________________________________________________
 ///
 /// \brief Allocate memory for a block-sparse tensor, including the dense blocks for conserved quantum numbers.
@@ -39,6 +388,9 @@ void allocate_block_sparse_tensor(const enum numeric_type dtype, const int ndim,
 {
 	t->dtype = dtype;
 
+	// each dense block owns its entries
+	t->data = NULL;
+
 	assert(ndim >= 0);
 	t->ndim = ndim;
 
@@ -53,6 +405,8 @@ void allocate_block_sparse_tensor(const enum numeric_type dtype, const int ndim,
 		t->qnums_blocks  = NULL;
 
 		// allocate memory for a single block
+		t->nblocks = 1;
+		t->grid_offsets = ct_calloc(1, sizeof(long));
 		t->blocks = ct_calloc(1, sizeof(struct dense_tensor*));
 		t->blocks[0] = ct_calloc(1, sizeof(struct dense_tensor));
 		allocate_dense_tensor(dtype, ndim, dim, t->blocks[0]);
@@ -78,70 +432,44 @@ void allocate_block_sparse_tensor(const enum numeric_type dtype, const int ndim,
 	t->qnums_blocks = ct_calloc(ndim, sizeof(qnumber*));
 
 	// count quantum numbers along each dimension axis
-	struct qnumber_count** qcounts = ct_malloc(ndim * sizeof(struct qnumber_count*));
+	long** qcounts = ct_malloc(ndim * sizeof(long*));
 	for (int i = 0; i < ndim; i++)
 	{
 		assert(dim[i] > 0);
 
 		// likely not requiring all the allocated memory
-		qcounts[i] = ct_calloc(dim[i], sizeof(struct qnumber_count));
-		long nqc = 0;
-		for (long j = 0; j < dim[i]; j++)
-		{
-			int k;
-			for (k = 0; k < nqc; k++)
-			{
-				if (qcounts[i][k].qnum == qnums[i][j]) {
-					qcounts[i][k].count++;
-					break;
-				}
-			}
-			if (k == nqc)
-			{
-				// add new entry
-				qcounts[i][k].qnum = qnums[i][j];
-				qcounts[i][k].count = 1;
-				nqc++;
-			}
-		}
+		qnumber* qnums_unique = ct_malloc(dim[i] * sizeof(qnumber));
+		qcounts[i] = ct_malloc(dim[i] * sizeof(long));
+		const long nqc = count_sorted_qnumbers(qnums[i], dim[i], qnums_unique, qcounts[i]);
 		assert(nqc <= dim[i]);
 
-		qsort(qcounts[i], nqc, sizeof(struct qnumber_count), compare_qnumber_count);
-
 		t->dim_blocks[i] = nqc;
 
 		// store quantum numbers
-		t->qnums_blocks[i] = ct_calloc(nqc, sizeof(qnumber));
-		for (long j = 0; j < nqc; j++) {
-			t->qnums_blocks[i][j] = qcounts[i][j].qnum;
-		}
+		t->qnums_blocks[i] = ct_malloc(nqc * sizeof(qnumber));
+		memcpy(t->qnums_blocks[i], qnums_unique, nqc * sizeof(qnumber));
+		ct_free(qnums_unique);
 	}
 
+	// enumerate blocks with conserved quantum numbers
+	t->nblocks = enumerate_conserved_blocks(ndim, t->dim_blocks, axis_dir, (const qnumber**)t->qnums_blocks, NULL);
+	t->grid_offsets = ct_malloc(t->nblocks * sizeof(long));
+	enumerate_conserved_blocks(ndim, t->dim_blocks, axis_dir, (const qnumber**)t->qnums_blocks, t->grid_offsets);
+
 	// allocate dense tensor blocks
-	const long nblocks = integer_product(t->dim_blocks, ndim);
-	t->blocks = ct_calloc(nblocks, sizeof(struct dense_tensor*));
-	long* index_block = ct_calloc(ndim, sizeof(long));
-	for (long k = 0; k < nblocks; k++, next_tensor_index(ndim, t->dim_blocks, index_block))
+	t->blocks = ct_calloc(t->nblocks, sizeof(struct dense_tensor*));
+	long* index_block = ct_malloc(ndim * sizeof(long));
+	long* bdim = ct_malloc(ndim * sizeof(long));
+	for (long k = 0; k < t->nblocks; k++)
 	{
-		// probe whether quantum numbers sum to zero
-		qnumber qsum = 0;
-		for (int i = 0; i < ndim; i++)
-		{
-			qsum += axis_dir[i] * t->qnums_blocks[i][index_block[i]];
-		}
-		if (qsum != 0) {
-			continue;
-		}
-
-		// allocate dense tensor block
-		t->blocks[k] = ct_calloc(1, sizeof(struct dense_tensor));
-		long* bdim = ct_malloc(ndim * sizeof(long));
+		block_sparse_tensor_block_index(t, k, index_block);
 		for (int i = 0; i < ndim; i++) {
-			bdim[i] = qcounts[i][index_block[i]].count;
+			bdim[i] = qcounts[i][index_block[i]];
 		}
+		t->blocks[k] = ct_calloc(1, sizeof(struct dense_tensor));
 		allocate_dense_tensor(dtype, ndim, bdim, t->blocks[k]);
-		ct_free(bdim);
 	}
+	ct_free(bdim);
 	ct_free(index_block);
 
 	for (int i = 0; i < ndim; i++)
@@ -168,37 +496,29 @@ void allocate_block_sparse_tensor_like(const struct block_sparse_tensor* restric
 ///
 void delete_block_sparse_tensor(struct block_sparse_tensor* t)
 {
-	if (t->ndim == 0)  // special case
-	{
-		delete_dense_tensor(t->blocks[0]);
-		ct_free(t->blocks[0]);
-		ct_free(t->blocks);
-
-		return;
-	}
-
 	// free dense tensor blocks
-	const long nblocks = integer_product(t->dim_blocks, t->ndim);
-	long* index_block = ct_calloc(t->ndim, sizeof(long));
-	for (long k = 0; k < nblocks; k++, next_tensor_index(t->ndim, t->dim_blocks, index_block))
+	for (long k = 0; k < t->nblocks; k++)
 	{
-		// probe whether quantum numbers sum to zero
-		qnumber qsum = 0;
-		for (int i = 0; i < t->ndim; i++)
-		{
-			qsum += t->axis_dir[i] * t->qnums_blocks[i][index_block[i]];
-		}
-		if (qsum != 0) {
-			continue;
-		}
-
 		assert(t->blocks[k] != NULL);
+		if (t->data != NULL) {
+			// entries are part of the contiguous storage
+			t->blocks[k]->data = NULL;
+		}
 		delete_dense_tensor(t->blocks[k]);
 		ct_free(t->blocks[k]);
 	}
-	ct_free(index_block);
 	ct_free(t->blocks);
 	t->blocks = NULL;
+	ct_free(t->data);
+	t->data = NULL;
+	ct_free(t->grid_offsets);
+	t->grid_offsets = NULL;
+	t->nblocks = 0;
+
+	if (t->ndim == 0) {
+		// special case: no dimension and quantum number arrays
+		return;
+	}
 
 	for (int i = 0; i < t->ndim; i++)
 	{
@@ -219,9 +539,24 @@ void delete_block_sparse_tensor(struct block_sparse_tensor* t)
 ///
 /// \brief Copy a block-sparse tensor, allocating memory for the copy.
 ///
+/// The copy of a tensor with contiguous storage uses contiguous storage as well, and its entries are copied by a single 'memcpy'.
+///
 void copy_block_sparse_tensor(const struct block_sparse_tensor* restrict src, struct block_sparse_tensor* restrict dst)
 {
-	dst->dtype = src->dtype;
+	convert_block_sparse_tensor(src->dtype, src, dst);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Copy a block-sparse tensor and convert its entries to numeric type 'dtype', allocating memory for the copy.
+///
+/// Supports the same conversions as 'convert_dense_tensor'.
+///
+void convert_block_sparse_tensor(const enum numeric_type dtype, const struct block_sparse_tensor* restrict src, struct block_sparse_tensor* restrict dst)
+{
+	dst->dtype = dtype;
+	dst->data  = NULL;
 
 	const int ndim = src->ndim;
 	dst->ndim = ndim;
@@ -237,9 +572,14 @@ void copy_block_sparse_tensor(const struct block_sparse_tensor* restrict src, st
 		dst->qnums_blocks  = NULL;
 
 		// allocate memory for a single block
+		dst->nblocks = 1;
+		dst->grid_offsets = ct_calloc(1, sizeof(long));
 		dst->blocks = ct_calloc(1, sizeof(struct dense_tensor*));
 		dst->blocks[0] = ct_calloc(1, sizeof(struct dense_tensor));
-		copy_dense_tensor(src->blocks[0], dst->blocks[0]);
+		convert_dense_tensor(dtype, src->blocks[0], dst->blocks[0]);
+		if (src->data != NULL) {
+			block_sparse_tensor_make_contiguous(dst);
+		}
 
 		return;
 	}
@@ -268,28 +608,39 @@ void copy_block_sparse_tensor(const struct block_sparse_tensor* restrict src, st
 	}
 
 	// copy dense tensor blocks
-	const long nblocks = integer_product(src->dim_blocks, ndim);
-	dst->blocks = ct_calloc(nblocks, sizeof(struct dense_tensor*));
-	long* index_block = ct_calloc(ndim, sizeof(long));
-	for (long k = 0; k < nblocks; k++, next_tensor_index(ndim, src->dim_blocks, index_block))
+	dst->nblocks = src->nblocks;
+	dst->grid_offsets = ct_malloc(src->nblocks * sizeof(long));
+	memcpy(dst->grid_offsets, src->grid_offsets, src->nblocks * sizeof(long));
+	dst->blocks = ct_calloc(src->nblocks, sizeof(struct dense_tensor*));
+	if (src->data != NULL)
 	{
-		// probe whether quantum numbers sum to zero
-		qnumber qsum = 0;
-		for (int i = 0; i < ndim; i++)
+		// contiguous storage
+		for (long k = 0; k < src->nblocks; k++)
 		{
-			qsum += src->axis_dir[i] * src->qnums_blocks[i][index_block[i]];
+			assert(src->blocks[k] != NULL);
+			dst->blocks[k] = ct_calloc(1, sizeof(struct dense_tensor));
+			allocate_dense_tensor_header(dtype, src->blocks[k]->ndim, src->blocks[k]->dim, dst->blocks[k]);
 		}
-		if (qsum != 0) {
-			continue;
+		const long nelem = block_sparse_tensor_num_elements_blocks(src);
+		block_sparse_tensor_attach_entries(dst, ct_malloc(nelem * sizeof_numeric_type(dtype)));
+		if (dtype == src->dtype) {
+			memcpy(dst->data, src->data, nelem * sizeof_numeric_type(dtype));
 		}
-
+		else {
+			for (long k = 0; k < src->nblocks; k++) {
+				convert_dense_tensor_fill(src->blocks[k], dst->blocks[k]);
+			}
+		}
+		return;
+	}
+	for (long k = 0; k < src->nblocks; k++)
+	{
 		assert(src->blocks[k] != NULL);
 
-		// allocate and copy dense tensor block
+		// allocate, copy and convert dense tensor block
 		dst->blocks[k] = ct_calloc(1, sizeof(struct dense_tensor));
-		copy_dense_tensor(src->blocks[k], dst->blocks[k]);
+		convert_dense_tensor(dtype, src->blocks[k], dst->blocks[k]);
 	}
-	ct_free(index_block);
 }
 
 
@@ -300,6 +651,9 @@ void copy_block_sparse_tensor(const struct block_sparse_tensor* restrict src, st
 void move_block_sparse_tensor_data(struct block_sparse_tensor* restrict src, struct block_sparse_tensor* restrict dst)
 {
 	dst->blocks        = src->blocks;
+	dst->data          = src->data;
+	dst->grid_offsets  = src->grid_offsets;
+	dst->nblocks       = src->nblocks;
 	dst->dim_blocks    = src->dim_blocks;
 	dst->dim_logical   = src->dim_logical;
 	dst->axis_dir      = src->axis_dir;
@@ -309,6 +663,9 @@ void move_block_sparse_tensor_data(struct block_sparse_tensor* restrict src, str
 	dst->ndim          = src->ndim;
 
 	src->blocks        = NULL;
+	src->data          = NULL;
+	src->grid_offsets  = NULL;
+	src->nblocks       = 0;
 	src->dim_blocks    = NULL;
 	src->dim_logical   = NULL;
 	src->axis_dir      = NULL;
@@ -319,56 +676,202 @@ void move_block_sparse_tensor_data(struct block_sparse_tensor* restrict src, str
 
 //________________________________________________________________________________________________________________________
 ///
-/// \brief Retrieve a dense block based on its quantum numbers.
+/// \brief Switch a block-sparse tensor to contiguous storage: all block entries are stored in a single memory buffer,
+/// in the layout of 'block_sparse_tensor_serialize_entries'.
 ///
-struct dense_tensor* block_sparse_tensor_get_block(const struct block_sparse_tensor* t, const qnumber* qnums)
+/// Serializing or deserializing the entries then amounts to a single 'memcpy' (or none if the buffer is accessed directly via 't->data'),
+/// and copying the tensor copies its entries by a single 'memcpy'.
+///
+void block_sparse_tensor_make_contiguous(struct block_sparse_tensor* t)
 {
-	assert(t->ndim > 0);
-
-	// find indices corresponding to quantum numbers
-	long* index = ct_malloc(t->ndim * sizeof(long));
-	for (int i = 0; i < t->ndim; i++)
-	{
-		index[i] = -1;
-		for (long j = 0; j < t->dim_blocks[i]; j++)
-		{
-			if (t->qnums_blocks[i][j] == qnums[i]) {
-				index[i] = j;
-				break;
-			}
-		}
-		if (index[i] == -1) {
-			// quantum number not found
-			ct_free(index);
-			return NULL;
-		}
+	if (t->data != NULL) {
+		// already contiguous
+		return;
 	}
 
-	long o = tensor_index_to_offset(t->ndim, t->dim_blocks, index);
-
-	ct_free(index);
-
-	return t->blocks[o];
+	const size_t dtype_size = sizeof_numeric_type(t->dtype);
+	const long nelem = block_sparse_tensor_num_elements_blocks(t);
+	void* entries = ct_malloc(nelem * dtype_size);
+	block_sparse_tensor_serialize_entries(t, entries);
+	for (long k = 0; k < t->nblocks; k++) {
+		ct_free(t->blocks[k]->data);
+	}
+	block_sparse_tensor_attach_entries(t, entries);
 }
 
 
 //________________________________________________________________________________________________________________________
 ///
-/// \brief Compute the 2-norm (Frobenius norm) of the tensor.
+/// \brief Free the entries of a block-sparse tensor while retaining its structure (quantum numbers and dense block dimensions).
 ///
-/// Result is returned as double also for single-precision tensor entries.
+/// The dense blocks refer to NULL afterwards; entries can be provided again by 'block_sparse_tensor_attach_entries'.
+///
+void block_sparse_tensor_release_entries(struct block_sparse_tensor* t)
+{
+	for (long k = 0; k < t->nblocks; k++)
+	{
+		if (t->data == NULL) {
+			// dense block owns its entries
+			ct_free(t->blocks[k]->data);
+		}
+		t->blocks[k]->data = NULL;
+	}
+	ct_free(t->data);
+	t->data = NULL;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Allocate a block-sparse tensor with the same structure as 's', but with dense blocks not owning any data;
+/// the entries are provided externally by 'block_sparse_tensor_view_entries'.
+///
+/// A view must be deleted by 'delete_block_sparse_tensor_view'.
+///
+void allocate_block_sparse_tensor_view(const struct block_sparse_tensor* restrict s, struct block_sparse_tensor* restrict v)
+{
+	allocate_block_sparse_tensor_like(s, v);
+	for (long k = 0; k < v->nblocks; k++)
+	{
+		ct_free(v->blocks[k]->data);
+		v->blocks[k]->data = NULL;
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Let a block-sparse tensor view refer to the external contiguous 'entries', in the layout of 'block_sparse_tensor_serialize_entries'.
+///
+/// The entries are neither copied nor owned by the view, which allows, e.g., Krylov vectors to be interpreted as tensors without copying.
+///
+void block_sparse_tensor_view_entries(struct block_sparse_tensor* v, void* entries)
+{
+	block_sparse_tensor_attach_entries(v, entries);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Delete a block-sparse tensor view (free memory), without touching the referenced entries.
+///
+void delete_block_sparse_tensor_view(struct block_sparse_tensor* v)
+{
+	for (long k = 0; k < v->nblocks; k++) {
+		v->blocks[k]->data = NULL;
+	}
+	v->data = NULL;
+	delete_block_sparse_tensor(v);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Retrieve a dense block based on its quantum numbers.
+///
+struct dense_tensor* block_sparse_tensor_get_block(const struct block_sparse_tensor* t, const qnumber* qnums)
+{
+	assert(t->ndim > 0);
+
+	// find indices corresponding to quantum numbers, using that the block quantum numbers are sorted
+	long* index = ct_malloc(t->ndim * sizeof(long));
+	for (int i = 0; i < t->ndim; i++)
+	{
+		long lo = 0;
+		long hi = t->dim_blocks[i];
+		while (lo < hi)
+		{
+			const long mid = lo + (hi - lo) / 2;
+			if (t->qnums_blocks[i][mid] < qnums[i]) {
+				lo = mid + 1;
+			}
+			else {
+				hi = mid;
+			}
+		}
+		if (lo == t->dim_blocks[i] || t->qnums_blocks[i][lo] != qnums[i]) {
+			// quantum number not found
+			ct_free(index);
+			return NULL;
+		}
+		index[i] = lo;
+	}
+
+	struct dense_tensor* b = block_sparse_tensor_find_block(t, index);
+
+	ct_free(index);
+
+	return b;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Find the storage position of the dense block with grid offset 'o', or return -1 if the block is not stored.
+///
+static long find_block_position_by_offset(const struct block_sparse_tensor* t, const long o)
+{
+	// binary search in sorted grid offsets
+	long lo = 0;
+	long hi = t->nblocks;
+	while (lo < hi)
+	{
+		const long mid = lo + (hi - lo) / 2;
+		if (t->grid_offsets[mid] < o) {
+			lo = mid + 1;
+		}
+		else {
+			hi = mid;
+		}
+	}
+	if (lo < t->nblocks && t->grid_offsets[lo] == o) {
+		return lo;
+	}
+
+	return -1;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Find the storage position of the dense block with block index 'index_block', or return -1 if the block is not stored (i.e., quantum numbers are not conserved).
+///
+long block_sparse_tensor_find_block_position(const struct block_sparse_tensor* t, const long* index_block)
+{
+	return find_block_position_by_offset(t, tensor_index_to_offset(t->ndim, t->dim_blocks, index_block));
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Find the dense block with block index 'index_block', or return NULL if the block is not stored (i.e., quantum numbers are not conserved).
+///
+struct dense_tensor* block_sparse_tensor_find_block(const struct block_sparse_tensor* t, const long* index_block)
+{
+	const long k = block_sparse_tensor_find_block_position(t, index_block);
+	if (k < 0) {
+		return NULL;
+	}
+
+	return t->blocks[k];
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Compute the 2-norm (Frobenius norm) of the tensor.
+///
+/// Result is returned as double also for single-precision tensor entries.
 ///
 double block_sparse_tensor_norm2(const struct block_sparse_tensor* t)
 {
 	double nrm = 0;
 
-	const long nblocks = integer_product(t->dim_blocks, t->ndim);
-	for (long k = 0; k < nblocks; k++)
+	for (long k = 0; k < t->nblocks; k++)
 	{
 		struct dense_tensor* b = t->blocks[k];
-		if (b != NULL) {
-			nrm += square(dense_tensor_norm2(b));
-		}
+		assert(b != NULL);
+		nrm += square(dense_tensor_norm2(b));
 	}
 	nrm = sqrt(nrm);
 
@@ -399,13 +902,11 @@ void block_sparse_tensor_reverse_axis_directions(struct block_sparse_tensor* t)
 ///
 void scale_block_sparse_tensor(const void* alpha, struct block_sparse_tensor* t)
 {
-	const long nblocks = integer_product(t->dim_blocks, t->ndim);
-	for (long k = 0; k < nblocks; k++)
+	for (long k = 0; k < t->nblocks; k++)
 	{
 		struct dense_tensor* b = t->blocks[k];
-		if (b != NULL) {
-			scale_dense_tensor(alpha, b);
-		}
+		assert(b != NULL);
+		scale_dense_tensor(alpha, b);
 	}
 }
 
@@ -418,13 +919,11 @@ void scale_block_sparse_tensor(const void* alpha, struct block_sparse_tensor* t)
 ///
 void rscale_block_sparse_tensor(const void* alpha, struct block_sparse_tensor* t)
 {
-	const long nblocks = integer_product(t->dim_blocks, t->ndim);
-	for (long k = 0; k < nblocks; k++)
+	for (long k = 0; k < t->nblocks; k++)
 	{
 		struct dense_tensor* b = t->blocks[k];
-		if (b != NULL) {
-			rscale_dense_tensor(alpha, b);
-		}
+		assert(b != NULL);
+		rscale_dense_tensor(alpha, b);
 	}
 }
 
@@ -435,13 +934,11 @@ void rscale_block_sparse_tensor(const void* alpha, struct block_sparse_tensor* t
 ///
 void conjugate_block_sparse_tensor(struct block_sparse_tensor* t)
 {
-	const long nblocks = integer_product(t->dim_blocks, t->ndim);
-	for (long k = 0; k < nblocks; k++)
+	for (long k = 0; k < t->nblocks; k++)
 	{
 		struct dense_tensor* b = t->blocks[k];
-		if (b != NULL) {
-			conjugate_dense_tensor(b);
-		}
+		assert(b != NULL);
+		conjugate_dense_tensor(b);
 	}
 }
 
@@ -452,13 +949,11 @@ void conjugate_block_sparse_tensor(struct block_sparse_tensor* t)
 ///
 void block_sparse_tensor_fill_random_normal(const void* alpha, const void* shift, struct rng_state* rng_state, struct block_sparse_tensor* t)
 {
-	const long nblocks = integer_product(t->dim_blocks, t->ndim);
-	for (long k = 0; k < nblocks; k++)
+	for (long k = 0; k < t->nblocks; k++)
 	{
 		struct dense_tensor* b = t->blocks[k];
-		if (b != NULL) {
-			dense_tensor_fill_random_normal(alpha, shift, rng_state, b);
-		}
+		assert(b != NULL);
+		dense_tensor_fill_random_normal(alpha, shift, rng_state, b);
 	}
 }
 
@@ -472,19 +967,10 @@ void block_sparse_to_dense_tensor(const struct block_sparse_tensor* restrict s,
 	allocate_dense_tensor(s->dtype, s->ndim, s->dim_logical, t);
 
 	// for each block with matching quantum numbers...
-	const long nblocks = integer_product(s->dim_blocks, s->ndim);
 	long* index_block = ct_calloc(s->ndim, sizeof(long));
-	for (long k = 0; k < nblocks; k++, next_tensor_index(s->ndim, s->dim_blocks, index_block))
+	for (long k = 0; k < s->nblocks; k++)
 	{
-		// probe whether quantum numbers sum to zero
-		qnumber qsum = 0;
-		for (int i = 0; i < s->ndim; i++)
-		{
-			qsum += s->axis_dir[i] * s->qnums_blocks[i][index_block[i]];
-		}
-		if (qsum != 0) {
-			continue;
-		}
+		block_sparse_tensor_block_index(s, k, index_block);
 
 		const struct dense_tensor* b = s->blocks[k];
 		assert(b != NULL);
@@ -622,19 +1108,10 @@ void dense_to_block_sparse_tensor_entries(const struct dense_tensor* restrict t,
 	}
 
 	// for each block with matching quantum numbers...
-	const long nblocks = integer_product(s->dim_blocks, s->ndim);
 	long* index_block = ct_calloc(s->ndim, sizeof(long));
-	for (long k = 0; k < nblocks; k++, next_tensor_index(s->ndim, s->dim_blocks, index_block))
+	for (long k = 0; k < s->nblocks; k++)
 	{
-		// probe whether quantum numbers sum to zero
-		qnumber qsum = 0;
-		for (int i = 0; i < s->ndim; i++)
-		{
-			qsum += s->axis_dir[i] * s->qnums_blocks[i][index_block[i]];
-		}
-		if (qsum != 0) {
-			continue;
-		}
+		block_sparse_tensor_block_index(s, k, index_block);
 
 		struct dense_tensor* b = s->blocks[k];
 		assert(b != NULL);
@@ -740,6 +1217,59 @@ void dense_to_block_sparse_tensor_entries(const struct dense_tensor* restrict t,
 }
 
 
+//________________________________________________________________________________________________________________________
+///
+/// \brief Pair of a block grid offset and a storage index, used for sorting permuted blocks.
+///
+struct index_offset_pair
+{
+	long offset;  //!< grid offset
+	long index;   //!< storage index
+};
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Comparison function for sorting by grid offset.
+///
+static int compare_index_offset_pair(const void* a, const void* b)
+{
+	const struct index_offset_pair* x = (const struct index_offset_pair*)a;
+	const struct index_offset_pair* y = (const struct index_offset_pair*)b;
+
+	if (x->offset < y->offset) {
+		return -1;
+	}
+	if (x->offset > y->offset) {
+		return 1;
+	}
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Find the first entry of 'pairs' (sorted by grid offset) with an offset not less than 'offset' by bisection.
+///
+/// Returns 'n' if all offsets are smaller.
+///
+static long lower_bound_index_offset_pair(const struct index_offset_pair* pairs, const long n, const long offset)
+{
+	long lo = 0;
+	long hi = n;
+	while (lo < hi)
+	{
+		const long mid = lo + (hi - lo) / 2;
+		if (pairs[mid].offset < offset) {
+			lo = mid + 1;
+		}
+		else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+
 //________________________________________________________________________________________________________________________
 ///
 /// \brief Generalized transpose of a tensor 't' such that
@@ -751,6 +1281,7 @@ void transpose_block_sparse_tensor(const int* restrict perm, const struct block_
 {
 	r->dtype = t->dtype;
 	r->ndim = t->ndim;
+	r->data = NULL;
 
 	if (t->ndim == 0)  // special case
 	{
@@ -763,6 +1294,8 @@ void transpose_block_sparse_tensor(const int* restrict perm, const struct block_
 		r->qnums_blocks  = NULL;
 
 		// allocate memory for a single block
+		r->nblocks = 1;
+		r->grid_offsets = ct_calloc(1, sizeof(long));
 		r->blocks = ct_calloc(1, sizeof(struct dense_tensor*));
 		r->blocks[0] = ct_calloc(1, sizeof(struct dense_tensor));
 		allocate_dense_tensor(r->dtype, 0, NULL, r->blocks[0]);
@@ -812,42 +1345,79 @@ void transpose_block_sparse_tensor(const int* restrict perm, const struct block_
 		memcpy(r->qnums_blocks[i], t->qnums_blocks[perm[i]], r->dim_blocks[i] * sizeof(qnumber));
 	}
 
-	// dense tensor blocks
-	const long nblocks = integer_product(t->dim_blocks, t->ndim);
-	r->blocks = ct_calloc(nblocks, sizeof(struct dense_tensor*));
+	// dense tensor blocks; the permuted blocks are generally not sorted with respect to the grid offsets of 'r'
+	r->nblocks = t->nblocks;
+	struct index_offset_pair* offset_map = ct_malloc(t->nblocks * sizeof(struct index_offset_pair));
 	long* index_block_t = ct_calloc(t->ndim, sizeof(long));
 	long* index_block_r = ct_calloc(r->ndim, sizeof(long));
-	for (long k = 0; k < nblocks; k++, next_tensor_index(t->ndim, t->dim_blocks, index_block_t))
+	for (long k = 0; k < t->nblocks; k++)
 	{
-		// probe whether quantum numbers sum to zero
-		qnumber qsum = 0;
-		for (int i = 0; i < t->ndim; i++)
-		{
-			qsum += t->axis_dir[i] * t->qnums_blocks[i][index_block_t[i]];
-		}
-		if (qsum != 0) {
-			continue;
-		}
-
-		assert(t->blocks[k] != NULL);
-		assert(t->blocks[k]->ndim == t->ndim);
-		assert(t->blocks[k]->dtype == t->dtype);
+		block_sparse_tensor_block_index(t, k, index_block_t);
 
 		// corresponding block index in 'r'
 		for (int i = 0; i < t->ndim; i++) {
 			index_block_r[i] = index_block_t[perm[i]];
 		}
-		long j = tensor_index_to_offset(r->ndim, r->dim_blocks, index_block_r);
+		offset_map[k].offset = tensor_index_to_offset(r->ndim, r->dim_blocks, index_block_r);
+		offset_map[k].index  = k;
+	}
+	qsort(offset_map, t->nblocks, sizeof(struct index_offset_pair), compare_index_offset_pair);
+
+	r->grid_offsets = ct_malloc(r->nblocks * sizeof(long));
+	r->blocks = ct_calloc(r->nblocks, sizeof(struct dense_tensor*));
+	for (long j = 0; j < r->nblocks; j++)
+	{
+		const struct dense_tensor* bt = t->blocks[offset_map[j].index];
+		assert(bt != NULL);
+		assert(bt->ndim == t->ndim);
+		assert(bt->dtype == t->dtype);
 
 		// transpose dense tensor block
+		r->grid_offsets[j] = offset_map[j].offset;
 		r->blocks[j] = ct_calloc(1, sizeof(struct dense_tensor));
-		transpose_dense_tensor(perm, t->blocks[k], r->blocks[j]);
+		transpose_dense_tensor(perm, bt, r->blocks[j]);
 	}
+	ct_free(offset_map);
 	ct_free(index_block_r);
 	ct_free(index_block_t);
 }
 
 
+//________________________________________________________________________________________________________________________
+///
+/// \brief Generalized transpose of a tensor 't' such that
+/// the i-th axis in the output tensor 'r' is the perm[i]-th axis of the input tensor 't'.
+///
+/// 'r' must have been allocated beforehand with the block sparsity structure of the transposed tensor,
+/// e.g., by a previous call of 'transpose_block_sparse_tensor'. The function does not allocate any memory.
+///
+void transpose_block_sparse_tensor_fill(const int* restrict perm, const struct block_sparse_tensor* restrict t, struct block_sparse_tensor* restrict r)
+{
+	assert(t->dtype == r->dtype);
+	assert(t->ndim  == r->ndim);
+	assert(t->nblocks == r->nblocks);
+	for (int i = 0; i < t->ndim; i++) {
+		assert(r->dim_blocks[i] == t->dim_blocks[perm[i]]);
+	}
+
+	for (long k = 0; k < r->nblocks; k++)
+	{
+		// grid offset of the corresponding block in 't', obtained by decomposing the grid offset of 'r' axis by axis
+		long or = r->grid_offsets[k];
+		long ot = 0;
+		for (int i = r->ndim - 1; i >= 0; i--)
+		{
+			ot += (or % r->dim_blocks[i]) * integer_product(t->dim_blocks + perm[i] + 1, t->ndim - perm[i] - 1);
+			or /= r->dim_blocks[i];
+		}
+		const long kt = find_block_position_by_offset(t, ot);
+		assert(kt >= 0);
+
+		transpose_dense_tensor_fill(perm, t->blocks[kt], r->blocks[k]);
+	}
+}
+
+
 //________________________________________________________________________________________________________________________
 ///
 /// \brief Generalized conjugate transpose of a tensor 't' such that
@@ -926,20 +1496,11 @@ void flatten_block_sparse_tensor_axes(const struct block_sparse_tensor* restrict
 	const size_t dtype_size = sizeof_numeric_type(t->dtype);
 
 	// for each block with matching quantum numbers...
-	const long nblocks = integer_product(t->dim_blocks, t->ndim);
 	long* index_block_t = ct_calloc(t->ndim, sizeof(long));
 	long* index_block_r = ct_calloc(r->ndim, sizeof(long));
-	for (long k = 0; k < nblocks; k++, next_tensor_index(t->ndim, t->dim_blocks, index_block_t))
+	for (long k = 0; k < t->nblocks; k++)
 	{
-		// probe whether quantum numbers sum to zero
-		qnumber qsum = 0;
-		for (int i = 0; i < t->ndim; i++)
-		{
-			qsum += t->axis_dir[i] * t->qnums_blocks[i][index_block_t[i]];
-		}
-		if (qsum != 0) {
-			continue;
-		}
+		block_sparse_tensor_block_index(t, k, index_block_t);
 
 		const struct dense_tensor* bt = t->blocks[k];
 		assert(bt != NULL);
@@ -971,7 +1532,7 @@ void flatten_block_sparse_tensor_axes(const struct block_sparse_tensor* restrict
 		{
 			index_block_r[i - 1] = index_block_t[i];
 		}
-		struct dense_tensor* br = r->blocks[tensor_index_to_offset(r->ndim, r->dim_blocks, index_block_r)];
+		struct dense_tensor* br = block_sparse_tensor_find_block(r, index_block_r);
 		assert(br != NULL);
 		assert(br->ndim == r->ndim);
 		assert(br->dtype == r->dtype);
@@ -1110,20 +1671,11 @@ void split_block_sparse_tensor_axis(const struct block_sparse_tensor* restrict t
 	const size_t dtype_size = sizeof_numeric_type(t->dtype);
 
 	// for each block with matching quantum numbers...
-	const long nblocks = integer_product(r->dim_blocks, r->ndim);
 	long* index_block_t = ct_calloc(t->ndim, sizeof(long));
 	long* index_block_r = ct_calloc(r->ndim, sizeof(long));
-	for (long k = 0; k < nblocks; k++, next_tensor_index(r->ndim, r->dim_blocks, index_block_r))
+	for (long k = 0; k < r->nblocks; k++)
 	{
-		// probe whether quantum numbers sum to zero
-		qnumber qsum = 0;
-		for (int i = 0; i < r->ndim; i++)
-		{
-			qsum += r->axis_dir[i] * r->qnums_blocks[i][index_block_r[i]];
-		}
-		if (qsum != 0) {
-			continue;
-		}
+		block_sparse_tensor_block_index(r, k, index_block_r);
 
 		const struct dense_tensor* br = r->blocks[k];
 		assert(br != NULL);
@@ -1155,7 +1707,7 @@ void split_block_sparse_tensor_axis(const struct block_sparse_tensor* restrict t
 		{
 			index_block_t[i] = index_block_r[i + 1];
 		}
-		const struct dense_tensor* bt = t->blocks[tensor_index_to_offset(t->ndim, t->dim_blocks, index_block_t)];
+		const struct dense_tensor* bt = block_sparse_tensor_find_block(t, index_block_t);
 		assert(bt != NULL);
 		assert(bt->ndim == t->ndim);
 		assert(bt->dtype == t->dtype);
@@ -1269,20 +1821,11 @@ void block_sparse_tensor_slice(const struct block_sparse_tensor* restrict t, con
 	}
 
 	// for each block with matching quantum numbers...
-	const long nblocks = integer_product(r->dim_blocks, r->ndim);
 	long* index_block_t = ct_calloc(t->ndim, sizeof(long));
 	long* index_block_r = ct_calloc(r->ndim, sizeof(long));
-	for (long k = 0; k < nblocks; k++, next_tensor_index(r->ndim, r->dim_blocks, index_block_r))
+	for (long k = 0; k < r->nblocks; k++)
 	{
-		// probe whether quantum numbers sum to zero
-		qnumber qsum = 0;
-		for (int i = 0; i < r->ndim; i++)
-		{
-			qsum += r->axis_dir[i] * r->qnums_blocks[i][index_block_r[i]];
-		}
-		if (qsum != 0) {
-			continue;
-		}
+		block_sparse_tensor_block_index(r, k, index_block_r);
 
 		struct dense_tensor* br = r->blocks[k];
 		assert(br != NULL);
@@ -1303,7 +1846,7 @@ void block_sparse_tensor_slice(const struct block_sparse_tensor* restrict t, con
 		}
 		assert(index_block_t[i_ax] != -1);
 
-		const struct dense_tensor* bt = t->blocks[tensor_index_to_offset(t->ndim, t->dim_blocks, index_block_t)];
+		const struct dense_tensor* bt = block_sparse_tensor_find_block(t, index_block_t);
 		assert(bt != NULL);
 		assert(bt->ndim == t->ndim);
 		assert(bt->dtype == t->dtype);
@@ -1376,42 +1919,44 @@ void block_sparse_tensor_cyclic_partial_trace(const struct block_sparse_tensor*
 	// construct new block-sparse tensor 'r'
 	allocate_block_sparse_tensor(t->dtype, t->ndim - 2 * ndim_trace, t->dim_logical + ndim_trace, t->axis_dir + ndim_trace, (const qnumber**)(t->qnums_logical + ndim_trace), r);
 
-	// for each block with matching quantum numbers...
-	const long nblocks_r = integer_product(r->dim_blocks, r->ndim);
+	block_sparse_tensor_cyclic_partial_trace_fill(t, ndim_trace, r);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Compute the "cyclic" partial trace, by tracing out the 'ndim_trace' leading with the 'ndim_trace' trailing axes.
+///
+/// 'r' must have been allocated beforehand (e.g., by a previous call of 'block_sparse_tensor_cyclic_partial_trace'),
+/// and its entries are overwritten. The function does not allocate any memory.
+///
+void block_sparse_tensor_cyclic_partial_trace_fill(const struct block_sparse_tensor* restrict t, const int ndim_trace, struct block_sparse_tensor* restrict r)
+{
+	assert(ndim_trace >= 1);
+	assert(t->dtype == r->dtype);
+	assert(r->ndim == t->ndim - 2 * ndim_trace);
+
+	// number of blocks of the traced axes, and of the block grid of 'r'
 	const long nblocks_p = integer_product(t->dim_blocks, ndim_trace);
-	long* index_block_t  = ct_calloc(t->ndim, sizeof(long));
-	long* index_block_r  = ct_calloc(r->ndim, sizeof(long));
-	for (long k = 0; k < nblocks_r; k++, next_tensor_index(r->ndim, r->dim_blocks, index_block_r))
-	{
-		// probe whether quantum numbers sum to zero
-		qnumber qsum = 0;
-		for (int i = 0; i < r->ndim; i++)
-		{
-			qsum += r->axis_dir[i] * r->qnums_blocks[i][index_block_r[i]];
-		}
-		if (qsum != 0) {
-			continue;
-		}
+	const long ngrid_r   = integer_product(t->dim_blocks + ndim_trace, r->ndim);
 
+	// for each block with matching quantum numbers...
+	for (long k = 0; k < r->nblocks; k++)
+	{
 		struct dense_tensor* br = r->blocks[k];
 		assert(br != NULL);
+		memset(br->data, 0, dense_tensor_num_elements(br) * sizeof_numeric_type(br->dtype));
 
-		memcpy(index_block_t + ndim_trace, index_block_r, r->ndim * sizeof(long));
-
-		for (long j = 0; j < nblocks_p; j++, next_tensor_index(ndim_trace, t->dim_blocks, index_block_t))
+		for (long j = 0; j < nblocks_p; j++)
 		{
-			// duplicate leading 'ndim_trace' indices at the end
-			memcpy(index_block_t + ndim_trace + r->ndim, index_block_t, ndim_trace * sizeof(long));
-
-			const struct dense_tensor* bt = t->blocks[tensor_index_to_offset(t->ndim, t->dim_blocks, index_block_t)];
-			assert(bt != NULL);
+			// the leading 'ndim_trace' block indices are duplicated at the end
+			const long ot = (j * ngrid_r + r->grid_offsets[k]) * nblocks_p + j;
+			const long kt = find_block_position_by_offset(t, ot);
+			assert(kt >= 0);
 
-			dense_tensor_cyclic_partial_trace_update(bt, ndim_trace, br);
+			dense_tensor_cyclic_partial_trace_update(t->blocks[kt], ndim_trace, br);
 		}
 	}
-
-	ct_free(index_block_r);
-	ct_free(index_block_t);
 }
 
 
@@ -1433,19 +1978,10 @@ void block_sparse_tensor_multiply_pointwise_vector(const struct block_sparse_ten
 	allocate_block_sparse_tensor(s->dtype, s->ndim, s->dim_logical, s->axis_dir, (const qnumber**)s->qnums_logical, r);
 
 	// for each block with matching quantum numbers...
-	const long nblocks = integer_product(r->dim_blocks, r->ndim);
 	long* index_block_r = ct_calloc(r->ndim, sizeof(long));
-	for (long k = 0; k < nblocks; k++, next_tensor_index(r->ndim, r->dim_blocks, index_block_r))
+	for (long k = 0; k < r->nblocks; k++)
 	{
-		// probe whether quantum numbers sum to zero
-		qnumber qsum = 0;
-		for (int i = 0; i < r->ndim; i++)
-		{
-			qsum += r->axis_dir[i] * r->qnums_blocks[i][index_block_r[i]];
-		}
-		if (qsum != 0) {
-			continue;
-		}
+		block_sparse_tensor_block_index(r, k, index_block_r);
 
 		struct dense_tensor* br = r->blocks[k];
 		assert(br != NULL);
@@ -1530,21 +2066,12 @@ void block_sparse_tensor_multiply_axis(const struct block_sparse_tensor* restric
 	}
 
 	// for each dense block of 'r'...
-	const long nblocks = integer_product(r->dim_blocks, r->ndim);
 	long* index_block_s = ct_calloc(s->ndim, sizeof(long));
 	long* index_block_t = ct_calloc(t->ndim, sizeof(long));
 	long* index_block_r = ct_calloc(r->ndim, sizeof(long));
-	for (long k = 0; k < nblocks; k++, next_tensor_index(r->ndim, r->dim_blocks, index_block_r))
+	for (long k = 0; k < r->nblocks; k++)
 	{
-		// probe whether quantum numbers in 'r' sum to zero
-		qnumber qsum = 0;
-		for (int i = 0; i < r->ndim; i++)
-		{
-			qsum += r->axis_dir[i] * r->qnums_blocks[i][index_block_r[i]];
-		}
-		if (qsum != 0) {
-			continue;
-		}
+		block_sparse_tensor_block_index(r, k, index_block_r);
 
 		memcpy( index_block_s, index_block_r, i_ax * sizeof(long));
 		memcpy(&index_block_t[offset_t], &index_block_r[i_ax], (t->ndim - 1) * sizeof(long));
@@ -1578,8 +2105,8 @@ void block_sparse_tensor_multiply_axis(const struct block_sparse_tensor* restric
 			}
 			assert(qsum == 0);
 
-			const struct dense_tensor* bs = s->blocks[tensor_index_to_offset(s->ndim, s->dim_blocks, index_block_s)];
-			const struct dense_tensor* bt = t->blocks[tensor_index_to_offset(t->ndim, t->dim_blocks, index_block_t)];
+			const struct dense_tensor* bs = block_sparse_tensor_find_block(s, index_block_s);
+			const struct dense_tensor* bt = block_sparse_tensor_find_block(t, index_block_t);
 			assert(bs != NULL);
 			assert(bt != NULL);
 
@@ -1589,198 +2116,1179 @@ void block_sparse_tensor_multiply_axis(const struct block_sparse_tensor* restric
 		}
 	}
 
-	ct_free(index_block_r);
-	ct_free(index_block_t);
-	ct_free(index_block_s);
+	ct_free(index_block_r);
+	ct_free(index_block_t);
+	ct_free(index_block_s);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Create a contraction plan for multiplying (leading or trailing) 'ndim_mult' axes in 's' by 'ndim_mult' axes in 't'.
+///
+/// The plan records all pairs of dense blocks contributing to the output blocks, together with the matrix dimensions,
+/// such that the contraction can be repeatedly executed for tensors with the same block sparsity structure (but different entries).
+///
+void create_block_sparse_tensor_dot_plan(const struct block_sparse_tensor* restrict s, const enum tensor_axis_range axrange_s, const struct block_sparse_tensor* restrict t, const enum tensor_axis_range axrange_t, const int ndim_mult, struct block_sparse_tensor_dot_plan* restrict plan)
+{
+	create_block_sparse_tensor_dot_conj_plan(s, axrange_s, false, t, axrange_t, false, ndim_mult, plan);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Create a contraction plan for contracting the axes 'axes_s' of 's' with the axes 'axes_t' of 't',
+/// optionally using the complex conjugate of 's' or 't'. Sets all plan fields except for the axis ranges.
+///
+static void create_block_sparse_tensor_plan_axes(const struct block_sparse_tensor* restrict s, const int* restrict axes_s, const bool conj_s, const struct block_sparse_tensor* restrict t, const int* restrict axes_t, const bool conj_t, const int ndim_mult, struct block_sparse_tensor_dot_plan* restrict plan)
+{
+	assert(s->dtype == t->dtype);
+
+	// effective axis direction signs
+	const int sign_s = (conj_s ? -1 : 1);
+	const int sign_t = (conj_t ? -1 : 1);
+
+	// dimension and quantum number compatibility checks
+	assert(ndim_mult >= 1);
+	assert(s->ndim >= ndim_mult && t->ndim >= ndim_mult);
+	for (int i = 0; i < ndim_mult; i++)
+	{
+		assert(0 <= axes_s[i] && axes_s[i] < s->ndim);
+		assert(0 <= axes_t[i] && axes_t[i] < t->ndim);
+		assert(s->dim_logical[axes_s[i]] == t->dim_logical[axes_t[i]]);
+		assert(s->dim_blocks [axes_s[i]] == t->dim_blocks [axes_t[i]]);
+		assert(sign_s * s->axis_dir[axes_s[i]] == -sign_t * t->axis_dir[axes_t[i]]);
+		// quantum numbers must match entrywise
+		assert(qnumber_all_equal(t->dim_logical[axes_t[i]], s->qnums_logical[axes_s[i]], t->qnums_logical[axes_t[i]]));
+		assert(qnumber_all_equal(t->dim_blocks [axes_t[i]], s->qnums_blocks [axes_s[i]], t->qnums_blocks [axes_t[i]]));
+	}
+
+	// remaining (free) axes of 's' and 't', in their original order
+	int* free_s = ct_malloc(lmax(s->ndim - ndim_mult, 1) * sizeof(int));
+	int* free_t = ct_malloc(lmax(t->ndim - ndim_mult, 1) * sizeof(int));
+	{
+		int c = 0;
+		for (int i = 0; i < s->ndim; i++)
+		{
+			bool contracted = false;
+			for (int j = 0; j < ndim_mult; j++) {
+				contracted = contracted || (axes_s[j] == i);
+			}
+			if (!contracted) {
+				free_s[c++] = i;
+			}
+		}
+		assert(c == s->ndim - ndim_mult);
+		c = 0;
+		for (int i = 0; i < t->ndim; i++)
+		{
+			bool contracted = false;
+			for (int j = 0; j < ndim_mult; j++) {
+				contracted = contracted || (axes_t[j] == i);
+			}
+			if (!contracted) {
+				free_t[c++] = i;
+			}
+		}
+		assert(c == t->ndim - ndim_mult);
+	}
+
+	const int ndimr = s->ndim + t->ndim - 2*ndim_mult;
+
+	plan->dtype     = s->dtype;
+	plan->conj_s    = conj_s;
+	plan->conj_t    = conj_t;
+	plan->ndim_mult = ndim_mult;
+	plan->ndim_r    = ndimr;
+	plan->nblocks_s = s->nblocks;
+	plan->nblocks_t = t->nblocks;
+	plan->axes_s = ct_malloc(ndim_mult * sizeof(int));
+	plan->axes_t = ct_malloc(ndim_mult * sizeof(int));
+	plan->batches = NULL;
+	plan->batch_triples = NULL;
+	plan->nbatches = 0;
+	plan->batch_threshold = 0;
+	memcpy(plan->axes_s, axes_s, ndim_mult * sizeof(int));
+	memcpy(plan->axes_t, axes_t, ndim_mult * sizeof(int));
+
+	// layout of output tensor 'r'; block quantum numbers of 'r' are inherited from 's' and 't'
+	long* dim_blocks_r = ct_malloc(ndimr * sizeof(long));
+	const qnumber** qnums_blocks_r = ct_malloc(ndimr * sizeof(qnumber*));
+	plan->dim_logical_r   = ct_malloc(ndimr * sizeof(long));
+	plan->axis_dir_r      = ct_malloc(ndimr * sizeof(enum tensor_axis_direction));
+	plan->qnums_logical_r = ct_malloc(ndimr * sizeof(qnumber*));
+	for (int i = 0; i < ndimr; i++)
+	{
+		const struct block_sparse_tensor* u = (i < s->ndim - ndim_mult ? s : t);
+		const int j = (i < s->ndim - ndim_mult ? free_s[i] : free_t[i - (s->ndim - ndim_mult)]);
+		dim_blocks_r[i]         = u->dim_blocks[j];
+		qnums_blocks_r[i]       = u->qnums_blocks[j];
+		plan->dim_logical_r[i]  = u->dim_logical[j];
+		plan->axis_dir_r[i]     = (i < s->ndim - ndim_mult ? sign_s : sign_t) * u->axis_dir[j];
+		plan->qnums_logical_r[i] = ct_malloc(u->dim_logical[j] * sizeof(qnumber));
+		memcpy(plan->qnums_logical_r[i], u->qnums_logical[j], u->dim_logical[j] * sizeof(qnumber));
+	}
+
+	// enumerate blocks of 'r' in the same order as 'allocate_block_sparse_tensor'
+	plan->nblocks_r = enumerate_conserved_blocks(ndimr, dim_blocks_r, plan->axis_dir_r, qnums_blocks_r, NULL);
+	long* grid_offsets_r = ct_malloc(plan->nblocks_r * sizeof(long));
+	enumerate_conserved_blocks(ndimr, dim_blocks_r, plan->axis_dir_r, qnums_blocks_r, grid_offsets_r);
+
+	long capacity = lmax(plan->nblocks_r, 1);
+	plan->triples = ct_malloc(capacity * sizeof(struct block_sparse_tensor_dot_triple));
+	plan->r_triple_offsets = ct_malloc((plan->nblocks_r + 1) * sizeof(long));
+	plan->ntriples = 0;
+
+	// sector-matching index: key the blocks of 's' by their (free, contracted) and the blocks of 't' by their (contracted, free) grid offsets;
+	// the blocks of 's' sharing the free part of an output block then pair one-to-one with the matching blocks of 't'
+	long ngrid_free_t = 1;
+	for (int i = 0; i < t->ndim - ndim_mult; i++) {
+		ngrid_free_t *= t->dim_blocks[free_t[i]];
+	}
+	long ncontract = 1;
+	for (int i = 0; i < ndim_mult; i++) {
+		ncontract *= t->dim_blocks[axes_t[i]];
+	}
+	struct index_offset_pair* sector_map_s = ct_malloc(lmax(s->nblocks, 1) * sizeof(struct index_offset_pair));
+	long* index_block_s = ct_malloc(s->ndim * sizeof(long));
+	for (long ks = 0; ks < s->nblocks; ks++)
+	{
+		block_sparse_tensor_block_index(s, ks, index_block_s);
+		long offset = 0;
+		for (int i = 0; i < s->ndim - ndim_mult; i++) {
+			offset = offset * s->dim_blocks[free_s[i]] + index_block_s[free_s[i]];
+		}
+		for (int i = 0; i < ndim_mult; i++) {
+			offset = offset * s->dim_blocks[axes_s[i]] + index_block_s[axes_s[i]];
+		}
+		sector_map_s[ks].offset = offset;
+		sector_map_s[ks].index  = ks;
+	}
+	qsort(sector_map_s, s->nblocks, sizeof(struct index_offset_pair), compare_index_offset_pair);
+	struct index_offset_pair* sector_map_t = ct_malloc(lmax(t->nblocks, 1) * sizeof(struct index_offset_pair));
+	long* index_block_t = ct_malloc(t->ndim * sizeof(long));
+	for (long kt = 0; kt < t->nblocks; kt++)
+	{
+		block_sparse_tensor_block_index(t, kt, index_block_t);
+		long offset = 0;
+		for (int i = 0; i < ndim_mult; i++) {
+			offset = offset * t->dim_blocks[axes_t[i]] + index_block_t[axes_t[i]];
+		}
+		for (int i = 0; i < t->ndim - ndim_mult; i++) {
+			offset = offset * t->dim_blocks[free_t[i]] + index_block_t[free_t[i]];
+		}
+		sector_map_t[kt].offset = offset;
+		sector_map_t[kt].index  = kt;
+	}
+	qsort(sector_map_t, t->nblocks, sizeof(struct index_offset_pair), compare_index_offset_pair);
+
+	// for each dense block of 'r'...
+	for (long kr = 0; kr < plan->nblocks_r; kr++)
+	{
+		plan->r_triple_offsets[kr] = plan->ntriples;
+
+		// the free axes of 's' precede the free axes of 't' in 'r'
+		const long offset_free_s = grid_offsets_r[kr] / ngrid_free_t;
+		const long offset_free_t = grid_offsets_r[kr] % ngrid_free_t;
+
+		// for each block of 's' with matching free axes, in ascending order of the contracted sectors...
+		for (long j = lower_bound_index_offset_pair(sector_map_s, s->nblocks, offset_free_s * ncontract);
+			j < s->nblocks && sector_map_s[j].offset < (offset_free_s + 1) * ncontract; j++)
+		{
+			const long ks = sector_map_s[j].index;
+			const long offset_contract = sector_map_s[j].offset % ncontract;
+
+			// quantum numbers of 'r' and 's' sum to zero, hence the matching block of 't' must exist
+			const long jt = lower_bound_index_offset_pair(sector_map_t, t->nblocks, offset_contract * ngrid_free_t + offset_free_t);
+			assert(jt < t->nblocks && sector_map_t[jt].offset == offset_contract * ngrid_free_t + offset_free_t);
+			const long kt = sector_map_t[jt].index;
+
+			const struct dense_tensor* bs = s->blocks[ks];
+			const struct dense_tensor* bt = t->blocks[kt];
+
+			if (plan->ntriples == capacity)
+			{
+				capacity *= 2;
+				struct block_sparse_tensor_dot_triple* triples = ct_malloc(capacity * sizeof(struct block_sparse_tensor_dot_triple));
+				memcpy(triples, plan->triples, plan->ntriples * sizeof(struct block_sparse_tensor_dot_triple));
+				ct_free(plan->triples);
+				plan->triples = triples;
+			}
+
+			struct block_sparse_tensor_dot_triple* triple = &plan->triples[plan->ntriples];
+			triple->ks = ks;
+			triple->kt = kt;
+			triple->kr = kr;
+			triple->m = 1;
+			for (int i = 0; i < s->ndim - ndim_mult; i++) {
+				triple->m *= bs->dim[free_s[i]];
+			}
+			triple->n = 1;
+			for (int i = 0; i < t->ndim - ndim_mult; i++) {
+				triple->n *= bt->dim[free_t[i]];
+			}
+			triple->k = 1;
+			for (int i = 0; i < ndim_mult; i++) {
+				assert(bs->dim[axes_s[i]] == bt->dim[axes_t[i]]);
+				triple->k *= bs->dim[axes_s[i]];
+			}
+			plan->ntriples++;
+		}
+	}
+	plan->r_triple_offsets[plan->nblocks_r] = plan->ntriples;
+
+	// order output blocks by decreasing computational cost, for load balancing of parallel execution
+	struct block_cost* costs = ct_malloc(plan->nblocks_r * sizeof(struct block_cost));
+	for (long kr = 0; kr < plan->nblocks_r; kr++)
+	{
+		costs[kr].cost  = 0;
+		costs[kr].index = kr;
+		for (long j = plan->r_triple_offsets[kr]; j < plan->r_triple_offsets[kr + 1]; j++) {
+			costs[kr].cost += plan->triples[j].m * plan->triples[j].n * plan->triples[j].k;
+		}
+	}
+	qsort(costs, plan->nblocks_r, sizeof(struct block_cost), compare_block_cost);
+	plan->r_block_order = ct_malloc(plan->nblocks_r * sizeof(long));
+	for (long j = 0; j < plan->nblocks_r; j++) {
+		plan->r_block_order[j] = costs[j].index;
+	}
+	ct_free(costs);
+
+	ct_free(index_block_t);
+	ct_free(sector_map_t);
+	ct_free(index_block_s);
+	ct_free(sector_map_s);
+	ct_free(grid_offsets_r);
+	ct_free(qnums_blocks_r);
+	ct_free(dim_blocks_r);
+	ct_free(free_t);
+	ct_free(free_s);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Temporary data structure for grouping block multiplications by shape.
+///
+struct triple_shape
+{
+	long m;      //!< number of rows of the output block
+	long n;      //!< number of columns of the output block
+	long k;      //!< contraction dimension
+	long index;  //!< triple index
+};
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Comparison function for sorting by shape, and by triple index for equal shapes.
+///
+static int compare_triple_shape(const void* a, const void* b)
+{
+	const struct triple_shape* x = (const struct triple_shape*)a;
+	const struct triple_shape* y = (const struct triple_shape*)b;
+
+	if (x->m != y->m) {
+		return (x->m < y->m ? -1 : 1);
+	}
+	if (x->n != y->n) {
+		return (x->n < y->n ? -1 : 1);
+	}
+	if (x->k != y->k) {
+		return (x->k < y->k ? -1 : 1);
+	}
+	if (x->index != y->index) {
+		return (x->index < y->index ? -1 : 1);
+	}
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Group the block multiplications of a plan with at most 'threshold' multiply-add operations by shape.
+///
+static void create_block_sparse_tensor_dot_batches(const long threshold, struct block_sparse_tensor_dot_plan* plan)
+{
+	plan->batch_threshold = threshold;
+
+	long nsmall = 0;
+	for (long j = 0; j < plan->ntriples; j++) {
+		if (plan->triples[j].m * plan->triples[j].n * plan->triples[j].k <= threshold) {
+			nsmall++;
+		}
+	}
+	if (nsmall == 0) {
+		return;
+	}
+
+	struct triple_shape* shapes = ct_malloc(nsmall * sizeof(struct triple_shape));
+	long c = 0;
+	for (long j = 0; j < plan->ntriples; j++)
+	{
+		const struct block_sparse_tensor_dot_triple* triple = &plan->triples[j];
+		if (triple->m * triple->n * triple->k <= threshold)
+		{
+			shapes[c].m = triple->m;
+			shapes[c].n = triple->n;
+			shapes[c].k = triple->k;
+			shapes[c].index = j;
+			c++;
+		}
+	}
+	// ordering by triple index for equal shapes retains the summation order within each output block
+	qsort(shapes, nsmall, sizeof(struct triple_shape), compare_triple_shape);
+
+	plan->batch_triples = ct_malloc(nsmall * sizeof(long));
+	plan->batches = ct_malloc(nsmall * sizeof(struct block_sparse_tensor_dot_batch));
+	plan->nbatches = 0;
+	for (long j = 0; j < nsmall; j++)
+	{
+		plan->batch_triples[j] = shapes[j].index;
+		if (j == 0 || shapes[j].m != shapes[j - 1].m || shapes[j].n != shapes[j - 1].n || shapes[j].k != shapes[j - 1].k)
+		{
+			struct block_sparse_tensor_dot_batch* batch = &plan->batches[plan->nbatches];
+			batch->m = shapes[j].m;
+			batch->n = shapes[j].n;
+			batch->k = shapes[j].k;
+			batch->offset = j;
+			batch->count = 0;
+			plan->nbatches++;
+		}
+		plan->batches[plan->nbatches - 1].count++;
+	}
+
+	ct_free(shapes);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Create a contraction plan for multiplying (leading or trailing) 'ndim_mult' axes in 's' by 'ndim_mult' axes in 't',
+/// optionally using the complex conjugate of 's' or 't'.
+///
+/// A conjugated tensor is logically interpreted with reversed axis directions, i.e., as the dual tensor.
+/// Conjugation is applied within the matrix-matrix multiplications and does not require a conjugated copy of the tensor entries.
+/// Currently a conjugated 's' requires leading and a conjugated 't' trailing to-be contracted axes.
+///
+void create_block_sparse_tensor_dot_conj_plan(const struct block_sparse_tensor* restrict s, const enum tensor_axis_range axrange_s, const bool conj_s, const struct block_sparse_tensor* restrict t, const enum tensor_axis_range axrange_t, const bool conj_t, const int ndim_mult, struct block_sparse_tensor_dot_plan* restrict plan)
+{
+	// conjugation is realized by the 'CblasConjTrans' operation
+	assert(!conj_s || axrange_s == TENSOR_AXIS_RANGE_LEADING);
+	assert(!conj_t || axrange_t == TENSOR_AXIS_RANGE_TRAILING);
+
+	assert(ndim_mult >= 1);
+	assert(s->ndim >= ndim_mult && t->ndim >= ndim_mult);
+
+	const int shift_s = (axrange_s == TENSOR_AXIS_RANGE_LEADING ? 0 : s->ndim - ndim_mult);
+	const int shift_t = (axrange_t == TENSOR_AXIS_RANGE_LEADING ? 0 : t->ndim - ndim_mult);
+
+	int* axes_s = ct_malloc(ndim_mult * sizeof(int));
+	int* axes_t = ct_malloc(ndim_mult * sizeof(int));
+	for (int i = 0; i < ndim_mult; i++)
+	{
+		axes_s[i] = shift_s + i;
+		axes_t[i] = shift_t + i;
+	}
+
+	create_block_sparse_tensor_plan_axes(s, axes_s, conj_s, t, axes_t, conj_t, ndim_mult, plan);
+
+	plan->axrange_s = axrange_s;
+	plan->axrange_t = axrange_t;
+	plan->general_axes = false;
+
+	create_block_sparse_tensor_dot_batches(block_sparse_gemm_batch_threshold, plan);
+
+	ct_free(axes_t);
+	ct_free(axes_s);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Create a contraction plan for contracting the axes 'axes_s' of 's' with the axes 'axes_t' of 't' (pairwise, 'ndim_mult' axes each).
+///
+/// The axes of the output tensor are the remaining axes of 's' followed by the remaining axes of 't', both in their original order.
+/// The dense blocks are contracted by 'dense_tensor_contract_update', which maps them to strided (batched) matrix-matrix
+/// multiplications whenever possible, such that the operands do not have to be transposed beforehand.
+///
+void create_block_sparse_tensor_contract_plan(const struct block_sparse_tensor* restrict s, const int* restrict axes_s, const struct block_sparse_tensor* restrict t, const int* restrict axes_t, const int ndim_mult, struct block_sparse_tensor_dot_plan* restrict plan)
+{
+	create_block_sparse_tensor_contract_conj_plan(s, axes_s, false, t, axes_t, false, ndim_mult, plan);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Create a contraction plan for contracting the axes 'axes_s' of 's' with the axes 'axes_t' of 't' (pairwise, 'ndim_mult' axes each),
+/// optionally using the complex conjugate of 's' or 't'.
+///
+/// As for 'create_block_sparse_tensor_dot_conj_plan', a conjugated tensor is logically interpreted with reversed axis directions.
+/// There is no restriction on the to-be contracted axes; see 'dense_tensor_contract_conj_update' for how the conjugation is realized.
+///
+void create_block_sparse_tensor_contract_conj_plan(const struct block_sparse_tensor* restrict s, const int* restrict axes_s, const bool conj_s, const struct block_sparse_tensor* restrict t, const int* restrict axes_t, const bool conj_t, const int ndim_mult, struct block_sparse_tensor_dot_plan* restrict plan)
+{
+	create_block_sparse_tensor_plan_axes(s, axes_s, conj_s, t, axes_t, conj_t, ndim_mult, plan);
+
+	// not used for general axes
+	plan->axrange_s = TENSOR_AXIS_RANGE_TRAILING;
+	plan->axrange_t = TENSOR_AXIS_RANGE_LEADING;
+	plan->general_axes = true;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Delete a block-sparse tensor contraction plan (free memory).
+///
+void delete_block_sparse_tensor_dot_plan(struct block_sparse_tensor_dot_plan* plan)
+{
+	for (int i = 0; i < plan->ndim_r; i++)
+	{
+		ct_free(plan->qnums_logical_r[i]);
+	}
+	ct_free(plan->qnums_logical_r);
+	ct_free(plan->axis_dir_r);
+	ct_free(plan->dim_logical_r);
+	ct_free(plan->batches);
+	ct_free(plan->batch_triples);
+	ct_free(plan->r_block_order);
+	ct_free(plan->r_triple_offsets);
+	ct_free(plan->triples);
+	ct_free(plan->axes_t);
+	ct_free(plan->axes_s);
+	plan->ntriples = 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Allocate the output tensor 'r' of a block-sparse tensor contraction plan.
+///
+void allocate_block_sparse_tensor_dot_output(const struct block_sparse_tensor_dot_plan* restrict plan, struct block_sparse_tensor* restrict r)
+{
+	allocate_block_sparse_tensor(plan->dtype, plan->ndim_r, plan->dim_logical_r, plan->axis_dir_r, (const qnumber**)plan->qnums_logical_r, r);
+	assert(r->nblocks == plan->nblocks_r);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief General matrix-matrix multiplication of dense blocks, using row-major storage convention.
+///
+static inline void dense_block_gemm(const enum numeric_type dtype, const CBLAS_TRANSPOSE transa, const CBLAS_TRANSPOSE transb, const long m, const long n, const long k,
+	const void* alpha, const void* restrict a, const long lda, const void* restrict b, const long ldb, const void* beta, void* restrict c, const long ldc)
+{
+	if (small_k_gemm_applicable(k))
+	{
+		small_k_gemm(dtype, transa, transb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+		return;
+	}
+
+	switch (dtype)
+	{
+		case CT_SINGLE_REAL:
+		{
+			cblas_sgemm(CblasRowMajor, transa, transb, m, n, k, *((float*)alpha), a, lda, b, ldb, *((float*)beta), c, ldc);
+			break;
+		}
+		case CT_DOUBLE_REAL:
+		{
+			cblas_dgemm(CblasRowMajor, transa, transb, m, n, k, *((double*)alpha), a, lda, b, ldb, *((double*)beta), c, ldc);
+			break;
+		}
+		case CT_SINGLE_COMPLEX:
+		{
+			cblas_cgemm(CblasRowMajor, transa, transb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+			break;
+		}
+		case CT_DOUBLE_COMPLEX:
+		{
+			cblas_zgemm(CblasRowMajor, transa, transb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+			break;
+		}
+		default:
+		{
+			// unknown data type
+			assert(false);
+		}
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Small-matrix kernel for single precision real entries: c += alpha * a . b,
+/// with a[i, l] = a[i*ars + l*acs] and b[l, j] = b[l*brs + j*bcs] for 0 <= i < m, 0 <= j < n, 0 <= l < k.
+///
+static void small_gemm_update_s(const long m, const long n, const long k, const float alpha,
+	const float* restrict a, const long ars, const long acs, const float* restrict b, const long brs, const long bcs, float* restrict c, const long ldc)
+{
+	if (bcs != 1)
+	{
+		// rows of 'b' are strided: accumulate inner products along the contiguous contraction dimension
+		for (long i = 0; i < m; i++)
+		{
+			const float* ai = a + i*ars;
+			for (long j = 0; j < n; j++)
+			{
+				const float* bj = b + j*bcs;
+				float sum = 0;
+				for (long l = 0; l < k; l++) {
+					sum += ai[l*acs] * bj[l*brs];
+				}
+				c[i*ldc + j] += alpha * sum;
+			}
+		}
+		return;
+	}
+
+	for (long i = 0; i < m; i++)
+	{
+		float* ci = c + i*ldc;
+		for (long l = 0; l < k; l++)
+		{
+			const float ail = alpha * a[i*ars + l*acs];
+			const float* bl = b + l*brs;
+			for (long j = 0; j < n; j++) {
+				ci[j] += ail * bl[j];
+			}
+		}
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Small-matrix kernel for double precision real entries: c += alpha * a . b, see 'small_gemm_update_s'.
+///
+static void small_gemm_update_d(const long m, const long n, const long k, const double alpha,
+	const double* restrict a, const long ars, const long acs, const double* restrict b, const long brs, const long bcs, double* restrict c, const long ldc)
+{
+	if (bcs != 1)
+	{
+		// rows of 'b' are strided: accumulate inner products along the contiguous contraction dimension
+		for (long i = 0; i < m; i++)
+		{
+			const double* ai = a + i*ars;
+			for (long j = 0; j < n; j++)
+			{
+				const double* bj = b + j*bcs;
+				double sum = 0;
+				for (long l = 0; l < k; l++) {
+					sum += ai[l*acs] * bj[l*brs];
+				}
+				c[i*ldc + j] += alpha * sum;
+			}
+		}
+		return;
+	}
+
+	for (long i = 0; i < m; i++)
+	{
+		double* ci = c + i*ldc;
+		for (long l = 0; l < k; l++)
+		{
+			const double ail = alpha * a[i*ars + l*acs];
+			const double* bl = b + l*brs;
+			for (long j = 0; j < n; j++) {
+				ci[j] += ail * bl[j];
+			}
+		}
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Small-matrix kernel for single precision complex entries: c += alpha * a . b, see 'small_gemm_update_s',
+/// optionally using the complex conjugate of 'a' or 'b'.
+///
+static void small_gemm_update_c(const long m, const long n, const long k, const scomplex alpha,
+	const scomplex* restrict a, const long ars, const long acs, const bool conja, const scomplex* restrict b, const long brs, const long bcs, const bool conjb, scomplex* restrict c, const long ldc)
+{
+	if (bcs != 1)
+	{
+		// rows of 'b' are strided: accumulate inner products along the contiguous contraction dimension
+		for (long i = 0; i < m; i++)
+		{
+			const scomplex* ai = a + i*ars;
+			for (long j = 0; j < n; j++)
+			{
+				const scomplex* bj = b + j*bcs;
+				scomplex sum = 0;
+				// conj(a) . b is evaluated as conj(a . conj(b))
+				if (conjb != conja) {
+					for (long l = 0; l < k; l++) {
+						sum += ai[l*acs] * conjf(bj[l*brs]);
+					}
+				}
+				else {
+					for (long l = 0; l < k; l++) {
+						sum += ai[l*acs] * bj[l*brs];
+					}
+				}
+				c[i*ldc + j] += alpha * (conja ? conjf(sum) : sum);
+			}
+		}
+		return;
+	}
+
+	for (long i = 0; i < m; i++)
+	{
+		scomplex* ci = c + i*ldc;
+		for (long l = 0; l < k; l++)
+		{
+			const scomplex ail = alpha * (conja ? conjf(a[i*ars + l*acs]) : a[i*ars + l*acs]);
+			const scomplex* bl = b + l*brs;
+			if (conjb) {
+				for (long j = 0; j < n; j++) {
+					ci[j] += ail * conjf(bl[j]);
+				}
+			}
+			else {
+				for (long j = 0; j < n; j++) {
+					ci[j] += ail * bl[j];
+				}
+			}
+		}
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Small-matrix kernel for double precision complex entries: c += alpha * a . b, see 'small_gemm_update_c'.
+///
+static void small_gemm_update_z(const long m, const long n, const long k, const dcomplex alpha,
+	const dcomplex* restrict a, const long ars, const long acs, const bool conja, const dcomplex* restrict b, const long brs, const long bcs, const bool conjb, dcomplex* restrict c, const long ldc)
+{
+	if (bcs != 1)
+	{
+		// rows of 'b' are strided: accumulate inner products along the contiguous contraction dimension
+		for (long i = 0; i < m; i++)
+		{
+			const dcomplex* ai = a + i*ars;
+			for (long j = 0; j < n; j++)
+			{
+				const dcomplex* bj = b + j*bcs;
+				dcomplex sum = 0;
+				// conj(a) . b is evaluated as conj(a . conj(b))
+				if (conjb != conja) {
+					for (long l = 0; l < k; l++) {
+						sum += ai[l*acs] * conj(bj[l*brs]);
+					}
+				}
+				else {
+					for (long l = 0; l < k; l++) {
+						sum += ai[l*acs] * bj[l*brs];
+					}
+				}
+				c[i*ldc + j] += alpha * (conja ? conj(sum) : sum);
+			}
+		}
+		return;
+	}
+
+	for (long i = 0; i < m; i++)
+	{
+		dcomplex* ci = c + i*ldc;
+		for (long l = 0; l < k; l++)
+		{
+			const dcomplex ail = alpha * (conja ? conj(a[i*ars + l*acs]) : a[i*ars + l*acs]);
+			const dcomplex* bl = b + l*brs;
+			if (conjb) {
+				for (long j = 0; j < n; j++) {
+					ci[j] += ail * conj(bl[j]);
+				}
+			}
+			else {
+				for (long j = 0; j < n; j++) {
+					ci[j] += ail * bl[j];
+				}
+			}
+		}
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Accumulate the small block multiplications 'triple_indices' of a contraction plan (with leading or trailing axis ranges)
+/// into the output blocks by the internal small-matrix kernels: r[kr] += alpha * s[ks] . t[kt].
+///
+/// The data type dispatch is hoisted out of the loop over the block multiplications.
+///
+static void block_sparse_tensor_dot_execute_small(const struct block_sparse_tensor_dot_plan* restrict plan, const long* triple_indices, const long count,
+	const void* alpha, const struct block_sparse_tensor* restrict s, const struct block_sparse_tensor* restrict t, struct block_sparse_tensor* restrict r)
+{
+	assert(!plan->general_axes);
+
+	const bool leading_s = (plan->axrange_s == TENSOR_AXIS_RANGE_LEADING);
+	const bool leading_t = (plan->axrange_t == TENSOR_AXIS_RANGE_LEADING);
+
+	switch (plan->dtype)
+	{
+		case CT_SINGLE_REAL:
+		{
+			for (long j = 0; j < count; j++)
+			{
+				const struct block_sparse_tensor_dot_triple* tr = &plan->triples[triple_indices[j]];
+				small_gemm_update_s(tr->m, tr->n, tr->k, *((float*)alpha),
+					s->blocks[tr->ks]->data, leading_s ? 1 : tr->k, leading_s ? tr->m : 1,
+					t->blocks[tr->kt]->data, leading_t ? tr->n : 1, leading_t ? 1 : tr->k,
+					r->blocks[tr->kr]->data, tr->n);
+			}
+			break;
+		}
+		case CT_DOUBLE_REAL:
+		{
+			for (long j = 0; j < count; j++)
+			{
+				const struct block_sparse_tensor_dot_triple* tr = &plan->triples[triple_indices[j]];
+				small_gemm_update_d(tr->m, tr->n, tr->k, *((double*)alpha),
+					s->blocks[tr->ks]->data, leading_s ? 1 : tr->k, leading_s ? tr->m : 1,
+					t->blocks[tr->kt]->data, leading_t ? tr->n : 1, leading_t ? 1 : tr->k,
+					r->blocks[tr->kr]->data, tr->n);
+			}
+			break;
+		}
+		case CT_SINGLE_COMPLEX:
+		{
+			for (long j = 0; j < count; j++)
+			{
+				const struct block_sparse_tensor_dot_triple* tr = &plan->triples[triple_indices[j]];
+				small_gemm_update_c(tr->m, tr->n, tr->k, *((scomplex*)alpha),
+					s->blocks[tr->ks]->data, leading_s ? 1 : tr->k, leading_s ? tr->m : 1, plan->conj_s,
+					t->blocks[tr->kt]->data, leading_t ? tr->n : 1, leading_t ? 1 : tr->k, plan->conj_t,
+					r->blocks[tr->kr]->data, tr->n);
+			}
+			break;
+		}
+		case CT_DOUBLE_COMPLEX:
+		{
+			for (long j = 0; j < count; j++)
+			{
+				const struct block_sparse_tensor_dot_triple* tr = &plan->triples[triple_indices[j]];
+				small_gemm_update_z(tr->m, tr->n, tr->k, *((dcomplex*)alpha),
+					s->blocks[tr->ks]->data, leading_s ? 1 : tr->k, leading_s ? tr->m : 1, plan->conj_s,
+					t->blocks[tr->kt]->data, leading_t ? tr->n : 1, leading_t ? 1 : tr->k, plan->conj_t,
+					r->blocks[tr->kr]->data, tr->n);
+			}
+			break;
+		}
+		default:
+		{
+			// unknown data type
+			assert(false);
+		}
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Compute the output block with index 'kr' of a block-sparse tensor contraction plan.
+///
+/// If 'defer_small' is set, the small block multiplications (see 'batch_threshold') are skipped
+/// and must be accumulated afterwards by 'block_sparse_tensor_dot_execute_small'.
+///
+static void block_sparse_tensor_dot_execute_block(const struct block_sparse_tensor_dot_plan* restrict plan, const long kr,
+	const void* alpha, const struct block_sparse_tensor* restrict s, const struct block_sparse_tensor* restrict t, const void* beta, struct block_sparse_tensor* restrict r, const bool defer_small)
+{
+	struct dense_tensor* br = r->blocks[kr];
+	assert(br != NULL);
+
+	if (plan->r_triple_offsets[kr] == plan->r_triple_offsets[kr + 1])
+	{
+		// no contributing block pairs
+		if (memcmp(beta, numeric_zero(plan->dtype), sizeof_numeric_type(plan->dtype)) == 0) {
+			// follow BLAS convention: 'r' is not read for 'beta == 0'
+			memset(br->data, 0, dense_tensor_num_elements(br) * sizeof_numeric_type(plan->dtype));
+		}
+		else {
+			scale_dense_tensor(beta, br);
+		}
+		return;
+	}
+
+	const void* one = numeric_one(plan->dtype);
+
+	if (plan->general_axes)
+	{
+		for (long j = plan->r_triple_offsets[kr]; j < plan->r_triple_offsets[kr + 1]; j++)
+		{
+			const struct block_sparse_tensor_dot_triple* triple = &plan->triples[j];
+			assert(triple->kr == kr);
+			// strided (batched) matrix-matrix multiplications without transposing the blocks
+			dense_tensor_contract_conj_update(alpha, s->blocks[triple->ks], plan->axes_s, plan->conj_s, t->blocks[triple->kt], plan->axes_t, plan->conj_t, plan->ndim_mult,
+				(j == plan->r_triple_offsets[kr] ? beta : one), br);
+		}
+		return;
+	}
+
+	const CBLAS_TRANSPOSE transa = (plan->axrange_s == TENSOR_AXIS_RANGE_LEADING ? (plan->conj_s ? CblasConjTrans : CblasTrans) : CblasNoTrans);
+	const CBLAS_TRANSPOSE transb = (plan->axrange_t == TENSOR_AXIS_RANGE_LEADING ? CblasNoTrans : (plan->conj_t ? CblasConjTrans : CblasTrans));
+
+	// the small-matrix kernels only accumulate, hence 'beta' must be applied beforehand if the first multiplication is small
+	const void* beta_next = beta;
+	{
+		const struct block_sparse_tensor_dot_triple* triple = &plan->triples[plan->r_triple_offsets[kr]];
+		if (triple->m * triple->n * triple->k <= plan->batch_threshold)
+		{
+			if (memcmp(beta, numeric_zero(plan->dtype), sizeof_numeric_type(plan->dtype)) == 0) {
+				memset(br->data, 0, dense_tensor_num_elements(br) * sizeof_numeric_type(plan->dtype));
+			}
+			else if (memcmp(beta, one, sizeof_numeric_type(plan->dtype)) != 0) {
+				scale_dense_tensor(beta, br);
+			}
+			beta_next = one;
+		}
+	}
+
+	for (long j = plan->r_triple_offsets[kr]; j < plan->r_triple_offsets[kr + 1]; j++)
+	{
+		const struct block_sparse_tensor_dot_triple* triple = &plan->triples[j];
+		assert(triple->kr == kr);
+
+		if (triple->m * triple->n * triple->k <= plan->batch_threshold)
+		{
+			if (!defer_small) {
+				block_sparse_tensor_dot_execute_small(plan, &j, 1, alpha, s, t, r);
+			}
+			continue;
+		}
+
+		const struct dense_tensor* bs = s->blocks[triple->ks];
+		const struct dense_tensor* bt = t->blocks[triple->kt];
+		assert(triple->m * triple->k == dense_tensor_num_elements(bs));
+		assert(triple->n * triple->k == dense_tensor_num_elements(bt));
+		assert(triple->m * triple->n == dense_tensor_num_elements(br));
+
+		const long lda = (plan->axrange_s == TENSOR_AXIS_RANGE_LEADING ? triple->m : triple->k);
+		const long ldb = (plan->axrange_t == TENSOR_AXIS_RANGE_LEADING ? triple->n : triple->k);
+
+		// actually multiply dense tensor blocks and add result to 'br'
+		dense_block_gemm(plan->dtype, transa, transb, triple->m, triple->n, triple->k,
+			alpha, bs->data, lda, bt->data, ldb, beta_next, br->data, triple->n);
+		beta_next = one;
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Execute a block-sparse tensor contraction plan, computing 'r <- alpha * s . t + beta * r'.
+///
+/// The tensors 's' and 't' must have the same block sparsity structure as the tensors used for creating the plan,
+/// and 'r' must be allocated already (e.g., by 'allocate_block_sparse_tensor_dot_output').
+///
+/// Output blocks are computed in parallel if the parallel mode is set to 'BLOCK_SPARSE_PARALLEL_BLOCKS'.
+/// Otherwise, the small block multiplications are executed after the BLAS calls, grouped by shape.
+///
+void block_sparse_tensor_dot_execute(const struct block_sparse_tensor_dot_plan* restrict plan, const void* alpha, const struct block_sparse_tensor* restrict s, const struct block_sparse_tensor* restrict t, const void* beta, struct block_sparse_tensor* restrict r)
+{
+	// data types must agree
+	assert(s->dtype == plan->dtype);
+	assert(t->dtype == plan->dtype);
+	assert(r->dtype == plan->dtype);
+	// block structure must agree
+	assert(s->nblocks == plan->nblocks_s);
+	assert(t->nblocks == plan->nblocks_t);
+	assert(r->nblocks == plan->nblocks_r);
+	assert(r->ndim == plan->ndim_r);
+
+	if (block_sparse_parallel_mode == BLOCK_SPARSE_PARALLEL_BLOCKS)
+	{
+		const int blas_nthreads = (plan->nblocks_r > 1 ? block_parallel_blas_threads_single() : 0);
+		// largest blocks first, and dynamic scheduling such that a few large blocks do not serialize the computation
+		#pragma omp parallel for schedule(dynamic, 1) if (plan->nblocks_r > 1)
+		for (long j = 0; j < plan->nblocks_r; j++)
+		{
+			block_sparse_tensor_dot_execute_block(plan, plan->r_block_order[j], alpha, s, t, beta, r, false);
+		}
+		block_parallel_blas_threads_restore(blas_nthreads);
+	}
+	else
+	{
+		const bool batched = (!plan->general_axes && plan->nbatches > 0);
+		for (long kr = 0; kr < plan->nblocks_r; kr++)
+		{
+			block_sparse_tensor_dot_execute_block(plan, kr, alpha, s, t, beta, r, batched);
+		}
+		if (batched)
+		{
+			for (long b = 0; b < plan->nbatches; b++)
+			{
+				const struct block_sparse_tensor_dot_batch* batch = &plan->batches[b];
+				block_sparse_tensor_dot_execute_small(plan, plan->batch_triples + batch->offset, batch->count, alpha, s, t, r);
+			}
+		}
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Multiply (leading or trailing) 'ndim_mult' axes in 's' by 'ndim_mult' axes in 't', and store result in 'r'.
+/// Whether to use leading or trailing axes is specified by axis range.
+///
+/// Memory will be allocated for 'r'. Operation requires that the quantum numbers of the to-be contracted axes match,
+/// and that the axis directions are reversed between the tensors.
+///
+/// For repeated contractions of tensors with the same block sparsity structure, consider using a precomputed
+/// plan ('create_block_sparse_tensor_dot_plan') instead.
+///
+void block_sparse_tensor_dot(const struct block_sparse_tensor* restrict s, const enum tensor_axis_range axrange_s, const struct block_sparse_tensor* restrict t, const enum tensor_axis_range axrange_t, const int ndim_mult, struct block_sparse_tensor* restrict r)
+{
+	struct block_sparse_tensor_dot_plan plan;
+	create_block_sparse_tensor_dot_plan(s, axrange_s, t, axrange_t, ndim_mult, &plan);
+
+	allocate_block_sparse_tensor_dot_output(&plan, r);
+
+	block_sparse_tensor_dot_execute(&plan, numeric_one(s->dtype), s, t, numeric_zero(s->dtype), r);
+
+	delete_block_sparse_tensor_dot_plan(&plan);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Multiply (leading or trailing) 'ndim_mult' axes in 's' by 'ndim_mult' axes in 't', and store result in 'r',
+/// optionally using the complex conjugate of 's' or 't' (logically interpreted with reversed axis directions).
+///
+/// Memory will be allocated for 'r'. See 'create_block_sparse_tensor_dot_conj_plan' for the requirements.
+///
+void block_sparse_tensor_dot_conj(const struct block_sparse_tensor* restrict s, const enum tensor_axis_range axrange_s, const bool conj_s, const struct block_sparse_tensor* restrict t, const enum tensor_axis_range axrange_t, const bool conj_t, const int ndim_mult, struct block_sparse_tensor* restrict r)
+{
+	struct block_sparse_tensor_dot_plan plan;
+	create_block_sparse_tensor_dot_conj_plan(s, axrange_s, conj_s, t, axrange_t, conj_t, ndim_mult, &plan);
+
+	allocate_block_sparse_tensor_dot_output(&plan, r);
+
+	block_sparse_tensor_dot_execute(&plan, numeric_one(s->dtype), s, t, numeric_zero(s->dtype), r);
+
+	delete_block_sparse_tensor_dot_plan(&plan);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Contract the axes 'axes_s' of 's' with the axes 'axes_t' of 't' (pairwise, 'ndim_mult' axes each), and store result in 'r'.
+///
+/// The axes of 'r' are the remaining axes of 's' followed by the remaining axes of 't', both in their original order.
+/// Memory will be allocated for 'r'. Operation requires that the quantum numbers of the to-be contracted axes match,
+/// and that the axis directions are reversed between the tensors.
+///
+void block_sparse_tensor_contract(const struct block_sparse_tensor* restrict s, const int* restrict axes_s, const struct block_sparse_tensor* restrict t, const int* restrict axes_t, const int ndim_mult, struct block_sparse_tensor* restrict r)
+{
+	struct block_sparse_tensor_dot_plan plan;
+	create_block_sparse_tensor_contract_plan(s, axes_s, t, axes_t, ndim_mult, &plan);
+
+	allocate_block_sparse_tensor_dot_output(&plan, r);
+
+	block_sparse_tensor_dot_execute(&plan, numeric_one(s->dtype), s, t, numeric_zero(s->dtype), r);
+
+	delete_block_sparse_tensor_dot_plan(&plan);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Create a lazy view of tensor 't' without pending operations.
+///
+/// The tensor must remain valid during the lifetime of the view.
+///
+void create_block_sparse_tensor_lazy_view(const struct block_sparse_tensor* restrict t, struct block_sparse_tensor_lazy_view* restrict v)
+{
+	v->tensor = t;
+	v->perm = ct_malloc(t->ndim * sizeof(int));
+	for (int i = 0; i < t->ndim; i++) {
+		v->perm[i] = i;
+	}
+	v->conj = false;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Delete a lazy block-sparse tensor view (free memory); the referenced tensor is not affected.
+///
+void delete_block_sparse_tensor_lazy_view(struct block_sparse_tensor_lazy_view* v)
+{
+	ct_free(v->perm);
+	v->perm = NULL;
+	v->tensor = NULL;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Lazily transpose a view such that the i-th axis of the updated view is the perm[i]-th axis of the original view.
+///
+/// The permutation is composed with the pending permutation of the view.
+///
+void block_sparse_tensor_lazy_view_transpose(const int* restrict perm, struct block_sparse_tensor_lazy_view* restrict v)
+{
+	const int ndim = v->tensor->ndim;
+	int* perm_new = ct_malloc(ndim * sizeof(int));
+	for (int i = 0; i < ndim; i++)
+	{
+		assert(0 <= perm[i] && perm[i] < ndim);
+		perm_new[i] = v->perm[perm[i]];
+	}
+	ct_free(v->perm);
+	v->perm = perm_new;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Lazily conjugate a view (including reversal of the axis directions).
+///
+void block_sparse_tensor_lazy_view_conjugate(struct block_sparse_tensor_lazy_view* v)
+{
+	v->conj = !v->conj;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Whether the view has no pending operations, i.e., is equivalent to the referenced tensor.
+///
+bool block_sparse_tensor_lazy_view_is_trivial(const struct block_sparse_tensor_lazy_view* v)
+{
+	if (v->conj) {
+		return false;
+	}
+	for (int i = 0; i < v->tensor->ndim; i++) {
+		if (v->perm[i] != i) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Materialize a view as new block-sparse tensor 'r', applying all pending operations
+/// with a single pass over the tensor entries.
+///
+/// Memory will be allocated for 'r'.
+///
+void block_sparse_tensor_lazy_view_materialize(const struct block_sparse_tensor_lazy_view* restrict v, struct block_sparse_tensor* restrict r)
+{
+	bool identity_perm = true;
+	for (int i = 0; i < v->tensor->ndim; i++) {
+		identity_perm = identity_perm && (v->perm[i] == i);
+	}
+
+	if (identity_perm) {
+		copy_block_sparse_tensor(v->tensor, r);
+	}
+	else {
+		transpose_block_sparse_tensor(v->perm, v->tensor, r);
+	}
+
+	if (v->conj)
+	{
+		conjugate_block_sparse_tensor(r);
+		block_sparse_tensor_reverse_axis_directions(r);
+	}
 }
 
 
 //________________________________________________________________________________________________________________________
 ///
-/// \brief Multiply (leading or trailing) 'ndim_mult' axes in 's' by 'ndim_mult' axes in 't', and store result in 'r'.
-/// Whether to use leading or trailing axes is specified by axis range.
+/// \brief Contract the axes 'axes_s' of view 's' with the axes 'axes_t' of view 't' (pairwise, 'ndim_mult' axes each),
+/// absorbing the pending operations of the views into the contraction.
 ///
-/// Memory will be allocated for 'r'. Operation requires that the quantum numbers of the to-be contracted axes match,
-/// and that the axis directions are reversed between the tensors.
+/// The result is stored in 'r', and 'r_view' is set to a view of 'r' whose axes are the remaining axes of 's'
+/// followed by the remaining axes of 't', both in the order of the views. The axes of 'r' itself follow the order
+/// of the referenced tensors, such that neither the operands nor the output have to be permuted; the remaining
+/// permutation is recorded in 'r_view' and can be composed with subsequent operations.
 ///
-void block_sparse_tensor_dot(const struct block_sparse_tensor* restrict s, const enum tensor_axis_range axrange_s, const struct block_sparse_tensor* restrict t, const enum tensor_axis_range axrange_t, const int ndim_mult, struct block_sparse_tensor* restrict r)
+/// Memory will be allocated for 'r' and 'r_view'.
+///
+void block_sparse_tensor_lazy_view_contract(const struct block_sparse_tensor_lazy_view* restrict s, const int* restrict axes_s, const struct block_sparse_tensor_lazy_view* restrict t, const int* restrict axes_t, const int ndim_mult, struct block_sparse_tensor* restrict r, struct block_sparse_tensor_lazy_view* restrict r_view)
 {
-	assert(s->dtype == t->dtype);
-
-	const int shift_s = (axrange_s == TENSOR_AXIS_RANGE_LEADING ? 0 : s->ndim - ndim_mult);
-	const int shift_t = (axrange_t == TENSOR_AXIS_RANGE_LEADING ? 0 : t->ndim - ndim_mult);
-
-	// dimension and quantum number compatibility checks
 	assert(ndim_mult >= 1);
-	assert(s->ndim >= ndim_mult && t->ndim >= ndim_mult);
+	assert(s->tensor->ndim >= ndim_mult && t->tensor->ndim >= ndim_mult);
+
+	// to-be contracted axes of the referenced tensors
+	int* axes_s_base = ct_malloc(ndim_mult * sizeof(int));
+	int* axes_t_base = ct_malloc(ndim_mult * sizeof(int));
 	for (int i = 0; i < ndim_mult; i++)
 	{
-		assert(s->dim_logical[shift_s + i] ==  t->dim_logical[shift_t + i]);
-		assert(s->dim_blocks [shift_s + i] ==  t->dim_blocks [shift_t + i]);
-		assert(s->axis_dir   [shift_s + i] == -t->axis_dir   [shift_t + i]);
-		// quantum numbers must match entrywise
-		assert(qnumber_all_equal(t->dim_logical[shift_t + i], s->qnums_logical[shift_s + i], t->qnums_logical[shift_t + i]));
-		assert(qnumber_all_equal(t->dim_blocks [shift_t + i], s->qnums_blocks [shift_s + i], t->qnums_blocks [shift_t + i]));
+		assert(0 <= axes_s[i] && axes_s[i] < s->tensor->ndim);
+		assert(0 <= axes_t[i] && axes_t[i] < t->tensor->ndim);
+		axes_s_base[i] = s->perm[axes_s[i]];
+		axes_t_base[i] = t->perm[axes_t[i]];
 	}
 
-	const void* one = numeric_one(s->dtype);
-
-	if (s->ndim + t->ndim == 2*ndim_mult)
-	{
-		// special case: resulting tensor has degree 0
-
-		assert(s->ndim == ndim_mult && t->ndim == ndim_mult);
-
-		allocate_block_sparse_tensor(s->dtype, 0, NULL, NULL, NULL, r);
-		assert(r->blocks[0] != NULL);
-
-		// for each quantum number combination of the to-be contracted axes...
-		const long ncontract = integer_product(s->dim_blocks, ndim_mult);
-		long* index_contract = ct_calloc(ndim_mult, sizeof(long));
-		for (long m = 0; m < ncontract; m++, next_tensor_index(ndim_mult, s->dim_blocks, index_contract))
-		{
-			// probe whether quantum numbers in 's' sum to zero
-			qnumber qsum = 0;
-			for (int i = 0; i < s->ndim; i++)
-			{
-				qsum += s->axis_dir[i] * s->qnums_blocks[i][index_contract[i]];
-			}
-			if (qsum != 0) {
-				continue;
-			}
-
-			const long ib = tensor_index_to_offset(s->ndim, s->dim_blocks, index_contract);
-			const struct dense_tensor* bs = s->blocks[ib];
-			const struct dense_tensor* bt = t->blocks[ib];
-			assert(bs != NULL);
-			assert(bt != NULL);
-
-			// actually multiply dense tensor blocks and add result to block in 'r'
-			dense_tensor_dot_update(one, bs, axrange_s, bt, axrange_t, ndim_mult, one, r->blocks[0]);
-		}
+	struct block_sparse_tensor_dot_plan plan;
+	create_block_sparse_tensor_contract_conj_plan(s->tensor, axes_s_base, s->conj, t->tensor, axes_t_base, t->conj, ndim_mult, &plan);
 
-		ct_free(index_contract);
+	allocate_block_sparse_tensor_dot_output(&plan, r);
 
-		return;
-	}
+	block_sparse_tensor_dot_execute(&plan, numeric_one(s->tensor->dtype), s->tensor, t->tensor, numeric_zero(s->tensor->dtype), r);
 
-	const int offset_s = (axrange_s == TENSOR_AXIS_RANGE_LEADING ? ndim_mult : 0);
-	const int offset_t = (axrange_t == TENSOR_AXIS_RANGE_LEADING ? ndim_mult : 0);
+	delete_block_sparse_tensor_dot_plan(&plan);
 
-	// allocate new block-sparse tensor 'r'
+	// pending permutation of the output: position of each remaining view axis among the remaining axes of the referenced tensors
+	r_view->tensor = r;
+	r_view->perm = ct_malloc(r->ndim * sizeof(int));
+	r_view->conj = false;
+	int c = 0;
+	for (int i = 0; i < s->tensor->ndim; i++)
 	{
-		const int ndimr = s->ndim + t->ndim - 2*ndim_mult;
-
-		// logical dimensions of new tensor 'r'
-		long* r_dim_logical = ct_malloc(ndimr * sizeof(long));
-		for (int i = 0; i < s->ndim - ndim_mult; i++)
-		{
-			r_dim_logical[i] = s->dim_logical[offset_s + i];
+		bool contracted = false;
+		for (int j = 0; j < ndim_mult; j++) {
+			contracted = contracted || (axes_s[j] == i);
 		}
-		for (int i = 0; i < t->ndim - ndim_mult; i++)
-		{
-			r_dim_logical[(s->ndim - ndim_mult) + i] = t->dim_logical[offset_t + i];
-		}
-		// axis directions of new tensor 'r'
-		enum tensor_axis_direction* r_axis_dir = ct_malloc(ndimr * sizeof(enum tensor_axis_direction));
-		for (int i = 0; i < s->ndim - ndim_mult; i++)
-		{
-			r_axis_dir[i] = s->axis_dir[offset_s + i];
-		}
-		for (int i = 0; i < t->ndim - ndim_mult; i++)
-		{
-			r_axis_dir[(s->ndim - ndim_mult) + i] = t->axis_dir[offset_t + i];
-		}
-		// logical quantum numbers along each dimension
-		const qnumber** r_qnums_logical = ct_malloc(ndimr * sizeof(qnumber*));
-		for (int i = 0; i < s->ndim - ndim_mult; i++)
-		{
-			// simply copy the pointer
-			r_qnums_logical[i] = s->qnums_logical[offset_s + i];
+		if (contracted) {
+			continue;
 		}
-		for (int i = 0; i < t->ndim - ndim_mult; i++)
+		int pos = 0;
+		for (int k = 0; k < s->perm[i]; k++)
 		{
-			// simply copy the pointer
-			r_qnums_logical[(s->ndim - ndim_mult) + i] = t->qnums_logical[offset_t + i];
+			bool contracted_k = false;
+			for (int j = 0; j < ndim_mult; j++) {
+				contracted_k = contracted_k || (axes_s_base[j] == k);
+			}
+			if (!contracted_k) {
+				pos++;
+			}
 		}
-		// create new tensor 'r'
-		allocate_block_sparse_tensor(s->dtype, ndimr, r_dim_logical, r_axis_dir, r_qnums_logical, r);
-		ct_free(r_qnums_logical);
-		ct_free(r_axis_dir);
-		ct_free(r_dim_logical);
+		r_view->perm[c++] = pos;
 	}
-
-	// for each dense block of 'r'...
-	const long nblocks = integer_product(r->dim_blocks, r->ndim);
-	long* index_block_s = ct_calloc(s->ndim, sizeof(long));
-	long* index_block_t = ct_calloc(t->ndim, sizeof(long));
-	long* index_block_r = ct_calloc(r->ndim, sizeof(long));
-	for (long k = 0; k < nblocks; k++, next_tensor_index(r->ndim, r->dim_blocks, index_block_r))
+	assert(c == s->tensor->ndim - ndim_mult);
+	for (int i = 0; i < t->tensor->ndim; i++)
 	{
-		// probe whether quantum numbers in 'r' sum to zero
-		qnumber qsum = 0;
-		for (int i = 0; i < r->ndim; i++)
-		{
-			qsum += r->axis_dir[i] * r->qnums_blocks[i][index_block_r[i]];
+		bool contracted = false;
+		for (int j = 0; j < ndim_mult; j++) {
+			contracted = contracted || (axes_t[j] == i);
 		}
-		if (qsum != 0) {
+		if (contracted) {
 			continue;
 		}
-
-		struct dense_tensor* br = r->blocks[k];
-		assert(br != NULL);
-		assert(br->ndim == r->ndim);
-
-		// for each quantum number combination of the to-be contracted axes...
-		const long ncontract = integer_product(t->dim_blocks + shift_t, ndim_mult);
-		long* index_contract = ct_calloc(ndim_mult, sizeof(long));
-		for (long m = 0; m < ncontract; m++, next_tensor_index(ndim_mult, t->dim_blocks + shift_t, index_contract))
+		int pos = s->tensor->ndim - ndim_mult;
+		for (int k = 0; k < t->perm[i]; k++)
 		{
-			for (int i = 0; i < s->ndim - ndim_mult; i++) {
-				index_block_s[offset_s + i] = index_block_r[i];
-			}
-			for (int i = 0; i < ndim_mult; i++) {
-				index_block_s[shift_s + i] = index_contract[i];
-			}
-			// probe whether quantum numbers in 's' sum to zero
-			qnumber qsum = 0;
-			for (int i = 0; i < s->ndim; i++)
-			{
-				qsum += s->axis_dir[i] * s->qnums_blocks[i][index_block_s[i]];
-			}
-			if (qsum != 0) {
-				continue;
-			}
-
-			for (int i = 0; i < t->ndim - ndim_mult; i++) {
-				index_block_t[offset_t + i] = index_block_r[(s->ndim - ndim_mult) + i];
-			}
-			for (int i = 0; i < ndim_mult; i++) {
-				index_block_t[shift_t + i] = index_contract[i];
+			bool contracted_k = false;
+			for (int j = 0; j < ndim_mult; j++) {
+				contracted_k = contracted_k || (axes_t_base[j] == k);
 			}
-			// quantum numbers in 't' must now also sum to zero
-			qsum = 0;
-			for (int i = 0; i < t->ndim; i++)
-			{
-				qsum += t->axis_dir[i] * t->qnums_blocks[i][index_block_t[i]];
+			if (!contracted_k) {
+				pos++;
 			}
-			assert(qsum == 0);
-
-			const struct dense_tensor* bs = s->blocks[tensor_index_to_offset(s->ndim, s->dim_blocks, index_block_s)];
-			const struct dense_tensor* bt = t->blocks[tensor_index_to_offset(t->ndim, t->dim_blocks, index_block_t)];
-			assert(bs != NULL);
-			assert(bt != NULL);
-
-			// actually multiply dense tensor blocks and add result to 'br'
-			dense_tensor_dot_update(one, bs, axrange_s, bt, axrange_t, ndim_mult, one, br);
 		}
-
-		ct_free(index_contract);
+		r_view->perm[c++] = pos;
 	}
+	assert(c == r->ndim);
 
-	ct_free(index_block_r);
-	ct_free(index_block_t);
-	ct_free(index_block_s);
+	ct_free(axes_t_base);
+	ct_free(axes_s_base);
 }
 
 
@@ -1862,20 +3370,11 @@ void block_sparse_tensor_concatenate(const struct block_sparse_tensor* restrict
 	struct dense_tensor* tlist_blocks = ct_malloc(num_tensors * sizeof(struct dense_tensor));
 
 	// for each dense block of 'r'...
-	const long nblocks = integer_product(r->dim_blocks, r->ndim);
 	long* index_block_t = ct_calloc(r->ndim, sizeof(long));
 	long* index_block_r = ct_calloc(r->ndim, sizeof(long));
-	for (long kr = 0; kr < nblocks; kr++, next_tensor_index(r->ndim, r->dim_blocks, index_block_r))
+	for (long kr = 0; kr < r->nblocks; kr++)
 	{
-		// probe whether quantum numbers in 'r' sum to zero
-		qnumber qsum = 0;
-		for (int i = 0; i < r->ndim; i++)
-		{
-			qsum += r->axis_dir[i] * r->qnums_blocks[i][index_block_r[i]];
-		}
-		if (qsum != 0) {
-			continue;
-		}
+		block_sparse_tensor_block_index(r, kr, index_block_r);
 
 		struct dense_tensor* br = r->blocks[kr];
 		assert(br != NULL);
@@ -1899,8 +3398,7 @@ void block_sparse_tensor_concatenate(const struct block_sparse_tensor* restrict
 				continue;
 			}
 
-			const long kt = tensor_index_to_offset(tlist[j].ndim, tlist[j].dim_blocks, index_block_t);
-			const struct dense_tensor* bt = tlist[j].blocks[kt];
+			const struct dense_tensor* bt = block_sparse_tensor_find_block(&tlist[j], index_block_t);
 			assert(bt != NULL);
 
 			// copy pointers, not actual data
@@ -1922,16 +3420,16 @@ void block_sparse_tensor_concatenate(const struct block_sparse_tensor* restrict
 ///
 /// \brief Count the number of occurrences of each unique quantum number.
 ///
+/// The unique quantum numbers must be sorted in ascending order.
+///
 static void count_quantum_numbers(const qnumber* qnums_logical, const long dim, const qnumber* unique_qnums, const long num_qnums, long* qnum_counts)
 {
 	memset(qnum_counts, 0, num_qnums * sizeof(long));
 
 	for (long i = 0; i < dim; i++) {
-		for (long j = 0; j < num_qnums; j++) {
-			if (qnums_logical[i] == unique_qnums[j]) {
-				qnum_counts[j]++;
-				break;
-			}
+		const long j = find_qnumber_sorted(unique_qnums, num_qnums, qnums_logical[i]);
+		if (j >= 0) {
+			qnum_counts[j]++;
 		}
 	}
 }
@@ -2080,19 +3578,10 @@ void block_sparse_tensor_block_diag(const struct block_sparse_tensor* restrict t
 
 	// for each dense block of 'r'...
 	qnumber* qnums_block = ct_malloc(r->ndim * sizeof(qnumber));
-	const long nblocks   = integer_product(r->dim_blocks, r->ndim);
 	long* index_block_r  = ct_calloc(r->ndim, sizeof(long));
-	for (long kr = 0; kr < nblocks; kr++, next_tensor_index(r->ndim, r->dim_blocks, index_block_r))
+	for (long kr = 0; kr < r->nblocks; kr++)
 	{
-		// probe whether quantum numbers in 'r' sum to zero
-		qnumber qsum = 0;
-		for (int i = 0; i < r->ndim; i++)
-		{
-			qsum += r->axis_dir[i] * r->qnums_blocks[i][index_block_r[i]];
-		}
-		if (qsum != 0) {
-			continue;
-		}
+		block_sparse_tensor_block_index(r, kr, index_block_r);
 
 		struct dense_tensor* br = r->blocks[kr];
 		assert(br != NULL);
@@ -2175,6 +3664,145 @@ void block_sparse_tensor_block_diag(const struct block_sparse_tensor* restrict t
 }
 
 
+//________________________________________________________________________________________________________________________
+///
+/// \brief Find the dense block with block indices (i, j) of a block-sparse matrix, or return NULL if the block is not stored.
+///
+static inline struct dense_tensor* block_sparse_matrix_find_block(const struct block_sparse_tensor* t, const long i, const long j)
+{
+	assert(t->ndim == 2);
+	const long index_block[2] = { i, j };
+	return block_sparse_tensor_find_block(t, index_block);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Type of matrix decomposition of the individual dense blocks of a block-sparse matrix.
+///
+enum block_decomposition_type
+{
+	BLOCK_DECOMPOSITION_QR  = 0,  //!< QR decomposition
+	BLOCK_DECOMPOSITION_RQ  = 1,  //!< RQ decomposition
+	BLOCK_DECOMPOSITION_SVD = 2,  //!< singular value decomposition
+};
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Decomposition of a single dense block of a block-sparse matrix.
+///
+struct block_decomposition_task
+{
+	const struct dense_tensor* a;  //!< input block
+	struct dense_tensor* x;        //!< first output block ('q' for QR, 'r' for RQ, 'u' for SVD)
+	struct dense_tensor* y;        //!< second output block ('r' for QR, 'q' for RQ, 'vh' for SVD)
+	void* s;                       //!< output location of the singular values (SVD only)
+	double cost;                   //!< estimated computational cost
+};
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Comparison function for sorting block decompositions by decreasing computational cost.
+///
+static int compare_block_decomposition_tasks(const void* a, const void* b)
+{
+	const double cost_a = ((const struct block_decomposition_task*)a)->cost;
+	const double cost_b = ((const struct block_decomposition_task*)b)->cost;
+	if (cost_a > cost_b) {
+		return -1;
+	}
+	if (cost_a < cost_b) {
+		return 1;
+	}
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Perform a single block decomposition.
+///
+static int block_decomposition_task_execute(const enum block_decomposition_type type, const struct block_decomposition_task* task)
+{
+	switch (type)
+	{
+		case BLOCK_DECOMPOSITION_QR:
+		{
+			return dense_tensor_qr_fill(task->a, task->x, task->y);
+		}
+		case BLOCK_DECOMPOSITION_RQ:
+		{
+			return dense_tensor_rq_fill(task->a, task->x, task->y);
+		}
+		case BLOCK_DECOMPOSITION_SVD:
+		{
+			struct dense_tensor bs;
+			const long dim_bs[1] = { task->x->dim[1] };
+			allocate_dense_tensor(numeric_real_type(task->a->dtype), 1, dim_bs, &bs);
+			int ret = dense_tensor_svd_fill(task->a, task->x, &bs, task->y);
+			if (ret == 0) {
+				memcpy(task->s, bs.data, bs.dim[0] * sizeof_numeric_type(bs.dtype));
+			}
+			delete_dense_tensor(&bs);
+			return ret;
+		}
+		default:
+		{
+			// unknown decomposition type
+			assert(false);
+			return -1;
+		}
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Perform the independent decompositions of the dense blocks of a block-sparse matrix.
+///
+/// If the parallel mode is set to 'BLOCK_SPARSE_PARALLEL_BLOCKS', the blocks are decomposed in parallel,
+/// largest first and with dynamic scheduling, such that the decompositions of small blocks overlap with the large ones.
+/// Returns the first non-zero LAPACK error code encountered, or zero on success.
+///
+static int block_sparse_matrix_decompose_blocks(const enum block_decomposition_type type, struct block_decomposition_task* tasks, const long ntasks)
+{
+	if (block_sparse_parallel_mode == BLOCK_SPARSE_PARALLEL_BLOCKS && ntasks > 1)
+	{
+		qsort(tasks, ntasks, sizeof(struct block_decomposition_task), compare_block_decomposition_tasks);
+
+		const int blas_nthreads = block_parallel_blas_threads_single();
+		int ret = 0;
+		#pragma omp parallel for schedule(dynamic, 1)
+		for (long j = 0; j < ntasks; j++)
+		{
+			const int ret_j = block_decomposition_task_execute(type, &tasks[j]);
+			if (ret_j != 0)
+			{
+				#pragma omp critical
+				{
+					if (ret == 0) {
+						ret = ret_j;
+					}
+				}
+			}
+		}
+		block_parallel_blas_threads_restore(blas_nthreads);
+		return ret;
+	}
+
+	for (long j = 0; j < ntasks; j++)
+	{
+		int ret = block_decomposition_task_execute(type, &tasks[j]);
+		if (ret != 0) {
+			return ret;
+		}
+	}
+	return 0;
+}
+
+
 //________________________________________________________________________________________________________________________
 ///
 /// \brief Compute the logical QR decomposition of a block-sparse matrix.
@@ -2206,7 +3834,7 @@ int block_sparse_tensor_qr(const struct block_sparse_tensor* restrict a, struct
 				continue;
 			}
 
-			const struct dense_tensor* b = a->blocks[i*a->dim_blocks[1] + j];
+			const struct dense_tensor* b = block_sparse_matrix_find_block(a, i, j);
 			assert(b != NULL);
 			assert(b->ndim == 2);
 			assert(b->dtype == a->dtype);
@@ -2268,7 +3896,9 @@ int block_sparse_tensor_qr(const struct block_sparse_tensor* restrict a, struct
 		return 0;
 	}
 
-	// perform QR decompositions of the individual blocks
+	// collect QR decompositions of the individual blocks
+	struct block_decomposition_task* tasks = ct_malloc(a->nblocks * sizeof(struct block_decomposition_task));
+	long ntasks = 0;
 	for (long i = 0; i < a->dim_blocks[0]; i++)
 	{
 		for (long j = 0; j < a->dim_blocks[1]; j++)
@@ -2279,7 +3909,7 @@ int block_sparse_tensor_qr(const struct block_sparse_tensor* restrict a, struct
 				continue;
 			}
 
-			const struct dense_tensor* ba = a->blocks[i*a->dim_blocks[1] + j];
+			const struct dense_tensor* ba = block_sparse_matrix_find_block(a, i, j);
 			assert(ba != NULL);
 			assert(ba->ndim == 2);
 			assert(ba->dtype == a->dtype);
@@ -2297,20 +3927,26 @@ int block_sparse_tensor_qr(const struct block_sparse_tensor* restrict a, struct
 			assert(k < q->dim_blocks[1]);
 			assert(q->qnums_blocks[1][k] == a->qnums_blocks[1][j]);
 			assert(r->qnums_blocks[0][k] == a->qnums_blocks[1][j]);
-			struct dense_tensor* bq = q->blocks[i*q->dim_blocks[1] + k];
-			struct dense_tensor* br = r->blocks[k*r->dim_blocks[1] + j];
+			struct dense_tensor* bq = block_sparse_matrix_find_block(q, i, k);
+			struct dense_tensor* br = block_sparse_matrix_find_block(r, k, j);
 			assert(bq != NULL);
 			assert(br != NULL);
 
-			// perform QR decomposition of block
-			int ret = dense_tensor_qr_fill(ba, bq, br);
-			if (ret != 0) {
-				return ret;
-			}
+			struct block_decomposition_task* task = &tasks[ntasks++];
+			task->a = ba;
+			task->x = bq;
+			task->y = br;
+			task->s = NULL;
+			task->cost = (double)ba->dim[0] * ba->dim[1] * lmin(ba->dim[0], ba->dim[1]);
 		}
 	}
+	assert(ntasks <= a->nblocks);
 
-	return 0;
+	// perform QR decompositions of the individual blocks
+	int ret = block_sparse_matrix_decompose_blocks(BLOCK_DECOMPOSITION_QR, tasks, ntasks);
+	ct_free(tasks);
+
+	return ret;
 }
 
 
@@ -2345,7 +3981,7 @@ int block_sparse_tensor_rq(const struct block_sparse_tensor* restrict a, struct
 				continue;
 			}
 
-			const struct dense_tensor* b = a->blocks[i*a->dim_blocks[1] + j];
+			const struct dense_tensor* b = block_sparse_matrix_find_block(a, i, j);
 			assert(b != NULL);
 			assert(b->ndim == 2);
 			assert(b->dtype == a->dtype);
@@ -2407,7 +4043,9 @@ int block_sparse_tensor_rq(const struct block_sparse_tensor* restrict a, struct
 		return 0;
 	}
 
-	// perform RQ decompositions of the individual blocks
+	// collect RQ decompositions of the individual blocks
+	struct block_decomposition_task* tasks = ct_malloc(a->nblocks * sizeof(struct block_decomposition_task));
+	long ntasks = 0;
 	for (long i = 0; i < a->dim_blocks[0]; i++)
 	{
 		for (long j = 0; j < a->dim_blocks[1]; j++)
@@ -2418,7 +4056,7 @@ int block_sparse_tensor_rq(const struct block_sparse_tensor* restrict a, struct
 				continue;
 			}
 
-			const struct dense_tensor* ba = a->blocks[i*a->dim_blocks[1] + j];
+			const struct dense_tensor* ba = block_sparse_matrix_find_block(a, i, j);
 			assert(ba != NULL);
 			assert(ba->ndim == 2);
 			assert(ba->dtype == a->dtype);
@@ -2436,20 +4074,26 @@ int block_sparse_tensor_rq(const struct block_sparse_tensor* restrict a, struct
 			assert(k < q->dim_blocks[0]);
 			assert(q->qnums_blocks[0][k] == a->qnums_blocks[0][i]);
 			assert(r->qnums_blocks[1][k] == a->qnums_blocks[0][i]);
-			struct dense_tensor* br = r->blocks[i*r->dim_blocks[1] + k];
-			struct dense_tensor* bq = q->blocks[k*q->dim_blocks[1] + j];
+			struct dense_tensor* br = block_sparse_matrix_find_block(r, i, k);
+			struct dense_tensor* bq = block_sparse_matrix_find_block(q, k, j);
 			assert(br != NULL);
 			assert(bq != NULL);
 
-			// perform RQ decomposition of block
-			int ret = dense_tensor_rq_fill(ba, br, bq);
-			if (ret != 0) {
-				return ret;
-			}
+			struct block_decomposition_task* task = &tasks[ntasks++];
+			task->a = ba;
+			task->x = br;
+			task->y = bq;
+			task->s = NULL;
+			task->cost = (double)ba->dim[0] * ba->dim[1] * lmin(ba->dim[0], ba->dim[1]);
 		}
 	}
+	assert(ntasks <= a->nblocks);
 
-	return 0;
+	// perform RQ decompositions of the individual blocks
+	int ret = block_sparse_matrix_decompose_blocks(BLOCK_DECOMPOSITION_RQ, tasks, ntasks);
+	ct_free(tasks);
+
+	return ret;
 }
 
 
@@ -2484,7 +4128,7 @@ int block_sparse_tensor_svd(const struct block_sparse_tensor* restrict a, struct
 				continue;
 			}
 
-			const struct dense_tensor* b = a->blocks[i*a->dim_blocks[1] + j];
+			const struct dense_tensor* b = block_sparse_matrix_find_block(a, i, j);
 			assert(b != NULL);
 			assert(b->ndim == 2);
 			assert(b->dtype == a->dtype);
@@ -2552,7 +4196,9 @@ int block_sparse_tensor_svd(const struct block_sparse_tensor* restrict a, struct
 		return 0;
 	}
 
-	// perform SVD decompositions of the individual blocks
+	// collect SVD decompositions of the individual blocks
+	struct block_decomposition_task* tasks = ct_malloc(a->nblocks * sizeof(struct block_decomposition_task));
+	long ntasks = 0;
 	for (long i = 0; i < a->dim_blocks[0]; i++)
 	{
 		for (long j = 0; j < a->dim_blocks[1]; j++)
@@ -2563,7 +4209,7 @@ int block_sparse_tensor_svd(const struct block_sparse_tensor* restrict a, struct
 				continue;
 			}
 
-			const struct dense_tensor* ba = a->blocks[i*a->dim_blocks[1] + j];
+			const struct dense_tensor* ba = block_sparse_matrix_find_block(a, i, j);
 			assert(ba != NULL);
 			assert(ba->ndim == 2);
 			assert(ba->dtype == a->dtype);
@@ -2581,23 +4227,13 @@ int block_sparse_tensor_svd(const struct block_sparse_tensor* restrict a, struct
 			assert(k < u->dim_blocks[1]);
 			assert( u->qnums_blocks[1][k] == a->qnums_blocks[1][j]);
 			assert(vh->qnums_blocks[0][k] == a->qnums_blocks[1][j]);
-			struct dense_tensor* bu  =  u->blocks[i* u->dim_blocks[1] + k];
-			struct dense_tensor* bvh = vh->blocks[k*vh->dim_blocks[1] + j];
+			struct dense_tensor* bu  = block_sparse_matrix_find_block(u, i, k);
+			struct dense_tensor* bvh = block_sparse_matrix_find_block(vh, k, j);
 			assert(bu  != NULL);
 			assert(bvh != NULL);
 			assert(bu->dim[1] == bvh->dim[0]);
 
-			struct dense_tensor bs;
-			const long dim_bs[1] = { bu->dim[1] };
-			allocate_dense_tensor(numeric_real_type(a->dtype), 1, dim_bs, &bs);
-
-			// perform SVD decomposition of block
-			int ret = dense_tensor_svd_fill(ba, bu, &bs, bvh);
-			if (ret != 0) {
-				return ret;
-			}
-
-			// copy entries from 'bs' into output vector 's'
+			// singular values of the block are copied into output vector 's';
 			// find range of logical indices corresponding to current block
 			for (k = 0; k < u->dim_logical[1]; k++) {
 				if (u->qnums_logical[1][k] == a->qnums_blocks[1][j]) {
@@ -2605,20 +4241,27 @@ int block_sparse_tensor_svd(const struct block_sparse_tensor* restrict a, struct
 				}
 			}
 			// expecting continuous range of quantum number 'a->qnums_blocks[1][j]' along connecting axis
-			assert(k + bs.dim[0] <= u->dim_logical[1]);
-			for (long l = 0; l < bs.dim[0]; l++) {
+			assert(k + bu->dim[1] <= u->dim_logical[1]);
+			for (long l = 0; l < bu->dim[1]; l++) {
 				assert(u->qnums_logical[1][k + l] == a->qnums_blocks[1][j]);
 			}
-			assert(bs.dtype == s->dtype);
-			// casting to int8_t* to ensure that pointer arithmetic is performed in terms of bytes
-			const size_t dtype_size = sizeof_numeric_type(s->dtype);
-			memcpy((int8_t*)s->data + k * dtype_size, bs.data, bs.dim[0] * dtype_size);
 
-			delete_dense_tensor(&bs);
+			struct block_decomposition_task* task = &tasks[ntasks++];
+			task->a = ba;
+			task->x = bu;
+			task->y = bvh;
+			// casting to int8_t* to ensure that pointer arithmetic is performed in terms of bytes
+			task->s = (int8_t*)s->data + k * sizeof_numeric_type(s->dtype);
+			task->cost = (double)ba->dim[0] * ba->dim[1] * lmin(ba->dim[0], ba->dim[1]);
 		}
 	}
+	assert(ntasks <= a->nblocks);
 
-	return 0;
+	// perform SVD decompositions of the individual blocks
+	int ret = block_sparse_matrix_decompose_blocks(BLOCK_DECOMPOSITION_SVD, tasks, ntasks);
+	ct_free(tasks);
+
+	return ret;
 }
 
 
@@ -2669,33 +4312,21 @@ bool block_sparse_tensor_allclose(const struct block_sparse_tensor* restrict s,
 		assert(qnumber_all_equal(s->dim_blocks[i], s->qnums_blocks[i], t->qnums_blocks[i]));
 	}
 
+	// same quantum numbers imply same block storage layout
+	assert(s->nblocks == t->nblocks);
+
 	// for each block with matching quantum numbers...
-	const long nblocks = integer_product(s->dim_blocks, s->ndim);
-	long* index_block = ct_calloc(s->ndim, sizeof(long));
-	for (long k = 0; k < nblocks; k++, next_tensor_index(s->ndim, s->dim_blocks, index_block))
+	for (long k = 0; k < s->nblocks; k++)
 	{
-		// probe whether quantum numbers sum to zero
-		qnumber qsum = 0;
-		for (int i = 0; i < s->ndim; i++)
-		{
-			qsum += s->axis_dir[i] * s->qnums_blocks[i][index_block[i]];
-		}
-		if (qsum != 0) {
-			continue;
-		}
-
 		// retrieve and compare blocks
 		const struct dense_tensor* bs = s->blocks[k];
 		const struct dense_tensor* bt = t->blocks[k];
 		assert(bs != NULL);
 		assert(bt != NULL);
-		if (!dense_tensor_allclose(bs, bt, tol))
-		{
-			ct_free(index_block);
+		if (!dense_tensor_allclose(bs, bt, tol)) {
 			return false;
 		}
 	}
-	ct_free(index_block);
 
 	return true;
 }
@@ -2728,14 +4359,12 @@ bool block_sparse_tensor_is_identity(const struct block_sparse_tensor* t, const
 	}
 
 	// individual blocks must be identity matrices
-	const long nblocks = integer_product(t->dim_blocks, t->ndim);
-	for (long k = 0; k < nblocks; k++)
+	for (long k = 0; k < t->nblocks; k++)
 	{
 		const struct dense_tensor* b = t->blocks[k];
-		if (b != NULL) {
-			if (!dense_tensor_is_identity(b, tol)) {
-				return false;
-			}
+		assert(b != NULL);
+		if (!dense_tensor_is_identity(b, tol)) {
+			return false;
 		}
 	}
 
@@ -2785,14 +4414,11 @@ bool block_sparse_tensor_is_isometry(const struct block_sparse_tensor* t, const
 ///
 long block_sparse_tensor_num_elements_blocks(const struct block_sparse_tensor* t)
 {
-	const long nblocks = integer_product(t->dim_blocks, t->ndim);
-
 	long nelem = 0;
-	for (long k = 0; k < nblocks; k++)
+	for (long k = 0; k < t->nblocks; k++)
 	{
-		if (t->blocks[k] != NULL) {
-			nelem += dense_tensor_num_elements(t->blocks[k]);
-		}
+		assert(t->blocks[k] != NULL);
+		nelem += dense_tensor_num_elements(t->blocks[k]);
 	}
 
 	return nelem;
@@ -2807,21 +4433,27 @@ void block_sparse_tensor_serialize_entries(const struct block_sparse_tensor* t,
 {
 	const size_t dtype_size = sizeof_numeric_type(t->dtype);
 
+	if (t->data != NULL)
+	{
+		// contiguous storage already uses the serialization layout
+		if (entries != t->data) {
+			memcpy(entries, t->data, block_sparse_tensor_num_elements_blocks(t) * dtype_size);
+		}
+		return;
+	}
+
 	// casting to int8_t* to ensure that pointer arithmetic is performed in terms of bytes
 	int8_t* pentries = (int8_t*)entries;
 
-	const long nblocks = integer_product(t->dim_blocks, t->ndim);
 	long offset = 0;
-	for (long k = 0; k < nblocks; k++)
+	for (long k = 0; k < t->nblocks; k++)
 	{
 		const struct dense_tensor* b = t->blocks[k];
-		if (b != NULL)
-		{
-			assert(t->dtype == b->dtype);
-			const long nelem = dense_tensor_num_elements(b);
-			memcpy(pentries + offset * dtype_size, b->data, nelem * dtype_size);
-			offset += nelem;
-		}
+		assert(b != NULL);
+		assert(t->dtype == b->dtype);
+		const long nelem = dense_tensor_num_elements(b);
+		memcpy(pentries + offset * dtype_size, b->data, nelem * dtype_size);
+		offset += nelem;
 	}
 }
 
@@ -2834,21 +4466,27 @@ void block_sparse_tensor_deserialize_entries(struct block_sparse_tensor* t, cons
 {
 	const size_t dtype_size = sizeof_numeric_type(t->dtype);
 
+	if (t->data != NULL)
+	{
+		// contiguous storage already uses the serialization layout
+		if (entries != t->data) {
+			memcpy(t->data, entries, block_sparse_tensor_num_elements_blocks(t) * dtype_size);
+		}
+		return;
+	}
+
 	// casting to int8_t* to ensure that pointer arithmetic is performed in terms of bytes
 	const int8_t* pentries = (const int8_t*)entries;
 
-	const long nblocks = integer_product(t->dim_blocks, t->ndim);
 	long offset = 0;
-	for (long k = 0; k < nblocks; k++)
+	for (long k = 0; k < t->nblocks; k++)
 	{
 		struct dense_tensor* b = t->blocks[k];
-		if (b != NULL)
-		{
-			assert(t->dtype == b->dtype);
-			const long nelem = dense_tensor_num_elements(b);
-			memcpy(b->data, pentries + offset * dtype_size, nelem * dtype_size);
-			offset += nelem;
-		}
+		assert(b != NULL);
+		assert(t->dtype == b->dtype);
+		const long nelem = dense_tensor_num_elements(b);
+		memcpy(b->data, pentries + offset * dtype_size, nelem * dtype_size);
+		offset += nelem;
 	}
 }
 
@@ -2857,23 +4495,18 @@ void block_sparse_tensor_deserialize_entries(struct block_sparse_tensor* t, cons
 ///
 /// \brief Construct the maps from a logical index to the corresponding dense block and entry index along an axis.
 ///
+/// The unique quantum numbers must be sorted in ascending order.
+///
 static void construct_logical_to_block_index_maps(const qnumber* qnums_logical, const long dim, const qnumber* unique_qnums, const long num_qnums, long* index_map_block, long* index_map_block_entry)
 {
 	long* counter = ct_calloc(num_qnums, sizeof(long));
 
 	for (long i = 0; i < dim; i++)
 	{
-		bool found = false;
-		for (long j = 0; j < num_qnums; j++)
-		{
-			if (qnums_logical[i] == unique_qnums[j]) {
-				index_map_block[i] = j;
-				index_map_block_entry[i] = counter[j]++;
-				found = true;
-				break;
-			}
-		}
-		assert(found);
+		const long j = find_qnumber_sorted(unique_qnums, num_qnums, qnums_logical[i]);
+		assert(j >= 0);
+		index_map_block[i] = j;
+		index_map_block_entry[i] = counter[j]++;
 	}
 
 	ct_free(counter);
@@ -2933,10 +4566,9 @@ void* block_sparse_tensor_get_entry(const struct block_sparse_tensor_entry_acces
 		assert(0 <= index[i] && index[i] < acc->tensor->dim_logical[i]);
 		index_block[i] = acc->index_map_blocks[i][index[i]];
 	}
-	const long ob = tensor_index_to_offset(acc->tensor->ndim, acc->tensor->dim_blocks, index_block);
+	const struct dense_tensor* block = block_sparse_tensor_find_block(acc->tensor, index_block);
 	ct_free(index_block);
 
-	const struct dense_tensor* block = acc->tensor->blocks[ob];
 	if (block == NULL) {
 		// logical entry is zero
 		return NULL;
@@ -9,6 +9,25 @@
 #include "util.h"
 
 
+//________________________________________________________________________________________________________________________
+///
+/// \brief Parallelization strategy for block-sparse tensor operations.
+///
+enum block_sparse_parallel_mode
+{
+	BLOCK_SPARSE_PARALLEL_BLAS   = 0,  //!< process blocks sequentially, relying on a (possibly multi-threaded) BLAS library for parallelism
+	BLOCK_SPARSE_PARALLEL_BLOCKS = 1,  //!< process independent blocks in parallel using OpenMP threads; OpenBLAS is switched to a single thread meanwhile, other BLAS libraries must be configured single-threaded by the user
+};
+
+void set_block_sparse_parallel_mode(const enum block_sparse_parallel_mode mode);
+
+enum block_sparse_parallel_mode get_block_sparse_parallel_mode();
+
+void set_block_sparse_gemm_batch_threshold(const long threshold);
+
+long get_block_sparse_gemm_batch_threshold();
+
+
 //________________________________________________________________________________________________________________________
 ///
 /// \brief Block-sparse tensor structure.
@@ -17,7 +36,10 @@
 ///
 struct block_sparse_tensor
 {
-	struct dense_tensor** blocks;           //!< dense blocks, array of size dim_blocks[0] x ... x dim_blocks[ndim-1]; contains NULL pointers for non-conserved quantum numbers
+	struct dense_tensor** blocks;           //!< dense blocks with conserved quantum numbers, array of length 'nblocks', sorted lexicographically by block quantum numbers
+	void* data;                             //!< optional contiguous storage of all block entries (in the layout of 'block_sparse_tensor_serialize_entries'), or NULL if each dense block owns its entries
+	long* grid_offsets;                     //!< offset of each dense block within the virtual grid dim_blocks[0] x ... x dim_blocks[ndim-1], strictly increasing (serves as sorted lookup index)
+	long nblocks;                           //!< number of dense blocks (with conserved quantum numbers)
 	long* dim_blocks;                       //!< block dimensions
 	long* dim_logical;                      //!< logical dimensions of the overall tensor
 	enum tensor_axis_direction* axis_dir;   //!< tensor axis directions
@@ -41,8 +63,28 @@ void delete_block_sparse_tensor(struct block_sparse_tensor* t);
 
 void copy_block_sparse_tensor(const struct block_sparse_tensor* restrict src, struct block_sparse_tensor* restrict dst);
 
+void convert_block_sparse_tensor(const enum numeric_type dtype, const struct block_sparse_tensor* restrict src, struct block_sparse_tensor* restrict dst);
+
 void move_block_sparse_tensor_data(struct block_sparse_tensor* restrict src, struct block_sparse_tensor* restrict dst);
 
+void block_sparse_tensor_make_contiguous(struct block_sparse_tensor* t);
+
+void block_sparse_tensor_attach_entries(struct block_sparse_tensor* t, void* entries);
+
+void block_sparse_tensor_release_entries(struct block_sparse_tensor* t);
+
+
+//________________________________________________________________________________________________________________________
+//
+
+// views of external contiguous entries
+
+void allocate_block_sparse_tensor_view(const struct block_sparse_tensor* restrict s, struct block_sparse_tensor* restrict v);
+
+void block_sparse_tensor_view_entries(struct block_sparse_tensor* v, void* entries);
+
+void delete_block_sparse_tensor_view(struct block_sparse_tensor* v);
+
 
 //________________________________________________________________________________________________________________________
 //
@@ -50,6 +92,21 @@ void move_block_sparse_tensor_data(struct block_sparse_tensor* restrict src, str
 
 struct dense_tensor* block_sparse_tensor_get_block(const struct block_sparse_tensor* t, const qnumber* qnums);
 
+long block_sparse_tensor_find_block_position(const struct block_sparse_tensor* t, const long* index_block);
+
+struct dense_tensor* block_sparse_tensor_find_block(const struct block_sparse_tensor* t, const long* index_block);
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Retrieve the block indices (along each dimension) of the k-th dense block.
+///
+static inline void block_sparse_tensor_block_index(const struct block_sparse_tensor* t, const long k, long* restrict index_block)
+{
+	assert(0 <= k && k < t->nblocks);
+	offset_to_tensor_index(t->ndim, t->dim_blocks, t->grid_offsets[k], index_block);
+}
+
 
 //________________________________________________________________________________________________________________________
 //
@@ -58,6 +115,8 @@ struct dense_tensor* block_sparse_tensor_get_block(const struct block_sparse_ten
 
 void block_sparse_tensor_cyclic_partial_trace(const struct block_sparse_tensor* restrict t, const int ndim_trace, struct block_sparse_tensor* restrict r);
 
+void block_sparse_tensor_cyclic_partial_trace_fill(const struct block_sparse_tensor* restrict t, const int ndim_trace, struct block_sparse_tensor* restrict r);
+
 double block_sparse_tensor_norm2(const struct block_sparse_tensor* t);
 
 
@@ -96,6 +155,8 @@ void dense_to_block_sparse_tensor_entries(const struct dense_tensor* restrict t,
 
 void transpose_block_sparse_tensor(const int* restrict perm, const struct block_sparse_tensor* restrict t, struct block_sparse_tensor* restrict r);
 
+void transpose_block_sparse_tensor_fill(const int* restrict perm, const struct block_sparse_tensor* restrict t, struct block_sparse_tensor* restrict r);
+
 void conjugate_transpose_block_sparse_tensor(const int* restrict perm, const struct block_sparse_tensor* restrict t, struct block_sparse_tensor* restrict r);
 
 
@@ -128,11 +189,131 @@ void block_sparse_tensor_multiply_axis(const struct block_sparse_tensor* restric
 
 void block_sparse_tensor_dot(const struct block_sparse_tensor* restrict s, const enum tensor_axis_range axrange_s, const struct block_sparse_tensor* restrict t, const enum tensor_axis_range axrange_t, const int ndim_mult, struct block_sparse_tensor* restrict r);
 
+void block_sparse_tensor_dot_conj(const struct block_sparse_tensor* restrict s, const enum tensor_axis_range axrange_s, const bool conj_s, const struct block_sparse_tensor* restrict t, const enum tensor_axis_range axrange_t, const bool conj_t, const int ndim_mult, struct block_sparse_tensor* restrict r);
+
+void block_sparse_tensor_contract(const struct block_sparse_tensor* restrict s, const int* restrict axes_s, const struct block_sparse_tensor* restrict t, const int* restrict axes_t, const int ndim_mult, struct block_sparse_tensor* restrict r);
+
 void block_sparse_tensor_concatenate(const struct block_sparse_tensor* restrict tlist, const int num_tensors, const int i_ax, struct block_sparse_tensor* restrict r);
 
 void block_sparse_tensor_block_diag(const struct block_sparse_tensor* restrict tlist, const int num_tensors, const int* i_ax, const int ndim_block, struct block_sparse_tensor* restrict r);
 
 
+//________________________________________________________________________________________________________________________
+///
+/// \brief Single dense block multiplication within a block-sparse dot product plan,
+/// as matrix-matrix multiplication of dimensions (m x k) times (k x n).
+///
+struct block_sparse_tensor_dot_triple
+{
+	long ks;  //!< block index of 's' (position in 'blocks' array)
+	long kt;  //!< block index of 't' (position in 'blocks' array)
+	long kr;  //!< block index of 'r' (position in 'blocks' array)
+	long m;   //!< number of rows of the output block, interpreted as matrix
+	long n;   //!< number of columns of the output block, interpreted as matrix
+	long k;   //!< contraction dimension
+};
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Group of small dense block multiplications of equal shape within a block-sparse dot product plan,
+/// executed together by an internal small-matrix kernel instead of individual BLAS calls.
+///
+struct block_sparse_tensor_dot_batch
+{
+	long m;       //!< number of rows of the output blocks, interpreted as matrices
+	long n;       //!< number of columns of the output blocks, interpreted as matrices
+	long k;       //!< contraction dimension
+	long offset;  //!< offset of the first triple index of the group in 'batch_triples'
+	long count;   //!< number of block multiplications in the group
+};
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Precomputed contraction plan for 'block_sparse_tensor_dot', which can be executed repeatedly
+/// for input tensors sharing the same block sparsity structure.
+///
+/// Triples contributing to the same output block are stored contiguously, in the range
+/// 'triples[r_triple_offsets[kr]]' to 'triples[r_triple_offsets[kr + 1] - 1]'.
+///
+struct block_sparse_tensor_dot_plan
+{
+	struct block_sparse_tensor_dot_triple* triples;  //!< list of block multiplications
+	long* r_triple_offsets;                          //!< offsets into 'triples' array for each output block, of length 'nblocks_r + 1'
+	long* r_block_order;                             //!< output block indices ordered by decreasing computational cost, for load balancing
+	struct block_sparse_tensor_dot_batch* batches;   //!< groups of small block multiplications of equal shape
+	long* batch_triples;                             //!< triple indices of the small block multiplications, stored contiguously for each group
+	long nbatches;                                   //!< number of groups of small block multiplications
+	long batch_threshold;                            //!< block multiplications with 'm * n * k' up to this threshold are batched
+	long ntriples;                                   //!< number of block multiplications
+	long nblocks_s;                                  //!< number of dense blocks of 's', for consistency checks
+	long nblocks_t;                                  //!< number of dense blocks of 't', for consistency checks
+	long nblocks_r;                                  //!< number of dense blocks of 'r'
+	enum numeric_type dtype;                         //!< numeric data type
+	int* axes_s;                                     //!< to-be contracted axes of 's'
+	int* axes_t;                                     //!< to-be contracted axes of 't'
+	enum tensor_axis_range axrange_s;                //!< axis range of 's' to be contracted (unless 'general_axes' is set)
+	enum tensor_axis_range axrange_t;                //!< axis range of 't' to be contracted (unless 'general_axes' is set)
+	bool general_axes;                               //!< whether the contracted axes are arbitrary instead of a leading or trailing range
+	bool conj_s;                                     //!< whether to use the complex conjugate of 's'
+	bool conj_t;                                     //!< whether to use the complex conjugate of 't'
+	int ndim_mult;                                   //!< number of to-be contracted axes
+	int ndim_r;                                      //!< degree of output tensor 'r'
+	long* dim_logical_r;                             //!< logical dimensions of output tensor 'r'
+	enum tensor_axis_direction* axis_dir_r;          //!< axis directions of output tensor 'r'
+	qnumber** qnums_logical_r;                       //!< logical quantum numbers of output tensor 'r'
+};
+
+
+void create_block_sparse_tensor_dot_plan(const struct block_sparse_tensor* restrict s, const enum tensor_axis_range axrange_s, const struct block_sparse_tensor* restrict t, const enum tensor_axis_range axrange_t, const int ndim_mult, struct block_sparse_tensor_dot_plan* restrict plan);
+
+void create_block_sparse_tensor_dot_conj_plan(const struct block_sparse_tensor* restrict s, const enum tensor_axis_range axrange_s, const bool conj_s, const struct block_sparse_tensor* restrict t, const enum tensor_axis_range axrange_t, const bool conj_t, const int ndim_mult, struct block_sparse_tensor_dot_plan* restrict plan);
+
+void create_block_sparse_tensor_contract_plan(const struct block_sparse_tensor* restrict s, const int* restrict axes_s, const struct block_sparse_tensor* restrict t, const int* restrict axes_t, const int ndim_mult, struct block_sparse_tensor_dot_plan* restrict plan);
+
+void create_block_sparse_tensor_contract_conj_plan(const struct block_sparse_tensor* restrict s, const int* restrict axes_s, const bool conj_s, const struct block_sparse_tensor* restrict t, const int* restrict axes_t, const bool conj_t, const int ndim_mult, struct block_sparse_tensor_dot_plan* restrict plan);
+
+void delete_block_sparse_tensor_dot_plan(struct block_sparse_tensor_dot_plan* plan);
+
+void allocate_block_sparse_tensor_dot_output(const struct block_sparse_tensor_dot_plan* restrict plan, struct block_sparse_tensor* restrict r);
+
+void block_sparse_tensor_dot_execute(const struct block_sparse_tensor_dot_plan* restrict plan, const void* alpha, const struct block_sparse_tensor* restrict s, const struct block_sparse_tensor* restrict t, const void* beta, struct block_sparse_tensor* restrict r);
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Lazy view of a block-sparse tensor, recording a pending axis permutation and conjugation
+/// without touching the tensor entries.
+///
+/// The i-th axis of the view is the perm[i]-th axis of the referenced tensor. A conjugated view is logically
+/// interpreted with reversed axis directions, i.e., as the dual tensor (as for 'block_sparse_tensor_dot_conj').
+/// Contractions absorb the pending operations, and consecutive permutations are composed into a single one,
+/// such that the entries are rearranged at most once when materializing the view.
+///
+struct block_sparse_tensor_lazy_view
+{
+	const struct block_sparse_tensor* tensor;  //!< reference to tensor (not owned by the view)
+	int* perm;                                 //!< pending axis permutation
+	bool conj;                                 //!< whether the view is the complex conjugate (dual) of the permuted tensor
+};
+
+
+void create_block_sparse_tensor_lazy_view(const struct block_sparse_tensor* restrict t, struct block_sparse_tensor_lazy_view* restrict v);
+
+void delete_block_sparse_tensor_lazy_view(struct block_sparse_tensor_lazy_view* v);
+
+void block_sparse_tensor_lazy_view_transpose(const int* restrict perm, struct block_sparse_tensor_lazy_view* restrict v);
+
+void block_sparse_tensor_lazy_view_conjugate(struct block_sparse_tensor_lazy_view* v);
+
+bool block_sparse_tensor_lazy_view_is_trivial(const struct block_sparse_tensor_lazy_view* v);
+
+void block_sparse_tensor_lazy_view_materialize(const struct block_sparse_tensor_lazy_view* restrict v, struct block_sparse_tensor* restrict r);
+
+void block_sparse_tensor_lazy_view_contract(const struct block_sparse_tensor_lazy_view* restrict s, const int* restrict axes_s, const struct block_sparse_tensor_lazy_view* restrict t, const int* restrict axes_t, const int ndim_mult, struct block_sparse_tensor* restrict r, struct block_sparse_tensor_lazy_view* restrict r_view);
+
+
 //________________________________________________________________________________________________________________________
 //
 
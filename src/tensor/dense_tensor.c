@@ -8,6 +8,7 @@
 #include <cblas.h>
 #include <lapacke.h>
 #include "dense_tensor.h"
+#include "small_gemm.h"
 #include "aligned_memory.h"
 
 
@@ -74,6 +75,143 @@ void copy_dense_tensor(const struct dense_tensor* restrict src, struct dense_ten
 }
 
 
+//________________________________________________________________________________________________________________________
+///
+/// \brief Copy a tensor and convert its entries to numeric type 'dtype', allocating memory for the copy.
+///
+/// Conversions between single and double precision are supported, as well as conversions from real to complex type.
+///
+void convert_dense_tensor(const enum numeric_type dtype, const struct dense_tensor* restrict src, struct dense_tensor* restrict dst)
+{
+	allocate_dense_tensor(dtype, src->ndim, src->dim, dst);
+	convert_dense_tensor_fill(src, dst);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Copy the entries of 'src' into the already allocated tensor 'dst' of the same dimensions,
+/// converting them to the numeric type of 'dst'.
+///
+void convert_dense_tensor_fill(const struct dense_tensor* restrict src, struct dense_tensor* restrict dst)
+{
+	assert(src->ndim == dst->ndim);
+	for (int i = 0; i < src->ndim; i++) {
+		assert(src->dim[i] == dst->dim[i]);
+	}
+
+	const long nelem = dense_tensor_num_elements(src);
+
+	if (src->dtype == dst->dtype) {
+		memcpy(dst->data, src->data, nelem * sizeof_numeric_type(src->dtype));
+		return;
+	}
+
+	switch (dst->dtype)
+	{
+		case CT_SINGLE_REAL:
+		{
+			assert(src->dtype == CT_DOUBLE_REAL);
+			const double* sdata = src->data;
+			float* ddata = dst->data;
+			for (long j = 0; j < nelem; j++) {
+				ddata[j] = (float)sdata[j];
+			}
+			break;
+		}
+		case CT_DOUBLE_REAL:
+		{
+			assert(src->dtype == CT_SINGLE_REAL);
+			const float* sdata = src->data;
+			double* ddata = dst->data;
+			for (long j = 0; j < nelem; j++) {
+				ddata[j] = sdata[j];
+			}
+			break;
+		}
+		case CT_SINGLE_COMPLEX:
+		{
+			scomplex* ddata = dst->data;
+			switch (src->dtype)
+			{
+				case CT_SINGLE_REAL:
+				{
+					const float* sdata = src->data;
+					for (long j = 0; j < nelem; j++) {
+						ddata[j] = sdata[j];
+					}
+					break;
+				}
+				case CT_DOUBLE_REAL:
+				{
+					const double* sdata = src->data;
+					for (long j = 0; j < nelem; j++) {
+						ddata[j] = (float)sdata[j];
+					}
+					break;
+				}
+				case CT_DOUBLE_COMPLEX:
+				{
+					const dcomplex* sdata = src->data;
+					for (long j = 0; j < nelem; j++) {
+						ddata[j] = (scomplex)sdata[j];
+					}
+					break;
+				}
+				default:
+				{
+					// unknown data type
+					assert(false);
+				}
+			}
+			break;
+		}
+		case CT_DOUBLE_COMPLEX:
+		{
+			dcomplex* ddata = dst->data;
+			switch (src->dtype)
+			{
+				case CT_SINGLE_REAL:
+				{
+					const float* sdata = src->data;
+					for (long j = 0; j < nelem; j++) {
+						ddata[j] = sdata[j];
+					}
+					break;
+				}
+				case CT_DOUBLE_REAL:
+				{
+					const double* sdata = src->data;
+					for (long j = 0; j < nelem; j++) {
+						ddata[j] = sdata[j];
+					}
+					break;
+				}
+				case CT_SINGLE_COMPLEX:
+				{
+					const scomplex* sdata = src->data;
+					for (long j = 0; j < nelem; j++) {
+						ddata[j] = sdata[j];
+					}
+					break;
+				}
+				default:
+				{
+					// unknown data type
+					assert(false);
+				}
+			}
+			break;
+		}
+		default:
+		{
+			// unknown data type
+			assert(false);
+		}
+	}
+}
+
+
 //________________________________________________________________________________________________________________________
 ///
 /// \brief Move tensor data (without allocating new memory).
@@ -401,6 +539,34 @@ void reshape_dense_tensor(const int ndim, const long* dim, struct dense_tensor*
 }
 
 
+//________________________________________________________________________________________________________________________
+///
+/// \brief Elementwise complex conjugation of single precision complex entries.
+///
+/// Inlined separately for aligned and unaligned data, such that the compiler can use aligned vector loads and stores.
+///
+static inline void conjugate_entries_c(const long n, scomplex* restrict data)
+{
+	for (long i = 0; i < n; i++)
+	{
+		data[i] = conjf(data[i]);
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Elementwise complex conjugation of double precision complex entries.
+///
+static inline void conjugate_entries_z(const long n, dcomplex* restrict data)
+{
+	for (long i = 0; i < n; i++)
+	{
+		data[i] = conj(data[i]);
+	}
+}
+
+
 //________________________________________________________________________________________________________________________
 ///
 /// \brief Elementwise complex conjugation of a dense tensor.
@@ -420,20 +586,22 @@ void conjugate_dense_tensor(struct dense_tensor* t)
 		case CT_SINGLE_COMPLEX:
 		{
 			const long nelem = dense_tensor_num_elements(t);
-			scomplex* data = t->data;
-			for (long i = 0; i < nelem; i++)
-			{
-				data[i] = conjf(data[i]);
+			if (ct_is_aligned(t->data)) {
+				conjugate_entries_c(nelem, ct_assume_aligned(t->data));
+			}
+			else {
+				conjugate_entries_c(nelem, t->data);
 			}
 			break;
 		}
 		case CT_DOUBLE_COMPLEX:
 		{
 			const long nelem = dense_tensor_num_elements(t);
-			dcomplex* data = t->data;
-			for (long i = 0; i < nelem; i++)
-			{
-				data[i] = conj(data[i]);
+			if (ct_is_aligned(t->data)) {
+				conjugate_entries_z(nelem, ct_assume_aligned(t->data));
+			}
+			else {
+				conjugate_entries_z(nelem, t->data);
 			}
 			break;
 		}
@@ -576,125 +744,6 @@ void dense_tensor_fill_random_normal(const void* alpha, const void* shift, struc
 }
 
 
-//________________________________________________________________________________________________________________________
-///
-/// \brief Temporary data structure storing tensor dimensions and a permutation of them.
-///
-struct dimension_permutation
-{
-	long* dim;  //!< dimensions
-	int* perm;  //!< permutation
-	int ndim;   //!< number of dimensions (degree)
-};
-
-
-//________________________________________________________________________________________________________________________
-///
-/// \brief "Squeeze" dimensions by removing dimensions equal to one.
-///
-static void squeeze_dimensions(const struct dimension_permutation* restrict dp, struct dimension_permutation* restrict dp_eff)
-{
-	assert(dp->ndim >= 1);
-
-	// map from original to effective axis
-	int* axis_map = ct_malloc(dp->ndim * sizeof(int));
-	dp_eff->ndim = 0;
-	for (int i = 0; i < dp->ndim; i++)
-	{
-		assert(dp->dim[i] >= 1);
-		if (dp->dim[i] == 1) {
-			axis_map[i] = -1;
-		}
-		else {
-			axis_map[i] = dp_eff->ndim;
-			dp_eff->ndim++;
-		}
-	}
-	if (dp_eff->ndim == 0) {
-		// special case: all dimensions are 1
-		ct_free(axis_map);
-		return;
-	}
-
-	// effective dimensions
-	dp_eff->dim = ct_malloc(dp_eff->ndim * sizeof(long));
-	for (int i = 0; i < dp->ndim; i++) {
-		if (dp->dim[i] != 1) {
-			dp_eff->dim[axis_map[i]] = dp->dim[i];
-		}
-	}
-
-	// effective permutation
-	dp_eff->perm = ct_malloc(dp_eff->ndim * sizeof(int));
-	int c = 0;
-	for (int i = 0; i < dp->ndim; i++) {
-		if (dp->dim[dp->perm[i]] != 1) {
-			dp_eff->perm[c] = axis_map[dp->perm[i]];
-			c++;
-		}
-	}
-	assert(c == dp_eff->ndim);
-
-	ct_free(axis_map);
-}
-
-
-//________________________________________________________________________________________________________________________
-///
-/// \brief Fuse axes which remain neighbors after a permutation.
-///
-static void fuse_permutation_axes(const struct dimension_permutation* restrict dp, struct dimension_permutation* restrict dp_eff)
-{
-	assert(dp->ndim >= 1);
-
-	// whether to fuse with previous axis
-	int* fuse_map = ct_calloc(dp->ndim, sizeof(int));
-	for (int i = 1; i < dp->ndim; i++) {
-		if (dp->perm[i] == dp->perm[i - 1] + 1) {
-			fuse_map[dp->perm[i]] = true;
-		}
-	}
-
-	// map from original to effective axis
-	int* axis_map = ct_malloc(dp->ndim * sizeof(int));
-	dp_eff->ndim = 0;
-	for (int i = 0; i < dp->ndim; i++) {
-		if (fuse_map[i]) {
-			axis_map[i] = axis_map[i - 1];
-		}
-		else {
-			axis_map[i] = dp_eff->ndim;
-			dp_eff->ndim++;
-		}
-	}
-	assert(dp_eff->ndim >= 1);
-
-	// effective dimensions
-	dp_eff->dim = ct_malloc(dp_eff->ndim * sizeof(long));
-	for (int i = 0; i < dp_eff->ndim; i++) {
-		dp_eff->dim[i] = 1;
-	}
-	for (int i = 0; i < dp->ndim; i++) {
-		assert(dp->dim[i] >= 1);
-		dp_eff->dim[axis_map[i]] *= dp->dim[i];
-	}
-
-	// effective permutation
-	dp_eff->perm = ct_malloc(dp_eff->ndim * sizeof(int));
-	int c = 0;
-	for (int i = 0; i < dp->ndim; i++) {
-		if (!fuse_map[dp->perm[i]]) {
-			dp_eff->perm[c] = axis_map[dp->perm[i]];
-			c++;
-		}
-	}
-	assert(c == dp_eff->ndim);
-
-	ct_free(fuse_map);
-	ct_free(axis_map);
-}
-
-
 //________________________________________________________________________________________________________________________
 ///
 /// \brief Generalized transpose of a tensor 't' such that
@@ -704,8 +753,6 @@ static void fuse_permutation_axes(const struct dimension_permutation* restrict d
 ///
 void transpose_dense_tensor(const int* restrict perm, const struct dense_tensor* restrict t, struct dense_tensor* restrict r)
 {
-	// TODO: consider using an optimized library like https://github.com/springer13/hptt
-
 	if (t->ndim == 0)
 	{
 		allocate_dense_tensor(t->dtype, 0, NULL, r);
@@ -736,155 +783,363 @@ void transpose_dense_tensor(const int* restrict perm, const struct dense_tensor*
 	allocate_dense_tensor(t->dtype, t->ndim, rdim, r);
 	ct_free(rdim);
 
-	// effective dimensions and permutation
-	const struct dimension_permutation dp = { .dim = t->dim, .perm = (int*)perm, .ndim = t->ndim };
-	struct dimension_permutation dp_squeeze;
-	squeeze_dimensions(&dp, &dp_squeeze);
-	if (dp_squeeze.ndim == 0)
-	{
-		// special case: all dimensions are 1
-		// copy single scalar entry
-		memcpy(r->data, t->data, sizeof_numeric_type(t->dtype));
-		return;
-	}
-	struct dimension_permutation dp_eff;
-	fuse_permutation_axes(&dp_squeeze, &dp_eff);
-	ct_free(dp_squeeze.perm);
-	ct_free(dp_squeeze.dim);
+	transpose_dense_tensor_fill(perm, t, r);
+}
 
-	// effective dimensions of 'r'
-	long* rdim_eff = ct_malloc(dp_eff.ndim * sizeof(long));
-	for (int i = 0; i < dp_eff.ndim; i++) {
-		rdim_eff[i] = dp_eff.dim[dp_eff.perm[i]];
-	}
 
-	// stride (offset between successive elements) in new tensor 'r' corresponding to original last axis
-	int ax_r_last = -1;
-	for (int i = 0; i < dp_eff.ndim; i++) {
-		if (dp_eff.perm[i] == dp_eff.ndim - 1) {
-			ax_r_last = i;
-			break;
-		}
-	}
-	assert(ax_r_last != -1);
-	const long stride = integer_product(rdim_eff + ax_r_last + 1, dp_eff.ndim - ax_r_last - 1);
+//________________________________________________________________________________________________________________________
+///
+/// \brief Size of the two-dimensional tiles (in bytes along each direction) used by the transposition kernels,
+/// chosen such that each tile row corresponds to a cache line.
+///
+#define TRANSPOSE_TILE_BYTES 64
 
-	const long nelem = integer_product(dp_eff.dim, dp_eff.ndim);
-	assert(nelem == dense_tensor_num_elements(t));
 
-	long* index_t = ct_calloc(dp_eff.ndim,  sizeof(long));
-	long* index_r = ct_malloc(dp_eff.ndim * sizeof(long));
+//________________________________________________________________________________________________________________________
+///
+/// \brief Two-dimensional tiled transposition kernel for single precision real entries:
+/// r[ia*ldr + ib] = t[ia + ib*ldt] for 0 <= ia < na, 0 <= ib < nb.
+///
+static void transpose_tiled_kernel_s(const long na, const long nb, const float* restrict t, const long ldt, float* restrict r, const long ldr)
+{
+	const long tile = TRANSPOSE_TILE_BYTES / sizeof(float);
 
-	for (long ot = 0; ot < nelem; ot += dp_eff.dim[dp_eff.ndim - 1])
+	for (long ib = 0; ib < nb; ib += tile)
 	{
-		// map index of tensor 't' to index of tensor 'r'
-		for (int i = 0; i < dp_eff.ndim; i++) {
-			index_r[i] = index_t[dp_eff.perm[i]];
-		}
-		// convert back to offset of tensor 'r'
-		const long or = tensor_index_to_offset(dp_eff.ndim, rdim_eff, index_r);
-
-		// main copy loop
-		const long n = dp_eff.dim[dp_eff.ndim - 1];
-		switch (t->dtype)
-		{
-			case CT_SINGLE_REAL:
-			{
-				const float* tdata = (const float*)t->data + ot;
-				float*       rdata =       (float*)r->data + or;
-				////assume_aligned(tdata);
-				////assume_aligned(rdata);
-				////#pragma ivdep
-				for (long j = 0; j < n; j++)
-				{
-					rdata[j*stride] = tdata[j];
+		const long mb = lmin(tile, nb - ib);
+		for (long ia = 0; ia < na; ia += tile)
+		{
+			const long ma = lmin(tile, na - ia);
+			const float* tt = t + ia + ib*ldt;
+			float*       rr = r + ia*ldr + ib;
+			if (ma == tile && mb == tile)
+			{
+				// full tile with compile-time loop bounds, contiguous stores
+				for (long i = 0; i < tile; i++) {
+					for (long j = 0; j < tile; j++) {
+						rr[i*ldr + j] = tt[j*ldt + i];
+					}
 				}
-				break;
 			}
-			case CT_DOUBLE_REAL:
+			else
 			{
-				const double* tdata = (const double*)t->data + ot;
-				double*       rdata =       (double*)r->data + or;
-				////assume_aligned(tdata);
-				////assume_aligned(rdata);
-				////#pragma ivdep
-				for (long j = 0; j < n; j++)
-				{
-					rdata[j*stride] = tdata[j];
+				for (long i = 0; i < ma; i++) {
+					for (long j = 0; j < mb; j++) {
+						rr[i*ldr + j] = tt[j*ldt + i];
+					}
 				}
-				break;
 			}
-			case CT_SINGLE_COMPLEX:
-			{
-				const scomplex* tdata = (const scomplex*)t->data + ot;
-				scomplex*       rdata =       (scomplex*)r->data + or;
-				////assume_aligned(tdata);
-				////assume_aligned(rdata);
-				////#pragma ivdep
-				for (long j = 0; j < n; j++)
-				{
-					rdata[j*stride] = tdata[j];
+		}
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Two-dimensional tiled transposition kernel for double precision real entries:
+/// r[ia*ldr + ib] = t[ia + ib*ldt] for 0 <= ia < na, 0 <= ib < nb.
+///
+static void transpose_tiled_kernel_d(const long na, const long nb, const double* restrict t, const long ldt, double* restrict r, const long ldr)
+{
+	const long tile = TRANSPOSE_TILE_BYTES / sizeof(double);
+
+	for (long ib = 0; ib < nb; ib += tile)
+	{
+		const long mb = lmin(tile, nb - ib);
+		for (long ia = 0; ia < na; ia += tile)
+		{
+			const long ma = lmin(tile, na - ia);
+			const double* tt = t + ia + ib*ldt;
+			double*       rr = r + ia*ldr + ib;
+			if (ma == tile && mb == tile)
+			{
+				// full tile with compile-time loop bounds, contiguous stores
+				for (long i = 0; i < tile; i++) {
+					for (long j = 0; j < tile; j++) {
+						rr[i*ldr + j] = tt[j*ldt + i];
+					}
 				}
-				break;
 			}
-			case CT_DOUBLE_COMPLEX:
+			else
 			{
-				const dcomplex* tdata = (const dcomplex*)t->data + ot;
-				dcomplex*       rdata =       (dcomplex*)r->data + or;
-				////assume_aligned(tdata);
-				////assume_aligned(rdata);
-				////#pragma ivdep
-				for (long j = 0; j < n; j++)
-				{
-					rdata[j*stride] = tdata[j];
+				for (long i = 0; i < ma; i++) {
+					for (long j = 0; j < mb; j++) {
+						rr[i*ldr + j] = tt[j*ldt + i];
+					}
 				}
-				break;
-			}
-			default:
-			{
-				// unknown data type
-				assert(false);
 			}
 		}
-
-		// advance index of tensor 't' by dp_eff.dim[dp_eff.ndim - 1] elements
-		next_tensor_index(dp_eff.ndim - 1, dp_eff.dim, index_t);
 	}
-
-	// clean up
-	ct_free(rdim_eff);
-	ct_free(dp_eff.perm);
-	ct_free(dp_eff.dim);
-	ct_free(index_r);
-	ct_free(index_t);
 }
 
 
 //________________________________________________________________________________________________________________________
 ///
-/// \brief Generalized conjugate transpose of a tensor 't' such that
-/// the i-th axis in the output tensor 'r' is the perm[i]-th axis of the input tensor 't'.
-///
-/// Memory will be allocated for 'r'.
+/// \brief Two-dimensional tiled transposition kernel for single precision complex entries:
+/// r[ia*ldr + ib] = t[ia + ib*ldt] for 0 <= ia < na, 0 <= ib < nb.
 ///
-void conjugate_transpose_dense_tensor(const int* restrict perm, const struct dense_tensor* restrict t, struct dense_tensor* restrict r)
+static void transpose_tiled_kernel_c(const long na, const long nb, const scomplex* restrict t, const long ldt, scomplex* restrict r, const long ldr)
 {
-	transpose_dense_tensor(perm, t, r);
-	conjugate_dense_tensor(r);
+	const long tile = TRANSPOSE_TILE_BYTES / sizeof(scomplex);
+
+	for (long ib = 0; ib < nb; ib += tile)
+	{
+		const long mb = lmin(tile, nb - ib);
+		for (long ia = 0; ia < na; ia += tile)
+		{
+			const long ma = lmin(tile, na - ia);
+			const scomplex* tt = t + ia + ib*ldt;
+			scomplex*       rr = r + ia*ldr + ib;
+			if (ma == tile && mb == tile)
+			{
+				// full tile with compile-time loop bounds, contiguous stores
+				for (long i = 0; i < tile; i++) {
+					for (long j = 0; j < tile; j++) {
+						rr[i*ldr + j] = tt[j*ldt + i];
+					}
+				}
+			}
+			else
+			{
+				for (long i = 0; i < ma; i++) {
+					for (long j = 0; j < mb; j++) {
+						rr[i*ldr + j] = tt[j*ldt + i];
+					}
+				}
+			}
+		}
+	}
 }
 
 
 //________________________________________________________________________________________________________________________
 ///
-/// \brief Slice an axis of the tensor by selecting logical indices 'ind' along this axis.
-///
-/// Indices 'ind' can be duplicate and need not be sorted.
-/// Memory will be allocated for 'r'.
+/// \brief Two-dimensional tiled transposition kernel for double precision complex entries:
+/// r[ia*ldr + ib] = t[ia + ib*ldt] for 0 <= ia < na, 0 <= ib < nb.
 ///
-void dense_tensor_slice(const struct dense_tensor* restrict t, const int i_ax, const long* ind, const long nind, struct dense_tensor* restrict r)
+static void transpose_tiled_kernel_z(const long na, const long nb, const dcomplex* restrict t, const long ldt, dcomplex* restrict r, const long ldr)
 {
-	assert(0 <= i_ax && i_ax < t->ndim);
-	assert(nind > 0);
+	const long tile = TRANSPOSE_TILE_BYTES / sizeof(dcomplex);
+
+	for (long ib = 0; ib < nb; ib += tile)
+	{
+		const long mb = lmin(tile, nb - ib);
+		for (long ia = 0; ia < na; ia += tile)
+		{
+			const long ma = lmin(tile, na - ia);
+			const dcomplex* tt = t + ia + ib*ldt;
+			dcomplex*       rr = r + ia*ldr + ib;
+			if (ma == tile && mb == tile)
+			{
+				// full tile with compile-time loop bounds, contiguous stores
+				for (long i = 0; i < tile; i++) {
+					for (long j = 0; j < tile; j++) {
+						rr[i*ldr + j] = tt[j*ldt + i];
+					}
+				}
+			}
+			else
+			{
+				for (long i = 0; i < ma; i++) {
+					for (long j = 0; j < mb; j++) {
+						rr[i*ldr + j] = tt[j*ldt + i];
+					}
+				}
+			}
+		}
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Parameters of a generalized transposition, shared by all recursion levels.
+///
+struct transpose_params
+{
+	const long* dim;    //!< dimensions of the input tensor
+	const int* perm;    //!< axis permutation
+	long chunk;         //!< number of entries of the contiguous trailing chunk (trailing axes which are not permuted)
+	long ldt;           //!< stride in the input tensor of the axes which are innermost in the output tensor
+	long nb;            //!< fused dimension of the axes which are innermost in the output tensor
+	int ndim;           //!< number of dimensions (degree)
+	int ax_tail;        //!< first of the trailing axes which are not permuted
+	int b_start;        //!< first input tensor axis of the axes which are innermost in the output tensor
+	int b_len;          //!< number of axes which are innermost in the output tensor, or zero if the last axis of the input tensor is not permuted
+	enum numeric_type dtype;  //!< numeric data type
+};
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Recursively copy the entries of 't' to their transposed locations in 'r', starting from axis 'ax' of 't'.
+///
+/// Axes 'ax_tail' and beyond are not permuted and are copied as contiguous chunks.
+/// Consecutive axes of 't' which remain consecutive in 'r' are handled by a single loop.
+/// If the last axis of 't' is permuted, the axes which are innermost in 'r' are skipped by the recursion and
+/// handled together with the last axis of 't' by a two-dimensional tiled kernel instead.
+///
+static void transpose_dense_tensor_copy(const struct transpose_params* params, int ax, const void* restrict tdata, void* restrict rdata)
+{
+	if (params->b_len > 0 && ax == params->b_start) {
+		ax += params->b_len;
+	}
+
+	// position of axis 'ax' in 'r'
+	int p = 0;
+	while (params->perm[p] != ax) {
+		p++;
+	}
+	// number of subsequent axes which can be fused with 'ax'
+	int len = 1;
+	while (ax + len < params->ax_tail && p + len < params->ndim && params->perm[p + len] == ax + len) {
+		len++;
+	}
+
+	const long n = integer_product(params->dim + ax, len);
+	// strides (offset between successive entries) of the fused axis in 't' and 'r'
+	const long stride_t = params->chunk * integer_product(params->dim + ax + len, params->ax_tail - ax - len);
+	long stride_r = 1;
+	for (int j = p + len; j < params->ndim; j++) {
+		stride_r *= params->dim[params->perm[j]];
+	}
+
+	const size_t dtype_size = sizeof_numeric_type(params->dtype);
+
+	// casting to int8_t* to ensure that pointer arithmetic is performed in terms of bytes
+	const int8_t* pt = (const int8_t*)tdata;
+	int8_t*       pr =       (int8_t*)rdata;
+
+	if (ax + len < params->ax_tail)
+	{
+		for (long i = 0; i < n; i++)
+		{
+			transpose_dense_tensor_copy(params, ax + len, pt + i * stride_t * dtype_size, pr + i * stride_r * dtype_size);
+		}
+		return;
+	}
+
+	// innermost loop
+	if (params->b_len == 0)
+	{
+		for (long i = 0; i < n; i++)
+		{
+			memcpy(pr + i * stride_r * dtype_size, pt + i * stride_t * dtype_size, params->chunk * dtype_size);
+		}
+		return;
+	}
+	assert(stride_t == 1);
+	// two-dimensional tile formed by the last axis of 't' and the innermost axes of 'r'
+	switch (params->dtype)
+	{
+		case CT_SINGLE_REAL:
+		{
+			transpose_tiled_kernel_s(n, params->nb, tdata, params->ldt, rdata, stride_r);
+			break;
+		}
+		case CT_DOUBLE_REAL:
+		{
+			transpose_tiled_kernel_d(n, params->nb, tdata, params->ldt, rdata, stride_r);
+			break;
+		}
+		case CT_SINGLE_COMPLEX:
+		{
+			transpose_tiled_kernel_c(n, params->nb, tdata, params->ldt, rdata, stride_r);
+			break;
+		}
+		case CT_DOUBLE_COMPLEX:
+		{
+			transpose_tiled_kernel_z(n, params->nb, tdata, params->ldt, rdata, stride_r);
+			break;
+		}
+		default:
+		{
+			// unknown data type
+			assert(false);
+		}
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Generalized transpose of a tensor 't' such that
+/// the i-th axis in the output tensor 'r' is the perm[i]-th axis of the input tensor 't'.
+///
+/// 'r' must have been allocated beforehand. The function does not allocate any memory.
+///
+void transpose_dense_tensor_fill(const int* restrict perm, const struct dense_tensor* restrict t, struct dense_tensor* restrict r)
+{
+	assert(t->dtype == r->dtype);
+	assert(t->ndim  == r->ndim);
+	for (int i = 0; i < t->ndim; i++) {
+		assert(r->dim[i] == t->dim[perm[i]]);
+	}
+
+	struct transpose_params params = {
+		.dim   = t->dim,
+		.perm  = perm,
+		.ndim  = t->ndim,
+		.dtype = t->dtype,
+	};
+
+	// trailing axes which are not permuted
+	params.ax_tail = t->ndim;
+	while (params.ax_tail > 0 && perm[params.ax_tail - 1] == params.ax_tail - 1) {
+		params.ax_tail--;
+	}
+	params.chunk = integer_product(t->dim + params.ax_tail, t->ndim - params.ax_tail);
+
+	if (params.ax_tail == 0)
+	{
+		// identity permutation
+		memcpy(r->data, t->data, params.chunk * sizeof_numeric_type(t->dtype));
+		return;
+	}
+
+	if (params.ax_tail == t->ndim)
+	{
+		// consecutive axes of 't' which are innermost in 'r'
+		params.b_len = 1;
+		while (params.b_len < t->ndim && perm[t->ndim - 1 - params.b_len] == perm[t->ndim - 1] - params.b_len) {
+			params.b_len++;
+		}
+		params.b_start = perm[t->ndim - 1] - params.b_len + 1;
+		// cannot contain the last axis of 't', since it is permuted
+		assert(params.b_start + params.b_len < t->ndim);
+		params.nb  = integer_product(t->dim + params.b_start, params.b_len);
+		params.ldt = integer_product(t->dim + params.b_start + params.b_len, t->ndim - params.b_start - params.b_len);
+	}
+
+	transpose_dense_tensor_copy(&params, 0, t->data, r->data);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Generalized conjugate transpose of a tensor 't' such that
+/// the i-th axis in the output tensor 'r' is the perm[i]-th axis of the input tensor 't'.
+///
+/// Memory will be allocated for 'r'.
+///
+void conjugate_transpose_dense_tensor(const int* restrict perm, const struct dense_tensor* restrict t, struct dense_tensor* restrict r)
+{
+	transpose_dense_tensor(perm, t, r);
+	conjugate_dense_tensor(r);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Slice an axis of the tensor by selecting logical indices 'ind' along this axis.
+///
+/// Indices 'ind' can be duplicate and need not be sorted.
+/// Memory will be allocated for 'r'.
+///
+void dense_tensor_slice(const struct dense_tensor* restrict t, const int i_ax, const long* ind, const long nind, struct dense_tensor* restrict r)
+{
+	assert(0 <= i_ax && i_ax < t->ndim);
+	assert(nind > 0);
 
 	long* rdim = ct_malloc(t->ndim * sizeof(long));
 	memcpy(rdim, t->dim, t->ndim * sizeof(long));
@@ -1353,6 +1608,17 @@ void dense_tensor_multiply_axis_update(const void* alpha, const struct dense_ten
 	const long k = s->dim[i_ax];
 	const long n = integer_product(&s->dim[i_ax + 1], s->ndim - i_ax - 1);
 
+	if (small_k_gemm_applicable(k))
+	{
+		// typically a physical dimension: use specialized kernels
+		const size_t dtype_size = sizeof_numeric_type(s->dtype);
+		for (long j = 0; j < dim_outer; j++)
+		{
+			small_k_gemm(s->dtype, transa, CblasNoTrans, m, n, k, alpha, t->data, tdt, (const int8_t*)s->data + j*dim_inner_s*dtype_size, n, beta, (int8_t*)r->data + j*dim_inner_r*dtype_size, n);
+		}
+		return;
+	}
+
 	switch (s->dtype)
 	{
 		case CT_SINGLE_REAL:
@@ -1462,6 +1728,13 @@ void dense_tensor_dot(const struct dense_tensor* restrict s, const enum tensor_a
 	const long n = (axrange_t == TENSOR_AXIS_RANGE_LEADING ? tdt : ldt);
 	const long k = (axrange_s == TENSOR_AXIS_RANGE_LEADING ? lds : tds);
 	assert(k == (axrange_t == TENSOR_AXIS_RANGE_LEADING ? ldt : tdt));
+
+	if (small_k_gemm_applicable(k))
+	{
+		small_k_gemm(s->dtype, transa, transb, m, n, k, numeric_one(s->dtype), s->data, tds, t->data, tdt, numeric_zero(s->dtype), r->data, n);
+		return;
+	}
+
 	switch (s->dtype)
 	{
 		case CT_SINGLE_REAL:
@@ -1507,6 +1780,25 @@ void dense_tensor_dot(const struct dense_tensor* restrict s, const enum tensor_a
 ///
 void dense_tensor_dot_update(const void* alpha, const struct dense_tensor* restrict s, const enum tensor_axis_range axrange_s, const struct dense_tensor* restrict t, const enum tensor_axis_range axrange_t, const int ndim_mult, const void* beta, struct dense_tensor* restrict r)
 {
+	dense_tensor_dot_conj_update(alpha, s, axrange_s, false, t, axrange_t, false, ndim_mult, beta, r);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Multiply (leading or trailing) 'ndim_mult' axes in 's' by 'ndim_mult' axes in 't', optionally using the complex conjugate
+/// of 's' or 't', scale by 'alpha' and add result to 'r' scaled by beta: r <- alpha * op(s) @ op(t) + beta * r.
+///
+/// Conjugation is realized by the 'CblasConjTrans' operation (or on the fly by the small-k kernels), such that no conjugated copy
+/// of the tensor entries is required. Hence a conjugated 's' requires leading and a conjugated 't' trailing to-be contracted axes.
+///
+/// Assuming that 'r' has the appropriate dimensions.
+///
+void dense_tensor_dot_conj_update(const void* alpha, const struct dense_tensor* restrict s, const enum tensor_axis_range axrange_s, const bool conj_s, const struct dense_tensor* restrict t, const enum tensor_axis_range axrange_t, const bool conj_t, const int ndim_mult, const void* beta, struct dense_tensor* restrict r)
+{
+	assert(!conj_s || axrange_s == TENSOR_AXIS_RANGE_LEADING);
+	assert(!conj_t || axrange_t == TENSOR_AXIS_RANGE_TRAILING);
+
 	// data types must agree
 	assert(s->dtype == t->dtype);
 	assert(s->dtype == r->dtype);
@@ -1543,8 +1835,8 @@ void dense_tensor_dot_update(const void* alpha, const struct dense_tensor* restr
 	// trailing dimension of 't' as a matrix
 	const long tdt = integer_product(&t->dim[nldt], t->ndim - nldt);
 
-	const CBLAS_TRANSPOSE transa = (axrange_s == TENSOR_AXIS_RANGE_LEADING ? CblasTrans : CblasNoTrans);
-	const CBLAS_TRANSPOSE transb = (axrange_t == TENSOR_AXIS_RANGE_LEADING ? CblasNoTrans : CblasTrans);
+	const CBLAS_TRANSPOSE transa = (axrange_s == TENSOR_AXIS_RANGE_LEADING ? (conj_s ? CblasConjTrans : CblasTrans) : CblasNoTrans);
+	const CBLAS_TRANSPOSE transb = (axrange_t == TENSOR_AXIS_RANGE_LEADING ? CblasNoTrans : (conj_t ? CblasConjTrans : CblasTrans));
 
 	// matrix-matrix multiplication
 	const long m = (axrange_s == TENSOR_AXIS_RANGE_LEADING ? tds : lds);
@@ -1552,6 +1844,12 @@ void dense_tensor_dot_update(const void* alpha, const struct dense_tensor* restr
 	const long k = (axrange_s == TENSOR_AXIS_RANGE_LEADING ? lds : tds);
 	assert(k == (axrange_t == TENSOR_AXIS_RANGE_LEADING ? ldt : tdt));
 
+	if (small_k_gemm_applicable(k))
+	{
+		small_k_gemm(s->dtype, transa, transb, m, n, k, alpha, s->data, tds, t->data, tdt, beta, r->data, n);
+		return;
+	}
+
 	// matrix-matrix multiplication
 	switch (s->dtype)
 	{
@@ -1584,6 +1882,484 @@ void dense_tensor_dot_update(const void* alpha, const struct dense_tensor* restr
 }
 
 
+//________________________________________________________________________________________________________________________
+///
+/// \brief Maximum tensor degree supported by the strided matrix-matrix multiplication path of a general contraction;
+/// contractions of tensors with larger degree fall back to explicitly permuting the operands.
+///
+#define CONTRACT_MAX_NDIM 32
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Outer loop over a tensor axis which is not absorbed into the matrix-matrix multiplications of a general contraction.
+///
+struct contract_loop
+{
+	long dim;       //!< dimension of the axis
+	long stride_s;  //!< stride of the axis in 's' (zero if not an axis of 's')
+	long stride_t;  //!< stride of the axis in 't' (zero if not an axis of 't')
+	long stride_r;  //!< stride of the axis in 'r' (zero for contracted axes)
+};
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Mapping of a general contraction to nested loops of strided matrix-matrix multiplications.
+///
+struct contract_gemm_layout
+{
+	struct contract_loop loops[2 * CONTRACT_MAX_NDIM];  //!< outer loops: batch loops over output axes, followed by summation loops over contracted axes
+	int nloops_batch;                                   //!< number of batch loops
+	int nloops_sum;                                     //!< number of summation loops
+	CBLAS_TRANSPOSE transa;                             //!< transposition of 's' as matrix
+	CBLAS_TRANSPOSE transb;                             //!< transposition of 't' as matrix
+	long m, n, k;                                       //!< matrix dimensions
+	long lda, ldb, ldc;                                 //!< leading dimensions
+};
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Analyze the strides of a general contraction of 's' and 't' and map it to (batched) matrix-matrix multiplications
+/// without permuting any tensor entries.
+///
+/// The rows of the matrix multiplication are formed by a group of consecutive free axes of 's', the columns by the trailing
+/// group of consecutive free axes of 't', and the summation by a group of contracted axes which are consecutive in both 's' and 't'.
+/// All remaining axes are realized by outer loops. Returns false if no such mapping exists.
+///
+static bool contract_gemm_layout_analyze(const struct dense_tensor* restrict s, const int* restrict axes_s, const struct dense_tensor* restrict t, const int* restrict axes_t, const int ndim_mult, struct contract_gemm_layout* restrict layout)
+{
+	if (s->ndim > CONTRACT_MAX_NDIM || t->ndim > CONTRACT_MAX_NDIM) {
+		return false;
+	}
+
+	// contraction partner of each axis, or -1 for free axes
+	int partner_s[CONTRACT_MAX_NDIM];
+	int partner_t[CONTRACT_MAX_NDIM];
+	for (int i = 0; i < s->ndim; i++) {
+		partner_s[i] = -1;
+	}
+	for (int i = 0; i < t->ndim; i++) {
+		partner_t[i] = -1;
+	}
+	for (int i = 0; i < ndim_mult; i++) {
+		partner_s[axes_s[i]] = axes_t[i];
+		partner_t[axes_t[i]] = axes_s[i];
+	}
+
+	// strides of 's' and 't'
+	long stride_s[CONTRACT_MAX_NDIM];
+	long stride_t[CONTRACT_MAX_NDIM];
+	stride_s[s->ndim - 1] = 1;
+	for (int i = s->ndim - 2; i >= 0; i--) {
+		stride_s[i] = stride_s[i + 1] * s->dim[i + 1];
+	}
+	stride_t[t->ndim - 1] = 1;
+	for (int i = t->ndim - 2; i >= 0; i--) {
+		stride_t[i] = stride_t[i + 1] * t->dim[i + 1];
+	}
+
+	// strides of the free axes in the output tensor 'r', which consists of the free axes of 's' followed by the free axes of 't'
+	long rstride_s[CONTRACT_MAX_NDIM];
+	long rstride_t[CONTRACT_MAX_NDIM];
+	long stride_r = 1;
+	for (int i = t->ndim - 1; i >= 0; i--) {
+		if (partner_t[i] < 0) {
+			rstride_t[i] = stride_r;
+			stride_r *= t->dim[i];
+		}
+	}
+	for (int i = s->ndim - 1; i >= 0; i--) {
+		if (partner_s[i] < 0) {
+			rstride_s[i] = stride_r;
+			stride_r *= s->dim[i];
+		}
+	}
+
+	// column group: consecutive free axes of 't' ending at its last free axis, such that the group is trailing in 'r'
+	int n_end = t->ndim;
+	while (n_end > 0 && partner_t[n_end - 1] >= 0) {
+		n_end--;
+	}
+	int n_begin = n_end;
+	while (n_begin > 0 && partner_t[n_begin - 1] < 0) {
+		n_begin--;
+	}
+
+	// an innermost contracted axis of 's' or 't' must be part of the summation group
+	int k_seed = -1;
+	if (partner_s[s->ndim - 1] >= 0) {
+		k_seed = s->ndim - 1;
+	}
+	if (partner_t[t->ndim - 1] >= 0)
+	{
+		if (k_seed >= 0 && partner_s[k_seed] != t->ndim - 1) {
+			return false;
+		}
+		k_seed = partner_t[t->ndim - 1];
+	}
+
+	// summation group: contracted axes which are consecutive and in the same order in 's' and 't', with largest dimension
+	int k_begin = -1;
+	int k_end   = -1;
+	long k = 0;
+	for (int i = 0; i < s->ndim; i++)
+	{
+		if (partner_s[i] < 0 || (k_seed >= 0 && i != k_seed)) {
+			continue;
+		}
+		int lo = i;
+		while (lo > 0 && partner_s[lo - 1] >= 0 && partner_s[lo - 1] == partner_s[i] - (i - lo + 1)) {
+			lo--;
+		}
+		int hi = i + 1;
+		while (hi < s->ndim && partner_s[hi] >= 0 && partner_s[hi] == partner_s[i] + (hi - i)) {
+			hi++;
+		}
+		const long kdim = integer_product(s->dim + lo, hi - lo);
+		if (kdim > k) {
+			k_begin = lo;
+			k_end   = hi;
+			k = kdim;
+		}
+	}
+	if (k_begin < 0) {
+		return false;
+	}
+
+	// row group: consecutive free axes of 's' including its innermost axis if free, and otherwise with largest dimension
+	int m_begin = 0;
+	int m_end   = 0;
+	long m = 0;
+	for (int i = 0; i < s->ndim; i++)
+	{
+		if (partner_s[i] >= 0 || (i > 0 && partner_s[i - 1] < 0)) {
+			continue;
+		}
+		int j = i + 1;
+		while (j < s->ndim && partner_s[j] < 0) {
+			j++;
+		}
+		const long mdim = integer_product(s->dim + i, j - i);
+		if (j == s->ndim || mdim > m) {
+			m_begin = i;
+			m_end   = j;
+			m = mdim;
+		}
+	}
+	if (m_begin == m_end) {
+		m = 1;
+	}
+	const long n = integer_product(t->dim + n_begin, n_end - n_begin);
+
+	// 's' as (m x k) matrix
+	const long stride_s_k = stride_s[k_end - 1];
+	const long stride_s_m = (m_begin < m_end ? stride_s[m_end - 1] : 0);
+	if (m_begin == m_end || (stride_s_m == 1 && stride_s_k >= m)) {
+		layout->transa = CblasTrans;
+		layout->lda = lmax(stride_s_k, 1);
+	}
+	else if (stride_s_k == 1 && stride_s_m >= k) {
+		layout->transa = CblasNoTrans;
+		layout->lda = stride_s_m;
+	}
+	else {
+		return false;
+	}
+
+	// 't' as (k x n) matrix
+	const long stride_t_k = stride_t[partner_s[k_end - 1]];
+	const long stride_t_n = (n_begin < n_end ? stride_t[n_end - 1] : 0);
+	if (n_begin == n_end || (stride_t_n == 1 && stride_t_k >= n)) {
+		layout->transb = CblasNoTrans;
+		layout->ldb = lmax(stride_t_k, 1);
+	}
+	else if (stride_t_k == 1 && stride_t_n >= k) {
+		layout->transb = CblasTrans;
+		layout->ldb = stride_t_n;
+	}
+	else {
+		return false;
+	}
+
+	layout->m = m;
+	layout->n = n;
+	layout->k = k;
+	// row stride of 'r' as matrix
+	layout->ldc = (m_begin < m_end ? rstride_s[m_end - 1] : lmax(n, 1));
+
+	// batch loops over free axes not absorbed into the matrix multiplication
+	int nloops = 0;
+	for (int i = 0; i < s->ndim; i++)
+	{
+		if (partner_s[i] >= 0 || (m_begin <= i && i < m_end) || s->dim[i] == 1) {
+			continue;
+		}
+		layout->loops[nloops++] = (struct contract_loop) { .dim = s->dim[i], .stride_s = stride_s[i], .stride_t = 0, .stride_r = rstride_s[i] };
+	}
+	for (int i = 0; i < t->ndim; i++)
+	{
+		if (partner_t[i] >= 0 || (n_begin <= i && i < n_end) || t->dim[i] == 1) {
+			continue;
+		}
+		layout->loops[nloops++] = (struct contract_loop) { .dim = t->dim[i], .stride_s = 0, .stride_t = stride_t[i], .stride_r = rstride_t[i] };
+	}
+	layout->nloops_batch = nloops;
+	// summation loops over contracted axes not absorbed into the matrix multiplication
+	for (int i = 0; i < s->ndim; i++)
+	{
+		if (partner_s[i] < 0 || (k_begin <= i && i < k_end) || s->dim[i] == 1) {
+			continue;
+		}
+		layout->loops[nloops++] = (struct contract_loop) { .dim = s->dim[i], .stride_s = stride_s[i], .stride_t = stride_t[partner_s[i]], .stride_r = 0 };
+	}
+	layout->nloops_sum = nloops - layout->nloops_batch;
+
+	return true;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief General matrix-matrix multiplication using row-major storage convention.
+///
+static inline void dense_gemm(const enum numeric_type dtype, const CBLAS_TRANSPOSE transa, const CBLAS_TRANSPOSE transb, const long m, const long n, const long k,
+	const void* alpha, const void* restrict a, const long lda, const void* restrict b, const long ldb, const void* beta, void* restrict c, const long ldc)
+{
+	if (small_k_gemm_applicable(k))
+	{
+		small_k_gemm(dtype, transa, transb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+		return;
+	}
+
+	switch (dtype)
+	{
+		case CT_SINGLE_REAL:
+		{
+			cblas_sgemm(CblasRowMajor, transa, transb, m, n, k, *((float*)alpha), a, lda, b, ldb, *((float*)beta), c, ldc);
+			break;
+		}
+		case CT_DOUBLE_REAL:
+		{
+			cblas_dgemm(CblasRowMajor, transa, transb, m, n, k, *((double*)alpha), a, lda, b, ldb, *((double*)beta), c, ldc);
+			break;
+		}
+		case CT_SINGLE_COMPLEX:
+		{
+			cblas_cgemm(CblasRowMajor, transa, transb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+			break;
+		}
+		case CT_DOUBLE_COMPLEX:
+		{
+			cblas_zgemm(CblasRowMajor, transa, transb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+			break;
+		}
+		default:
+		{
+			// unknown data type
+			assert(false);
+		}
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Recursively run the outer loops of a general contraction and perform the innermost matrix-matrix multiplications.
+///
+/// For the summation loops, 'beta' is only applied by the first contribution to an output entry.
+///
+static void contract_gemm_execute(const struct contract_gemm_layout* restrict layout, const int level, const enum numeric_type dtype,
+	const void* alpha, const int8_t* restrict sdata, const int8_t* restrict tdata, const void* beta, int8_t* restrict rdata)
+{
+	if (level == layout->nloops_batch + layout->nloops_sum)
+	{
+		dense_gemm(dtype, layout->transa, layout->transb, layout->m, layout->n, layout->k,
+			alpha, sdata, layout->lda, tdata, layout->ldb, beta, rdata, layout->ldc);
+		return;
+	}
+
+	const struct contract_loop* loop = &layout->loops[level];
+	const size_t dtype_size = sizeof_numeric_type(dtype);
+	const bool summation = (level >= layout->nloops_batch);
+	for (long i = 0; i < loop->dim; i++)
+	{
+		contract_gemm_execute(layout, level + 1, dtype, alpha,
+			sdata + i * loop->stride_s * dtype_size,
+			tdata + i * loop->stride_t * dtype_size,
+			(summation && i > 0 ? numeric_one(dtype) : beta),
+			rdata + i * loop->stride_r * dtype_size);
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Contract the axes 'axes_s' of 's' with the axes 'axes_t' of 't' (pairwise, 'ndim_mult' axes each), and store result in 'r'.
+///
+/// The axes of 'r' are the remaining axes of 's' followed by the remaining axes of 't', both in their original order.
+/// Memory will be allocated for 'r'.
+///
+void dense_tensor_contract(const struct dense_tensor* restrict s, const int* restrict axes_s, const struct dense_tensor* restrict t, const int* restrict axes_t, const int ndim_mult, struct dense_tensor* restrict r)
+{
+	// data types must agree
+	assert(s->dtype == t->dtype);
+
+	assert(ndim_mult >= 1);
+	assert(s->ndim >= ndim_mult && t->ndim >= ndim_mult);
+
+	// dimensions of new tensor 'r'
+	const int ndimr = s->ndim + t->ndim - 2*ndim_mult;
+	long* rdim = ct_malloc(lmax(ndimr, 1) * sizeof(long));
+	int c = 0;
+	for (int i = 0; i < s->ndim; i++)
+	{
+		bool contracted = false;
+		for (int j = 0; j < ndim_mult; j++) {
+			contracted = contracted || (axes_s[j] == i);
+		}
+		if (!contracted) {
+			rdim[c++] = s->dim[i];
+		}
+	}
+	for (int i = 0; i < t->ndim; i++)
+	{
+		bool contracted = false;
+		for (int j = 0; j < ndim_mult; j++) {
+			contracted = contracted || (axes_t[j] == i);
+		}
+		if (!contracted) {
+			rdim[c++] = t->dim[i];
+		}
+	}
+	assert(c == ndimr);
+	// create new tensor 'r'
+	allocate_dense_tensor(s->dtype, ndimr, rdim, r);
+	ct_free(rdim);
+
+	dense_tensor_contract_update(numeric_one(s->dtype), s, axes_s, t, axes_t, ndim_mult, numeric_zero(s->dtype), r);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Contract the axes 'axes_s' of 's' with the axes 'axes_t' of 't' (pairwise, 'ndim_mult' axes each), scale by 'alpha'
+/// and add result to 'r' scaled by beta: r <- alpha * contract(s, t) + beta * r.
+///
+/// The axes of 'r' are the remaining axes of 's' followed by the remaining axes of 't', both in their original order,
+/// and 'r' must have the appropriate dimensions. Whenever the strides permit it, the contraction is performed by
+/// (batched) matrix-matrix multiplications operating directly on the tensor entries; otherwise the operands are
+/// permuted into temporary tensors first.
+///
+void dense_tensor_contract_update(const void* alpha, const struct dense_tensor* restrict s, const int* restrict axes_s, const struct dense_tensor* restrict t, const int* restrict axes_t, const int ndim_mult, const void* beta, struct dense_tensor* restrict r)
+{
+	dense_tensor_contract_conj_update(alpha, s, axes_s, false, t, axes_t, false, ndim_mult, beta, r);
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Contract the axes 'axes_s' of 's' with the axes 'axes_t' of 't' (pairwise, 'ndim_mult' axes each), optionally using
+/// the complex conjugate entries of 's' and/or 't', scale by 'alpha' and add result to 'r' scaled by beta.
+///
+/// The conjugation is absorbed into the matrix-matrix multiplications whenever the strides map the conjugated operand
+/// to a transposed matrix; otherwise the conjugated operand is permuted such that its contracted axes are leading ('s')
+/// or trailing ('t'), respectively, which again admits a conjugate-transposed matrix multiplication.
+///
+void dense_tensor_contract_conj_update(const void* alpha, const struct dense_tensor* restrict s, const int* restrict axes_s, bool conj_s, const struct dense_tensor* restrict t, const int* restrict axes_t, bool conj_t, const int ndim_mult, const void* beta, struct dense_tensor* restrict r)
+{
+	// data types must agree
+	assert(s->dtype == t->dtype);
+	assert(s->dtype == r->dtype);
+
+	assert(ndim_mult >= 1);
+	assert(s->ndim >= ndim_mult && t->ndim >= ndim_mult);
+	assert(r->ndim == s->ndim + t->ndim - 2*ndim_mult);
+	for (int i = 0; i < ndim_mult; i++)
+	{
+		assert(0 <= axes_s[i] && axes_s[i] < s->ndim);
+		assert(0 <= axes_t[i] && axes_t[i] < t->ndim);
+		assert(s->dim[axes_s[i]] == t->dim[axes_t[i]]);
+	}
+
+	if (dense_tensor_num_elements(r) == 0) {
+		return;
+	}
+
+	// conjugation has no effect on real entries
+	if (s->dtype == CT_SINGLE_REAL || s->dtype == CT_DOUBLE_REAL)
+	{
+		conj_s = false;
+		conj_t = false;
+	}
+
+	struct contract_gemm_layout layout;
+	if (dense_tensor_num_elements(s) > 0 && contract_gemm_layout_analyze(s, axes_s, t, axes_t, ndim_mult, &layout)
+		&& (!conj_s || layout.transa == CblasTrans) && (!conj_t || layout.transb == CblasTrans))
+	{
+		if (conj_s) {
+			layout.transa = CblasConjTrans;
+		}
+		if (conj_t) {
+			layout.transb = CblasConjTrans;
+		}
+		contract_gemm_execute(&layout, 0, s->dtype, alpha, s->data, t->data, beta, r->data);
+		return;
+	}
+
+	// fall back to permuting 's' to [free axes, contracted axes] and 't' to [contracted axes, free axes],
+	// or to the reversed arrangement in case of conjugation
+	int* perm_s = ct_malloc(s->ndim * sizeof(int));
+	int* perm_t = ct_malloc(t->ndim * sizeof(int));
+	const int offset_s = (conj_s ? ndim_mult : 0);
+	int cs = 0;
+	for (int i = 0; i < s->ndim; i++)
+	{
+		bool contracted = false;
+		for (int j = 0; j < ndim_mult; j++) {
+			contracted = contracted || (axes_s[j] == i);
+		}
+		if (!contracted) {
+			perm_s[offset_s + cs++] = i;
+		}
+	}
+	assert(cs == s->ndim - ndim_mult);
+	const int offset_t = (conj_t ? 0 : ndim_mult);
+	int ct = 0;
+	for (int i = 0; i < t->ndim; i++)
+	{
+		bool contracted = false;
+		for (int j = 0; j < ndim_mult; j++) {
+			contracted = contracted || (axes_t[j] == i);
+		}
+		if (!contracted) {
+			perm_t[offset_t + ct++] = i;
+		}
+	}
+	assert(ct == t->ndim - ndim_mult);
+	for (int j = 0; j < ndim_mult; j++)
+	{
+		perm_s[(conj_s ? 0 : cs) + j] = axes_s[j];
+		perm_t[(conj_t ? ct : 0) + j] = axes_t[j];
+	}
+
+	struct dense_tensor s_perm;
+	struct dense_tensor t_perm;
+	transpose_dense_tensor(perm_s, s, &s_perm);
+	transpose_dense_tensor(perm_t, t, &t_perm);
+
+	dense_tensor_dot_conj_update(alpha,
+		&s_perm, conj_s ? TENSOR_AXIS_RANGE_LEADING  : TENSOR_AXIS_RANGE_TRAILING, conj_s,
+		&t_perm, conj_t ? TENSOR_AXIS_RANGE_TRAILING : TENSOR_AXIS_RANGE_LEADING,  conj_t, ndim_mult, beta, r);
+
+	delete_dense_tensor(&t_perm);
+	delete_dense_tensor(&s_perm);
+	ct_free(perm_t);
+	ct_free(perm_s);
+}
+
+
 //________________________________________________________________________________________________________________________
 ///
 /// \brief Compute the Kronecker product of two tensors; the tensors must have the same degree.
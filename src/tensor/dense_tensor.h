@@ -34,6 +34,10 @@ void delete_dense_tensor(struct dense_tensor* t);
 
 void copy_dense_tensor(const struct dense_tensor* restrict src, struct dense_tensor* restrict dst);
 
+void convert_dense_tensor(const enum numeric_type dtype, const struct dense_tensor* restrict src, struct dense_tensor* restrict dst);
+
+void convert_dense_tensor_fill(const struct dense_tensor* restrict src, struct dense_tensor* restrict dst);
+
 void move_dense_tensor_data(struct dense_tensor* restrict src, struct dense_tensor* restrict dst);
 
 
@@ -68,6 +72,20 @@ static inline long tensor_index_to_offset(const int ndim, const long* restrict d
 }
 
 
+//________________________________________________________________________________________________________________________
+///
+/// \brief Convert data offset to tensor index.
+///
+static inline void offset_to_tensor_index(const int ndim, const long* restrict dim, long offset, long* restrict index)
+{
+	for (int i = ndim - 1; i >= 0; i--)
+	{
+		index[i] = offset % dim[i];
+		offset /= dim[i];
+	}
+}
+
+
 //________________________________________________________________________________________________________________________
 ///
 /// \brief Compute the lexicographically next tensor index.
@@ -128,6 +146,8 @@ void dense_tensor_fill_random_normal(const void* alpha, const void* shift, struc
 
 void transpose_dense_tensor(const int* restrict perm, const struct dense_tensor* restrict t, struct dense_tensor* restrict r);
 
+void transpose_dense_tensor_fill(const int* restrict perm, const struct dense_tensor* restrict t, struct dense_tensor* restrict r);
+
 void conjugate_transpose_dense_tensor(const int* restrict perm, const struct dense_tensor* restrict t, struct dense_tensor* restrict r);
 
 
@@ -180,6 +200,14 @@ void dense_tensor_dot(const struct dense_tensor* restrict s, const enum tensor_a
 
 void dense_tensor_dot_update(const void* alpha, const struct dense_tensor* restrict s, const enum tensor_axis_range axrange_s, const struct dense_tensor* restrict t, const enum tensor_axis_range axrange_t, const int ndim_mult, const void* beta, struct dense_tensor* restrict r);
 
+void dense_tensor_dot_conj_update(const void* alpha, const struct dense_tensor* restrict s, const enum tensor_axis_range axrange_s, const bool conj_s, const struct dense_tensor* restrict t, const enum tensor_axis_range axrange_t, const bool conj_t, const int ndim_mult, const void* beta, struct dense_tensor* restrict r);
+
+void dense_tensor_contract(const struct dense_tensor* restrict s, const int* restrict axes_s, const struct dense_tensor* restrict t, const int* restrict axes_t, const int ndim_mult, struct dense_tensor* restrict r);
+
+void dense_tensor_contract_update(const void* alpha, const struct dense_tensor* restrict s, const int* restrict axes_s, const struct dense_tensor* restrict t, const int* restrict axes_t, const int ndim_mult, const void* beta, struct dense_tensor* restrict r);
+
+void dense_tensor_contract_conj_update(const void* alpha, const struct dense_tensor* restrict s, const int* restrict axes_s, bool conj_s, const struct dense_tensor* restrict t, const int* restrict axes_t, bool conj_t, const int ndim_mult, const void* beta, struct dense_tensor* restrict r);
+
 void dense_tensor_kronecker_product(const struct dense_tensor* restrict s, const struct dense_tensor* restrict t, struct dense_tensor* restrict r);
 
 void dense_tensor_concatenate(const struct dense_tensor* restrict tlist, const int num_tensors, const int i_ax, struct dense_tensor* restrict r);
@@ -0,0 +1,495 @@
+/// \file small_gemm.c
+/// \brief Specialized matrix-matrix multiplication kernels for a small inner dimension.
+
+#include <complex.h>
+#include "small_gemm.h"
+
+
+/// \brief Number of columns of 'op(b)' packed into a contiguous buffer.
+#define SMALL_K_GEMM_TILE 128
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Small-k kernel for single precision real entries: c <- alpha * op(a) . op(b) + beta * c, using row-major storage convention.
+///
+/// The inner dimension 'k' is expected to be a compile-time constant after inlining.
+/// Tiles of 'op(b)' are packed into a contiguous buffer, such that the innermost loop over the columns of 'c' has unit stride.
+///
+static inline void small_k_gemm_kernel_s(const long k, const bool transa, const bool transb, const long m, const long n,
+	const float alpha, const float* restrict a, const long lda, const float* restrict b, const long ldb, const float beta, float* restrict c, const long ldc)
+{
+	// strides of 'op(a)' and 'op(b)'
+	const long ars = (transa ? 1 : lda);
+	const long acs = (transa ? lda : 1);
+	const long brs = (transb ? 1 : ldb);
+	const long bcs = (transb ? ldb : 1);
+
+	float bt[SMALL_K_GEMM_MAX][SMALL_K_GEMM_TILE];
+
+	for (long j0 = 0; j0 < n; j0 += SMALL_K_GEMM_TILE)
+	{
+		const long nj = (n - j0 < SMALL_K_GEMM_TILE ? n - j0 : SMALL_K_GEMM_TILE);
+
+		// pack tile of 'op(b)'
+		for (long l = 0; l < k; l++) {
+			for (long j = 0; j < nj; j++) {
+				bt[l][j] = b[l*brs + (j0 + j)*bcs];
+			}
+		}
+
+		for (long i = 0; i < m; i++)
+		{
+			// i-th row of 'op(a)', scaled by 'alpha'
+			float ai[SMALL_K_GEMM_MAX];
+			for (long l = 0; l < k; l++) {
+				ai[l] = alpha * a[i*ars + l*acs];
+			}
+			float* ci = c + i*ldc + j0;
+			if (beta == 0)
+			{
+				for (long j = 0; j < nj; j++)
+				{
+					float sum = 0;
+					for (long l = 0; l < k; l++) {
+						sum += ai[l] * bt[l][j];
+					}
+					ci[j] = sum;
+				}
+			}
+			else
+			{
+				for (long j = 0; j < nj; j++)
+				{
+					float sum = beta * ci[j];
+					for (long l = 0; l < k; l++) {
+						sum += ai[l] * bt[l][j];
+					}
+					ci[j] = sum;
+				}
+			}
+		}
+	}
+}
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Instantiate the small-k kernel for single precision real entries with compile-time constant inner dimension.
+///
+static void small_k_gemm_s(const bool transa, const bool transb, const long m, const long n, const long k,
+	const float alpha, const float* restrict a, const long lda, const float* restrict b, const long ldb, const float beta, float* restrict c, const long ldc)
+{
+	switch (k)
+	{
+		case 1:
+		{
+			small_k_gemm_kernel_s(1, transa, transb, m, n, alpha, a, lda, b, ldb, beta, c, ldc);
+			break;
+		}
+		case 2:
+		{
+			small_k_gemm_kernel_s(2, transa, transb, m, n, alpha, a, lda, b, ldb, beta, c, ldc);
+			break;
+		}
+		case 3:
+		{
+			small_k_gemm_kernel_s(3, transa, transb, m, n, alpha, a, lda, b, ldb, beta, c, ldc);
+			break;
+		}
+		case 4:
+		{
+			small_k_gemm_kernel_s(4, transa, transb, m, n, alpha, a, lda, b, ldb, beta, c, ldc);
+			break;
+		}
+		default:
+		{
+			// inner dimension not supported
+			assert(false);
+		}
+	}
+}
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Small-k kernel for double precision real entries: c <- alpha * op(a) . op(b) + beta * c, using row-major storage convention.
+///
+/// The inner dimension 'k' is expected to be a compile-time constant after inlining.
+/// Tiles of 'op(b)' are packed into a contiguous buffer, such that the innermost loop over the columns of 'c' has unit stride.
+///
+static inline void small_k_gemm_kernel_d(const long k, const bool transa, const bool transb, const long m, const long n,
+	const double alpha, const double* restrict a, const long lda, const double* restrict b, const long ldb, const double beta, double* restrict c, const long ldc)
+{
+	// strides of 'op(a)' and 'op(b)'
+	const long ars = (transa ? 1 : lda);
+	const long acs = (transa ? lda : 1);
+	const long brs = (transb ? 1 : ldb);
+	const long bcs = (transb ? ldb : 1);
+
+	double bt[SMALL_K_GEMM_MAX][SMALL_K_GEMM_TILE];
+
+	for (long j0 = 0; j0 < n; j0 += SMALL_K_GEMM_TILE)
+	{
+		const long nj = (n - j0 < SMALL_K_GEMM_TILE ? n - j0 : SMALL_K_GEMM_TILE);
+
+		// pack tile of 'op(b)'
+		for (long l = 0; l < k; l++) {
+			for (long j = 0; j < nj; j++) {
+				bt[l][j] = b[l*brs + (j0 + j)*bcs];
+			}
+		}
+
+		for (long i = 0; i < m; i++)
+		{
+			// i-th row of 'op(a)', scaled by 'alpha'
+			double ai[SMALL_K_GEMM_MAX];
+			for (long l = 0; l < k; l++) {
+				ai[l] = alpha * a[i*ars + l*acs];
+			}
+			double* ci = c + i*ldc + j0;
+			if (beta == 0)
+			{
+				for (long j = 0; j < nj; j++)
+				{
+					double sum = 0;
+					for (long l = 0; l < k; l++) {
+						sum += ai[l] * bt[l][j];
+					}
+					ci[j] = sum;
+				}
+			}
+			else
+			{
+				for (long j = 0; j < nj; j++)
+				{
+					double sum = beta * ci[j];
+					for (long l = 0; l < k; l++) {
+						sum += ai[l] * bt[l][j];
+					}
+					ci[j] = sum;
+				}
+			}
+		}
+	}
+}
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Instantiate the small-k kernel for double precision real entries with compile-time constant inner dimension.
+///
+static void small_k_gemm_d(const bool transa, const bool transb, const long m, const long n, const long k,
+	const double alpha, const double* restrict a, const long lda, const double* restrict b, const long ldb, const double beta, double* restrict c, const long ldc)
+{
+	switch (k)
+	{
+		case 1:
+		{
+			small_k_gemm_kernel_d(1, transa, transb, m, n, alpha, a, lda, b, ldb, beta, c, ldc);
+			break;
+		}
+		case 2:
+		{
+			small_k_gemm_kernel_d(2, transa, transb, m, n, alpha, a, lda, b, ldb, beta, c, ldc);
+			break;
+		}
+		case 3:
+		{
+			small_k_gemm_kernel_d(3, transa, transb, m, n, alpha, a, lda, b, ldb, beta, c, ldc);
+			break;
+		}
+		case 4:
+		{
+			small_k_gemm_kernel_d(4, transa, transb, m, n, alpha, a, lda, b, ldb, beta, c, ldc);
+			break;
+		}
+		default:
+		{
+			// inner dimension not supported
+			assert(false);
+		}
+	}
+}
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Small-k kernel for single precision complex entries: c <- alpha * op(a) . op(b) + beta * c, using row-major storage convention,
+/// where 'op' optionally includes complex conjugation.
+///
+/// The inner dimension 'k' is expected to be a compile-time constant after inlining.
+/// Tiles of 'op(b)' are packed into separate buffers for the real and imaginary parts, and the complex arithmetic
+/// is written out in terms of real and imaginary parts to enable vectorization of the innermost loop.
+///
+static inline void small_k_gemm_kernel_c(const long k, const bool transa, const bool conja, const bool transb, const bool conjb, const long m, const long n,
+	const scomplex alpha, const scomplex* restrict a, const long lda, const scomplex* restrict b, const long ldb, const scomplex beta, scomplex* restrict c, const long ldc)
+{
+	// strides of 'op(a)' and 'op(b)'
+	const long ars = (transa ? 1 : lda);
+	const long acs = (transa ? lda : 1);
+	const long brs = (transb ? 1 : ldb);
+	const long bcs = (transb ? ldb : 1);
+
+	float bt_re[SMALL_K_GEMM_MAX][SMALL_K_GEMM_TILE];
+	float bt_im[SMALL_K_GEMM_MAX][SMALL_K_GEMM_TILE];
+
+	const float beta_re = crealf(beta);
+	const float beta_im = cimagf(beta);
+
+	for (long j0 = 0; j0 < n; j0 += SMALL_K_GEMM_TILE)
+	{
+		const long nj = (n - j0 < SMALL_K_GEMM_TILE ? n - j0 : SMALL_K_GEMM_TILE);
+
+		// pack tile of 'op(b)'
+		for (long l = 0; l < k; l++) {
+			for (long j = 0; j < nj; j++) {
+				const scomplex blj = b[l*brs + (j0 + j)*bcs];
+				bt_re[l][j] = crealf(blj);
+				bt_im[l][j] = (conjb ? -cimagf(blj) : cimagf(blj));
+			}
+		}
+
+		for (long i = 0; i < m; i++)
+		{
+			// i-th row of 'op(a)', scaled by 'alpha'
+			float ai_re[SMALL_K_GEMM_MAX];
+			float ai_im[SMALL_K_GEMM_MAX];
+			for (long l = 0; l < k; l++) {
+				const scomplex ail = alpha * (conja ? conjf(a[i*ars + l*acs]) : a[i*ars + l*acs]);
+				ai_re[l] = crealf(ail);
+				ai_im[l] = cimagf(ail);
+			}
+			// interpret as interleaved real and imaginary parts
+			float* ci = (float*)(c + i*ldc + j0);
+			if (beta == 0)
+			{
+				for (long j = 0; j < nj; j++)
+				{
+					float sum_re = 0;
+					float sum_im = 0;
+					for (long l = 0; l < k; l++) {
+						sum_re += ai_re[l] * bt_re[l][j] - ai_im[l] * bt_im[l][j];
+						sum_im += ai_re[l] * bt_im[l][j] + ai_im[l] * bt_re[l][j];
+					}
+					ci[2*j    ] = sum_re;
+					ci[2*j + 1] = sum_im;
+				}
+			}
+			else
+			{
+				for (long j = 0; j < nj; j++)
+				{
+					float sum_re = beta_re * ci[2*j] - beta_im * ci[2*j + 1];
+					float sum_im = beta_re * ci[2*j + 1] + beta_im * ci[2*j];
+					for (long l = 0; l < k; l++) {
+						sum_re += ai_re[l] * bt_re[l][j] - ai_im[l] * bt_im[l][j];
+						sum_im += ai_re[l] * bt_im[l][j] + ai_im[l] * bt_re[l][j];
+					}
+					ci[2*j    ] = sum_re;
+					ci[2*j + 1] = sum_im;
+				}
+			}
+		}
+	}
+}
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Instantiate the small-k kernel for single precision complex entries with compile-time constant inner dimension.
+///
+static void small_k_gemm_c(const bool transa, const bool conja, const bool transb, const bool conjb, const long m, const long n, const long k,
+	const scomplex alpha, const scomplex* restrict a, const long lda, const scomplex* restrict b, const long ldb, const scomplex beta, scomplex* restrict c, const long ldc)
+{
+	switch (k)
+	{
+		case 1:
+		{
+			small_k_gemm_kernel_c(1, transa, conja, transb, conjb, m, n, alpha, a, lda, b, ldb, beta, c, ldc);
+			break;
+		}
+		case 2:
+		{
+			small_k_gemm_kernel_c(2, transa, conja, transb, conjb, m, n, alpha, a, lda, b, ldb, beta, c, ldc);
+			break;
+		}
+		case 3:
+		{
+			small_k_gemm_kernel_c(3, transa, conja, transb, conjb, m, n, alpha, a, lda, b, ldb, beta, c, ldc);
+			break;
+		}
+		case 4:
+		{
+			small_k_gemm_kernel_c(4, transa, conja, transb, conjb, m, n, alpha, a, lda, b, ldb, beta, c, ldc);
+			break;
+		}
+		default:
+		{
+			// inner dimension not supported
+			assert(false);
+		}
+	}
+}
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Small-k kernel for double precision complex entries: c <- alpha * op(a) . op(b) + beta * c, using row-major storage convention,
+/// where 'op' optionally includes complex conjugation.
+///
+/// The inner dimension 'k' is expected to be a compile-time constant after inlining.
+/// Tiles of 'op(b)' are packed into separate buffers for the real and imaginary parts, and the complex arithmetic
+/// is written out in terms of real and imaginary parts to enable vectorization of the innermost loop.
+///
+static inline void small_k_gemm_kernel_z(const long k, const bool transa, const bool conja, const bool transb, const bool conjb, const long m, const long n,
+	const dcomplex alpha, const dcomplex* restrict a, const long lda, const dcomplex* restrict b, const long ldb, const dcomplex beta, dcomplex* restrict c, const long ldc)
+{
+	// strides of 'op(a)' and 'op(b)'
+	const long ars = (transa ? 1 : lda);
+	const long acs = (transa ? lda : 1);
+	const long brs = (transb ? 1 : ldb);
+	const long bcs = (transb ? ldb : 1);
+
+	double bt_re[SMALL_K_GEMM_MAX][SMALL_K_GEMM_TILE];
+	double bt_im[SMALL_K_GEMM_MAX][SMALL_K_GEMM_TILE];
+
+	const double beta_re = creal(beta);
+	const double beta_im = cimag(beta);
+
+	for (long j0 = 0; j0 < n; j0 += SMALL_K_GEMM_TILE)
+	{
+		const long nj = (n - j0 < SMALL_K_GEMM_TILE ? n - j0 : SMALL_K_GEMM_TILE);
+
+		// pack tile of 'op(b)'
+		for (long l = 0; l < k; l++) {
+			for (long j = 0; j < nj; j++) {
+				const dcomplex blj = b[l*brs + (j0 + j)*bcs];
+				bt_re[l][j] = creal(blj);
+				bt_im[l][j] = (conjb ? -cimag(blj) : cimag(blj));
+			}
+		}
+
+		for (long i = 0; i < m; i++)
+		{
+			// i-th row of 'op(a)', scaled by 'alpha'
+			double ai_re[SMALL_K_GEMM_MAX];
+			double ai_im[SMALL_K_GEMM_MAX];
+			for (long l = 0; l < k; l++) {
+				const dcomplex ail = alpha * (conja ? conj(a[i*ars + l*acs]) : a[i*ars + l*acs]);
+				ai_re[l] = creal(ail);
+				ai_im[l] = cimag(ail);
+			}
+			// interpret as interleaved real and imaginary parts
+			double* ci = (double*)(c + i*ldc + j0);
+			if (beta == 0)
+			{
+				for (long j = 0; j < nj; j++)
+				{
+					double sum_re = 0;
+					double sum_im = 0;
+					for (long l = 0; l < k; l++) {
+						sum_re += ai_re[l] * bt_re[l][j] - ai_im[l] * bt_im[l][j];
+						sum_im += ai_re[l] * bt_im[l][j] + ai_im[l] * bt_re[l][j];
+					}
+					ci[2*j    ] = sum_re;
+					ci[2*j + 1] = sum_im;
+				}
+			}
+			else
+			{
+				for (long j = 0; j < nj; j++)
+				{
+					double sum_re = beta_re * ci[2*j] - beta_im * ci[2*j + 1];
+					double sum_im = beta_re * ci[2*j + 1] + beta_im * ci[2*j];
+					for (long l = 0; l < k; l++) {
+						sum_re += ai_re[l] * bt_re[l][j] - ai_im[l] * bt_im[l][j];
+						sum_im += ai_re[l] * bt_im[l][j] + ai_im[l] * bt_re[l][j];
+					}
+					ci[2*j    ] = sum_re;
+					ci[2*j + 1] = sum_im;
+				}
+			}
+		}
+	}
+}
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Instantiate the small-k kernel for double precision complex entries with compile-time constant inner dimension.
+///
+static void small_k_gemm_z(const bool transa, const bool conja, const bool transb, const bool conjb, const long m, const long n, const long k,
+	const dcomplex alpha, const dcomplex* restrict a, const long lda, const dcomplex* restrict b, const long ldb, const dcomplex beta, dcomplex* restrict c, const long ldc)
+{
+	switch (k)
+	{
+		case 1:
+		{
+			small_k_gemm_kernel_z(1, transa, conja, transb, conjb, m, n, alpha, a, lda, b, ldb, beta, c, ldc);
+			break;
+		}
+		case 2:
+		{
+			small_k_gemm_kernel_z(2, transa, conja, transb, conjb, m, n, alpha, a, lda, b, ldb, beta, c, ldc);
+			break;
+		}
+		case 3:
+		{
+			small_k_gemm_kernel_z(3, transa, conja, transb, conjb, m, n, alpha, a, lda, b, ldb, beta, c, ldc);
+			break;
+		}
+		case 4:
+		{
+			small_k_gemm_kernel_z(4, transa, conja, transb, conjb, m, n, alpha, a, lda, b, ldb, beta, c, ldc);
+			break;
+		}
+		default:
+		{
+			// inner dimension not supported
+			assert(false);
+		}
+	}
+}
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief General matrix-matrix multiplication c <- alpha * op(a) . op(b) + beta * c with a small inner dimension 'k',
+/// using row-major storage convention and the same interface as the BLAS 'gemm' routines.
+///
+/// Contractions over a physical axis (e.g., d = 2 or d = 4) lead to such multiplications, for which the packing overhead
+/// of general BLAS routines dominates. The kernels are instantiated for each 'k' with the inner dimension as compile-time constant,
+/// such that the summation is fully unrolled and the loop over the columns of 'c' can be vectorized.
+///
+/// 'k' must satisfy 'small_k_gemm_applicable(k)'. As for BLAS, 'c' is not read if 'beta' is zero.
+///
+void small_k_gemm(const enum numeric_type dtype, const CBLAS_TRANSPOSE transa, const CBLAS_TRANSPOSE transb, const long m, const long n, const long k,
+	const void* alpha, const void* restrict a, const long lda, const void* restrict b, const long ldb, const void* beta, void* restrict c, const long ldc)
+{
+	assert(small_k_gemm_applicable(k));
+
+	const bool ta = (transa != CblasNoTrans);
+	const bool tb = (transb != CblasNoTrans);
+
+	switch (dtype)
+	{
+		case CT_SINGLE_REAL:
+		{
+			small_k_gemm_s(ta, tb, m, n, k, *((float*)alpha), a, lda, b, ldb, *((float*)beta), c, ldc);
+			break;
+		}
+		case CT_DOUBLE_REAL:
+		{
+			small_k_gemm_d(ta, tb, m, n, k, *((double*)alpha), a, lda, b, ldb, *((double*)beta), c, ldc);
+			break;
+		}
+		case CT_SINGLE_COMPLEX:
+		{
+			small_k_gemm_c(ta, transa == CblasConjTrans, tb, transb == CblasConjTrans, m, n, k, *((scomplex*)alpha), a, lda, b, ldb, *((scomplex*)beta), c, ldc);
+			break;
+		}
+		case CT_DOUBLE_COMPLEX:
+		{
+			small_k_gemm_z(ta, transa == CblasConjTrans, tb, transb == CblasConjTrans, m, n, k, *((dcomplex*)alpha), a, lda, b, ldb, *((dcomplex*)beta), c, ldc);
+			break;
+		}
+		default:
+		{
+			// unknown data type
+			assert(false);
+		}
+	}
+}
@@ -0,0 +1,26 @@
+/// \file small_gemm.h
+/// \brief Specialized matrix-matrix multiplication kernels for a small inner dimension.
+
+#pragma once
+
+#include <stdbool.h>
+#include <cblas.h>
+#include "numeric.h"
+
+
+/// \brief Maximum inner dimension 'k' handled by the specialized kernels (covering the physical dimensions d = 2 and d = 4).
+#define SMALL_K_GEMM_MAX 4
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Whether a matrix-matrix multiplication with inner dimension 'k' is dispatched to the specialized small-k kernels.
+///
+static inline bool small_k_gemm_applicable(const long k)
+{
+	return 1 <= k && k <= SMALL_K_GEMM_MAX;
+}
+
+
+void small_k_gemm(const enum numeric_type dtype, const CBLAS_TRANSPOSE transa, const CBLAS_TRANSPOSE transb, const long m, const long n, const long k,
+	const void* alpha, const void* restrict a, const long lda, const void* restrict b, const long ldb, const void* beta, void* restrict c, const long ldc);
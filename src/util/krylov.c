@@ -1,6 +1,8 @@
 /// \file krylov.c
 /// \brief Krylov subspace algorithms.
 
+#include <math.h>
+#include <stdbool.h>
 #include <complex.h>
 #include <cblas.h>
 #include <lapacke.h>
@@ -10,6 +12,7 @@
 #include "util.h"
 
 
+#define FLT_EPSILON 1.1920928955078125e-07F
 #define DBL_EPSILON 2.2204460492503131e-16
 
 
@@ -161,6 +164,154 @@ void lanczos_iteration_z(const long n, lanczos_linear_func_z afunc, const void*
 }
 
 
+//________________________________________________________________________________________________________________________
+///
+/// \brief Perform a "matrix free" Lanczos iteration for real-valued single precision vectors.
+///
+void lanczos_iteration_s(const long n, lanczos_linear_func_s afunc, const void* restrict adata, const float* restrict vstart, const int maxiter,
+	float* restrict alpha, float* restrict beta, float* restrict v, int* restrict numiter)
+{
+	float* w = ct_malloc(n * sizeof(float));
+
+	// set first "v" vector to normalized starting vector
+	memcpy(v, vstart, n * sizeof(float));
+	float nrm = cblas_snrm2(n, v, 1);
+	assert(nrm > 0);
+	cblas_sscal(n, 1/nrm, v, 1);
+
+	for (int j = 0; j < maxiter - 1; j++)
+	{
+		// w' = A v_j
+		afunc(n, adata, &v[j*n], w);
+
+		// alpha_j = <w', v_j>
+		alpha[j] = cblas_sdot(n, w, 1, &v[j*n], 1);
+
+		// w = w' - alpha_j v_j - beta_j v_{j-1}
+		if (j > 0) {
+			for (long i = 0; i < n; i++) {
+				w[i] -= alpha[j] * v[j*n + i] + beta[j - 1] * v[(j - 1)*n + i];
+			}
+		}
+		else {
+			for (long i = 0; i < n; i++) {
+				w[i] -= alpha[j] * v[j*n + i];
+			}
+		}
+
+		// beta_{j+1} = ||w||
+		beta[j] = cblas_snrm2(n, w, 1);
+
+		if (beta[j] < 100 * n * FLT_EPSILON)
+		{
+			// premature end of iterations
+			(*numiter) = j + 1;
+			ct_free(w);
+			return;
+		}
+
+		// v_{j+1} = w / beta[j+1]
+		assert(beta[j] > 0);
+		const float inv_beta = 1 / beta[j];
+		for (long i = 0; i < n; i++)
+		{
+			v[(j + 1)*n + i] = inv_beta * w[i];
+		}
+	}
+
+	// complete final iteration
+	{
+		int j = maxiter - 1;
+
+		// w' = A v_j
+		afunc(n, adata, &v[j*n], w);
+
+		// alpha_j = <w', v_j>
+		alpha[j] = cblas_sdot(n, w, 1, &v[j*n], 1);
+	}
+
+	ct_free(w);
+
+	(*numiter) = maxiter;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Perform a "matrix free" Lanczos iteration for complex-valued single precision vectors.
+///
+void lanczos_iteration_c(const long n, lanczos_linear_func_c afunc, const void* restrict adata, const scomplex* restrict vstart, const int maxiter,
+	float* restrict alpha, float* restrict beta, scomplex* restrict v, int* restrict numiter)
+{
+	scomplex* w = ct_malloc(n * sizeof(scomplex));
+
+	// set first "v" vector to normalized starting vector
+	memcpy(v, vstart, n * sizeof(scomplex));
+	float nrm = cblas_scnrm2(n, v, 1);
+	assert(nrm > 0);
+	cblas_csscal(n, 1/nrm, v, 1);
+
+	for (int j = 0; j < maxiter - 1; j++)
+	{
+		// w' = A v_j
+		afunc(n, adata, &v[j*n], w);
+
+		// alpha_j = <w', v_j>
+		scomplex t;
+		cblas_cdotc_sub(n, w, 1, &v[j*n], 1, &t);
+		alpha[j] = crealf(t);  // should be real for self-adjoint linear operation
+
+		// w = w' - alpha_j v_j - beta_j v_{j-1}
+		if (j > 0) {
+			for (long i = 0; i < n; i++) {
+				w[i] -= alpha[j] * v[j*n + i] + beta[j - 1] * v[(j - 1)*n + i];
+			}
+		}
+		else {
+			for (long i = 0; i < n; i++) {
+				w[i] -= alpha[j] * v[j*n + i];
+			}
+		}
+
+		// beta_{j+1} = ||w||
+		beta[j] = cblas_scnrm2(n, w, 1);
+
+		if (beta[j] < 100 * n * FLT_EPSILON)
+		{
+			// premature end of iterations
+			(*numiter) = j + 1;
+			ct_free(w);
+			return;
+		}
+
+		// v_{j+1} = w / beta[j+1]
+		assert(beta[j] > 0);
+		const float inv_beta = 1 / beta[j];
+		for (long i = 0; i < n; i++)
+		{
+			v[(j + 1)*n + i] = inv_beta * w[i];
+		}
+	}
+
+	// complete final iteration
+	{
+		int j = maxiter - 1;
+
+		// w' = A v_j
+		afunc(n, adata, &v[j*n], w);
+
+		// alpha_j = <w', v_j>
+		scomplex t;
+		cblas_cdotc_sub(n, w, 1, &v[j*n], 1, &t);
+		alpha[j] = crealf(t);  // should be real for self-adjoint linear operation
+	}
+
+	ct_free(w);
+
+	(*numiter) = maxiter;
+}
+
+
 //________________________________________________________________________________________________________________________
 ///
 /// \brief Compute Krylov subspace approximation of eigenvalues and vectors, real symmetric case.
@@ -257,3 +408,731 @@ int eigensystem_krylov_hermitian(const long n, lanczos_linear_func_z afunc, cons
 
 	return 0;
 }
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Compute Krylov subspace approximation of eigenvalues and vectors, real symmetric case, single precision.
+///
+int eigensystem_krylov_symmetric_single(const long n, lanczos_linear_func_s afunc, const void* restrict adata,
+	const float* restrict vstart, const int maxiter, const int numeig,
+	float* restrict lambda, float* restrict u_ritz)
+{
+	assert(numeig <= maxiter);
+
+	float* alpha = ct_malloc(maxiter       * sizeof(float));
+	float* beta  = ct_malloc((maxiter - 1) * sizeof(float));
+	float* v     = ct_malloc(maxiter*n     * sizeof(float));
+	int numiter;
+	lanczos_iteration_s(n, afunc, adata, vstart, maxiter, alpha, beta, v, &numiter);
+
+	if (numiter < numeig) {
+		fprintf(stderr, "Lanczos iteration stopped after %i iterations, cannot compute %i eigenvalues\n", numiter, numeig);
+		return -1;
+	}
+
+	// diagonalize Hessenberg matrix
+	float* u = ct_malloc(numiter*numiter * sizeof(float));
+	lapack_int info = LAPACKE_ssteqr(LAPACK_ROW_MAJOR, 'I', numiter, alpha, beta, u, numiter);
+	if (info != 0) {
+		fprintf(stderr, "LAPACK function 'ssteqr()' failed, return value: %i\n", info);
+		return -2;
+	}
+
+	// 'alpha' now contains the eigenvalues
+	memcpy(lambda, alpha, numeig * sizeof(float));
+
+	// compute Ritz eigenvectors
+	cblas_sgemm(CblasRowMajor, CblasTrans, CblasNoTrans, n, numeig, numiter, 1.f, v, n, u, numiter, 0.f, u_ritz, numeig);
+
+	// clean up
+	ct_free(u);
+	ct_free(v);
+	ct_free(beta);
+	ct_free(alpha);
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Compute Krylov subspace approximation of eigenvalues and vectors, complex Hermitian case, single precision.
+///
+int eigensystem_krylov_hermitian_single(const long n, lanczos_linear_func_c afunc, const void* restrict adata,
+	const scomplex* restrict vstart, const int maxiter, const int numeig,
+	float* restrict lambda, scomplex* restrict u_ritz)
+{
+	assert(numeig <= maxiter);
+
+	float* alpha = ct_malloc(maxiter       * sizeof(float));
+	float* beta  = ct_malloc((maxiter - 1) * sizeof(float));
+	scomplex* v   = ct_malloc(maxiter*n     * sizeof(scomplex));
+	int numiter;
+	lanczos_iteration_c(n, afunc, adata, vstart, maxiter, alpha, beta, v, &numiter);
+
+	if (numiter < numeig) {
+		fprintf(stderr, "Lanczos iteration stopped after %i iterations, cannot compute %i eigenvalues\n", numiter, numeig);
+		return -1;
+	}
+
+	// diagonalize Hessenberg matrix
+	float* u = ct_malloc(numiter*numiter * sizeof(float));
+	lapack_int info = LAPACKE_ssteqr(LAPACK_ROW_MAJOR, 'I', numiter, alpha, beta, u, numiter);
+	if (info != 0) {
+		fprintf(stderr, "LAPACK function 'ssteqr()' failed, return value: %i\n", info);
+		return -2;
+	}
+
+	// 'alpha' now contains the eigenvalues
+	memcpy(lambda, alpha, numeig * sizeof(float));
+
+	// compute Ritz eigenvectors
+	// require complex 'u' entries for matrix multiplication
+	scomplex* uz = ct_malloc(numiter*numiter * sizeof(scomplex));
+	for (int i = 0; i < numiter*numiter; i++) {
+		uz[i] = (scomplex)u[i];
+	}
+	const scomplex one  = 1;
+	const scomplex zero = 0;
+	cblas_cgemm(CblasRowMajor, CblasTrans, CblasNoTrans, n, numeig, numiter, &one, v, n, uz, numiter, &zero, u_ritz, numeig);
+
+	// clean up
+	ct_free(uz);
+	ct_free(u);
+	ct_free(v);
+	ct_free(beta);
+	ct_free(alpha);
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Compute the algebraically smallest eigenvalue and corresponding eigenvector by the Davidson method, real symmetric case.
+///
+/// 'diag' contains the diagonal entries of the linear operator, which are used as preconditioner for the correction vectors;
+/// it can be NULL, in which case no preconditioning is performed.
+/// The search subspace is collapsed to the current Ritz vector once it reaches dimension 'maxvec'.
+/// The iteration terminates when the residual norm drops below 'tol' or after 'maxiter' applications of the linear operator,
+/// and the number of actual applications is stored in 'num_matvec'.
+///
+int eigensystem_davidson_symmetric(const long n, lanczos_linear_func_d afunc, const void* restrict adata, const double* restrict diag,
+	const double* restrict vstart, const int maxiter, const int maxvec, const double tol,
+	double* restrict lambda, double* restrict u, int* restrict num_matvec)
+{
+	assert(maxiter >= 1);
+	assert(maxvec >= 2);
+
+	// basis vectors of the search subspace and linear operator applied to them
+	double* v  = ct_malloc(maxvec * n * sizeof(double));
+	double* av = ct_malloc(maxvec * n * sizeof(double));
+	// projected linear operator, using 'maxvec' as leading dimension
+	double* h  = ct_malloc(maxvec * maxvec * sizeof(double));
+	// workspace for diagonalizing the projected linear operator
+	double* hs    = ct_malloc(maxvec * maxvec * sizeof(double));
+	double* theta = ct_malloc(maxvec * sizeof(double));
+	// residual and correction vectors
+	double* res = ct_malloc(n * sizeof(double));
+	double* t   = ct_malloc(n * sizeof(double));
+
+	// set first basis vector to normalized starting vector
+	memcpy(v, vstart, n * sizeof(double));
+	double nrm = cblas_dnrm2(n, v, 1);
+	assert(nrm > 0);
+	cblas_dscal(n, 1/nrm, v, 1);
+	afunc(n, adata, v, av);
+	h[0] = cblas_ddot(n, v, 1, av, 1);
+	int k = 1;
+	(*num_matvec) = 1;
+
+	while (true)
+	{
+		// Rayleigh-Ritz step: diagonalize projected linear operator
+		for (int i = 0; i < k; i++) {
+			memcpy(&hs[i*k], &h[i*maxvec], k * sizeof(double));
+		}
+		lapack_int info = LAPACKE_dsyev(LAPACK_ROW_MAJOR, 'V', 'U', k, hs, k, theta);
+		if (info != 0) {
+			fprintf(stderr, "LAPACK function 'dsyev()' failed, return value: %i\n", info);
+			return -1;
+		}
+		// eigenvector of smallest eigenvalue is stored in first column of 'hs'
+		(*lambda) = theta[0];
+
+		// Ritz vector and linear operator applied to it
+		memset(u,   0, n * sizeof(double));
+		memset(res, 0, n * sizeof(double));
+		for (int j = 0; j < k; j++)
+		{
+			cblas_daxpy(n, hs[j*k], &v[j*n],  1, u,   1);
+			cblas_daxpy(n, hs[j*k], &av[j*n], 1, res, 1);
+		}
+		// residual vector
+		cblas_daxpy(n, -theta[0], u, 1, res, 1);
+		if (cblas_dnrm2(n, res, 1) < tol || (*num_matvec) >= maxiter) {
+			break;
+		}
+
+		// collapse search subspace to Ritz vector
+		if (k == maxvec)
+		{
+			memcpy(v, u, n * sizeof(double));
+			for (long i = 0; i < n; i++) {
+				av[i] = res[i] + theta[0] * u[i];
+			}
+			h[0] = theta[0];
+			k = 1;
+		}
+
+		// preconditioned correction vector
+		for (long i = 0; i < n; i++)
+		{
+			double denom = (diag != NULL ? theta[0] - diag[i] : 1);
+			if (fabs(denom) < 1e-8) {
+				denom = copysign(1e-8, denom);
+			}
+			t[i] = res[i] / denom;
+		}
+
+		// orthogonalize correction vector with respect to current search subspace (twice for numerical stability)
+		for (int m = 0; m < 2; m++) {
+			for (int j = 0; j < k; j++) {
+				cblas_daxpy(n, -cblas_ddot(n, &v[j*n], 1, t, 1), &v[j*n], 1, t, 1);
+			}
+		}
+		nrm = cblas_dnrm2(n, t, 1);
+		if (nrm < 100 * n * DBL_EPSILON) {
+			// search subspace cannot be extended any further
+			break;
+		}
+
+		// extend search subspace
+		memcpy(&v[k*n], t, n * sizeof(double));
+		cblas_dscal(n, 1/nrm, &v[k*n], 1);
+		afunc(n, adata, &v[k*n], &av[k*n]);
+		(*num_matvec)++;
+		for (int j = 0; j <= k; j++)
+		{
+			h[j*maxvec + k] = cblas_ddot(n, &v[j*n], 1, &av[k*n], 1);
+			h[k*maxvec + j] = h[j*maxvec + k];
+		}
+		k++;
+	}
+
+	// clean up
+	ct_free(t);
+	ct_free(res);
+	ct_free(theta);
+	ct_free(hs);
+	ct_free(h);
+	ct_free(av);
+	ct_free(v);
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Compute the algebraically smallest eigenvalue and corresponding eigenvector by the Davidson method, complex Hermitian case.
+///
+/// 'diag' contains the (real) diagonal entries of the linear operator, which are used as preconditioner for the correction vectors;
+/// it can be NULL, in which case no preconditioning is performed.
+/// The search subspace is collapsed to the current Ritz vector once it reaches dimension 'maxvec'.
+/// The iteration terminates when the residual norm drops below 'tol' or after 'maxiter' applications of the linear operator,
+/// and the number of actual applications is stored in 'num_matvec'.
+///
+int eigensystem_davidson_hermitian(const long n, lanczos_linear_func_z afunc, const void* restrict adata, const double* restrict diag,
+	const dcomplex* restrict vstart, const int maxiter, const int maxvec, const double tol,
+	double* restrict lambda, dcomplex* restrict u, int* restrict num_matvec)
+{
+	assert(maxiter >= 1);
+	assert(maxvec >= 2);
+
+	// basis vectors of the search subspace and linear operator applied to them
+	dcomplex* v  = ct_malloc(maxvec * n * sizeof(dcomplex));
+	dcomplex* av = ct_malloc(maxvec * n * sizeof(dcomplex));
+	// projected linear operator, using 'maxvec' as leading dimension
+	dcomplex* h  = ct_malloc(maxvec * maxvec * sizeof(dcomplex));
+	// workspace for diagonalizing the projected linear operator
+	dcomplex* hs  = ct_malloc(maxvec * maxvec * sizeof(dcomplex));
+	double* theta = ct_malloc(maxvec * sizeof(double));
+	// residual and correction vectors
+	dcomplex* res = ct_malloc(n * sizeof(dcomplex));
+	dcomplex* t   = ct_malloc(n * sizeof(dcomplex));
+
+	// set first basis vector to normalized starting vector
+	memcpy(v, vstart, n * sizeof(dcomplex));
+	double nrm = cblas_dznrm2(n, v, 1);
+	assert(nrm > 0);
+	cblas_zdscal(n, 1/nrm, v, 1);
+	afunc(n, adata, v, av);
+	cblas_zdotc_sub(n, v, 1, av, 1, &h[0]);
+	h[0] = creal(h[0]);  // should be real for self-adjoint linear operation
+	int k = 1;
+	(*num_matvec) = 1;
+
+	while (true)
+	{
+		// Rayleigh-Ritz step: diagonalize projected linear operator
+		for (int i = 0; i < k; i++) {
+			memcpy(&hs[i*k], &h[i*maxvec], k * sizeof(dcomplex));
+		}
+		lapack_int info = LAPACKE_zheev(LAPACK_ROW_MAJOR, 'V', 'U', k, hs, k, theta);
+		if (info != 0) {
+			fprintf(stderr, "LAPACK function 'zheev()' failed, return value: %i\n", info);
+			return -1;
+		}
+		// eigenvector of smallest eigenvalue is stored in first column of 'hs'
+		(*lambda) = theta[0];
+
+		// Ritz vector and linear operator applied to it
+		memset(u,   0, n * sizeof(dcomplex));
+		memset(res, 0, n * sizeof(dcomplex));
+		for (int j = 0; j < k; j++)
+		{
+			cblas_zaxpy(n, &hs[j*k], &v[j*n],  1, u,   1);
+			cblas_zaxpy(n, &hs[j*k], &av[j*n], 1, res, 1);
+		}
+		// residual vector
+		for (long i = 0; i < n; i++) {
+			res[i] -= theta[0] * u[i];
+		}
+		if (cblas_dznrm2(n, res, 1) < tol || (*num_matvec) >= maxiter) {
+			break;
+		}
+
+		// collapse search subspace to Ritz vector
+		if (k == maxvec)
+		{
+			memcpy(v, u, n * sizeof(dcomplex));
+			for (long i = 0; i < n; i++) {
+				av[i] = res[i] + theta[0] * u[i];
+			}
+			h[0] = theta[0];
+			k = 1;
+		}
+
+		// preconditioned correction vector
+		for (long i = 0; i < n; i++)
+		{
+			double denom = (diag != NULL ? theta[0] - diag[i] : 1);
+			if (fabs(denom) < 1e-8) {
+				denom = copysign(1e-8, denom);
+			}
+			t[i] = res[i] / denom;
+		}
+
+		// orthogonalize correction vector with respect to current search subspace (twice for numerical stability)
+		for (int m = 0; m < 2; m++) {
+			for (int j = 0; j < k; j++) {
+				dcomplex c;
+				cblas_zdotc_sub(n, &v[j*n], 1, t, 1, &c);
+				c = -c;
+				cblas_zaxpy(n, &c, &v[j*n], 1, t, 1);
+			}
+		}
+		nrm = cblas_dznrm2(n, t, 1);
+		if (nrm < 100 * n * DBL_EPSILON) {
+			// search subspace cannot be extended any further
+			break;
+		}
+
+		// extend search subspace
+		memcpy(&v[k*n], t, n * sizeof(dcomplex));
+		cblas_zdscal(n, 1/nrm, &v[k*n], 1);
+		afunc(n, adata, &v[k*n], &av[k*n]);
+		(*num_matvec)++;
+		for (int j = 0; j < k; j++)
+		{
+			cblas_zdotc_sub(n, &v[j*n], 1, &av[k*n], 1, &h[j*maxvec + k]);
+			h[k*maxvec + j] = conj(h[j*maxvec + k]);
+		}
+		cblas_zdotc_sub(n, &v[k*n], 1, &av[k*n], 1, &h[k*maxvec + k]);
+		h[k*maxvec + k] = creal(h[k*maxvec + k]);
+		k++;
+	}
+
+	// clean up
+	ct_free(t);
+	ct_free(res);
+	ct_free(theta);
+	ct_free(hs);
+	ct_free(h);
+	ct_free(av);
+	ct_free(v);
+
+	return 0;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Block size (number of vector entries) for in-place basis transformations.
+///
+#define KRYLOV_TRANSFORM_CHUNK 256
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Replace the leading 'nk' vectors of the basis 'v' (consisting of 'm' vectors of length 'n') by the linear combinations
+/// described by the columns of 'y' (with leading dimension 'm'), using 'buf' of size 'nk * KRYLOV_TRANSFORM_CHUNK' as temporary storage.
+///
+static void krylov_basis_transform_d(const long n, const int m, const int nk, const double* restrict y, double* restrict v, double* restrict buf)
+{
+	for (long c = 0; c < n; c += KRYLOV_TRANSFORM_CHUNK)
+	{
+		const long len = lmin(KRYLOV_TRANSFORM_CHUNK, n - c);
+		cblas_dgemm(CblasRowMajor, CblasTrans, CblasNoTrans, nk, len, m, 1., y, m, &v[c], n, 0., buf, len);
+		for (int i = 0; i < nk; i++) {
+			memcpy(&v[i*n + c], &buf[i*len], len * sizeof(double));
+		}
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Replace the leading 'nk' vectors of the basis 'v' (consisting of 'm' vectors of length 'n') by the linear combinations
+/// described by the columns of 'y' (with leading dimension 'm'), using 'buf' of size 'nk * KRYLOV_TRANSFORM_CHUNK' as temporary storage.
+///
+static void krylov_basis_transform_z(const long n, const int m, const int nk, const dcomplex* restrict y, dcomplex* restrict v, dcomplex* restrict buf)
+{
+	const dcomplex one  = 1;
+	const dcomplex zero = 0;
+	for (long c = 0; c < n; c += KRYLOV_TRANSFORM_CHUNK)
+	{
+		const long len = lmin(KRYLOV_TRANSFORM_CHUNK, n - c);
+		cblas_zgemm(CblasRowMajor, CblasTrans, CblasNoTrans, nk, len, m, &one, y, m, &v[c], n, &zero, buf, len);
+		for (int i = 0; i < nk; i++) {
+			memcpy(&v[i*n + c], &buf[i*len], len * sizeof(dcomplex));
+		}
+	}
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Whether the residual norms of the 'numeig' Ritz pairs of the projected linear operator 't' (of dimension 'm' x 'm', with leading dimension 'ld')
+/// are below 'tol', with 'beta' the norm of the residual vector; 'y' and 'theta' serve as workspace.
+///
+static bool krylov_ritz_converged_d(const int m, const int ld, const int numeig, const double* restrict t, const double beta, const double tol,
+	double* restrict y, double* restrict theta)
+{
+	for (int i = 0; i < m; i++) {
+		memcpy(&y[i*m], &t[i*ld], m * sizeof(double));
+	}
+	lapack_int info = LAPACKE_dsyev(LAPACK_ROW_MAJOR, 'V', 'U', m, y, m, theta);
+	if (info != 0) {
+		return false;
+	}
+	for (int i = 0; i < numeig; i++) {
+		if (fabs(beta * y[(m - 1)*m + i]) > tol) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Whether the residual norms of the 'numeig' Ritz pairs of the projected linear operator 't' (of dimension 'm' x 'm', with leading dimension 'ld')
+/// are below 'tol', with 'beta' the norm of the residual vector; 'y' and 'theta' serve as workspace.
+///
+static bool krylov_ritz_converged_z(const int m, const int ld, const int numeig, const dcomplex* restrict t, const double beta, const double tol,
+	dcomplex* restrict y, double* restrict theta)
+{
+	for (int i = 0; i < m; i++) {
+		memcpy(&y[i*m], &t[i*ld], m * sizeof(dcomplex));
+	}
+	lapack_int info = LAPACKE_zheev(LAPACK_ROW_MAJOR, 'V', 'U', m, y, m, theta);
+	if (info != 0) {
+		return false;
+	}
+	for (int i = 0; i < numeig; i++) {
+		if (beta * cabs(y[(m - 1)*m + i]) > tol) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Compute the 'numeig' algebraically smallest eigenvalues and corresponding eigenvectors by a thick-restart Lanczos iteration,
+/// real symmetric case.
+///
+/// At most 'maxvec' Krylov basis vectors are stored at any time. Once the basis is full, it is collapsed to the current
+/// approximate Ritz vectors of the smallest eigenvalues (about half of the basis), and the iteration continues from the residual vector.
+/// The Krylov vectors are fully re-orthogonalized. The iteration terminates when the residual norms of all 'numeig'
+/// Ritz pairs drop below 'tol' (checked after each extension of the basis) or after 'maxiter' applications of the linear operator;
+/// the number of actual applications is stored in 'num_matvec'.
+///
+int eigensystem_krylov_restarted_symmetric(const long n, lanczos_linear_func_d afunc, const void* restrict adata,
+	const double* restrict vstart, const int maxiter, const int maxvec, const int numeig, const double tol,
+	double* restrict lambda, double* restrict u_ritz, int* restrict num_matvec)
+{
+	assert(1 <= numeig && numeig < maxvec);
+
+	// number of Ritz vectors retained at a restart
+	const int nkeep = numeig + (maxvec - numeig) / 2;
+
+	double* v     = ct_malloc(maxvec * n * sizeof(double));
+	double* w     = ct_malloc(n * sizeof(double));
+	double* t     = ct_calloc(maxvec * maxvec, sizeof(double));
+	double* y     = ct_malloc(maxvec * maxvec * sizeof(double));
+	double* theta = ct_malloc(maxvec * sizeof(double));
+	double* buf   = ct_malloc(nkeep * KRYLOV_TRANSFORM_CHUNK * sizeof(double));
+
+	// set first Krylov vector to normalized starting vector
+	memcpy(v, vstart, n * sizeof(double));
+	double beta = cblas_dnrm2(n, v, 1);
+	assert(beta > 0);
+	cblas_dscal(n, 1/beta, v, 1);
+
+	(*num_matvec) = 0;
+	int k = 0;  // number of retained Ritz vectors
+	int ret = 0;
+	while (true)
+	{
+		// extend Krylov basis
+		int m = k;
+		bool exhausted = false;
+		while (m < maxvec)
+		{
+			const int j = m;
+			afunc(n, adata, &v[j*n], w);
+			(*num_matvec)++;
+			m++;
+
+			// orthogonalize with respect to all basis vectors (twice for numerical stability),
+			// and record the projected linear operator
+			for (int i = 0; i <= j; i++) {
+				t[i*maxvec + j] = 0;
+			}
+			for (int pass = 0; pass < 2; pass++) {
+				for (int i = 0; i <= j; i++) {
+					const double c = cblas_ddot(n, &v[i*n], 1, w, 1);
+					cblas_daxpy(n, -c, &v[i*n], 1, w, 1);
+					t[i*maxvec + j] += c;
+				}
+			}
+			for (int i = 0; i < j; i++) {
+				t[j*maxvec + i] = t[i*maxvec + j];
+			}
+
+			beta = cblas_dnrm2(n, w, 1);
+			if (beta < 100 * n * DBL_EPSILON || (*num_matvec) >= maxiter) {
+				exhausted = true;
+				break;
+			}
+			if (m < maxvec) {
+				for (long i = 0; i < n; i++) {
+					v[m*n + i] = w[i] / beta;
+				}
+			}
+			// terminate early if the Ritz pairs have already converged before the basis is full (e.g., for a good starting vector)
+			if (m >= numeig && m < maxvec && krylov_ritz_converged_d(m, maxvec, numeig, t, beta, tol, y, theta)) {
+				break;
+			}
+		}
+
+		if (m < numeig) {
+			fprintf(stderr, "Lanczos iteration stopped after %i iterations, cannot compute %i eigenvalues\n", m, numeig);
+			ret = -1;
+			break;
+		}
+
+		// diagonalize projected linear operator
+		for (int i = 0; i < m; i++) {
+			memcpy(&y[i*m], &t[i*maxvec], m * sizeof(double));
+		}
+		lapack_int info = LAPACKE_dsyev(LAPACK_ROW_MAJOR, 'V', 'U', m, y, m, theta);
+		if (info != 0) {
+			fprintf(stderr, "LAPACK function 'dsyev()' failed, return value: %i\n", info);
+			ret = -2;
+			break;
+		}
+
+		// residual norms of the Ritz pairs are given by the last row of the eigenvectors
+		bool converged = true;
+		for (int i = 0; i < numeig; i++) {
+			if (fabs(beta * y[(m - 1)*m + i]) > tol) {
+				converged = false;
+			}
+		}
+		if (converged || exhausted)
+		{
+			memcpy(lambda, theta, numeig * sizeof(double));
+			// compute Ritz eigenvectors
+			cblas_dgemm(CblasRowMajor, CblasTrans, CblasNoTrans, n, numeig, m, 1., v, n, y, m, 0., u_ritz, numeig);
+			break;
+		}
+
+		// thick restart: retain Ritz vectors of smallest eigenvalues, and continue with normalized residual vector
+		k = imin(nkeep, m - 1);
+		krylov_basis_transform_d(n, m, k, y, v, buf);
+		for (long i = 0; i < n; i++) {
+			v[k*n + i] = w[i] / beta;
+		}
+		memset(t, 0, maxvec * maxvec * sizeof(double));
+		for (int i = 0; i < k; i++) {
+			t[i*maxvec + i] = theta[i];
+		}
+	}
+
+	// clean up
+	ct_free(buf);
+	ct_free(theta);
+	ct_free(y);
+	ct_free(t);
+	ct_free(w);
+	ct_free(v);
+
+	return ret;
+}
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Compute the 'numeig' algebraically smallest eigenvalues and corresponding eigenvectors by a thick-restart Lanczos iteration,
+/// complex Hermitian case.
+///
+/// At most 'maxvec' Krylov basis vectors are stored at any time. Once the basis is full, it is collapsed to the current
+/// approximate Ritz vectors of the smallest eigenvalues (about half of the basis), and the iteration continues from the residual vector.
+/// The Krylov vectors are fully re-orthogonalized. The iteration terminates when the residual norms of all 'numeig'
+/// Ritz pairs drop below 'tol' (checked after each extension of the basis) or after 'maxiter' applications of the linear operator;
+/// the number of actual applications is stored in 'num_matvec'.
+///
+int eigensystem_krylov_restarted_hermitian(const long n, lanczos_linear_func_z afunc, const void* restrict adata,
+	const dcomplex* restrict vstart, const int maxiter, const int maxvec, const int numeig, const double tol,
+	double* restrict lambda, dcomplex* restrict u_ritz, int* restrict num_matvec)
+{
+	assert(1 <= numeig && numeig < maxvec);
+
+	// number of Ritz vectors retained at a restart
+	const int nkeep = numeig + (maxvec - numeig) / 2;
+
+	dcomplex* v   = ct_malloc(maxvec * n * sizeof(dcomplex));
+	dcomplex* w   = ct_malloc(n * sizeof(dcomplex));
+	dcomplex* t   = ct_calloc(maxvec * maxvec, sizeof(dcomplex));
+	dcomplex* y   = ct_malloc(maxvec * maxvec * sizeof(dcomplex));
+	double* theta = ct_malloc(maxvec * sizeof(double));
+	dcomplex* buf = ct_malloc(nkeep * KRYLOV_TRANSFORM_CHUNK * sizeof(dcomplex));
+
+	// set first Krylov vector to normalized starting vector
+	memcpy(v, vstart, n * sizeof(dcomplex));
+	double beta = cblas_dznrm2(n, v, 1);
+	assert(beta > 0);
+	cblas_zdscal(n, 1/beta, v, 1);
+
+	(*num_matvec) = 0;
+	int k = 0;  // number of retained Ritz vectors
+	int ret = 0;
+	while (true)
+	{
+		// extend Krylov basis
+		int m = k;
+		bool exhausted = false;
+		while (m < maxvec)
+		{
+			const int j = m;
+			afunc(n, adata, &v[j*n], w);
+			(*num_matvec)++;
+			m++;
+
+			// orthogonalize with respect to all basis vectors (twice for numerical stability),
+			// and record the projected linear operator
+			for (int i = 0; i <= j; i++) {
+				t[i*maxvec + j] = 0;
+			}
+			for (int pass = 0; pass < 2; pass++) {
+				for (int i = 0; i <= j; i++) {
+					dcomplex c;
+					cblas_zdotc_sub(n, &v[i*n], 1, w, 1, &c);
+					t[i*maxvec + j] += c;
+					c = -c;
+					cblas_zaxpy(n, &c, &v[i*n], 1, w, 1);
+				}
+			}
+			t[j*maxvec + j] = creal(t[j*maxvec + j]);  // should be real for self-adjoint linear operation
+			for (int i = 0; i < j; i++) {
+				t[j*maxvec + i] = conj(t[i*maxvec + j]);
+			}
+
+			beta = cblas_dznrm2(n, w, 1);
+			if (beta < 100 * n * DBL_EPSILON || (*num_matvec) >= maxiter) {
+				exhausted = true;
+				break;
+			}
+			if (m < maxvec) {
+				for (long i = 0; i < n; i++) {
+					v[m*n + i] = w[i] / beta;
+				}
+			}
+			// terminate early if the Ritz pairs have already converged before the basis is full (e.g., for a good starting vector)
+			if (m >= numeig && m < maxvec && krylov_ritz_converged_z(m, maxvec, numeig, t, beta, tol, y, theta)) {
+				break;
+			}
+		}
+
+		if (m < numeig) {
+			fprintf(stderr, "Lanczos iteration stopped after %i iterations, cannot compute %i eigenvalues\n", m, numeig);
+			ret = -1;
+			break;
+		}
+
+		// diagonalize projected linear operator
+		for (int i = 0; i < m; i++) {
+			memcpy(&y[i*m], &t[i*maxvec], m * sizeof(dcomplex));
+		}
+		lapack_int info = LAPACKE_zheev(LAPACK_ROW_MAJOR, 'V', 'U', m, y, m, theta);
+		if (info != 0) {
+			fprintf(stderr, "LAPACK function 'zheev()' failed, return value: %i\n", info);
+			ret = -2;
+			break;
+		}
+
+		// residual norms of the Ritz pairs are given by the last row of the eigenvectors
+		bool converged = true;
+		for (int i = 0; i < numeig; i++) {
+			if (beta * cabs(y[(m - 1)*m + i]) > tol) {
+				converged = false;
+			}
+		}
+		if (converged || exhausted)
+		{
+			memcpy(lambda, theta, numeig * sizeof(double));
+			// compute Ritz eigenvectors
+			const dcomplex one  = 1;
+			const dcomplex zero = 0;
+			cblas_zgemm(CblasRowMajor, CblasTrans, CblasNoTrans, n, numeig, m, &one, v, n, y, m, &zero, u_ritz, numeig);
+			break;
+		}
+
+		// thick restart: retain Ritz vectors of smallest eigenvalues, and continue with normalized residual vector
+		k = imin(nkeep, m - 1);
+		krylov_basis_transform_z(n, m, k, y, v, buf);
+		for (long i = 0; i < n; i++) {
+			v[k*n + i] = w[i] / beta;
+		}
+		memset(t, 0, maxvec * maxvec * sizeof(dcomplex));
+		for (int i = 0; i < k; i++) {
+			t[i*maxvec + i] = theta[i];
+		}
+	}
+
+	// clean up
+	ct_free(buf);
+	ct_free(theta);
+	ct_free(y);
+	ct_free(t);
+	ct_free(w);
+	ct_free(v);
+
+	return ret;
+}
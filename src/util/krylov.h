@@ -6,14 +6,24 @@
 #include "numeric.h"
 
 
+typedef void lanczos_linear_func_s(const long n, const void* restrict data, const float* restrict v, float* restrict ret);
+
 typedef void lanczos_linear_func_d(const long n, const void* restrict data, const double* restrict v, double* restrict ret);
 
+typedef void lanczos_linear_func_c(const long n, const void* restrict data, const scomplex* restrict v, scomplex* restrict ret);
+
 typedef void lanczos_linear_func_z(const long n, const void* restrict data, const dcomplex* restrict v, dcomplex* restrict ret);
 
 
+void lanczos_iteration_s(const long n, lanczos_linear_func_s afunc, const void* restrict adata, const float* restrict vstart, const int maxiter,
+	float* restrict alpha, float* restrict beta, float* restrict v, int* restrict numiter);
+
 void lanczos_iteration_d(const long n, lanczos_linear_func_d afunc, const void* restrict adata, const double* restrict vstart, const int maxiter,
 	double* restrict alpha, double* restrict beta, double* restrict v, int* restrict numiter);
 
+void lanczos_iteration_c(const long n, lanczos_linear_func_c afunc, const void* restrict adata, const scomplex* restrict vstart, const int maxiter,
+	float* restrict alpha, float* restrict beta, scomplex* restrict v, int* restrict numiter);
+
 void lanczos_iteration_z(const long n, lanczos_linear_func_z afunc, const void* restrict adata, const dcomplex* restrict vstart, const int maxiter,
 	double* restrict alpha, double* restrict beta, dcomplex* restrict v, int* restrict numiter);
 
@@ -27,3 +37,33 @@ int eigensystem_krylov_symmetric(const long n, lanczos_linear_func_d afunc, cons
 int eigensystem_krylov_hermitian(const long n, lanczos_linear_func_z afunc, const void* restrict adata,
 	const dcomplex* restrict vstart, const int maxiter, const int numeig,
 	double* restrict lambda, dcomplex* restrict u_ritz);
+
+int eigensystem_krylov_symmetric_single(const long n, lanczos_linear_func_s afunc, const void* restrict adata,
+	const float* restrict vstart, const int maxiter, const int numeig,
+	float* restrict lambda, float* restrict u_ritz);
+
+int eigensystem_krylov_hermitian_single(const long n, lanczos_linear_func_c afunc, const void* restrict adata,
+	const scomplex* restrict vstart, const int maxiter, const int numeig,
+	float* restrict lambda, scomplex* restrict u_ritz);
+
+//________________________________________________________________________________________________________________________
+//
+
+int eigensystem_davidson_symmetric(const long n, lanczos_linear_func_d afunc, const void* restrict adata, const double* restrict diag,
+	const double* restrict vstart, const int maxiter, const int maxvec, const double tol,
+	double* restrict lambda, double* restrict u, int* restrict num_matvec);
+
+int eigensystem_davidson_hermitian(const long n, lanczos_linear_func_z afunc, const void* restrict adata, const double* restrict diag,
+	const dcomplex* restrict vstart, const int maxiter, const int maxvec, const double tol,
+	double* restrict lambda, dcomplex* restrict u, int* restrict num_matvec);
+
+//________________________________________________________________________________________________________________________
+//
+
+int eigensystem_krylov_restarted_symmetric(const long n, lanczos_linear_func_d afunc, const void* restrict adata,
+	const double* restrict vstart, const int maxiter, const int maxvec, const int numeig, const double tol,
+	double* restrict lambda, double* restrict u_ritz, int* restrict num_matvec);
+
+int eigensystem_krylov_restarted_hermitian(const long n, lanczos_linear_func_z afunc, const void* restrict adata,
+	const dcomplex* restrict vstart, const int maxiter, const int maxvec, const int numeig, const double tol,
+	double* restrict lambda, dcomplex* restrict u_ritz, int* restrict num_matvec);
@@ -134,6 +134,10 @@ char* test_dmrg_singlesite()
 
 	double* en_sweeps = ct_malloc(num_sweeps * sizeof(double));
 
+	// copy of initial state for running DMRG with Davidson eigensolver
+	struct mps psi_start;
+	copy_mps(&psi, &psi_start);
+
 	if (dmrg_singlesite(&hamiltonian, num_sweeps, maxiter_lanczos, &psi, en_sweeps) < 0) {
 		return "'dmrg_singlesite' failed internally";
 	}
@@ -213,8 +217,42 @@ char* test_dmrg_singlesite()
 		return "overlap between optimized and reference state vector must have absolute value 1";
 	}
 
+	// run DMRG with Davidson and restarted Lanczos eigensolvers (with small memory cap), and in mixed-precision mode, starting from the same initial state
+	const struct dmrg_options opts_list[3] = {
+		{ .eigensolver = DMRG_EIGENSOLVER_DAVIDSON,          .maxiter = 100, .tol_eigensolver = 1e-10 },
+		{ .eigensolver = DMRG_EIGENSOLVER_LANCZOS_RESTARTED, .maxiter = 200, .max_vectors = 8, .tol_eigensolver = 1e-10 },
+		{ .eigensolver = DMRG_EIGENSOLVER_LANCZOS,           .maxiter = maxiter_lanczos, .num_sweeps_single = num_sweeps / 2 },
+	};
+	// single-site DMRG is not fully converged yet after the last sweep, such that the single precision sweeps lead to small deviations
+	const double tol_list[3] = { 1e-10, 1e-10, 1e-8 };
+	for (int k = 0; k < 3; k++)
+	{
+		const struct dmrg_options* opts = &opts_list[k];
+		struct mps psi_opt;
+		copy_mps(&psi_start, &psi_opt);
+		struct dmrg_statistics stats;
+		if (dmrg_singlesite_options(&hamiltonian, num_sweeps, opts, &psi_opt, en_sweeps, NULL, &stats) < 0) {
+			return "'dmrg_singlesite_options' failed internally";
+		}
+		if (fabs(en_sweeps[num_sweeps - 1] - en_sweeps_ref[num_sweeps - 1]) > tol_list[k]) {
+			return "final energy of DMRG using Davidson or restarted Lanczos eigensolver or mixed precision does not match reference";
+		}
+		if (stats.num_local_opt != 2 * num_sweeps * (nsites - 1)) {
+			return "number of local optimizations reported by DMRG does not match expected number";
+		}
+		if (stats.num_matvec < stats.num_local_opt || stats.num_matvec > opts->maxiter * stats.num_local_opt) {
+			return "number of local Hamiltonian applications reported by DMRG is not within valid range";
+		}
+		mps_vdot(&psi_opt, &psi_ref, &overlap);
+		if (fabs(cabs(overlap) - 1) > tol_list[k]) {
+			return "overlap between state vector optimized using Davidson or restarted Lanczos eigensolver or mixed precision and reference state vector must have absolute value 1";
+		}
+		delete_mps(&psi_opt);
+	}
+
 	ct_free(en_sweeps_ref);
 	ct_free(en_sweeps);
+	delete_mps(&psi_start);
 	delete_mps(&psi_ref);
 	delete_mps(&psi);
 	delete_mpo(&hamiltonian);
@@ -360,6 +398,10 @@ char* test_dmrg_twosite()
 	double* en_sweeps = ct_malloc(num_sweeps * sizeof(double));
 	double* entropy   = ct_malloc((nsites - 1) * sizeof(double));
 
+	// store initial state for later comparison
+	struct mps psi_start;
+	copy_mps(&psi, &psi_start);
+
 	if (dmrg_twosite(&hamiltonian, num_sweeps, maxiter_lanczos, tol_split, max_vdim, &psi, en_sweeps, entropy) < 0) {
 		return "'dmrg_twosite' failed internally";
 	}
@@ -439,9 +481,229 @@ char* test_dmrg_twosite()
 		return "overlap between optimized and reference state vector must have absolute value 1";
 	}
 
+	// run DMRG with a bond dimension schedule and convergence tolerances, starting from the same initial state
+	{
+		const int max_num_sweeps = 12;
+		const long max_vdim_sweeps[12] = { 4, 8, 16, max_vdim, max_vdim, max_vdim, max_vdim, max_vdim, max_vdim, max_vdim, max_vdim, max_vdim };
+		const struct dmrg_options opts = {
+			.eigensolver = DMRG_EIGENSOLVER_LANCZOS, .maxiter = maxiter_lanczos,
+			.tol_energy = 1e-10, .tol_trunc = 1e-4, .tol_variance = 1e-4, .max_vdim_sweeps = max_vdim_sweeps };
+		struct mps psi_opt;
+		copy_mps(&psi_start, &psi_opt);
+		double* en_sweeps_opt = ct_malloc(max_num_sweeps * sizeof(double));
+		struct dmrg_sweep_info* sweep_info = ct_malloc(max_num_sweeps * sizeof(struct dmrg_sweep_info));
+		struct dmrg_statistics stats;
+		if (dmrg_twosite_options(&hamiltonian, max_num_sweeps, &opts, tol_split, max_vdim, &psi_opt, en_sweeps_opt, entropy, sweep_info, &stats) < 0) {
+			return "'dmrg_twosite_options' failed internally";
+		}
+		// sweeps must terminate early, but not before the final bond dimension of the schedule has been reached
+		if (!stats.converged || stats.num_sweeps <= 3 || stats.num_sweeps >= max_num_sweeps) {
+			return "DMRG with convergence tolerances did not terminate early after reaching convergence";
+		}
+		if (stats.num_local_opt != stats.num_sweeps * (2 * nsites - 3)) {
+			return "number of local optimizations reported by DMRG does not match expected number";
+		}
+		long num_matvec = 0;
+		for (int n = 0; n < stats.num_sweeps; n++)
+		{
+			if (sweep_info[n].energy != en_sweeps_opt[n]) {
+				return "energy in sweep diagnostics does not match recorded energy of sweep";
+			}
+			if (sweep_info[n].max_vdim > max_vdim_sweeps[n]) {
+				return "virtual bond dimension exceeds the scheduled maximum";
+			}
+			if (sweep_info[n].trunc_error < 0 || sweep_info[n].variance < -1e-12) {
+				return "truncation error and energy variance in sweep diagnostics must be non-negative";
+			}
+			num_matvec += sweep_info[n].num_matvec;
+		}
+		if (num_matvec != stats.num_matvec) {
+			return "number of local Hamiltonian applications in sweep diagnostics does not match total number";
+		}
+		const struct dmrg_sweep_info* info_last = &sweep_info[stats.num_sweeps - 1];
+		if (info_last->energy_change > opts.tol_energy || info_last->variance > opts.tol_variance) {
+			return "convergence criteria are not satisfied after the last sweep";
+		}
+		// reference energy after fewer sweeps is not fully converged yet
+		if (fabs(en_sweeps_opt[stats.num_sweeps - 1] - en_sweeps_ref[num_sweeps - 1]) > 1e-8) {
+			return "final energy of DMRG with convergence tolerances does not match reference";
+		}
+		ct_free(sweep_info);
+		ct_free(en_sweeps_opt);
+		delete_mps(&psi_opt);
+	}
+
+	// run two-site DMRG with the restarted Lanczos eigensolver, using a fixed and an adaptive tolerance, starting from the same initial state
+	{
+		const int max_num_sweeps = 6;
+		const struct dmrg_options opts_list[2] = {
+			{ .eigensolver = DMRG_EIGENSOLVER_LANCZOS_RESTARTED, .maxiter = 200, .max_vectors = 16, .tol_eigensolver = 1e-10 },
+			{ .eigensolver = DMRG_EIGENSOLVER_LANCZOS_RESTARTED, .maxiter = 200, .max_vectors = 16, .tol_eigensolver = 1e-10, .tol_eigensolver_trunc_ratio = 0.001 },
+		};
+		struct dmrg_sweep_info sweep_info[2][6];
+		struct dmrg_statistics stats[2];
+		for (int k = 0; k < 2; k++)
+		{
+			struct mps psi_opt;
+			copy_mps(&psi_start, &psi_opt);
+			double en_sweeps_opt[6];
+			if (dmrg_twosite_options(&hamiltonian, max_num_sweeps, &opts_list[k], tol_split, max_vdim, &psi_opt, en_sweeps_opt, entropy, sweep_info[k], &stats[k]) < 0) {
+				return "'dmrg_twosite_options' failed internally";
+			}
+			// reference energy after fewer sweeps is not fully converged yet
+			if (fabs(en_sweeps_opt[max_num_sweeps - 1] - en_sweeps_ref[num_sweeps - 1]) > 1e-8) {
+				return "final energy of two-site DMRG using restarted Lanczos eigensolver does not match reference";
+			}
+			delete_mps(&psi_opt);
+		}
+		// adaptive tolerance must not deteriorate the energy beyond the truncation error
+		if (fabs(sweep_info[1][max_num_sweeps - 1].energy - sweep_info[0][max_num_sweeps - 1].energy) > 1e-8) {
+			return "final energy of two-site DMRG with adaptive eigensolver tolerance does not match energy with fixed tolerance";
+		}
+		// local eigenvalue problems in later sweeps must converge with fewer iterations due to the adaptive tolerance
+		if (sweep_info[1][max_num_sweeps - 1].num_matvec >= sweep_info[0][max_num_sweeps - 1].num_matvec || stats[1].num_matvec >= stats[0].num_matvec) {
+			return "adaptive eigensolver tolerance does not reduce the number of local Hamiltonian applications";
+		}
+	}
+
+	// run single-site DMRG with subspace expansion, starting from the same initial state
+	{
+		const int max_num_sweeps = 12;
+		const struct dmrg_options opts = {
+			.eigensolver = DMRG_EIGENSOLVER_LANCZOS, .maxiter = maxiter_lanczos, .tol_energy = 1e-10,
+			.expansion_alpha = 0.1, .expansion_decay = 0.1, .tol_expansion = 1e-8, .max_vdim_expansion = max_vdim };
+		struct mps psi_opt;
+		copy_mps(&psi_start, &psi_opt);
+		double* en_sweeps_opt = ct_malloc(max_num_sweeps * sizeof(double));
+		struct dmrg_sweep_info* sweep_info = ct_malloc(max_num_sweeps * sizeof(struct dmrg_sweep_info));
+		struct dmrg_statistics stats;
+		if (dmrg_singlesite_options(&hamiltonian, max_num_sweeps, &opts, &psi_opt, en_sweeps_opt, sweep_info, &stats) < 0) {
+			return "'dmrg_singlesite_options' failed internally";
+		}
+		if (!stats.converged || stats.num_sweeps >= max_num_sweeps) {
+			return "single-site DMRG with subspace expansion did not converge";
+		}
+		// virtual bond dimensions must have increased beyond the ones of the initial state, up to the maximum
+		const struct dmrg_sweep_info* info_last = &sweep_info[stats.num_sweeps - 1];
+		if (info_last->max_vdim != max_vdim || mps_bond_dim(&psi_opt, nsites / 2) != max_vdim) {
+			return "virtual bond dimensions have not been increased by the subspace expansion";
+		}
+		if (fabs(mps_norm(&psi_opt) - 1) > 1e-12) {
+			return "state vector optimized by single-site DMRG with subspace expansion is not normalized";
+		}
+		// energy must agree with expectation value of the Hamiltonian
+		dcomplex en_expect;
+		mpo_inner_product(&psi_opt, &hamiltonian, &psi_opt, &en_expect);
+		if (cabs(en_expect - info_last->energy) > 1e-12) {
+			return "energy of single-site DMRG with subspace expansion does not match the expectation value of the Hamiltonian";
+		}
+		// reference two-site DMRG truncates with a larger tolerance, resulting in a slightly higher energy
+		if (info_last->energy > en_sweeps_ref[num_sweeps - 1] || info_last->energy < en_sweeps_ref[num_sweeps - 1] - 1e-4) {
+			return "energy of single-site DMRG with subspace expansion is not consistent with reference energy of two-site DMRG";
+		}
+		ct_free(sweep_info);
+		ct_free(en_sweeps_opt);
+		delete_mps(&psi_opt);
+	}
+
+	// run single-site and two-site DMRG with a tiny memory budget for the operator blocks, such that all blocks not in use are spilled to disk
+	{
+		const int num_sweeps_spill = 3;
+		for (int k = 0; k < 2; k++)
+		{
+			struct mps psi_opt[2];
+			double en_sweeps_opt[2][3];
+			for (int j = 0; j < 2; j++)
+			{
+				const struct dmrg_options opts = {
+					.eigensolver = DMRG_EIGENSOLVER_LANCZOS, .maxiter = maxiter_lanczos,
+					.expansion_alpha = 0.1, .tol_expansion = 1e-8, .max_vdim_expansion = max_vdim, .env_ram_budget = (j == 0 ? 0 : 1) };
+				copy_mps(&psi_start, &psi_opt[j]);
+				if (k == 0) {
+					if (dmrg_singlesite_options(&hamiltonian, num_sweeps_spill, &opts, &psi_opt[j], en_sweeps_opt[j], NULL, NULL) < 0) {
+						return "'dmrg_singlesite_options' failed internally";
+					}
+				}
+				else {
+					if (dmrg_twosite_options(&hamiltonian, num_sweeps_spill, &opts, tol_split, max_vdim, &psi_opt[j], en_sweeps_opt[j], entropy, NULL, NULL) < 0) {
+						return "'dmrg_twosite_options' failed internally";
+					}
+				}
+			}
+			// spilling the operator blocks must not change the results
+			for (int n = 0; n < num_sweeps_spill; n++) {
+				if (en_sweeps_opt[1][n] != en_sweeps_opt[0][n]) {
+					return "DMRG energies with operator blocks spilled to disk do not match energies with operator blocks kept in memory";
+				}
+			}
+			for (int i = 0; i < nsites; i++) {
+				if (!block_sparse_tensor_allclose(&psi_opt[1].a[i], &psi_opt[0].a[i], 0)) {
+					return "DMRG state with operator blocks spilled to disk does not match state with operator blocks kept in memory";
+				}
+			}
+			delete_mps(&psi_opt[1]);
+			delete_mps(&psi_opt[0]);
+		}
+	}
+
+	// run real-space parallel two-site DMRG with different numbers of segments, starting from the same initial state
+	{
+		const int max_num_sweeps = 8;
+		const struct dmrg_options opts = { .eigensolver = DMRG_EIGENSOLVER_LANCZOS, .maxiter = maxiter_lanczos, .tol_energy = 1e-10 };
+		// the truncation of the reference data depends on the optimization path, hence using a tight splitting tolerance
+		const double tol_split_parallel = 1e-10;
+		double* en_sweeps_opt = ct_malloc(max_num_sweeps * sizeof(double));
+
+		// sequential two-site DMRG for comparison
+		double en_seq;
+		{
+			struct mps psi_seq;
+			copy_mps(&psi_start, &psi_seq);
+			struct dmrg_statistics stats;
+			if (dmrg_twosite_options(&hamiltonian, max_num_sweeps, &opts, tol_split_parallel, max_vdim, &psi_seq, en_sweeps_opt, entropy, NULL, &stats) < 0) {
+				return "'dmrg_twosite_options' failed internally";
+			}
+			en_seq = en_sweeps_opt[stats.num_sweeps - 1];
+			delete_mps(&psi_seq);
+		}
+		// reference DMRG truncates with a larger tolerance, resulting in a slightly higher energy
+		if (en_seq > en_sweeps_ref[num_sweeps - 1] || en_seq < en_sweeps_ref[num_sweeps - 1] - 1e-4) {
+			return "energy of two-site DMRG with tight splitting tolerance is not consistent with reference energy";
+		}
+
+		for (int num_segments = 1; num_segments <= 3; num_segments++)
+		{
+			struct mps psi_opt;
+			copy_mps(&psi_start, &psi_opt);
+			struct dmrg_statistics stats;
+			if (dmrg_twosite_parallel(&hamiltonian, max_num_sweeps, num_segments, &opts, tol_split_parallel, max_vdim, &psi_opt, en_sweeps_opt, &stats) < 0) {
+				return "'dmrg_twosite_parallel' failed internally";
+			}
+			if (!stats.converged || stats.num_sweeps >= max_num_sweeps) {
+				return "parallel DMRG did not terminate early after reaching convergence";
+			}
+			if (fabs(en_sweeps_opt[stats.num_sweeps - 1] - en_seq) > 1e-10) {
+				return "final energy of parallel DMRG does not match energy of sequential DMRG";
+			}
+			if (fabs(mps_norm(&psi_opt) - 1) > 1e-12) {
+				return "state vector optimized by parallel DMRG is not normalized";
+			}
+			// energy of the merged state must agree with expectation value of the Hamiltonian
+			dcomplex en_expect;
+			mpo_inner_product(&psi_opt, &hamiltonian, &psi_opt, &en_expect);
+			if (cabs(en_expect - en_seq) > 1e-10) {
+				return "energy of the merged state optimized by parallel DMRG does not match energy of sequential DMRG";
+			}
+			delete_mps(&psi_opt);
+		}
+
+		ct_free(en_sweeps_opt);
+	}
+
 	ct_free(entropy);
 	ct_free(en_sweeps_ref);
 	ct_free(en_sweeps);
+	delete_mps(&psi_start);
 	delete_mps(&psi_ref);
 	delete_mps(&psi);
 	delete_mpo(&hamiltonian);
@@ -0,0 +1,125 @@
+#include "environment_cache.h"
+#include "rng.h"
+#include "aligned_memory.h"
+
+
+char* test_environment_cache()
+{
+	struct rng_state rng_state;
+	seed_rng_state(47, &rng_state);
+
+	const int num_blocks = 6;
+
+	const long dims[3] = { 7, 4, 9 };
+	const enum tensor_axis_direction axis_dir[3] = { TENSOR_AXIS_OUT, TENSOR_AXIS_IN, TENSOR_AXIS_IN };
+	qnumber* qnums[3];
+	for (int i = 0; i < 3; i++)
+	{
+		qnums[i] = ct_malloc(dims[i] * sizeof(qnumber));
+		for (long j = 0; j < dims[i]; j++) {
+			qnums[i][j] = (qnumber)rand_interval(3, &rng_state) - 1;
+		}
+	}
+
+	// reference tensors
+	const enum numeric_type dtype = CT_DOUBLE_COMPLEX;
+	struct block_sparse_tensor ref[6];
+	for (int i = 0; i < num_blocks; i++)
+	{
+		allocate_block_sparse_tensor(dtype, 3, dims, axis_dir, (const qnumber**)qnums, &ref[i]);
+		block_sparse_tensor_fill_random_normal(numeric_one(dtype), numeric_zero(dtype), &rng_state, &ref[i]);
+		if (i % 2 == 1) {
+			// test both storage layouts
+			block_sparse_tensor_make_contiguous(&ref[i]);
+		}
+	}
+	const size_t size = block_sparse_tensor_num_elements_blocks(&ref[0]) * sizeof_numeric_type(dtype);
+
+	// memory budget sufficient for two blocks
+	struct environment_cache cache;
+	create_environment_cache(num_blocks, 2 * size + size / 2, NULL, &cache);
+
+	for (int i = 0; i < num_blocks; i++)
+	{
+		copy_block_sparse_tensor(&ref[i], &cache.blocks[i]);
+		if (environment_cache_store(&cache, i) < 0) {
+			return "storing a block in the environment cache failed";
+		}
+		if (cache.ram_usage > cache.ram_budget) {
+			return "memory usage of environment cache exceeds budget";
+		}
+	}
+	// least recently used blocks must have been spilled to disk
+	if (cache.stats.num_writes != num_blocks - 2 || cache.slots[0].resident || !cache.slots[num_blocks - 1].resident) {
+		return "environment cache did not evict the least recently used blocks";
+	}
+
+	// access blocks in reverse order, prefetching the respective next block
+	for (int i = num_blocks - 1; i >= 0; i--)
+	{
+		if (environment_cache_acquire(&cache, i) < 0) {
+			return "acquiring a block from the environment cache failed";
+		}
+		if (i > 0) {
+			environment_cache_prefetch(&cache, i - 1);
+		}
+		if (!block_sparse_tensor_allclose(&cache.blocks[i], &ref[i], 0)) {
+			return "block retrieved from environment cache does not match reference";
+		}
+		environment_cache_release(&cache, i);
+	}
+	if (cache.stats.num_prefetches == 0) {
+		return "environment cache did not prefetch any block";
+	}
+	if (cache.stats.peak_ram_usage > 3 * size) {
+		return "peak memory usage of environment cache exceeds budget, including a single block in use";
+	}
+
+	// blocks which have been read back must not be written again
+	const long num_writes = cache.stats.num_writes;
+	for (int i = 0; i < num_blocks; i++)
+	{
+		if (environment_cache_acquire(&cache, i) < 0) {
+			return "acquiring a block from the environment cache failed";
+		}
+		environment_cache_release(&cache, i);
+	}
+	if (cache.stats.num_writes != num_writes) {
+		return "environment cache has written unmodified blocks to disk again";
+	}
+
+	// replace a spilled block by a different tensor
+	environment_cache_discard(&cache, 0);
+	copy_block_sparse_tensor(&ref[3], &cache.blocks[0]);
+	if (environment_cache_store(&cache, 0) < 0) {
+		return "storing a block in the environment cache failed";
+	}
+	for (int i = 1; i < num_blocks; i++)
+	{
+		if (environment_cache_acquire(&cache, i) < 0) {
+			return "acquiring a block from the environment cache failed";
+		}
+		environment_cache_release(&cache, i);
+	}
+	if (cache.slots[0].resident) {
+		return "environment cache did not evict the least recently used block";
+	}
+	if (environment_cache_acquire(&cache, 0) < 0) {
+		return "acquiring a block from the environment cache failed";
+	}
+	if (!block_sparse_tensor_allclose(&cache.blocks[0], &ref[3], 0)) {
+		return "replaced block retrieved from environment cache does not match reference";
+	}
+	environment_cache_release(&cache, 0);
+
+	delete_environment_cache(&cache);
+
+	for (int i = 0; i < num_blocks; i++) {
+		delete_block_sparse_tensor(&ref[i]);
+	}
+	for (int i = 0; i < 3; i++) {
+		ct_free(qnums[i]);
+	}
+
+	return 0;
+}
@@ -4,6 +4,7 @@
 #include "mpo.h"
 #include "aligned_memory.h"
 #include "numerical_gradient.h"
+#include "rng.h"
 
 
 #define ARRLEN(a) (sizeof(a) / sizeof(a[0]))
@@ -297,6 +298,29 @@ char* test_operator_average_coefficient_gradient()
 		return "gradient with respect to coefficients computed by 'operator_average_coefficient_gradient' does not match finite difference approximation";
 	}
 
+	// state in a different quantum number sector, such that the average value and gradient are logically zero
+	{
+		struct rng_state rng_state;
+		seed_rng_state(45, &rng_state);
+
+		const qnumber qnum_sector_psi = qbonds_psi[nsites][0];
+		const qnumber qnum_sector = (qnum_sector_psi <= 0 ? qnum_sector_psi + 1 : qnum_sector_psi - 1);
+		struct mps chi_other;
+		construct_random_mps(CT_SINGLE_COMPLEX, nsites, d, qsite, qnum_sector, 8, &rng_state, &chi_other);
+
+		operator_average_coefficient_gradient(&assembly, &psi, &chi_other, &avr, dcoeff);
+		if (avr != 0) {
+			return "average value between states in different quantum number sectors must be zero";
+		}
+		for (int i = 0; i < num_coeffs; i++) {
+			if (dcoeff[i] != 0) {
+				return "gradient of average value between states in different quantum number sectors must be zero";
+			}
+		}
+
+		delete_mps(&chi_other);
+	}
+
 	// clean up
 	ct_free(dcoeff_ref);
 	ct_free(dcoeff);
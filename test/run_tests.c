@@ -14,11 +14,13 @@ struct test
 char* test_dense_tensor_trace();
 char* test_dense_tensor_cyclic_partial_trace();
 char* test_dense_tensor_transpose();
+char* test_dense_tensor_transpose_tiled();
 char* test_dense_tensor_slice();
 char* test_dense_tensor_multiply_pointwise();
 char* test_dense_tensor_multiply_axis();
 char* test_dense_tensor_dot();
 char* test_dense_tensor_dot_update();
+char* test_dense_tensor_contract();
 char* test_dense_tensor_kronecker_product();
 char* test_dense_tensor_kronecker_product_degree_zero();
 char* test_dense_tensor_concatenate();
@@ -27,6 +29,8 @@ char* test_dense_tensor_qr();
 char* test_dense_tensor_rq();
 char* test_dense_tensor_svd();
 char* test_dense_tensor_block();
+char* test_small_k_gemm();
+char* test_block_sparse_tensor_allocate();
 char* test_block_sparse_tensor_copy();
 char* test_block_sparse_tensor_get_block();
 char* test_block_sparse_tensor_cyclic_partial_trace();
@@ -45,6 +49,7 @@ char* test_block_sparse_tensor_rq();
 char* test_block_sparse_tensor_svd();
 char* test_block_sparse_tensor_serialize();
 char* test_block_sparse_tensor_get_entry();
+char* test_block_sparse_tensor_lazy_view();
 char* test_clebsch_gordan_coefficients();
 char* test_su2_tree_enumerate_charge_sectors();
 char* test_su2_fuse_split_tree_enumerate_charge_sectors();
@@ -58,6 +63,7 @@ char* test_mps_compress();
 char* test_mps_split_tensor_svd();
 char* test_mps_to_statevector();
 char* test_ttns_vdot();
+char* test_aligned_memory();
 char* test_queue();
 char* test_linked_list();
 char* test_hash_table();
@@ -69,6 +75,12 @@ char* test_lanczos_iteration_d();
 char* test_lanczos_iteration_z();
 char* test_eigensystem_krylov_symmetric();
 char* test_eigensystem_krylov_hermitian();
+char* test_eigensystem_krylov_symmetric_single();
+char* test_eigensystem_krylov_hermitian_single();
+char* test_eigensystem_davidson_symmetric();
+char* test_eigensystem_davidson_hermitian();
+char* test_eigensystem_krylov_restarted_symmetric();
+char* test_eigensystem_krylov_restarted_hermitian();
 char* test_mpo_graph_from_opchains_basic();
 char* test_mpo_graph_from_opchains_advanced();
 char* test_mpo_from_assembly();
@@ -86,6 +98,7 @@ char* test_split_block_sparse_matrix_svd_zero();
 char* test_mpo_inner_product();
 char* test_apply_mpo();
 char* test_ttno_inner_product();
+char* test_environment_cache();
 char* test_dmrg_singlesite();
 char* test_dmrg_twosite();
 char* test_operator_average_coefficient_gradient();
@@ -100,12 +113,14 @@ int main()
 		TEST_FUNCTION_ENTRY(test_dense_tensor_trace),
 		TEST_FUNCTION_ENTRY(test_dense_tensor_cyclic_partial_trace),
 		TEST_FUNCTION_ENTRY(test_dense_tensor_transpose),
+		TEST_FUNCTION_ENTRY(test_dense_tensor_transpose_tiled),
 		TEST_FUNCTION_ENTRY(test_dense_tensor_slice),
 		TEST_FUNCTION_ENTRY(test_dense_tensor_pad_zeros),
 		TEST_FUNCTION_ENTRY(test_dense_tensor_multiply_pointwise),
 		TEST_FUNCTION_ENTRY(test_dense_tensor_multiply_axis),
 		TEST_FUNCTION_ENTRY(test_dense_tensor_dot),
 		TEST_FUNCTION_ENTRY(test_dense_tensor_dot_update),
+		TEST_FUNCTION_ENTRY(test_dense_tensor_contract),
 		TEST_FUNCTION_ENTRY(test_dense_tensor_kronecker_product),
 		TEST_FUNCTION_ENTRY(test_dense_tensor_kronecker_product_degree_zero),
 		TEST_FUNCTION_ENTRY(test_dense_tensor_concatenate),
@@ -114,6 +129,8 @@ int main()
 		TEST_FUNCTION_ENTRY(test_dense_tensor_rq),
 		TEST_FUNCTION_ENTRY(test_dense_tensor_svd),
 		TEST_FUNCTION_ENTRY(test_dense_tensor_block),
+		TEST_FUNCTION_ENTRY(test_small_k_gemm),
+		TEST_FUNCTION_ENTRY(test_block_sparse_tensor_allocate),
 		TEST_FUNCTION_ENTRY(test_block_sparse_tensor_copy),
 		TEST_FUNCTION_ENTRY(test_block_sparse_tensor_get_block),
 		TEST_FUNCTION_ENTRY(test_block_sparse_tensor_cyclic_partial_trace),
@@ -131,6 +148,7 @@ int main()
 		TEST_FUNCTION_ENTRY(test_block_sparse_tensor_svd),
 		TEST_FUNCTION_ENTRY(test_block_sparse_tensor_serialize),
 		TEST_FUNCTION_ENTRY(test_block_sparse_tensor_get_entry),
+		TEST_FUNCTION_ENTRY(test_block_sparse_tensor_lazy_view),
 		TEST_FUNCTION_ENTRY(test_clebsch_gordan_coefficients),
 		TEST_FUNCTION_ENTRY(test_su2_tree_enumerate_charge_sectors),
 		TEST_FUNCTION_ENTRY(test_su2_fuse_split_tree_enumerate_charge_sectors),
@@ -144,6 +162,7 @@ int main()
 		TEST_FUNCTION_ENTRY(test_mps_split_tensor_svd),
 		TEST_FUNCTION_ENTRY(test_mps_to_statevector),
 		TEST_FUNCTION_ENTRY(test_ttns_vdot),
+		TEST_FUNCTION_ENTRY(test_aligned_memory),
 		TEST_FUNCTION_ENTRY(test_queue),
 		TEST_FUNCTION_ENTRY(test_linked_list),
 		TEST_FUNCTION_ENTRY(test_hash_table),
@@ -155,6 +174,12 @@ int main()
 		TEST_FUNCTION_ENTRY(test_lanczos_iteration_z),
 		TEST_FUNCTION_ENTRY(test_eigensystem_krylov_symmetric),
 		TEST_FUNCTION_ENTRY(test_eigensystem_krylov_hermitian),
+		TEST_FUNCTION_ENTRY(test_eigensystem_krylov_symmetric_single),
+		TEST_FUNCTION_ENTRY(test_eigensystem_krylov_hermitian_single),
+		TEST_FUNCTION_ENTRY(test_eigensystem_davidson_symmetric),
+		TEST_FUNCTION_ENTRY(test_eigensystem_davidson_hermitian),
+		TEST_FUNCTION_ENTRY(test_eigensystem_krylov_restarted_symmetric),
+		TEST_FUNCTION_ENTRY(test_eigensystem_krylov_restarted_hermitian),
 		TEST_FUNCTION_ENTRY(test_mpo_graph_from_opchains_basic),
 		TEST_FUNCTION_ENTRY(test_mpo_graph_from_opchains_advanced),
 		TEST_FUNCTION_ENTRY(test_mpo_from_assembly),
@@ -172,6 +197,7 @@ int main()
 		TEST_FUNCTION_ENTRY(test_mpo_inner_product),
 		TEST_FUNCTION_ENTRY(test_apply_mpo),
 		TEST_FUNCTION_ENTRY(test_ttno_inner_product),
+		TEST_FUNCTION_ENTRY(test_environment_cache),
 		TEST_FUNCTION_ENTRY(test_dmrg_singlesite),
 		TEST_FUNCTION_ENTRY(test_dmrg_twosite),
 		TEST_FUNCTION_ENTRY(test_operator_average_coefficient_gradient),
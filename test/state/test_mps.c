@@ -310,6 +310,24 @@ char* test_mps_orthonormalize_qr()
 		delete_mps(&mps);
 	}
 
+	// logically zero MPS, since the overall quantum number sector cannot be reached by the physical quantum numbers
+	{
+		struct rng_state rng_state;
+		seed_rng_state(43, &rng_state);
+
+		const qnumber qsite_zero[2] = { 0, 1 };
+		for (int m = 0; m < 2; m++)
+		{
+			struct mps mps;
+			construct_random_mps(CT_DOUBLE_REAL, 3, 2, qsite_zero, 7, 4, &rng_state, &mps);
+			double norm = mps_orthonormalize_qr(&mps, m == 0 ? MPS_ORTHONORMAL_LEFT : MPS_ORTHONORMAL_RIGHT);
+			if (norm != 0) {
+				return "norm of logically zero MPS after orthonormalization must be zero";
+			}
+			delete_mps(&mps);
+		}
+	}
+
 	for (int i = 0; i < nsites + 1; i++)
 	{
 		ct_free(qbonds[i]);
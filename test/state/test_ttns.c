@@ -112,7 +112,7 @@ char* test_ttns_vdot()
 		struct block_sparse_tensor t_vdot_ref;
 		block_sparse_tensor_dot(&chi_vec_conj, TENSOR_AXIS_RANGE_TRAILING, &psi_vec, TENSOR_AXIS_RANGE_TRAILING, 2, &t_vdot_ref);
 		assert(t_vdot_ref.ndim == 0);
-		assert(t_vdot_ref.blocks[0] != NULL);
+		assert(t_vdot_ref.nblocks == 1);
 		assert(t_vdot_ref.blocks[0]->data != NULL);
 
 		s_ref = *((scomplex*)t_vdot_ref.blocks[0]->data);
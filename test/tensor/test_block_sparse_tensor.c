@@ -1,8 +1,95 @@
 #include <math.h>
+#include <limits.h>
 #include "block_sparse_tensor.h"
+#include "rng.h"
 #include "aligned_memory.h"
 
 
+#ifdef CHEMTENSOR_OPENBLAS_NUM_THREADS
+int openblas_get_num_threads(void);
+#endif
+
+
+char* test_block_sparse_tensor_allocate()
+{
+	struct rng_state rng_state;
+	seed_rng_state(36, &rng_state);
+
+	const int ndim = 4;
+	const long dims[4] = { 37, 11, 53, 24 };
+	const enum tensor_axis_direction axis_dir[4] = { TENSOR_AXIS_OUT, TENSOR_AXIS_IN, TENSOR_AXIS_OUT, TENSOR_AXIS_IN };
+
+	// random quantum numbers, including negative values
+	qnumber** qnums = ct_malloc(ndim * sizeof(qnumber*));
+	for (int i = 0; i < ndim; i++)
+	{
+		qnums[i] = ct_malloc(dims[i] * sizeof(qnumber));
+		for (long j = 0; j < dims[i]; j++) {
+			qnums[i][j] = (qnumber)rand_interval(2*i + 7, &rng_state) - (i + 3);
+		}
+	}
+
+	struct block_sparse_tensor t;
+	allocate_block_sparse_tensor(CT_DOUBLE_REAL, ndim, dims, axis_dir, (const qnumber**)qnums, &t);
+
+	// block quantum numbers must be distinct and sorted
+	for (int i = 0; i < ndim; i++)
+	{
+		for (long j = 0; j < t.dim_blocks[i]; j++)
+		{
+			if (j > 0 && t.qnums_blocks[i][j - 1] >= t.qnums_blocks[i][j]) {
+				return "block quantum numbers are not sorted in strictly ascending order";
+			}
+		}
+	}
+
+	// compare with enumeration of all blocks in the virtual grid
+	const long ngrid = integer_product(t.dim_blocks, ndim);
+	long* index_block = ct_calloc(ndim, sizeof(long));
+	long nblocks = 0;
+	for (long k = 0; k < ngrid; k++, next_tensor_index(ndim, t.dim_blocks, index_block))
+	{
+		qnumber qsum = 0;
+		for (int i = 0; i < ndim; i++) {
+			qsum += axis_dir[i] * t.qnums_blocks[i][index_block[i]];
+		}
+		if (qsum != 0) {
+			continue;
+		}
+		if (nblocks >= t.nblocks || t.grid_offsets[nblocks] != k) {
+			return "grid offsets of conserved blocks do not match reference";
+		}
+		const struct dense_tensor* b = t.blocks[nblocks];
+		for (int i = 0; i < ndim; i++)
+		{
+			long count = 0;
+			for (long j = 0; j < dims[i]; j++) {
+				if (qnums[i][j] == t.qnums_blocks[i][index_block[i]]) {
+					count++;
+				}
+			}
+			if (b->dim[i] != count) {
+				return "block dimension does not match quantum number multiplicity";
+			}
+		}
+		nblocks++;
+	}
+	if (nblocks != t.nblocks) {
+		return "number of conserved blocks does not match reference";
+	}
+	ct_free(index_block);
+
+	// clean up
+	delete_block_sparse_tensor(&t);
+	for (int i = 0; i < ndim; i++) {
+		ct_free(qnums[i]);
+	}
+	ct_free(qnums);
+
+	return 0;
+}
+
+
 char* test_block_sparse_tensor_copy()
 {
 	hid_t file = H5Fopen("../test/tensor/data/test_block_sparse_tensor_copy.hdf5", H5F_ACC_RDONLY, H5P_DEFAULT);
@@ -117,7 +204,7 @@ char* test_block_sparse_tensor_get_block()
 			continue;
 		}
 
-		struct dense_tensor* b_ref = t.blocks[k];
+		struct dense_tensor* b_ref = block_sparse_tensor_find_block(&t, index_block);
 		assert(b_ref != NULL);
 		assert(b_ref->ndim == t.ndim);
 
@@ -211,6 +298,22 @@ char* test_block_sparse_tensor_cyclic_partial_trace()
 		return "cyclic partial trace tensor does not match reference";
 	}
 
+	// evaluate partial trace again, overwriting the entries of an already allocated tensor
+	struct block_sparse_tensor t_tr_fill;
+	allocate_block_sparse_tensor_like(&t_tr, &t_tr_fill);
+	const scomplex fill_value = 3.f;
+	for (long k = 0; k < t_tr_fill.nblocks; k++) {
+		scomplex* data = t_tr_fill.blocks[k]->data;
+		for (long j = 0; j < dense_tensor_num_elements(t_tr_fill.blocks[k]); j++) {
+			data[j] = fill_value;
+		}
+	}
+	block_sparse_tensor_cyclic_partial_trace_fill(&t, ndim_trace, &t_tr_fill);
+	if (!block_sparse_tensor_allclose(&t_tr_fill, &t_tr_ref, 5e-6)) {
+		return "cyclic partial trace tensor computed in-place does not match reference";
+	}
+	delete_block_sparse_tensor(&t_tr_fill);
+
 	// clean up
 	for (int i = 0; i < ndim; i++)
 	{
@@ -343,6 +446,16 @@ char* test_block_sparse_tensor_transpose()
 	struct block_sparse_tensor t_tp;
 	transpose_block_sparse_tensor(perm, &t, &t_tp);
 
+	// blocks of the transposed tensor must be sorted by grid offsets
+	if (t_tp.nblocks != t.nblocks) {
+		return "number of blocks of transposed block-sparse tensor does not match original tensor";
+	}
+	for (long k = 0; k < t_tp.nblocks - 1; k++) {
+		if (t_tp.grid_offsets[k] >= t_tp.grid_offsets[k + 1]) {
+			return "blocks of transposed block-sparse tensor are not sorted";
+		}
+	}
+
 	// convert back to a dense tensor
 	struct dense_tensor t_tp_dns;
 	block_sparse_to_dense_tensor(&t_tp, &t_tp_dns);
@@ -352,6 +465,15 @@ char* test_block_sparse_tensor_transpose()
 		return "transposed block-sparse tensor does not match reference";
 	}
 
+	// transpose again, overwriting the entries of an already allocated tensor
+	struct block_sparse_tensor t_tp_fill;
+	allocate_block_sparse_tensor_like(&t_tp, &t_tp_fill);
+	transpose_block_sparse_tensor_fill(perm, &t, &t_tp_fill);
+	if (!block_sparse_tensor_allclose(&t_tp_fill, &t_tp, 0.)) {
+		return "block-sparse tensor transposed in-place does not match reference";
+	}
+	delete_block_sparse_tensor(&t_tp_fill);
+
 	// clean up
 	for (int i = 0; i < ndim; i++)
 	{
@@ -1040,6 +1162,112 @@ char* test_block_sparse_tensor_dot()
 				return "dot product of block-sparse tensors does not match reference";
 			}
 
+			// repeatedly execute a precomputed contraction plan
+			struct block_sparse_tensor_dot_plan plan;
+			create_block_sparse_tensor_dot_plan(&sp, axrange_s, &tp, axrange_t, ndim_mult, &plan);
+			struct block_sparse_tensor r_plan;
+			allocate_block_sparse_tensor_dot_output(&plan, &r_plan);
+			block_sparse_tensor_dot_execute(&plan, numeric_one(CT_DOUBLE_COMPLEX), &sp, &tp, numeric_zero(CT_DOUBLE_COMPLEX), &r_plan);
+			block_sparse_tensor_dot_execute(&plan, numeric_one(CT_DOUBLE_COMPLEX), &sp, &tp, numeric_one(CT_DOUBLE_COMPLEX),  &r_plan);
+			// parallel execution over output blocks
+			const enum block_sparse_parallel_mode parallel_mode = get_block_sparse_parallel_mode();
+			set_block_sparse_parallel_mode(BLOCK_SPARSE_PARALLEL_BLOCKS);
+			struct block_sparse_tensor r_par;
+			allocate_block_sparse_tensor_dot_output(&plan, &r_par);
+			#ifdef CHEMTENSOR_OPENBLAS_NUM_THREADS
+			const int blas_nthreads = openblas_get_num_threads();
+			#endif
+			block_sparse_tensor_dot_execute(&plan, numeric_one(CT_DOUBLE_COMPLEX), &sp, &tp, numeric_zero(CT_DOUBLE_COMPLEX), &r_par);
+			#ifdef CHEMTENSOR_OPENBLAS_NUM_THREADS
+			if (openblas_get_num_threads() != blas_nthreads) {
+				return "number of BLAS threads not restored after parallel dot product of block-sparse tensors";
+			}
+			#endif
+			set_block_sparse_parallel_mode(parallel_mode);
+			if (!block_sparse_tensor_allclose(&r_par, &r, 1e-13)) {
+				return "parallel dot product of block-sparse tensors does not match reference";
+			}
+			delete_block_sparse_tensor(&r_par);
+
+			if (axrange_t == TENSOR_AXIS_RANGE_TRAILING)
+			{
+				// conjugation within dot product
+				struct block_sparse_tensor tc;
+				copy_block_sparse_tensor(&tp, &tc);
+				conjugate_block_sparse_tensor(&tc);
+				block_sparse_tensor_reverse_axis_directions(&tc);
+				struct block_sparse_tensor r_conj;
+				block_sparse_tensor_dot_conj(&sp, axrange_s, false, &tc, axrange_t, true, ndim_mult, &r_conj);
+				if (!block_sparse_tensor_allclose(&r_conj, &r, 1e-13)) {
+					return "dot product of block-sparse tensors with conjugation does not match reference";
+				}
+				delete_block_sparse_tensor(&r_conj);
+				delete_block_sparse_tensor(&tc);
+			}
+
+			const dcomplex two = 2;
+			scale_block_sparse_tensor(&two, &r);
+			if (!block_sparse_tensor_allclose(&r_plan, &r, 1e-13)) {
+				return "dot product of block-sparse tensors using a precomputed plan does not match reference";
+			}
+			delete_block_sparse_tensor(&r_plan);
+			delete_block_sparse_tensor_dot_plan(&plan);
+
+			// no and all block multiplications executed by the batched small-matrix kernels
+			const long batch_threshold = get_block_sparse_gemm_batch_threshold();
+			for (int b = 0; b < 2; b++)
+			{
+				set_block_sparse_gemm_batch_threshold(b == 0 ? 0 : LONG_MAX);
+				struct block_sparse_tensor_dot_plan plan_batch;
+				create_block_sparse_tensor_dot_plan(&sp, axrange_s, &tp, axrange_t, ndim_mult, &plan_batch);
+				if ((plan_batch.nbatches == 0) != (b == 0)) {
+					return "batching of small block multiplications does not respect threshold";
+				}
+				struct block_sparse_tensor r_batch;
+				allocate_block_sparse_tensor_dot_output(&plan_batch, &r_batch);
+				block_sparse_tensor_dot_execute(&plan_batch, numeric_one(CT_DOUBLE_COMPLEX), &sp, &tp, numeric_zero(CT_DOUBLE_COMPLEX), &r_batch);
+				block_sparse_tensor_dot_execute(&plan_batch, numeric_one(CT_DOUBLE_COMPLEX), &sp, &tp, numeric_one(CT_DOUBLE_COMPLEX),  &r_batch);
+				if (!block_sparse_tensor_allclose(&r_batch, &r, 1e-13)) {
+					return "dot product of block-sparse tensors using batched block multiplications does not match reference";
+				}
+				delete_block_sparse_tensor(&r_batch);
+				delete_block_sparse_tensor_dot_plan(&plan_batch);
+
+				if (axrange_t == TENSOR_AXIS_RANGE_TRAILING)
+				{
+					struct block_sparse_tensor tc;
+					copy_block_sparse_tensor(&tp, &tc);
+					conjugate_block_sparse_tensor(&tc);
+					block_sparse_tensor_reverse_axis_directions(&tc);
+					struct block_sparse_tensor r_conj;
+					block_sparse_tensor_dot_conj(&sp, axrange_s, false, &tc, axrange_t, true, ndim_mult, &r_conj);
+					const double two_real = 2;
+					rscale_block_sparse_tensor(&two_real, &r_conj);
+					if (!block_sparse_tensor_allclose(&r_conj, &r, 1e-13)) {
+						return "dot product of block-sparse tensors with conjugation using batched block multiplications does not match reference";
+					}
+					delete_block_sparse_tensor(&r_conj);
+					delete_block_sparse_tensor(&tc);
+				}
+				if (axrange_s == TENSOR_AXIS_RANGE_LEADING)
+				{
+					struct block_sparse_tensor sc;
+					copy_block_sparse_tensor(&sp, &sc);
+					conjugate_block_sparse_tensor(&sc);
+					block_sparse_tensor_reverse_axis_directions(&sc);
+					struct block_sparse_tensor r_conj;
+					block_sparse_tensor_dot_conj(&sc, axrange_s, true, &tp, axrange_t, false, ndim_mult, &r_conj);
+					const double two_real = 2;
+					rscale_block_sparse_tensor(&two_real, &r_conj);
+					if (!block_sparse_tensor_allclose(&r_conj, &r, 1e-13)) {
+						return "dot product of block-sparse tensors with conjugation using batched block multiplications does not match reference";
+					}
+					delete_block_sparse_tensor(&r_conj);
+					delete_block_sparse_tensor(&sc);
+				}
+			}
+			set_block_sparse_gemm_batch_threshold(batch_threshold);
+
 			delete_dense_tensor(&r_dns);
 			delete_block_sparse_tensor(&r);
 
@@ -1049,6 +1277,49 @@ char* test_block_sparse_tensor_dot()
 		delete_block_sparse_tensor(&sp);
 	}
 
+	// general contraction with arbitrary axis lists
+	for (int c = 0; c < 2; c++)
+	{
+		// contracted axes of 's' are [s2, s3, s4] and of 't' are [t0, t1, t2]; the relative order of the remaining axes is preserved
+		const int perm_s[2][5] = { { 0, 1, 2, 3, 4 }, { 2, 0, 4, 1, 3 } };
+		const int perm_t[2][6] = { { 1, 2, 0, 3, 4, 5 }, { 3, 1, 4, 0, 5, 2 } };
+		const int axes_s[2][3] = { { 2, 3, 4 }, { 0, 4, 2 } };
+		const int axes_t[2][3] = { { 2, 0, 1 }, { 3, 1, 5 } };
+
+		struct block_sparse_tensor sp;
+		transpose_block_sparse_tensor(perm_s[c], &s, &sp);
+		struct block_sparse_tensor tp;
+		transpose_block_sparse_tensor(perm_t[c], &t, &tp);
+
+		struct block_sparse_tensor r;
+		block_sparse_tensor_contract(&sp, axes_s[c], &tp, axes_t[c], ndim_mult, &r);
+		struct dense_tensor r_dns;
+		block_sparse_to_dense_tensor(&r, &r_dns);
+		if (!dense_tensor_allclose(&r_dns, &r_dns_ref, 1e-13)) {
+			return "general contraction of block-sparse tensors does not match reference";
+		}
+
+		// precomputed plan, accumulating into the output tensor
+		struct block_sparse_tensor_dot_plan plan;
+		create_block_sparse_tensor_contract_plan(&sp, axes_s[c], &tp, axes_t[c], ndim_mult, &plan);
+		struct block_sparse_tensor r_plan;
+		allocate_block_sparse_tensor_dot_output(&plan, &r_plan);
+		block_sparse_tensor_dot_execute(&plan, numeric_one(CT_DOUBLE_COMPLEX), &sp, &tp, numeric_zero(CT_DOUBLE_COMPLEX), &r_plan);
+		block_sparse_tensor_dot_execute(&plan, numeric_one(CT_DOUBLE_COMPLEX), &sp, &tp, numeric_one(CT_DOUBLE_COMPLEX),  &r_plan);
+		const dcomplex two = 2;
+		scale_block_sparse_tensor(&two, &r);
+		if (!block_sparse_tensor_allclose(&r_plan, &r, 1e-13)) {
+			return "general contraction of block-sparse tensors using a precomputed plan does not match reference";
+		}
+		delete_block_sparse_tensor(&r_plan);
+		delete_block_sparse_tensor_dot_plan(&plan);
+
+		delete_dense_tensor(&r_dns);
+		delete_block_sparse_tensor(&r);
+		delete_block_sparse_tensor(&tp);
+		delete_block_sparse_tensor(&sp);
+	}
+
 	// clean up
 	delete_block_sparse_tensor(&s);
 	delete_block_sparse_tensor(&t);
@@ -1113,6 +1384,22 @@ char* test_block_sparse_tensor_qr()
 		struct block_sparse_tensor q, r;
 		block_sparse_tensor_qr(&a, &q, &r);
 
+		// parallel decomposition of the individual blocks
+		{
+			const enum block_sparse_parallel_mode parallel_mode = get_block_sparse_parallel_mode();
+			set_block_sparse_parallel_mode(BLOCK_SPARSE_PARALLEL_BLOCKS);
+			struct block_sparse_tensor q_par, r_par;
+			if (block_sparse_tensor_qr(&a, &q_par, &r_par) != 0) {
+				return "parallel QR decomposition of block-sparse tensor failed";
+			}
+			set_block_sparse_parallel_mode(parallel_mode);
+			if (!block_sparse_tensor_allclose(&q_par, &q, 1e-13) || !block_sparse_tensor_allclose(&r_par, &r, 1e-13)) {
+				return "parallel QR decomposition of block-sparse tensor does not match sequential version";
+			}
+			delete_block_sparse_tensor(&r_par);
+			delete_block_sparse_tensor(&q_par);
+		}
+
 		// matrix product 'q r' must be equal to 'a'
 		struct block_sparse_tensor qr;
 		block_sparse_tensor_dot(&q, TENSOR_AXIS_RANGE_TRAILING, &r, TENSOR_AXIS_RANGE_LEADING, 1, &qr);
@@ -1189,6 +1476,22 @@ char* test_block_sparse_tensor_rq()
 		struct block_sparse_tensor r, q;
 		block_sparse_tensor_rq(&a, &r, &q);
 
+		// parallel decomposition of the individual blocks
+		{
+			const enum block_sparse_parallel_mode parallel_mode = get_block_sparse_parallel_mode();
+			set_block_sparse_parallel_mode(BLOCK_SPARSE_PARALLEL_BLOCKS);
+			struct block_sparse_tensor r_par, q_par;
+			if (block_sparse_tensor_rq(&a, &r_par, &q_par) != 0) {
+				return "parallel RQ decomposition of block-sparse tensor failed";
+			}
+			set_block_sparse_parallel_mode(parallel_mode);
+			if (!block_sparse_tensor_allclose(&r_par, &r, 1e-13) || !block_sparse_tensor_allclose(&q_par, &q, 1e-13)) {
+				return "parallel RQ decomposition of block-sparse tensor does not match sequential version";
+			}
+			delete_block_sparse_tensor(&q_par);
+			delete_block_sparse_tensor(&r_par);
+		}
+
 		// matrix product 'r q' must be equal to 'a'
 		struct block_sparse_tensor rq;
 		block_sparse_tensor_dot(&r, TENSOR_AXIS_RANGE_TRAILING, &q, TENSOR_AXIS_RANGE_LEADING, 1, &rq);
@@ -1266,6 +1569,24 @@ char* test_block_sparse_tensor_svd()
 		struct dense_tensor s;
 		block_sparse_tensor_svd(&a, &u, &s, &vh);
 
+		// parallel decomposition of the individual blocks
+		{
+			const enum block_sparse_parallel_mode parallel_mode = get_block_sparse_parallel_mode();
+			set_block_sparse_parallel_mode(BLOCK_SPARSE_PARALLEL_BLOCKS);
+			struct block_sparse_tensor u_par, vh_par;
+			struct dense_tensor s_par;
+			if (block_sparse_tensor_svd(&a, &u_par, &s_par, &vh_par) != 0) {
+				return "parallel SVD of block-sparse tensor failed";
+			}
+			set_block_sparse_parallel_mode(parallel_mode);
+			if (!block_sparse_tensor_allclose(&u_par, &u, 1e-13) || !dense_tensor_allclose(&s_par, &s, 1e-13) || !block_sparse_tensor_allclose(&vh_par, &vh, 1e-13)) {
+				return "parallel SVD of block-sparse tensor does not match sequential version";
+			}
+			delete_block_sparse_tensor(&vh_par);
+			delete_dense_tensor(&s_par);
+			delete_block_sparse_tensor(&u_par);
+		}
+
 		if (s.dtype != CT_DOUBLE_REAL) {
 			return "expecting double data type for singular values";
 		}
@@ -1372,6 +1693,63 @@ char* test_block_sparse_tensor_serialize()
 		return "block-sparse tensor after serialization and deserialization does not match original tensor";
 	}
 
+	// contiguous storage of all blocks, in the serialization layout
+	block_sparse_tensor_make_contiguous(&s);
+	if (s.data == NULL) {
+		return "block-sparse tensor does not use contiguous storage";
+	}
+	if (memcmp(s.data, entries, nelem * sizeof(scomplex)) != 0) {
+		return "contiguous storage of block-sparse tensor does not match serialized entries";
+	}
+	if (!block_sparse_tensor_allclose(&s, &t, 0.)) {
+		return "block-sparse tensor with contiguous storage does not match original tensor";
+	}
+	// copy and conversion retain contiguous storage
+	struct block_sparse_tensor s_copy;
+	copy_block_sparse_tensor(&s, &s_copy);
+	struct block_sparse_tensor s_conv;
+	convert_block_sparse_tensor(CT_DOUBLE_COMPLEX, &s, &s_conv);
+	if (s_copy.data == NULL || s_conv.data == NULL) {
+		return "copy of block-sparse tensor with contiguous storage does not use contiguous storage";
+	}
+	if (!block_sparse_tensor_allclose(&s_copy, &t, 0.)) {
+		return "copy of block-sparse tensor with contiguous storage does not match original tensor";
+	}
+	for (long k = 0; k < s_conv.nblocks; k++) {
+		if (s_conv.blocks[k]->data != (dcomplex*)s_conv.data + ((scomplex*)s.blocks[k]->data - (scomplex*)s.data)) {
+			return "dense blocks do not refer to the contiguous storage of the converted block-sparse tensor";
+		}
+	}
+	struct block_sparse_tensor s_conv_ref;
+	convert_block_sparse_tensor(CT_DOUBLE_COMPLEX, &t, &s_conv_ref);
+	if (!block_sparse_tensor_allclose(&s_conv, &s_conv_ref, 0.)) {
+		return "converted block-sparse tensor with contiguous storage does not match reference";
+	}
+	// (de)serialization from and to the contiguous storage
+	scomplex* entries_contig = ct_malloc(nelem * sizeof(scomplex));
+	block_sparse_tensor_serialize_entries(&s_copy, entries_contig);
+	if (memcmp(entries_contig, entries, nelem * sizeof(scomplex)) != 0) {
+		return "serialized entries of block-sparse tensor with contiguous storage do not match reference";
+	}
+	memset(s_copy.data, 0, nelem * sizeof(scomplex));
+	block_sparse_tensor_deserialize_entries(&s_copy, entries_contig);
+	if (!block_sparse_tensor_allclose(&s_copy, &t, 0.)) {
+		return "block-sparse tensor with contiguous storage after deserialization does not match original tensor";
+	}
+	delete_block_sparse_tensor(&s_conv_ref);
+	delete_block_sparse_tensor(&s_conv);
+	delete_block_sparse_tensor(&s_copy);
+
+	// view of external entries
+	struct block_sparse_tensor v;
+	allocate_block_sparse_tensor_view(&t, &v);
+	block_sparse_tensor_view_entries(&v, entries_contig);
+	if (!block_sparse_tensor_allclose(&v, &t, 0.)) {
+		return "block-sparse tensor view does not match original tensor";
+	}
+	delete_block_sparse_tensor_view(&v);
+	ct_free(entries_contig);
+
 	// clean up
 	for (int i = 0; i < ndim; i++)
 	{
@@ -1466,3 +1844,145 @@ char* test_block_sparse_tensor_get_entry()
 
 	return 0;
 }
+
+
+char* test_block_sparse_tensor_lazy_view()
+{
+	struct rng_state rng_state;
+	seed_rng_state(47, &rng_state);
+
+	// tensor 's' with axes [s0, s1, s2, s3]
+	const long dims_s[4] = { 3, 4, 5, 2 };
+	const enum tensor_axis_direction axis_dir_s[4] = { TENSOR_AXIS_OUT, TENSOR_AXIS_IN, TENSOR_AXIS_IN, TENSOR_AXIS_OUT };
+	// tensor 't' with axes [x, s2, s3], sharing the axis directions with 's' (reversed by conjugation)
+	const long dims_t[3] = { 6, 5, 2 };
+	const enum tensor_axis_direction axis_dir_t[3] = { TENSOR_AXIS_IN, TENSOR_AXIS_IN, TENSOR_AXIS_OUT };
+
+	qnumber* qnums_s[4];
+	for (int i = 0; i < 4; i++)
+	{
+		qnums_s[i] = ct_malloc(dims_s[i] * sizeof(qnumber));
+		for (long j = 0; j < dims_s[i]; j++) {
+			qnums_s[i][j] = (qnumber)rand_interval(3, &rng_state) - 1;
+		}
+	}
+	qnumber* qnums_x = ct_malloc(dims_t[0] * sizeof(qnumber));
+	for (long j = 0; j < dims_t[0]; j++) {
+		qnums_x[j] = (qnumber)rand_interval(5, &rng_state) - 2;
+	}
+	const qnumber* qnums_t[3] = { qnums_x, qnums_s[2], qnums_s[3] };
+
+	for (int k = 0; k < 4; k++)
+	{
+		const enum numeric_type dtype = (enum numeric_type)k;
+		const double tol = (dtype == CT_SINGLE_REAL || dtype == CT_SINGLE_COMPLEX ? 1e-5 : 1e-13);
+
+		struct block_sparse_tensor s, t;
+		allocate_block_sparse_tensor(dtype, 4, dims_s, axis_dir_s, (const qnumber**)qnums_s, &s);
+		allocate_block_sparse_tensor(dtype, 3, dims_t, axis_dir_t, qnums_t, &t);
+		block_sparse_tensor_fill_random_normal(numeric_one(dtype), numeric_zero(dtype), &rng_state, &s);
+		block_sparse_tensor_fill_random_normal(numeric_one(dtype), numeric_zero(dtype), &rng_state, &t);
+
+		// composition of permutations and conjugation
+		{
+			const int perm_a[4] = { 1, 3, 0, 2 };
+			const int perm_b[4] = { 2, 0, 3, 1 };
+			struct block_sparse_tensor_lazy_view v;
+			create_block_sparse_tensor_lazy_view(&s, &v);
+			if (!block_sparse_tensor_lazy_view_is_trivial(&v)) {
+				return "newly created lazy view must not have pending operations";
+			}
+			block_sparse_tensor_lazy_view_transpose(perm_a, &v);
+			block_sparse_tensor_lazy_view_transpose(perm_b, &v);
+			block_sparse_tensor_lazy_view_conjugate(&v);
+			if (block_sparse_tensor_lazy_view_is_trivial(&v)) {
+				return "lazy view with pending operations reported as trivial";
+			}
+			struct block_sparse_tensor r;
+			block_sparse_tensor_lazy_view_materialize(&v, &r);
+			delete_block_sparse_tensor_lazy_view(&v);
+
+			// reference calculation
+			struct block_sparse_tensor s_a, r_ref;
+			transpose_block_sparse_tensor(perm_a, &s, &s_a);
+			conjugate_transpose_block_sparse_tensor(perm_b, &s_a, &r_ref);
+			block_sparse_tensor_reverse_axis_directions(&r_ref);
+
+			for (int i = 0; i < 4; i++) {
+				if (r.axis_dir[i] != r_ref.axis_dir[i]) {
+					return "axis directions of materialized lazy view do not match reference";
+				}
+			}
+			if (!block_sparse_tensor_allclose(&r, &r_ref, 0.)) {
+				return "materialized lazy view does not match reference";
+			}
+
+			delete_block_sparse_tensor(&r_ref);
+			delete_block_sparse_tensor(&s_a);
+			delete_block_sparse_tensor(&r);
+		}
+
+		// contraction absorbing permutations and conjugation
+		{
+			// view axes [s2, s0, s3, s1]
+			const int perm_s[4] = { 2, 0, 3, 1 };
+			struct block_sparse_tensor_lazy_view sv;
+			create_block_sparse_tensor_lazy_view(&s, &sv);
+			block_sparse_tensor_lazy_view_transpose(perm_s, &sv);
+			// view axes [s3, x, s2], conjugated
+			const int perm_t[3] = { 2, 0, 1 };
+			struct block_sparse_tensor_lazy_view tv;
+			create_block_sparse_tensor_lazy_view(&t, &tv);
+			block_sparse_tensor_lazy_view_transpose(perm_t, &tv);
+			block_sparse_tensor_lazy_view_conjugate(&tv);
+
+			const int axes_s[2] = { 2, 0 };
+			const int axes_t[2] = { 0, 2 };
+			struct block_sparse_tensor r;
+			struct block_sparse_tensor_lazy_view rv;
+			block_sparse_tensor_lazy_view_contract(&sv, axes_s, &tv, axes_t, 2, &r, &rv);
+			// pending permutation can be composed further
+			const int perm_r[3] = { 2, 0, 1 };
+			block_sparse_tensor_lazy_view_transpose(perm_r, &rv);
+			struct block_sparse_tensor r_mat;
+			block_sparse_tensor_lazy_view_materialize(&rv, &r_mat);
+
+			// reference calculation based on materialized operands
+			struct block_sparse_tensor s_mat, t_mat;
+			block_sparse_tensor_lazy_view_materialize(&sv, &s_mat);
+			block_sparse_tensor_lazy_view_materialize(&tv, &t_mat);
+			struct block_sparse_tensor u, r_ref;
+			block_sparse_tensor_contract(&s_mat, axes_s, &t_mat, axes_t, 2, &u);
+			transpose_block_sparse_tensor(perm_r, &u, &r_ref);
+
+			for (int i = 0; i < 3; i++) {
+				if (r_mat.axis_dir[i] != r_ref.axis_dir[i]) {
+					return "axis directions of contraction of lazy views do not match reference";
+				}
+			}
+			if (!block_sparse_tensor_allclose(&r_mat, &r_ref, tol)) {
+				return "contraction of lazy views does not match reference";
+			}
+
+			delete_block_sparse_tensor(&r_ref);
+			delete_block_sparse_tensor(&u);
+			delete_block_sparse_tensor(&t_mat);
+			delete_block_sparse_tensor(&s_mat);
+			delete_block_sparse_tensor(&r_mat);
+			delete_block_sparse_tensor_lazy_view(&rv);
+			delete_block_sparse_tensor(&r);
+			delete_block_sparse_tensor_lazy_view(&tv);
+			delete_block_sparse_tensor_lazy_view(&sv);
+		}
+
+		delete_block_sparse_tensor(&t);
+		delete_block_sparse_tensor(&s);
+	}
+
+	ct_free(qnums_x);
+	for (int i = 0; i < 4; i++) {
+		ct_free(qnums_s[i]);
+	}
+
+	return 0;
+}
@@ -2,6 +2,7 @@
 #include <complex.h>
 #include "dense_tensor.h"
 #include "aligned_memory.h"
+#include "rng.h"
 
 
 char* test_dense_tensor_trace()
@@ -135,6 +136,76 @@ char* test_dense_tensor_transpose()
 }
 
 
+char* test_dense_tensor_transpose_tiled()
+{
+	struct rng_state rng_state;
+	seed_rng_state(48, &rng_state);
+
+	// dimensions exceed the tile sizes of the transposition kernels, and include trailing non-permuted and singleton axes
+	const int ndim_list[5] = { 2, 3, 4, 4, 5 };
+	const long dim_list[5][5] = {
+		{ 19, 23 },
+		{ 13,  3, 37 },
+		{  5, 17,  2,  9 },
+		{  4,  1, 33,  1 },
+		{  3, 11,  2, 18,  3 },
+	};
+	const int perm_list[5][5] = {
+		{ 1, 0 },
+		{ 2, 0, 1 },
+		{ 3, 1, 0, 2 },
+		{ 2, 3, 0, 1 },
+		{ 1, 3, 0, 2, 4 },
+	};
+
+	for (int j = 0; j < 5; j++)
+	{
+		const int ndim = ndim_list[j];
+		const long* dim = dim_list[j];
+		const int* perm = perm_list[j];
+
+		for (int k = 0; k < 4; k++)
+		{
+			const enum numeric_type dtype = (enum numeric_type)k;
+
+			struct dense_tensor t;
+			allocate_dense_tensor(dtype, ndim, dim, &t);
+			dense_tensor_fill_random_normal(numeric_one(dtype), numeric_zero(dtype), &rng_state, &t);
+
+			struct dense_tensor t_tp;
+			transpose_dense_tensor(perm, &t, &t_tp);
+
+			// reference calculation based on individual tensor indices
+			struct dense_tensor t_tp_ref;
+			allocate_dense_tensor(dtype, ndim, t_tp.dim, &t_tp_ref);
+			const size_t dtype_size = sizeof_numeric_type(dtype);
+			long index_t[5];
+			long index_r[5];
+			const long nelem = dense_tensor_num_elements(&t);
+			for (long o = 0; o < nelem; o++)
+			{
+				offset_to_tensor_index(ndim, t.dim, o, index_t);
+				for (int i = 0; i < ndim; i++) {
+					index_r[i] = index_t[perm[i]];
+				}
+				memcpy((int8_t*)t_tp_ref.data + tensor_index_to_offset(ndim, t_tp_ref.dim, index_r) * dtype_size, (int8_t*)t.data + o * dtype_size, dtype_size);
+			}
+
+			// compare
+			if (!dense_tensor_allclose(&t_tp, &t_tp_ref, 0.)) {
+				return "transposed tensor does not match reference";
+			}
+
+			delete_dense_tensor(&t_tp_ref);
+			delete_dense_tensor(&t_tp);
+			delete_dense_tensor(&t);
+		}
+	}
+
+	return 0;
+}
+
+
 char* test_dense_tensor_slice()
 {
 	hid_t file = H5Fopen("../test/tensor/data/test_dense_tensor_slice.hdf5", H5F_ACC_RDONLY, H5P_DEFAULT);
@@ -542,6 +613,43 @@ char* test_dense_tensor_dot_update()
 				return "tensor updated by dot product of two other tensors does not match reference";
 			}
 
+			// complex conjugation of the operands (where supported by the axis ranges),
+			// compared to the dot product with explicitly conjugated copies
+			const bool conj_t = (axrange_t == TENSOR_AXIS_RANGE_LEADING);
+			const bool conj_s = (axrange_s == TENSOR_AXIS_RANGE_TRAILING);
+			{
+				struct dense_tensor tc, sc;
+				copy_dense_tensor(&tp, &tc);
+				copy_dense_tensor(&sp, &sc);
+				if (conj_t) {
+					conjugate_dense_tensor(&tc);
+				}
+				if (conj_s) {
+					conjugate_dense_tensor(&sc);
+				}
+
+				struct dense_tensor t_dot_s_conj_ref, t_dot_s_conj;
+				allocate_dense_tensor(CT_SINGLE_COMPLEX, 5, t_dot_s_dim, &t_dot_s_conj_ref);
+				allocate_dense_tensor(CT_SINGLE_COMPLEX, 5, t_dot_s_dim, &t_dot_s_conj);
+				if (read_hdf5_dataset(file, "t_dot_s_0", H5T_NATIVE_FLOAT, t_dot_s_conj_ref.data) < 0) {
+					return "reading tensor entries from disk failed";
+				}
+				if (read_hdf5_dataset(file, "t_dot_s_0", H5T_NATIVE_FLOAT, t_dot_s_conj.data) < 0) {
+					return "reading tensor entries from disk failed";
+				}
+				dense_tensor_dot_update(&alpha, &tc, axrange_t, &sc, axrange_s, 2, &beta, &t_dot_s_conj_ref);
+				dense_tensor_dot_conj_update(&alpha, &tp, axrange_t, conj_t, &sp, axrange_s, conj_s, 2, &beta, &t_dot_s_conj);
+
+				if (!dense_tensor_allclose(&t_dot_s_conj, &t_dot_s_conj_ref, 1e-5)) {
+					return "tensor updated by dot product of two other tensors with complex conjugation does not match reference";
+				}
+
+				delete_dense_tensor(&t_dot_s_conj);
+				delete_dense_tensor(&t_dot_s_conj_ref);
+				delete_dense_tensor(&sc);
+				delete_dense_tensor(&tc);
+			}
+
 			delete_dense_tensor(&t_dot_s);
 
 			delete_dense_tensor(&sp);
@@ -561,6 +669,175 @@ char* test_dense_tensor_dot_update()
 }
 
 
+char* test_dense_tensor_contract()
+{
+	struct rng_state rng_state;
+	seed_rng_state(49, &rng_state);
+
+	// test cases covering batched and summed matrix multiplications, transposed operands, singleton axes,
+	// empty row or column groups and the fallback to explicit permutations
+	const int ndim_s_list[8] = { 4, 4, 3, 2, 2, 4, 3, 4 };
+	const int ndim_t_list[8] = { 5, 5, 3, 2, 4, 2, 3, 3 };
+	const long dim_s_list[8][5] = {
+		{ 3, 2, 2, 4 },
+		{ 1, 5, 3, 7 },
+		{ 4, 5, 6 },
+		{ 3, 4 },
+		{ 6, 5 },
+		{ 2, 7, 1, 3 },
+		{ 4, 3, 6 },
+		{ 3, 5, 2, 4 },
+	};
+	const long dim_t_list[8][5] = {
+		{ 5, 2, 4, 6, 1 },
+		{ 3, 2, 5, 7, 1 },
+		{ 6, 3, 4 },
+		{ 3, 4 },
+		{ 2, 5, 6, 3 },
+		{ 7, 4 },
+		{ 5, 4, 6 },
+		{ 4, 6, 3 },
+	};
+	const int ndim_mult_list[8] = { 2, 2, 2, 2, 2, 1, 2, 2 };
+	const int axes_s_list[8][2] = {
+		{ 2, 3 },
+		{ 1, 2 },
+		{ 2, 0 },
+		{ 0, 1 },
+		{ 1, 0 },
+		{ 1 },
+		{ 0, 2 },
+		{ 0, 3 },
+	};
+	const int axes_t_list[8][2] = {
+		{ 1, 2 },
+		{ 2, 0 },
+		{ 0, 2 },
+		{ 0, 1 },
+		{ 1, 2 },
+		{ 0 },
+		{ 1, 2 },
+		{ 2, 0 },
+	};
+
+	const float    alpha_s =  1.2f;
+	const double   alpha_d = -0.4;
+	const scomplex alpha_c =  0.3f - 0.8f*I;
+	const dcomplex alpha_z = -1.1  + 0.5*I;
+	const float    beta_s  = -0.7f;
+	const double   beta_d  =  0.9;
+	const scomplex beta_c  = -0.2f + 1.3f*I;
+	const dcomplex beta_z  =  0.6  - 0.4*I;
+	const void* alpha_list[4] = { &alpha_s, &alpha_d, &alpha_c, &alpha_z };
+	const void* beta_list[4]  = { &beta_s,  &beta_d,  &beta_c,  &beta_z  };
+
+	for (int j = 0; j < 8; j++)
+	{
+		const int ndim_mult = ndim_mult_list[j];
+		const int* axes_s = axes_s_list[j];
+		const int* axes_t = axes_t_list[j];
+
+		for (int k = 0; k < 4; k++)
+		{
+			const enum numeric_type dtype = (enum numeric_type)k;
+
+			struct dense_tensor s, t;
+			allocate_dense_tensor(dtype, ndim_s_list[j], dim_s_list[j], &s);
+			allocate_dense_tensor(dtype, ndim_t_list[j], dim_t_list[j], &t);
+			dense_tensor_fill_random_normal(numeric_one(dtype), numeric_zero(dtype), &rng_state, &s);
+			dense_tensor_fill_random_normal(numeric_one(dtype), numeric_zero(dtype), &rng_state, &t);
+
+			struct dense_tensor r;
+			dense_tensor_contract(&s, axes_s, &t, axes_t, ndim_mult, &r);
+
+			// reference calculation: explicitly permute the to-be contracted axes to the end of 's' and the beginning of 't'
+			int perm_s[5];
+			int perm_t[5];
+			int c = 0;
+			for (int i = 0; i < s.ndim; i++) {
+				if (i != axes_s[0] && (ndim_mult < 2 || i != axes_s[1])) {
+					perm_s[c++] = i;
+				}
+			}
+			for (int i = 0; i < ndim_mult; i++) {
+				perm_s[c++] = axes_s[i];
+				perm_t[i] = axes_t[i];
+			}
+			c = ndim_mult;
+			for (int i = 0; i < t.ndim; i++) {
+				if (i != axes_t[0] && (ndim_mult < 2 || i != axes_t[1])) {
+					perm_t[c++] = i;
+				}
+			}
+			struct dense_tensor s_perm, t_perm;
+			transpose_dense_tensor(perm_s, &s, &s_perm);
+			transpose_dense_tensor(perm_t, &t, &t_perm);
+			struct dense_tensor r_ref;
+			dense_tensor_dot(&s_perm, TENSOR_AXIS_RANGE_TRAILING, &t_perm, TENSOR_AXIS_RANGE_LEADING, ndim_mult, &r_ref);
+
+			const double tol = (dtype == CT_SINGLE_REAL || dtype == CT_SINGLE_COMPLEX ? 1e-5 : 1e-13);
+
+			// compare
+			if (!dense_tensor_allclose(&r, &r_ref, tol)) {
+				return "general tensor contraction does not match reference";
+			}
+
+			// update version
+			struct dense_tensor r_update;
+			allocate_dense_tensor(dtype, r_ref.ndim, r_ref.dim, &r_update);
+			dense_tensor_fill_random_normal(numeric_one(dtype), numeric_zero(dtype), &rng_state, &r_update);
+			struct dense_tensor r_update_ref;
+			copy_dense_tensor(&r_update, &r_update_ref);
+			dense_tensor_contract_update(alpha_list[k], &s, axes_s, &t, axes_t, ndim_mult, beta_list[k], &r_update);
+			scale_dense_tensor(beta_list[k], &r_update_ref);
+			dense_tensor_scalar_multiply_add(alpha_list[k], &r_ref, &r_update_ref);
+			if (!dense_tensor_allclose(&r_update, &r_update_ref, tol)) {
+				return "general tensor contraction update does not match reference";
+			}
+
+			// conjugated operands
+			for (int c = 1; c < 4; c++)
+			{
+				const bool conj_s = ((c & 1) != 0);
+				const bool conj_t = ((c & 2) != 0);
+				struct dense_tensor s_conj, t_conj;
+				copy_dense_tensor(&s, &s_conj);
+				copy_dense_tensor(&t, &t_conj);
+				if (conj_s) {
+					conjugate_dense_tensor(&s_conj);
+				}
+				if (conj_t) {
+					conjugate_dense_tensor(&t_conj);
+				}
+				struct dense_tensor r_conj_ref;
+				dense_tensor_contract(&s_conj, axes_s, &t_conj, axes_t, ndim_mult, &r_conj_ref);
+				struct dense_tensor r_conj;
+				allocate_dense_tensor(dtype, r_ref.ndim, r_ref.dim, &r_conj);
+				dense_tensor_contract_conj_update(numeric_one(dtype), &s, axes_s, conj_s, &t, axes_t, conj_t, ndim_mult, numeric_zero(dtype), &r_conj);
+				if (!dense_tensor_allclose(&r_conj, &r_conj_ref, tol)) {
+					return "general tensor contraction with conjugated operands does not match reference";
+				}
+				delete_dense_tensor(&r_conj);
+				delete_dense_tensor(&r_conj_ref);
+				delete_dense_tensor(&t_conj);
+				delete_dense_tensor(&s_conj);
+			}
+
+			delete_dense_tensor(&r_update_ref);
+			delete_dense_tensor(&r_update);
+			delete_dense_tensor(&r_ref);
+			delete_dense_tensor(&t_perm);
+			delete_dense_tensor(&s_perm);
+			delete_dense_tensor(&r);
+			delete_dense_tensor(&t);
+			delete_dense_tensor(&s);
+		}
+	}
+
+	return 0;
+}
+
+
 char* test_dense_tensor_kronecker_product()
 {
 	hid_t file = H5Fopen("../test/tensor/data/test_dense_tensor_kronecker_product.hdf5", H5F_ACC_RDONLY, H5P_DEFAULT);
@@ -0,0 +1,128 @@
+#include <cblas.h>
+#include "small_gemm.h"
+#include "dense_tensor.h"
+#include "aligned_memory.h"
+#include "rng.h"
+
+
+//________________________________________________________________________________________________________________________
+///
+/// \brief Reference matrix-matrix multiplication by BLAS.
+///
+static void reference_gemm(const enum numeric_type dtype, const CBLAS_TRANSPOSE transa, const CBLAS_TRANSPOSE transb, const long m, const long n, const long k,
+	const void* alpha, const void* a, const long lda, const void* b, const long ldb, const void* beta, void* c, const long ldc)
+{
+	switch (dtype)
+	{
+		case CT_SINGLE_REAL:
+		{
+			cblas_sgemm(CblasRowMajor, transa, transb, m, n, k, *((float*)alpha), a, lda, b, ldb, *((float*)beta), c, ldc);
+			break;
+		}
+		case CT_DOUBLE_REAL:
+		{
+			cblas_dgemm(CblasRowMajor, transa, transb, m, n, k, *((double*)alpha), a, lda, b, ldb, *((double*)beta), c, ldc);
+			break;
+		}
+		case CT_SINGLE_COMPLEX:
+		{
+			cblas_cgemm(CblasRowMajor, transa, transb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+			break;
+		}
+		case CT_DOUBLE_COMPLEX:
+		{
+			cblas_zgemm(CblasRowMajor, transa, transb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+			break;
+		}
+		default:
+		{
+			// unknown data type
+			assert(false);
+		}
+	}
+}
+
+
+char* test_small_k_gemm()
+{
+	struct rng_state rng_state;
+	seed_rng_state(43, &rng_state);
+
+	const long m = 5;
+	const long n = 7;
+
+	const CBLAS_TRANSPOSE trans_list[3] = { CblasNoTrans, CblasTrans, CblasConjTrans };
+
+	for (int dt = 0; dt < 4; dt++)
+	{
+		const enum numeric_type dtype = (enum numeric_type)dt;
+		const bool is_complex = (dtype == CT_SINGLE_COMPLEX || dtype == CT_DOUBLE_COMPLEX);
+		const double tol = (dtype == CT_SINGLE_REAL || dtype == CT_SINGLE_COMPLEX ? 1e-5 : 1e-13);
+
+		// random scaling factors
+		struct dense_tensor alpha, beta;
+		const long dim_scalar[1] = { 1 };
+		allocate_dense_tensor(dtype, 1, dim_scalar, &alpha);
+		allocate_dense_tensor(dtype, 1, dim_scalar, &beta);
+		dense_tensor_fill_random_normal(numeric_one(dtype), numeric_zero(dtype), &rng_state, &alpha);
+		dense_tensor_fill_random_normal(numeric_one(dtype), numeric_zero(dtype), &rng_state, &beta);
+
+		for (long k = 1; k <= SMALL_K_GEMM_MAX; k++)
+		{
+			if (!small_k_gemm_applicable(k)) {
+				return "inner dimension not handled by specialized kernels";
+			}
+
+			for (int ia = 0; ia < (is_complex ? 3 : 2); ia++)
+			{
+				for (int ib = 0; ib < (is_complex ? 3 : 2); ib++)
+				{
+					const CBLAS_TRANSPOSE transa = trans_list[ia];
+					const CBLAS_TRANSPOSE transb = trans_list[ib];
+
+					// use leading dimensions larger than the matrix dimensions
+					struct dense_tensor a, b, c;
+					const long dim_a[2] = { transa == CblasNoTrans ? m : k, (transa == CblasNoTrans ? k : m) + 1 };
+					const long dim_b[2] = { transb == CblasNoTrans ? k : n, (transb == CblasNoTrans ? n : k) + 2 };
+					const long dim_c[2] = { m, n + 3 };
+					allocate_dense_tensor(dtype, 2, dim_a, &a);
+					allocate_dense_tensor(dtype, 2, dim_b, &b);
+					allocate_dense_tensor(dtype, 2, dim_c, &c);
+					dense_tensor_fill_random_normal(numeric_one(dtype), numeric_zero(dtype), &rng_state, &a);
+					dense_tensor_fill_random_normal(numeric_one(dtype), numeric_zero(dtype), &rng_state, &b);
+					dense_tensor_fill_random_normal(numeric_one(dtype), numeric_zero(dtype), &rng_state, &c);
+
+					for (int use_beta = 0; use_beta < 2; use_beta++)
+					{
+						const void* beta_data = (use_beta ? beta.data : numeric_zero(dtype));
+
+						struct dense_tensor c_ref;
+						copy_dense_tensor(&c, &c_ref);
+						reference_gemm(dtype, transa, transb, m, n, k, alpha.data, a.data, dim_a[1], b.data, dim_b[1], beta_data, c_ref.data, dim_c[1]);
+
+						struct dense_tensor c_small;
+						copy_dense_tensor(&c, &c_small);
+						small_k_gemm(dtype, transa, transb, m, n, k, alpha.data, a.data, dim_a[1], b.data, dim_b[1], beta_data, c_small.data, dim_c[1]);
+
+						// entries beyond the matrix dimensions must remain unchanged
+						if (!dense_tensor_allclose(&c_small, &c_ref, tol)) {
+							return "matrix-matrix multiplication by specialized small-k kernel does not match BLAS reference";
+						}
+
+						delete_dense_tensor(&c_small);
+						delete_dense_tensor(&c_ref);
+					}
+
+					delete_dense_tensor(&c);
+					delete_dense_tensor(&b);
+					delete_dense_tensor(&a);
+				}
+			}
+		}
+
+		delete_dense_tensor(&beta);
+		delete_dense_tensor(&alpha);
+	}
+
+	return 0;
+}
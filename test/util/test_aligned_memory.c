@@ -0,0 +1,238 @@
+#include <stdint.h>
+#include "aligned_memory.h"
+
+
+struct counting_allocator_context
+{
+	long num_allocate;
+	long num_deallocate;
+};
+
+static void* counting_allocate(size_t size, void* context)
+{
+	((struct counting_allocator_context*)context)->num_allocate++;
+	return ct_system_allocator.allocate(size, ct_system_allocator.context);
+}
+
+static void counting_deallocate(void* memblock, size_t size, void* context)
+{
+	((struct counting_allocator_context*)context)->num_deallocate++;
+	ct_system_allocator.deallocate(memblock, size, ct_system_allocator.context);
+}
+
+
+char* test_aligned_memory()
+{
+	const struct ct_allocator* default_allocator = ct_get_allocator();
+
+	// statistics
+	for (int k = 0; k < 2; k++)
+	{
+		// blocks from the system allocator are accounted for by their usable size, and otherwise by the requested size
+		ct_set_allocator(k == 0 ? &ct_system_allocator : &ct_pool_allocator);
+
+		ct_reset_memory_stats();
+		struct ct_memory_stats stats_start;
+		ct_get_memory_stats(&stats_start);
+
+		void* p = ct_malloc(100);
+		void* q = ct_calloc(7, 3);
+		if ((uintptr_t)p % CT_MEM_DATA_ALIGN != 0 || (uintptr_t)q % CT_MEM_DATA_ALIGN != 0) {
+			return "allocated memory block is not aligned";
+		}
+		for (int i = 0; i < 21; i++) {
+			if (((char*)q)[i] != 0) {
+				return "memory allocated by 'ct_calloc' is not initialized with zeros";
+			}
+		}
+		ct_free(p);
+		ct_free(q);
+		ct_free(NULL);
+
+		struct ct_memory_stats stats;
+		ct_get_memory_stats(&stats);
+		if (stats.num_allocations != 2 || stats.num_deallocations != 2) {
+			return "memory allocation statistics do not record the expected number of calls";
+		}
+		if (stats.current_bytes != stats_start.current_bytes) {
+			return "currently allocated memory must be unchanged after freeing all blocks";
+		}
+		if (k == 0 ? stats.peak_bytes < stats_start.current_bytes + 121 : stats.peak_bytes != stats_start.current_bytes + 121) {
+			return "peak memory usage does not match expected value";
+		}
+
+		ct_set_allocator(default_allocator);
+		ct_memory_trim();
+	}
+
+	// pool allocator
+	{
+		ct_set_allocator(&ct_pool_allocator);
+		if (ct_get_allocator() != &ct_pool_allocator) {
+			return "allocator has not been set";
+		}
+
+		void* p = ct_malloc(40);
+		// large block bypassing the size classes
+		void* r = ct_malloc(1 << 20);
+		ct_free(p);
+		ct_free(r);
+		// freed block must be re-used for a request of the same size class
+		void* q = ct_malloc(48);
+		if (q != p) {
+			return "pool allocator does not re-use freed memory block";
+		}
+
+		// switch back while 'q' is still allocated
+		ct_set_allocator(default_allocator);
+		ct_free(q);
+		ct_memory_trim();
+	}
+
+	// custom allocator
+	{
+		struct counting_allocator_context context = { 0 };
+		const struct ct_allocator counting_allocator = { .allocate = counting_allocate, .deallocate = counting_deallocate, .context = &context };
+		ct_set_allocator(&counting_allocator);
+		void* p = ct_malloc(17);
+		void* q = ct_malloc(5);
+		ct_free(p);
+		ct_set_allocator(default_allocator);
+		ct_free(q);
+		if (context.num_allocate != 2 || context.num_deallocate != 2) {
+			return "custom allocator has not been called the expected number of times";
+		}
+	}
+
+	// transparent huge pages for large memory blocks
+	{
+		ct_set_huge_page_threshold(1 << 20);
+		const size_t size = 3 << 20;
+		char* p = ct_malloc(size);
+		if (!ct_is_aligned(p)) {
+			return "memory block backed by huge pages is not aligned";
+		}
+		memset(p, 1, size);
+		if (p[size - 1] != 1) {
+			return "memory block backed by huge pages is not writable";
+		}
+		ct_free(p);
+		ct_set_huge_page_threshold(CT_MEM_HUGE_PAGE_THRESHOLD);
+	}
+
+	// arena regions
+	{
+		ct_reset_memory_stats();
+
+		struct ct_memory_marker marker = ct_memory_mark();
+		void* p = ct_malloc(24);
+		void* q = ct_malloc(3000000);  // larger than the default chunk capacity
+		if ((uintptr_t)p % CT_MEM_DATA_ALIGN != 0 || (uintptr_t)q % CT_MEM_DATA_ALIGN != 0) {
+			return "memory block allocated from arena is not aligned";
+		}
+		memset(q, 1, 3000000);
+
+		// nested region
+		struct ct_memory_marker marker_inner = ct_memory_mark();
+		void* s = ct_malloc(64);
+		ct_free(s);
+		ct_memory_release(&marker_inner);
+		void* t = ct_malloc(64);
+		if (t != s) {
+			return "arena memory has not been re-used after releasing nested region";
+		}
+		ct_free(t);
+
+		ct_free(q);
+		ct_free(p);
+		ct_memory_release(&marker);
+
+		// memory of released region must be re-used
+		marker = ct_memory_mark();
+		void* u = ct_malloc(24);
+		if (u != p) {
+			return "arena memory has not been re-used after releasing region";
+		}
+		ct_free(u);
+		ct_memory_release(&marker);
+
+		// allocations outside of regions are not served by the arena
+		void* v = ct_malloc(24);
+		ct_free(v);
+
+		struct ct_memory_stats stats;
+		ct_get_memory_stats(&stats);
+		if (stats.num_allocations != 6 || stats.num_arena_allocations != 5) {
+			return "number of arena allocations does not match expected value";
+		}
+
+		ct_memory_trim();
+		ct_get_memory_stats(&stats);
+		if (stats.arena_bytes != 0) {
+			return "arena memory has not been returned to the system";
+		}
+	}
+
+	// temporaries freed in reverse order within a region
+	{
+		struct ct_memory_marker marker = ct_memory_mark();
+		void* p = ct_malloc(1000);
+		ct_free(p);
+		void* q = ct_malloc(2000);
+		if (q != p) {
+			return "arena memory of most recently freed block has not been re-used within region";
+		}
+		ct_free(q);
+		ct_memory_release(&marker);
+	}
+
+	// arena footprint must not grow with the number of regions ("sites") of increasing memory demand
+	{
+		struct ct_memory_marker marker_outer = ct_memory_mark();
+		void* p = ct_malloc(24);
+		const size_t size_max = 6 << 20;
+		for (size_t size = 2 << 20; size <= size_max; size += 1 << 20)
+		{
+			struct ct_memory_marker marker = ct_memory_mark();
+			void* q = ct_malloc(size / 2);
+			void* r = ct_malloc(size);
+			memset(r, 1, size);
+			ct_free(r);
+			ct_free(q);
+			ct_memory_release(&marker);
+
+			// the chunk of the outer region, and at most two chunks sized for the current demand
+			struct ct_memory_stats stats;
+			ct_get_memory_stats(&stats);
+			if (stats.arena_bytes > (1 << 20) + 3 * size) {
+				return "arena footprint grows across regions of increasing memory demand";
+			}
+		}
+		ct_free(p);
+		ct_memory_release(&marker_outer);
+
+		// only a single chunk of default capacity is retained after releasing the outermost region
+		struct ct_memory_stats stats;
+		ct_get_memory_stats(&stats);
+		if (stats.arena_bytes > (1 << 20) + 4096) {
+			return "arena chunks have not been returned to the system after releasing the outermost region";
+		}
+		ct_memory_trim();
+	}
+
+	// memory blocks from the system allocator and the pool allocator can be freed by another thread
+	{
+		ct_set_allocator(&ct_pool_allocator);
+		void* p[2];
+		p[0] = ct_malloc(40);
+		ct_set_allocator(default_allocator);
+		p[1] = ct_malloc(40);
+		#pragma omp parallel for num_threads(2)
+		for (int i = 0; i < 2; i++) {
+			ct_free(p[i]);
+		}
+		ct_memory_trim();
+	}
+
+	return 0;
+}
@@ -1,11 +1,21 @@
 #include <math.h>
 #include <complex.h>
 #include <cblas.h>
+#include <lapacke.h>
 #include "krylov.h"
 #include "aligned_memory.h"
 #include "util.h"
 
 
+static void multiply_matrix_vector_s(const long n, const void* restrict data, const float* restrict v, float* restrict ret)
+{
+	const float* a = (float*)data;
+
+	// perform matrix-vector multiplication
+	cblas_sgemv(CblasRowMajor, CblasNoTrans, n, n, 1.f, a, n, v, 1, 0.f, ret, 1);
+}
+
+
 static void multiply_matrix_vector_d(const long n, const void* restrict data, const double* restrict v, double* restrict ret)
 {
 	const double* a = (double*)data;
@@ -15,6 +25,17 @@ static void multiply_matrix_vector_d(const long n, const void* restrict data, co
 }
 
 
+static void multiply_matrix_vector_c(const long n, const void* restrict data, const scomplex* restrict v, scomplex* restrict ret)
+{
+	const scomplex* a = (scomplex*)data;
+
+	// perform matrix-vector multiplication
+	const scomplex one  = 1;
+	const scomplex zero = 0;
+	cblas_cgemv(CblasRowMajor, CblasNoTrans, n, n, &one, a, n, v, 1, &zero, ret, 1);
+}
+
+
 static void multiply_matrix_vector_z(const long n, const void* restrict data, const dcomplex* restrict v, dcomplex* restrict ret)
 {
 	const dcomplex* a = (dcomplex*)data;
@@ -346,3 +367,539 @@ char* test_eigensystem_krylov_hermitian()
 
 	return 0;
 }
+
+
+char* test_eigensystem_krylov_symmetric_single()
+{
+	hid_t file = H5Fopen("../test/util/data/test_eigensystem_krylov_symmetric.hdf5", H5F_ACC_RDONLY, H5P_DEFAULT);
+	if (file < 0) {
+		return "'H5Fopen' in test_eigensystem_krylov_symmetric_single failed";
+	}
+
+	// "large" matrix dimension
+	const long n = 197;
+
+	// maximum number of iterations
+	const int maxiter = 35;
+
+	// number of eigenvalues and -vectors
+	const int numeig = 5;
+
+	// load 'a' matrix from disk and convert it to single precision
+	double* a_dbl = ct_malloc(n*n * sizeof(double));
+	if (read_hdf5_dataset(file, "a", H5T_NATIVE_DOUBLE, a_dbl) < 0) {
+		return "reading matrix entries from disk failed";
+	}
+	float* a = ct_malloc(n*n * sizeof(float));
+	for (long i = 0; i < n*n; i++) {
+		a[i] = (float)a_dbl[i];
+	}
+
+	// load starting vector from disk and convert it to single precision
+	double* vstart_dbl = ct_malloc(n * sizeof(double));
+	if (read_hdf5_dataset(file, "vstart", H5T_NATIVE_DOUBLE, vstart_dbl) < 0) {
+		return "reading starting vector from disk failed";
+	}
+	float* vstart = ct_malloc(n * sizeof(float));
+	for (long i = 0; i < n; i++) {
+		vstart[i] = (float)vstart_dbl[i];
+	}
+
+	float* lambda  = ct_malloc(numeig   * sizeof(float));
+	float* u_ritz = ct_malloc(n*numeig * sizeof(float));
+	int ret = eigensystem_krylov_symmetric_single(n, multiply_matrix_vector_s, a, vstart, maxiter, numeig, lambda, u_ritz);
+	if (ret < 0) {
+		return "'eigensystem_krylov_symmetric_single' failed internally";
+	}
+
+	// load double precision reference data from disk
+	double* lambda_ref = ct_malloc(numeig * sizeof(double));
+	if (read_hdf5_dataset(file, "lambda", H5T_NATIVE_DOUBLE, lambda_ref) < 0) {
+		return "reading Ritz eigenvalues from disk failed";
+	}
+
+	// compare, taking single precision rounding errors into account
+	for (int i = 0; i < numeig; i++) {
+		if (fabs(lambda[i] - lambda_ref[i]) > 1e-4 * fabs(lambda_ref[0])) {
+			return "Ritz eigenvalues computed in single precision do not match reference";
+		}
+	}
+	// residual of eigenvector corresponding to smallest Ritz eigenvalue, evaluated in double precision
+	double* u  = ct_malloc(n * sizeof(double));
+	double* au = ct_malloc(n * sizeof(double));
+	for (long j = 0; j < n; j++) {
+		u[j] = u_ritz[j*numeig];
+	}
+	multiply_matrix_vector_d(n, a_dbl, u, au);
+	double res = 0;
+	for (long j = 0; j < n; j++) {
+		res = fmax(res, fabs(au[j] - lambda_ref[0] * u[j]));
+	}
+	if (res > 1e-3 * fabs(lambda_ref[0])) {
+		return "Ritz eigenvector computed in single precision has too large residual";
+	}
+
+	ct_free(au);
+	ct_free(u);
+	ct_free(lambda_ref);
+	ct_free(u_ritz);
+	ct_free(lambda);
+	ct_free(vstart);
+	ct_free(vstart_dbl);
+	ct_free(a);
+	ct_free(a_dbl);
+
+	H5Fclose(file);
+
+	return 0;
+}
+
+
+char* test_eigensystem_krylov_hermitian_single()
+{
+	hid_t file = H5Fopen("../test/util/data/test_eigensystem_krylov_hermitian.hdf5", H5F_ACC_RDONLY, H5P_DEFAULT);
+	if (file < 0) {
+		return "'H5Fopen' in test_eigensystem_krylov_hermitian_single failed";
+	}
+
+	// "large" matrix dimension
+	const long n = 185;
+
+	// maximum number of iterations
+	const int maxiter = 37;
+
+	// number of eigenvalues and -vectors
+	const int numeig = 6;
+
+	// load 'a' matrix from disk and convert it to single precision
+	dcomplex* a_dbl = ct_malloc(n*n * sizeof(dcomplex));
+	if (read_hdf5_dataset(file, "a", H5T_NATIVE_DOUBLE, a_dbl) < 0) {
+		return "reading matrix entries from disk failed";
+	}
+	scomplex* a = ct_malloc(n*n * sizeof(scomplex));
+	for (long i = 0; i < n*n; i++) {
+		a[i] = (scomplex)a_dbl[i];
+	}
+
+	// load starting vector from disk and convert it to single precision
+	dcomplex* vstart_dbl = ct_malloc(n * sizeof(dcomplex));
+	if (read_hdf5_dataset(file, "vstart", H5T_NATIVE_DOUBLE, vstart_dbl) < 0) {
+		return "reading starting vector from disk failed";
+	}
+	scomplex* vstart = ct_malloc(n * sizeof(scomplex));
+	for (long i = 0; i < n; i++) {
+		vstart[i] = (scomplex)vstart_dbl[i];
+	}
+
+	float* lambda  = ct_malloc(numeig   * sizeof(float));
+	scomplex* u_ritz = ct_malloc(n*numeig * sizeof(scomplex));
+	int ret = eigensystem_krylov_hermitian_single(n, multiply_matrix_vector_c, a, vstart, maxiter, numeig, lambda, u_ritz);
+	if (ret < 0) {
+		return "'eigensystem_krylov_hermitian_single' failed internally";
+	}
+
+	// load double precision reference data from disk
+	double* lambda_ref = ct_malloc(numeig * sizeof(double));
+	if (read_hdf5_dataset(file, "lambda", H5T_NATIVE_DOUBLE, lambda_ref) < 0) {
+		return "reading Ritz eigenvalues from disk failed";
+	}
+
+	// compare, taking single precision rounding errors into account
+	for (int i = 0; i < numeig; i++) {
+		if (fabs(lambda[i] - lambda_ref[i]) > 1e-4 * fabs(lambda_ref[0])) {
+			return "Ritz eigenvalues computed in single precision do not match reference";
+		}
+	}
+	// residual of eigenvector corresponding to smallest Ritz eigenvalue, evaluated in double precision
+	dcomplex* u  = ct_malloc(n * sizeof(dcomplex));
+	dcomplex* au = ct_malloc(n * sizeof(dcomplex));
+	for (long j = 0; j < n; j++) {
+		u[j] = u_ritz[j*numeig];
+	}
+	multiply_matrix_vector_z(n, a_dbl, u, au);
+	double res = 0;
+	for (long j = 0; j < n; j++) {
+		res = fmax(res, cabs(au[j] - lambda_ref[0] * u[j]));
+	}
+	if (res > 1e-3 * fabs(lambda_ref[0])) {
+		return "Ritz eigenvector computed in single precision has too large residual";
+	}
+
+	ct_free(au);
+	ct_free(u);
+	ct_free(lambda_ref);
+	ct_free(u_ritz);
+	ct_free(lambda);
+	ct_free(vstart);
+	ct_free(vstart_dbl);
+	ct_free(a);
+	ct_free(a_dbl);
+
+	H5Fclose(file);
+
+	return 0;
+}
+
+
+char* test_eigensystem_davidson_symmetric()
+{
+	hid_t file = H5Fopen("../test/util/data/test_eigensystem_krylov_symmetric.hdf5", H5F_ACC_RDONLY, H5P_DEFAULT);
+	if (file < 0) {
+		return "'H5Fopen' in test_eigensystem_davidson_symmetric failed";
+	}
+
+	// "large" matrix dimension
+	const long n = 197;
+
+	// maximum number of linear operator applications and search subspace dimension
+	const int maxiter = 200;
+	const int maxvec  = 24;
+
+	// residual norm tolerance
+	const double tol = 1e-10;
+
+	// load 'a' matrix from disk
+	double* a = ct_malloc(n*n * sizeof(double));
+	if (read_hdf5_dataset(file, "a", H5T_NATIVE_DOUBLE, a) < 0) {
+		return "reading matrix entries from disk failed";
+	}
+
+	// load starting vector from disk
+	double* vstart = ct_malloc(n * sizeof(double));
+	if (read_hdf5_dataset(file, "vstart", H5T_NATIVE_DOUBLE, vstart) < 0) {
+		return "reading starting vector from disk failed";
+	}
+
+	// diagonal entries as preconditioner
+	double* diag = ct_malloc(n * sizeof(double));
+	for (long i = 0; i < n; i++) {
+		diag[i] = a[i*n + i];
+	}
+
+	double lambda;
+	double* u = ct_malloc(n * sizeof(double));
+	int num_matvec;
+	int ret = eigensystem_davidson_symmetric(n, multiply_matrix_vector_d, a, diag, vstart, maxiter, maxvec, tol, &lambda, u, &num_matvec);
+	if (ret < 0) {
+		return "'eigensystem_davidson_symmetric' failed internally";
+	}
+	if (num_matvec >= maxiter) {
+		return "Davidson method did not converge";
+	}
+
+	// reference eigenvalues by exact diagonalization
+	double* a_copy = ct_malloc(n*n * sizeof(double));
+	memcpy(a_copy, a, n*n * sizeof(double));
+	double* lambda_ref = ct_malloc(n * sizeof(double));
+	if (LAPACKE_dsyev(LAPACK_ROW_MAJOR, 'N', 'U', n, a_copy, n, lambda_ref) != 0) {
+		return "LAPACK function 'dsyev()' failed";
+	}
+
+	// compare
+	if (fabs(lambda - lambda_ref[0]) > 1e-12) {
+		return "smallest eigenvalue computed by Davidson method does not match reference";
+	}
+	// residual of eigenvector
+	double* au = ct_malloc(n * sizeof(double));
+	multiply_matrix_vector_d(n, a, u, au);
+	cblas_daxpy(n, -lambda, u, 1, au, 1);
+	if (cblas_dnrm2(n, au, 1) > tol) {
+		return "eigenvector computed by Davidson method has too large residual";
+	}
+	if (fabs(cblas_dnrm2(n, u, 1) - 1) > 1e-13) {
+		return "eigenvector computed by Davidson method is not normalized";
+	}
+
+	ct_free(au);
+	ct_free(lambda_ref);
+	ct_free(a_copy);
+	ct_free(u);
+	ct_free(diag);
+	ct_free(vstart);
+	ct_free(a);
+
+	H5Fclose(file);
+
+	return 0;
+}
+
+
+char* test_eigensystem_davidson_hermitian()
+{
+	hid_t file = H5Fopen("../test/util/data/test_eigensystem_krylov_hermitian.hdf5", H5F_ACC_RDONLY, H5P_DEFAULT);
+	if (file < 0) {
+		return "'H5Fopen' in test_eigensystem_davidson_hermitian failed";
+	}
+
+	// "large" matrix dimension
+	const long n = 185;
+
+	// maximum number of linear operator applications and search subspace dimension
+	const int maxiter = 200;
+	const int maxvec  = 24;
+
+	// residual norm tolerance
+	const double tol = 1e-10;
+
+	// load 'a' matrix from disk
+	dcomplex* a = ct_malloc(n*n * sizeof(dcomplex));
+	if (read_hdf5_dataset(file, "a", H5T_NATIVE_DOUBLE, a) < 0) {
+		return "reading matrix entries from disk failed";
+	}
+
+	// load starting vector from disk
+	dcomplex* vstart = ct_malloc(n * sizeof(dcomplex));
+	if (read_hdf5_dataset(file, "vstart", H5T_NATIVE_DOUBLE, vstart) < 0) {
+		return "reading starting vector from disk failed";
+	}
+
+	// diagonal entries as preconditioner
+	double* diag = ct_malloc(n * sizeof(double));
+	for (long i = 0; i < n; i++) {
+		diag[i] = creal(a[i*n + i]);
+	}
+
+	double lambda;
+	dcomplex* u = ct_malloc(n * sizeof(dcomplex));
+	int num_matvec;
+	int ret = eigensystem_davidson_hermitian(n, multiply_matrix_vector_z, a, diag, vstart, maxiter, maxvec, tol, &lambda, u, &num_matvec);
+	if (ret < 0) {
+		return "'eigensystem_davidson_hermitian' failed internally";
+	}
+	if (num_matvec >= maxiter) {
+		return "Davidson method did not converge";
+	}
+
+	// reference eigenvalues by exact diagonalization
+	dcomplex* a_copy = ct_malloc(n*n * sizeof(dcomplex));
+	memcpy(a_copy, a, n*n * sizeof(dcomplex));
+	double* lambda_ref = ct_malloc(n * sizeof(double));
+	if (LAPACKE_zheev(LAPACK_ROW_MAJOR, 'N', 'U', n, a_copy, n, lambda_ref) != 0) {
+		return "LAPACK function 'zheev()' failed";
+	}
+
+	// compare
+	if (fabs(lambda - lambda_ref[0]) > 1e-12) {
+		return "smallest eigenvalue computed by Davidson method does not match reference";
+	}
+	// residual of eigenvector
+	dcomplex* au = ct_malloc(n * sizeof(dcomplex));
+	multiply_matrix_vector_z(n, a, u, au);
+	for (long i = 0; i < n; i++) {
+		au[i] -= lambda * u[i];
+	}
+	if (cblas_dznrm2(n, au, 1) > tol) {
+		return "eigenvector computed by Davidson method has too large residual";
+	}
+	if (fabs(cblas_dznrm2(n, u, 1) - 1) > 1e-13) {
+		return "eigenvector computed by Davidson method is not normalized";
+	}
+
+	ct_free(au);
+	ct_free(lambda_ref);
+	ct_free(a_copy);
+	ct_free(u);
+	ct_free(diag);
+	ct_free(vstart);
+	ct_free(a);
+
+	H5Fclose(file);
+
+	return 0;
+}
+
+
+char* test_eigensystem_krylov_restarted_symmetric()
+{
+	hid_t file = H5Fopen("../test/util/data/test_eigensystem_krylov_symmetric.hdf5", H5F_ACC_RDONLY, H5P_DEFAULT);
+	if (file < 0) {
+		return "'H5Fopen' in test_eigensystem_krylov_restarted_symmetric failed";
+	}
+
+	// "large" matrix dimension
+	const long n = 197;
+
+	// maximum number of linear operator applications and stored Krylov vectors
+	const int maxiter = 1000;
+	const int maxvec  = 16;
+
+	// number of eigenvalues and -vectors
+	const int numeig = 3;
+
+	// residual norm tolerance
+	const double tol = 1e-10;
+
+	// load 'a' matrix from disk
+	double* a = ct_malloc(n*n * sizeof(double));
+	if (read_hdf5_dataset(file, "a", H5T_NATIVE_DOUBLE, a) < 0) {
+		return "reading matrix entries from disk failed";
+	}
+
+	// load starting vector from disk
+	double* vstart = ct_malloc(n * sizeof(double));
+	if (read_hdf5_dataset(file, "vstart", H5T_NATIVE_DOUBLE, vstart) < 0) {
+		return "reading starting vector from disk failed";
+	}
+
+	double* lambda = ct_malloc(numeig   * sizeof(double));
+	double* u_ritz = ct_malloc(n*numeig * sizeof(double));
+	int num_matvec;
+	int ret = eigensystem_krylov_restarted_symmetric(n, multiply_matrix_vector_d, a, vstart, maxiter, maxvec, numeig, tol, lambda, u_ritz, &num_matvec);
+	if (ret < 0) {
+		return "'eigensystem_krylov_restarted_symmetric' failed internally";
+	}
+	if (num_matvec >= maxiter) {
+		return "restarted Lanczos iteration did not converge";
+	}
+
+	// reference eigenvalues by exact diagonalization
+	double* a_copy = ct_malloc(n*n * sizeof(double));
+	memcpy(a_copy, a, n*n * sizeof(double));
+	double* lambda_ref = ct_malloc(n * sizeof(double));
+	if (LAPACKE_dsyev(LAPACK_ROW_MAJOR, 'N', 'U', n, a_copy, n, lambda_ref) != 0) {
+		return "LAPACK function 'dsyev()' failed";
+	}
+
+	// compare
+	if (uniform_distance(CT_DOUBLE_REAL, numeig, lambda, lambda_ref) > 1e-12) {
+		return "eigenvalues computed by restarted Lanczos iteration do not match reference";
+	}
+	// residuals and orthonormality of eigenvectors
+	double* u  = ct_malloc(n * sizeof(double));
+	double* au = ct_malloc(n * sizeof(double));
+	for (int i = 0; i < numeig; i++)
+	{
+		cblas_dcopy(n, &u_ritz[i], numeig, u, 1);
+		multiply_matrix_vector_d(n, a, u, au);
+		cblas_daxpy(n, -lambda[i], u, 1, au, 1);
+		if (cblas_dnrm2(n, au, 1) > tol) {
+			return "eigenvector computed by restarted Lanczos iteration has too large residual";
+		}
+		for (int j = 0; j < numeig; j++) {
+			if (fabs(cblas_ddot(n, &u_ritz[i], numeig, &u_ritz[j], numeig) - (i == j ? 1 : 0)) > 1e-13) {
+				return "eigenvectors computed by restarted Lanczos iteration are not orthonormal";
+			}
+		}
+	}
+
+	// starting from a slightly perturbed eigenvector of the smallest eigenvalue, the iteration must terminate before the Krylov basis is full
+	{
+		cblas_dcopy(n, &u_ritz[0], numeig, u, 1);
+		cblas_daxpy(n, 1e-4 / cblas_dnrm2(n, vstart, 1), vstart, 1, u, 1);
+		double lambda_restart;
+		ret = eigensystem_krylov_restarted_symmetric(n, multiply_matrix_vector_d, a, u, maxiter, maxvec, 1, 1e-2, &lambda_restart, au, &num_matvec);
+		if (ret < 0) {
+			return "'eigensystem_krylov_restarted_symmetric' failed internally";
+		}
+		if (num_matvec >= maxvec) {
+			return "restarted Lanczos iteration starting from perturbed eigenvector did not terminate early";
+		}
+		if (fabs(lambda_restart - lambda_ref[0]) > 1e-6) {
+			return "eigenvalue computed by restarted Lanczos iteration starting from perturbed eigenvector does not match reference";
+		}
+	}
+
+	ct_free(au);
+	ct_free(u);
+	ct_free(lambda_ref);
+	ct_free(a_copy);
+	ct_free(u_ritz);
+	ct_free(lambda);
+	ct_free(vstart);
+	ct_free(a);
+
+	H5Fclose(file);
+
+	return 0;
+}
+
+
+char* test_eigensystem_krylov_restarted_hermitian()
+{
+	hid_t file = H5Fopen("../test/util/data/test_eigensystem_krylov_hermitian.hdf5", H5F_ACC_RDONLY, H5P_DEFAULT);
+	if (file < 0) {
+		return "'H5Fopen' in test_eigensystem_krylov_restarted_hermitian failed";
+	}
+
+	// "large" matrix dimension
+	const long n = 185;
+
+	// maximum number of linear operator applications and stored Krylov vectors
+	const int maxiter = 1000;
+	const int maxvec  = 16;
+
+	// number of eigenvalues and -vectors
+	const int numeig = 3;
+
+	// residual norm tolerance
+	const double tol = 1e-10;
+
+	// load 'a' matrix from disk
+	dcomplex* a = ct_malloc(n*n * sizeof(dcomplex));
+	if (read_hdf5_dataset(file, "a", H5T_NATIVE_DOUBLE, a) < 0) {
+		return "reading matrix entries from disk failed";
+	}
+
+	// load starting vector from disk
+	dcomplex* vstart = ct_malloc(n * sizeof(dcomplex));
+	if (read_hdf5_dataset(file, "vstart", H5T_NATIVE_DOUBLE, vstart) < 0) {
+		return "reading starting vector from disk failed";
+	}
+
+	double* lambda   = ct_malloc(numeig   * sizeof(double));
+	dcomplex* u_ritz = ct_malloc(n*numeig * sizeof(dcomplex));
+	int num_matvec;
+	int ret = eigensystem_krylov_restarted_hermitian(n, multiply_matrix_vector_z, a, vstart, maxiter, maxvec, numeig, tol, lambda, u_ritz, &num_matvec);
+	if (ret < 0) {
+		return "'eigensystem_krylov_restarted_hermitian' failed internally";
+	}
+	if (num_matvec >= maxiter) {
+		return "restarted Lanczos iteration did not converge";
+	}
+
+	// reference eigenvalues by exact diagonalization
+	dcomplex* a_copy = ct_malloc(n*n * sizeof(dcomplex));
+	memcpy(a_copy, a, n*n * sizeof(dcomplex));
+	double* lambda_ref = ct_malloc(n * sizeof(double));
+	if (LAPACKE_zheev(LAPACK_ROW_MAJOR, 'N', 'U', n, a_copy, n, lambda_ref) != 0) {
+		return "LAPACK function 'zheev()' failed";
+	}
+
+	// compare
+	if (uniform_distance(CT_DOUBLE_REAL, numeig, lambda, lambda_ref) > 1e-12) {
+		return "eigenvalues computed by restarted Lanczos iteration do not match reference";
+	}
+	// residuals and orthonormality of eigenvectors
+	dcomplex* u  = ct_malloc(n * sizeof(dcomplex));
+	dcomplex* au = ct_malloc(n * sizeof(dcomplex));
+	for (int i = 0; i < numeig; i++)
+	{
+		cblas_zcopy(n, &u_ritz[i], numeig, u, 1);
+		multiply_matrix_vector_z(n, a, u, au);
+		const dcomplex neg_lambda = -lambda[i];
+		cblas_zaxpy(n, &neg_lambda, u, 1, au, 1);
+		if (cblas_dznrm2(n, au, 1) > tol) {
+			return "eigenvector computed by restarted Lanczos iteration has too large residual";
+		}
+		for (int j = 0; j < numeig; j++) {
+			dcomplex ov;
+			cblas_zdotc_sub(n, &u_ritz[i], numeig, &u_ritz[j], numeig, &ov);
+			if (cabs(ov - (i == j ? 1 : 0)) > 1e-13) {
+				return "eigenvectors computed by restarted Lanczos iteration are not orthonormal";
+			}
+		}
+	}
+
+	ct_free(au);
+	ct_free(u);
+	ct_free(lambda_ref);
+	ct_free(a_copy);
+	ct_free(u_ritz);
+	ct_free(lambda);
+	ct_free(vstart);
+	ct_free(a);
+
+	H5Fclose(file);
+
+	return 0;
+}